@@ -19,7 +19,7 @@ namespace api {
 static const char *const TAG = "api.connection";
 
 APIConnection::APIConnection(AsyncClient *client, APIServer *parent)
-    : client_(client), parent_(parent), initial_state_iterator_(parent, this), list_entities_iterator_(parent, this) {
+    : client_(client), parent_(parent), initial_state_iterator_(this), list_entities_iterator_(this) {
   this->client_->onError([](void *s, AsyncClient *c, int8_t error) { ((APIConnection *) s)->on_error_(error); }, this);
   this->client_->onDisconnect([](void *s, AsyncClient *c) { ((APIConnection *) s)->on_disconnect_(); }, this);
   this->client_->onTimeout([](void *s, AsyncClient *c, uint32_t time) { ((APIConnection *) s)->on_timeout_(time); },
@@ -655,8 +655,11 @@ void APIConnection::select_command(const SelectCommandRequest &msg) {
 void APIConnection::send_camera_state(std::shared_ptr<esp32_camera::CameraImage> image) {
   if (!this->state_subscription_)
     return;
-  if (this->image_reader_.available())
+  if (this->image_reader_.available()) {
+    // still sending an earlier frame, this client gets the next one
+    esp32_camera::global_esp32_camera->report_skipped_frame();
     return;
+  }
   this->image_reader_.set_image(image);
 }
 bool APIConnection::send_camera_info(esp32_camera::ESP32Camera *camera) {
@@ -90,6 +90,12 @@ void APIServer::loop() {
       this->status_clear_warning();
     }
   }
+
+  const bool connected = this->is_connected();
+  if (connected != this->was_connected_) {
+    this->was_connected_ = connected;
+    this->connected_state_callback_.call();
+  }
 }
 void APIServer::dump_config() {
   ESP_LOGCONFIG(TAG, "API Server:");
@@ -6,7 +6,6 @@
 #include "esphome/core/log.h"
 #include "api_pb2.h"
 #include "api_pb2_service.h"
-#include "util.h"
 #include "list_entities.h"
 #include "subscribe_state.h"
 #include "user_services.h"
@@ -73,6 +72,10 @@ class APIServer : public Component, public Controller {
 #endif
 
   bool is_connected() const;
+  /// Add a callback that is called after is_connected() has changed, at the latest in the next loop iteration.
+  template<typename F> void add_on_connected_state_callback(F &&callback) {
+    this->connected_state_callback_.add(std::forward<F>(callback));
+  }
 
   struct HomeAssistantStateSubscription {
     std::string entity_id;
@@ -94,6 +97,8 @@ class APIServer : public Component, public Controller {
   std::string password_;
   std::vector<HomeAssistantStateSubscription> state_subs_;
   std::vector<UserServiceDescriptor *> user_services_;
+  bool was_connected_{false};
+  CallbackManager<void()> connected_state_callback_;
 };
 
 extern APIServer *global_api_server;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
@@ -101,6 +106,10 @@ extern APIServer *global_api_server;  // NOLINT(cppcoreguidelines-avoid-non-cons
 template<typename... Ts> class APIConnectedCondition : public Condition<Ts...> {
  public:
   bool check(Ts... x) override { return global_api_server->is_connected(); }
+  bool add_listener(ConditionListener *listener) override {
+    global_api_server->add_on_connected_state_callback([listener]() { listener->on_condition_change(); });
+    return true;
+  }
 };
 
 }  // namespace api
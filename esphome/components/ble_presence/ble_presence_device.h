@@ -41,6 +41,9 @@ class BLEPresenceDevice : public binary_sensor::BinarySensorInitiallyOff,
     this->check_ibeacon_minor_ = true;
     this->ibeacon_minor_ = minor;
   }
+  uint64_t get_address_filter() const override {
+    return this->match_by_ == MATCH_BY_MAC_ADDRESS ? this->address_ : 0;
+  }
   void on_scan_end() override {
     if (!this->found_)
       this->publish_state(false);
@@ -27,6 +27,7 @@ class BLERSSISensor : public sensor::Sensor, public esp32_ble_tracker::ESPBTDevi
     this->by_address_ = false;
     this->uuid_ = esp32_ble_tracker::ESPBTUUID::from_raw(uuid);
   }
+  uint64_t get_address_filter() const override { return this->by_address_ ? this->address_ : 0; }
   void on_scan_end() override {
     if (!this->found_)
       this->publish_state(NAN);
@@ -5,141 +5,208 @@
 #include <Crypto.h>
 #include <GCM.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace esphome {
 namespace dsmr {
 
 static const char *const TAG = "dsmr";
 
-void Dsmr::loop() {
-  if (this->decryption_key_.empty())
-    this->receive_telegram_();
-  else
-    this->receive_encrypted_();
+// CRC16 of the telegram as specified by DSMR: polynomial 0xA001, initial value 0
+static uint16_t crc16_update(uint16_t crc, uint8_t byte) {
+  crc ^= byte;
+  for (uint8_t i = 0; i < 8; i++) {
+    if ((crc & 0x01) != 0) {
+      crc = (crc >> 1) ^ 0xA001;
+    } else {
+      crc >>= 1;
+    }
+  }
+  return crc;
 }
 
-void Dsmr::receive_telegram_() {
-  while (available()) {
-    const char c = read();
-
-    if (c == '/') {  // header: forward slash
-      ESP_LOGV(TAG, "Header found");
-      header_found_ = true;
-      footer_found_ = false;
-      telegram_len_ = 0;
+void Dsmr::loop() {
+  const uint32_t now = millis();
+  while (true) {
+    auto data = this->read_span();
+    if (data.empty())
+      break;
+    this->last_read_ = now;
+    if (this->decryption_key_.empty()) {
+      for (uint8_t c : data)
+        this->receive_char_(c);
+    } else {
+      this->receive_encrypted_(data.data(), data.size());
     }
+  }
 
-    if (!header_found_)
-      continue;
-    if (telegram_len_ >= MAX_TELEGRAM_LENGTH) {  // Buffer overflow
-      header_found_ = false;
-      footer_found_ = false;
-      ESP_LOGE(TAG, "Error: Message larger than buffer");
-      return;
-    }
+  if ((this->header_found_ || this->encrypted_pos_ > 0) && now - this->last_read_ > POLL_TIMEOUT) {
+    ESP_LOGW(TAG, "Timeout while waiting for the rest of the telegram");
+    this->status_momentary_warning("timeout");
+    this->reset_();
+  }
+}
+
+void Dsmr::receive_char_(char c) {
+  if (c == '/') {  // header: forward slash
+    ESP_LOGV(TAG, "Header found");
+    this->header_found_ = true;
+    this->footer_found_ = false;
+    this->telegram_len_ = 0;
+    this->crc_ = 0;
+  }
 
-    telegram_[telegram_len_] = c;
-    telegram_len_++;
+  if (!this->header_found_)
+    return;
+  if (this->telegram_len_ >= MAX_TELEGRAM_LENGTH) {  // Buffer overflow
+    ESP_LOGE(TAG, "Error: Message larger than buffer");
+    this->header_found_ = false;
+    this->footer_found_ = false;
+    return;
+  }
+
+  this->telegram_[this->telegram_len_++] = c;
+  if (!this->footer_found_) {
+    this->crc_ = crc16_update(this->crc_, c);
     if (c == '!') {  // footer: exclamation mark
       ESP_LOGV(TAG, "Footer found");
-      footer_found_ = true;
-    } else {
-      if (footer_found_ && c == 10) {  // last \n after footer
-        header_found_ = false;
-        // Parse message
-        if (parse_telegram())
-          return;
-      }
+      this->footer_found_ = true;
+      this->footer_pos_ = this->telegram_len_ - 1;
     }
+  } else if (c == '\n') {  // last \n after footer
+    this->header_found_ = false;
+    this->footer_found_ = false;
+    this->parse_telegram();
+    this->telegram_done_ = true;
   }
 }
 
-void Dsmr::receive_encrypted_() {
-  // Encrypted buffer
-  uint8_t buffer[MAX_TELEGRAM_LENGTH];
-  size_t buffer_length = 0;
-
-  size_t packet_size = 0;
-  while (available()) {
-    const char c = read();
-
-    if (!header_found_) {
-      if ((uint8_t) c == 0xdb) {
-        ESP_LOGV(TAG, "Start byte 0xDB found");
-        header_found_ = true;
+void Dsmr::receive_encrypted_(const uint8_t *data, size_t len) {
+  while (len > 0) {
+    if (this->encrypted_pos_ == 0) {
+      // Skip everything up to the start byte of the next telegram
+      auto *start = static_cast<const uint8_t *>(memchr(data, 0xDB, len));
+      if (start != data) {
+        ESP_LOGW(TAG, "Unexpected data, the first byte of an encrypted telegram should be 0xDB");
+        this->status_momentary_warning("unexpected_data");
       }
+      if (start == nullptr)
+        return;
+      len -= start - data;
+      data = start;
     }
 
-    // Sanity check
-    if (!header_found_ || buffer_length >= MAX_TELEGRAM_LENGTH) {
-      if (buffer_length == 0) {
-        ESP_LOGE(TAG, "First byte of encrypted telegram should be 0xDB, aborting.");
-      } else {
-        ESP_LOGW(TAG, "Unexpected data");
+    if (this->encrypted_pos_ < ENCRYPTED_HEADER_LENGTH) {
+      const size_t n = std::min(len, ENCRYPTED_HEADER_LENGTH - this->encrypted_pos_);
+      memcpy(&this->encrypted_header_[this->encrypted_pos_], data, n);
+      this->encrypted_pos_ += n;
+      data += n;
+      len -= n;
+      if (this->encrypted_pos_ < ENCRYPTED_HEADER_LENGTH)
+        return;
+
+      // the length at byte 11 counts everything after the length itself
+      this->encrypted_len_ = (this->encrypted_header_[11] << 8 | this->encrypted_header_[12]) + 13;
+      if (this->encrypted_len_ < ENCRYPTED_HEADER_LENGTH + ENCRYPTED_TAG_LENGTH ||
+          this->encrypted_len_ - ENCRYPTED_HEADER_LENGTH - ENCRYPTED_TAG_LENGTH > MAX_TELEGRAM_LENGTH) {
+        ESP_LOGW(TAG, "Invalid encrypted telegram length %u", (unsigned) this->encrypted_len_);
+        this->status_momentary_warning("unexpected_data");
+        this->encrypted_pos_ = 0;
+        continue;
       }
-      this->status_momentary_warning("unexpected_data");
-      this->flush();
-      while (available())
-        read();
-      return;
-    }
-
-    buffer[buffer_length++] = c;
+      ESP_LOGV(TAG, "Encrypted telegram of %u bytes", (unsigned) this->encrypted_len_);
 
-    if (packet_size == 0 && buffer_length > 20) {
-      // Complete header + a few bytes of data
-      packet_size = buffer[11] << 8 | buffer[12];
+      // the iv is 8 bytes of the system title + 4 bytes frame counter
+      // system title is at byte 2 and frame counter at byte 14
+      uint8_t iv[12];
+      memcpy(&iv[0], &this->encrypted_header_[2], 8);
+      memcpy(&iv[8], &this->encrypted_header_[14], 4);
+      this->gcm_->setIV(iv, sizeof(iv));
+      this->header_found_ = false;
+      this->footer_found_ = false;
+      this->telegram_done_ = false;
     }
-    if (buffer_length == packet_size + 13 && packet_size > 0) {
-      ESP_LOGV(TAG, "Encrypted data: %d bytes", buffer_length);
 
-      GCM<AES128> *gcmaes128{new GCM<AES128>()};
-      gcmaes128->setKey(this->decryption_key_.data(), gcmaes128->keySize());
-      // the iv is 8 bytes of the system title + 4 bytes frame counter
-      // system title is at byte 2 and frame counter at byte 15
-      for (int i = 10; i < 14; i++)
-        buffer[i] = buffer[i + 4];
-      constexpr uint16_t iv_size{12};
-      gcmaes128->setIV(&buffer[2], iv_size);
-      gcmaes128->decrypt(reinterpret_cast<uint8_t *>(this->telegram_),
-                         // the ciphertext start at byte 18
-                         &buffer[18],
-                         // cipher size
-                         buffer_length - 17);
-      delete gcmaes128;
-
-      telegram_len_ = strnlen(this->telegram_, sizeof(this->telegram_));
-      ESP_LOGV(TAG, "Decrypted data length: %d", telegram_len_);
-      ESP_LOGVV(TAG, "Decrypted data %s", this->telegram_);
-
-      parse_telegram();
-      telegram_len_ = 0;
-      return;
+    // the ciphertext is followed by the authentication tag, which is skipped
+    const size_t ciphertext_end = this->encrypted_len_ - ENCRYPTED_TAG_LENGTH;
+    if (this->encrypted_pos_ < ciphertext_end) {
+      uint8_t plaintext[uart::UART_READ_CHUNK_SIZE];
+      const size_t n = std::min(std::min(len, ciphertext_end - this->encrypted_pos_), sizeof(plaintext));
+      this->gcm_->decrypt(plaintext, data, n);
+      for (size_t i = 0; i < n; i++)
+        this->receive_char_(plaintext[i]);
+      this->encrypted_pos_ += n;
+      data += n;
+      len -= n;
+      continue;
     }
 
-    if (!available()) {
-      // baud rate is 115200 for encrypted data, this means a few byte should arrive every time
-      // program runs faster than buffer loading then available() might return false in the middle
-      delay(4);  // Wait for data
+    const size_t n = std::min(len, this->encrypted_len_ - this->encrypted_pos_);
+    this->encrypted_pos_ += n;
+    data += n;
+    len -= n;
+    if (this->encrypted_pos_ == this->encrypted_len_) {
+      if (!this->telegram_done_) {
+        ESP_LOGW(TAG, "Encrypted telegram did not contain a complete telegram, is the decryption key correct?");
+        this->status_momentary_warning("unexpected_data");
+      }
+      this->reset_();
     }
   }
-  if (buffer_length > 0)
-    ESP_LOGW(TAG, "Timeout while waiting for encrypted data or invalid data received.");
+}
+
+void Dsmr::reset_() {
+  this->header_found_ = false;
+  this->footer_found_ = false;
+  this->telegram_len_ = 0;
+  this->encrypted_pos_ = 0;
 }
 
 bool Dsmr::parse_telegram() {
+  // The CRC up to and including the footer was computed while receiving, the 4 hex digits after the footer must match
+  const char *crc_start = &this->telegram_[this->footer_pos_ + 1];
+  if (this->telegram_len_ - this->footer_pos_ - 1 < 4) {
+    ESP_LOGW(TAG, "No checksum found");
+    this->status_momentary_warning("crc");
+    return false;
+  }
+  uint16_t crc = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    const char c = crc_start[i];
+    uint8_t digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else {
+      ESP_LOGW(TAG, "Invalid checksum");
+      this->status_momentary_warning("crc");
+      return false;
+    }
+    crc = (crc << 4) | digit;
+  }
+  if (crc != this->crc_) {
+    ESP_LOGW(TAG, "Checksum mismatch, telegram has %04X but is %04X", crc, this->crc_);
+    this->status_momentary_warning("crc");
+    return false;
+  }
+
   MyData data;
   ESP_LOGV(TAG, "Trying to parse");
-  ::dsmr::ParseResult<void> res =
-      ::dsmr::P1Parser::parse(&data, telegram_, telegram_len_,
-                              false);  // Parse telegram according to data definition. Ignore unknown values.
+  // Parse the lines between header and footer according to data definition. Ignore unknown values.
+  const char *data_end = &this->telegram_[this->footer_pos_];
+  ::dsmr::ParseResult<void> res = ::dsmr::P1Parser::parse_data(&data, &this->telegram_[1], data_end, false);
   if (res.err) {
     // Parsing error, show it
-    auto err_str = res.fullError(telegram_, telegram_ + telegram_len_);
+    auto err_str = res.fullError(&this->telegram_[1], data_end);
     ESP_LOGE(TAG, "%s", err_str.c_str());
     return false;
   } else {
     this->status_clear_warning();
-    publish_sensors(data);
+    this->publish_sensors(data);
     return true;
   }
 }
@@ -176,6 +243,11 @@ void Dsmr::set_decryption_key(const std::string &decryption_key) {
     strncpy(temp, &(decryption_key.c_str()[i * 2]), 2);
     decryption_key_.push_back(std::strtoul(temp, nullptr, 16));
   }
+
+  // The cipher is keyed once, each telegram only sets its own iv
+  if (this->gcm_ == nullptr)
+    this->gcm_ = new GCM<AES128>();  // NOLINT(cppcoreguidelines-owning-memory)
+  this->gcm_->setKey(this->decryption_key_.data(), this->gcm_->keySize());
 }
 
 }  // namespace dsmr
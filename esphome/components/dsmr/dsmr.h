@@ -11,11 +11,19 @@
 #include <dsmr/parser.h>
 #include <dsmr/fields.h>
 
+// from <GCM.h> and <AES.h>
+template<typename T> class GCM;
+class AES128;
+
 namespace esphome {
 namespace dsmr {
 
 static constexpr uint32_t MAX_TELEGRAM_LENGTH = 1500;
+/// A partially received telegram is dropped when no data arrived for this long (ms).
 static constexpr uint32_t POLL_TIMEOUT = 1000;
+/// Start byte, system title, length and frame counter of an encrypted telegram.
+static constexpr size_t ENCRYPTED_HEADER_LENGTH = 18;
+static constexpr size_t ENCRYPTED_TAG_LENGTH = 12;
 
 using namespace ::dsmr::fields;
 
@@ -52,16 +60,20 @@ class Dsmr : public Component, public uart::UARTDevice {
 
   void loop() override;
 
+  /// Verify the CRC of the telegram in the buffer and parse it, returns false if either fails.
   bool parse_telegram();
 
+  /// Publish the values of the telegram, only those that changed since the last one.
   void publish_sensors(MyData &data) {
 #define DSMR_PUBLISH_SENSOR(s) \
-  if (data.s##_present && this->s_##s##_ != nullptr) \
+  if (data.s##_present && this->s_##s##_ != nullptr && \
+      (!this->s_##s##_->has_state() || this->s_##s##_->get_raw_state() != data.s)) \
     s_##s##_->publish_state(data.s);
     DSMR_SENSOR_LIST(DSMR_PUBLISH_SENSOR, )
 
 #define DSMR_PUBLISH_TEXT_SENSOR(s) \
-  if (data.s##_present && this->s_##s##_ != nullptr) \
+  if (data.s##_present && this->s_##s##_ != nullptr && \
+      (!this->s_##s##_->has_state() || this->s_##s##_->state != data.s.c_str())) \
     s_##s##_->publish_state(data.s.c_str());
     DSMR_TEXT_SENSOR_LIST(DSMR_PUBLISH_TEXT_SENSOR, )
   };
@@ -80,8 +92,12 @@ class Dsmr : public Component, public uart::UARTDevice {
   DSMR_TEXT_SENSOR_LIST(DSMR_SET_TEXT_SENSOR, )
 
  protected:
-  void receive_telegram_();
-  void receive_encrypted_();
+  /// Feed one character of a plaintext telegram to the parser, the telegram is parsed after its last line.
+  void receive_char_(char c);
+  /// Decrypt the received bytes of encrypted telegrams and feed the plaintext to receive_char_().
+  void receive_encrypted_(const uint8_t *data, size_t len);
+  /// Drop the telegram that is being received.
+  void reset_();
 
   // Telegram buffer
   char telegram_[MAX_TELEGRAM_LENGTH];
@@ -90,6 +106,22 @@ class Dsmr : public Component, public uart::UARTDevice {
   // Serial parser
   bool header_found_{false};
   bool footer_found_{false};
+  /// The CRC16 of the telegram up to and including the footer.
+  uint16_t crc_{0};
+  /// Position of the footer ('!') in the telegram buffer.
+  int footer_pos_{0};
+  /// Whether a telegram was completed since the start of the current encrypted telegram.
+  bool telegram_done_{false};
+  /// millis() when the last byte was received.
+  uint32_t last_read_{0};
+
+  // Encrypted telegram, the ciphertext is decrypted as it arrives
+  GCM<AES128> *gcm_{nullptr};
+  uint8_t encrypted_header_[ENCRYPTED_HEADER_LENGTH];
+  /// The number of bytes of the encrypted telegram received so far, 0 while waiting for its start byte.
+  size_t encrypted_pos_{0};
+  /// The length of the encrypted telegram including its header.
+  size_t encrypted_len_{0};
 
 // Sensor member pointers
 #define DSMR_DECLARE_SENSOR(s) sensor::Sensor *s_##s##_{nullptr};
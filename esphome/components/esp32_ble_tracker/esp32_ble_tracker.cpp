@@ -13,6 +13,8 @@
 #include <esp_gap_ble_api.h>
 #include <esp_bt_defs.h>
 
+#include <algorithm>
+
 // bt_trace.h
 #undef TAG
 
@@ -20,6 +22,8 @@ namespace esphome {
 namespace esp32_ble_tracker {
 
 static const char *const TAG = "esp32_ble_tracker";
+/// Dropped events are logged at most this often, in ms.
+static const uint32_t BLE_EVENTS_DROPPED_LOG_INTERVAL = 10000;
 
 ESP32BLETracker *global_esp32_ble_tracker = nullptr;
 
@@ -36,9 +40,18 @@ uint64_t ble_addr_to_uint64(const esp_bd_addr_t address) {
 
 void ESP32BLETracker::setup() {
   global_esp32_ble_tracker = this;
-  this->scan_result_lock_ = xSemaphoreCreateMutex();
   this->scan_end_lock_ = xSemaphoreCreateMutex();
 
+  // The addresses are set after the listeners are registered, so they can only be indexed now
+  for (auto *listener : this->listeners_) {
+    const uint64_t address = listener->get_address_filter();
+    if (address != 0) {
+      this->address_listeners_[address].push_back(listener);
+    } else {
+      this->any_address_listeners_.push_back(listener);
+    }
+  }
+
   if (!ESP32BLETracker::ble_setup()) {
     this->mark_failed();
     return;
@@ -48,15 +61,22 @@ void ESP32BLETracker::setup() {
 }
 
 void ESP32BLETracker::loop() {
-  BLEEvent *ble_event = this->ble_events_.pop();
-  while (ble_event != nullptr) {
+  BLEEvent *ble_event;
+  while ((ble_event = this->ble_events_.front()) != nullptr) {
     if (ble_event->type_)
       this->real_gattc_event_handler(ble_event->event_.gattc.gattc_event, ble_event->event_.gattc.gattc_if,
                                      &ble_event->event_.gattc.gattc_param);
     else
       this->real_gap_event_handler(ble_event->event_.gap.gap_event, &ble_event->event_.gap.gap_param);
-    delete ble_event;
-    ble_event = this->ble_events_.pop();
+    this->ble_events_.pop();
+  }
+  const uint32_t dropped = this->ble_events_.get_dropped();
+  const uint32_t now = millis();
+  if (dropped != this->ble_events_dropped_ &&
+      now - this->ble_events_dropped_reported_ >= BLE_EVENTS_DROPPED_LOG_INTERVAL) {
+    ESP_LOGW(TAG, "BLE event queue full, dropped %u events", dropped - this->ble_events_dropped_);
+    this->ble_events_dropped_ = dropped;
+    this->ble_events_dropped_reported_ = now;
   }
 
   bool connecting = false;
@@ -69,44 +89,6 @@ void ESP32BLETracker::loop() {
     global_esp32_ble_tracker->start_scan(false);
   }
 
-  if (xSemaphoreTake(this->scan_result_lock_, 5L / portTICK_PERIOD_MS)) {
-    uint32_t index = this->scan_result_index_;
-    xSemaphoreGive(this->scan_result_lock_);
-
-    if (index >= 16) {
-      ESP_LOGW(TAG, "Too many BLE events to process. Some devices may not show up.");
-    }
-    for (size_t i = 0; i < index; i++) {
-      ESPBTDevice device;
-      device.parse_scan_rst(this->scan_result_buffer_[i]);
-
-      bool found = false;
-      for (auto *listener : this->listeners_)
-        if (listener->parse_device(device))
-          found = true;
-
-      for (auto *client : this->clients_)
-        if (client->parse_device(device)) {
-          found = true;
-          if (client->state() == ClientState::Discovered) {
-            esp_ble_gap_stop_scanning();
-            if (xSemaphoreTake(this->scan_end_lock_, 10L / portTICK_PERIOD_MS)) {
-              xSemaphoreGive(this->scan_end_lock_);
-            }
-          }
-        }
-
-      if (!found) {
-        this->print_bt_device_info(device);
-      }
-    }
-
-    if (xSemaphoreTake(this->scan_result_lock_, 10L / portTICK_PERIOD_MS)) {
-      this->scan_result_index_ = 0;
-      xSemaphoreGive(this->scan_result_lock_);
-    }
-  }
-
   if (this->scan_set_param_failed_) {
     ESP_LOGE(TAG, "Scan set param failed: %d", this->scan_set_param_failed_);
     this->scan_set_param_failed_ = ESP_BT_STATUS_SUCCESS;
@@ -204,8 +186,7 @@ void ESP32BLETracker::register_client(ESPBTClient *client) {
 }
 
 void ESP32BLETracker::gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
-  BLEEvent *gap_event = new BLEEvent(event, param);
-  global_esp32_ble_tracker->ble_events_.push(gap_event);
+  global_esp32_ble_tracker->ble_events_.push(BLEEvent(event, param));
 }
 
 void ESP32BLETracker::real_gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
@@ -241,21 +222,46 @@ void ESP32BLETracker::gap_scan_stop_complete(const esp_ble_gap_cb_param_t::ble_s
 
 void ESP32BLETracker::gap_scan_result(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param) {
   if (param.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
-    if (xSemaphoreTake(this->scan_result_lock_, 0L)) {
-      if (this->scan_result_index_ < 16) {
-        this->scan_result_buffer_[this->scan_result_index_++] = param;
-      }
-      xSemaphoreGive(this->scan_result_lock_);
-    }
+    // Events are handled in loop(), so every scan result can be passed on right away
+    ESPBTDevice device;
+    device.parse_scan_rst(param);
+    this->dispatch_device_(device);
   } else if (param.search_evt == ESP_GAP_SEARCH_INQ_CMPL_EVT) {
     xSemaphoreGive(this->scan_end_lock_);
   }
 }
 
+void ESP32BLETracker::dispatch_device_(const ESPBTDevice &device) {
+  bool found = false;
+  auto it = this->address_listeners_.find(device.address_uint64());
+  if (it != this->address_listeners_.end()) {
+    for (auto *listener : it->second)
+      if (listener->parse_device(device))
+        found = true;
+  }
+  for (auto *listener : this->any_address_listeners_)
+    if (listener->parse_device(device))
+      found = true;
+
+  for (auto *client : this->clients_)
+    if (client->parse_device(device)) {
+      found = true;
+      if (client->state() == ClientState::Discovered) {
+        esp_ble_gap_stop_scanning();
+        if (xSemaphoreTake(this->scan_end_lock_, 10L / portTICK_PERIOD_MS)) {
+          xSemaphoreGive(this->scan_end_lock_);
+        }
+      }
+    }
+
+  if (!found) {
+    this->print_bt_device_info(device);
+  }
+}
+
 void ESP32BLETracker::gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if,
                                           esp_ble_gattc_cb_param_t *param) {
-  BLEEvent *gattc_event = new BLEEvent(event, gattc_if, param);
-  global_esp32_ble_tracker->ble_events_.push(gattc_event);
+  global_esp32_ble_tracker->ble_events_.push(BLEEvent(event, gattc_if, param));
 }
 
 void ESP32BLETracker::real_gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if,
@@ -396,9 +402,12 @@ void ESPBTDevice::parse_scan_rst(const esp_ble_gap_cb_param_t::ble_scan_result_e
     this->address_[i] = param.bda[i];
   this->address_type_ = param.ble_addr_type;
   this->rssi_ = param.rssi;
-  this->parse_adv_(param);
+  this->adv_len_ = std::min<size_t>(param.adv_data_len + param.scan_rsp_len, sizeof(this->adv_));
+  memcpy(this->adv_, param.ble_adv, this->adv_len_);
+  this->adv_parsed_ = false;
 
 #ifdef ESPHOME_LOG_HAS_VERY_VERBOSE
+  this->parse_adv_();
   ESP_LOGVV(TAG, "Parse Result:");
   const char *address_type = "";
   switch (this->address_type_) {
@@ -452,10 +461,21 @@ void ESPBTDevice::parse_scan_rst(const esp_ble_gap_cb_param_t::ble_scan_result_e
   ESP_LOGVV(TAG, "Adv data: %s", hexencode(param.ble_adv, param.adv_data_len + param.scan_rsp_len).c_str());
 #endif
 }
-void ESPBTDevice::parse_adv_(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param) {
+void ESPBTDevice::parse_adv_() const {
+  if (this->adv_parsed_)
+    return;
+  this->adv_parsed_ = true;
+  this->name_.clear();
+  this->tx_powers_.clear();
+  this->appearance_.reset();
+  this->ad_flag_.reset();
+  this->service_uuids_.clear();
+  this->manufacturer_datas_.clear();
+  this->service_datas_.clear();
+
   size_t offset = 0;
-  const uint8_t *payload = param.ble_adv;
-  uint8_t len = param.adv_data_len + param.scan_rsp_len;
+  const uint8_t *payload = this->adv_;
+  uint8_t len = this->adv_len_;
 
   while (offset + 2 < len) {
     const uint8_t field_length = payload[offset++];  // First byte is length of adv record
@@ -616,14 +636,11 @@ void ESP32BLETracker::dump_config() {
   ESP_LOGCONFIG(TAG, "  Scan Interval: %.1f ms", this->scan_interval_ * 0.625f);
   ESP_LOGCONFIG(TAG, "  Scan Window: %.1f ms", this->scan_window_ * 0.625f);
   ESP_LOGCONFIG(TAG, "  Scan Type: %s", this->scan_active_ ? "ACTIVE" : "PASSIVE");
+  ESP_LOGCONFIG(TAG, "  Dropped Events: %u", this->ble_events_.get_dropped());
 }
 void ESP32BLETracker::print_bt_device_info(const ESPBTDevice &device) {
-  const uint64_t address = device.address_uint64();
-  for (auto &disc : this->already_discovered_) {
-    if (disc == address)
-      return;
-  }
-  this->already_discovered_.push_back(address);
+  if (!this->already_discovered_.insert(device.address_uint64()).second)
+    return;
 
   ESP_LOGD(TAG, "Found device %s RSSI=%d", device.address_str().c_str(), device.get_rssi());
 
@@ -8,6 +8,8 @@
 
 #include <string>
 #include <array>
+#include <unordered_map>
+#include <unordered_set>
 #include <esp_gap_ble_api.h>
 #include <esp_gattc_api.h>
 #include <esp_bt_defs.h>
@@ -71,6 +73,11 @@ class ESPBLEiBeacon {
   } PACKED beacon_data_;
 };
 
+/** A device found in a scan.
+ *
+ * Only the address and RSSI are read when a scan result comes in. The advertisement data is copied as is, and only
+ * parsed into the name, UUIDs and service/manufacturer data the first time one of them is requested.
+ */
 class ESPBTDevice {
  public:
   void parse_scan_rst(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param);
@@ -83,20 +90,44 @@ class ESPBTDevice {
 
   esp_ble_addr_type_t get_address_type() const { return this->address_type_; }
   int get_rssi() const { return rssi_; }
-  const std::string &get_name() const { return this->name_; }
+  const std::string &get_name() const {
+    this->parse_adv_();
+    return this->name_;
+  }
+
+  const std::vector<int8_t> &get_tx_powers() const {
+    this->parse_adv_();
+    return tx_powers_;
+  }
 
-  const std::vector<int8_t> &get_tx_powers() const { return tx_powers_; }
+  const optional<uint16_t> &get_appearance() const {
+    this->parse_adv_();
+    return appearance_;
+  }
+  const optional<uint8_t> &get_ad_flag() const {
+    this->parse_adv_();
+    return ad_flag_;
+  }
+  const std::vector<ESPBTUUID> &get_service_uuids() const {
+    this->parse_adv_();
+    return service_uuids_;
+  }
 
-  const optional<uint16_t> &get_appearance() const { return appearance_; }
-  const optional<uint8_t> &get_ad_flag() const { return ad_flag_; }
-  const std::vector<ESPBTUUID> &get_service_uuids() const { return service_uuids_; }
+  const std::vector<ServiceData> &get_manufacturer_datas() const {
+    this->parse_adv_();
+    return manufacturer_datas_;
+  }
 
-  const std::vector<ServiceData> &get_manufacturer_datas() const { return manufacturer_datas_; }
+  const std::vector<ServiceData> &get_service_datas() const {
+    this->parse_adv_();
+    return service_datas_;
+  }
 
-  const std::vector<ServiceData> &get_service_datas() const { return service_datas_; }
+  /// The unparsed advertisement and scan response data.
+  Span<const uint8_t> get_raw_adv() const { return Span<const uint8_t>(this->adv_, this->adv_len_); }
 
   optional<ESPBLEiBeacon> get_ibeacon() const {
-    for (auto &it : this->manufacturer_datas_) {
+    for (auto &it : this->get_manufacturer_datas()) {
       auto res = ESPBLEiBeacon::from_manufacturer_data(it);
       if (res.has_value())
         return *res;
@@ -105,20 +136,24 @@ class ESPBTDevice {
   }
 
  protected:
-  void parse_adv_(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param);
+  /// Parse the advertisement data into the members below, if that has not been done yet.
+  void parse_adv_() const;
 
   esp_bd_addr_t address_{
       0,
   };
   esp_ble_addr_type_t address_type_{BLE_ADDR_TYPE_PUBLIC};
   int rssi_{0};
-  std::string name_{};
-  std::vector<int8_t> tx_powers_{};
-  optional<uint16_t> appearance_{};
-  optional<uint8_t> ad_flag_{};
-  std::vector<ESPBTUUID> service_uuids_;
-  std::vector<ServiceData> manufacturer_datas_{};
-  std::vector<ServiceData> service_datas_{};
+  uint8_t adv_[ESP_BLE_ADV_DATA_LEN_MAX + ESP_BLE_SCAN_RSP_DATA_LEN_MAX];
+  uint8_t adv_len_{0};
+  mutable bool adv_parsed_{false};
+  mutable std::string name_{};
+  mutable std::vector<int8_t> tx_powers_{};
+  mutable optional<uint16_t> appearance_{};
+  mutable optional<uint8_t> ad_flag_{};
+  mutable std::vector<ESPBTUUID> service_uuids_;
+  mutable std::vector<ServiceData> manufacturer_datas_{};
+  mutable std::vector<ServiceData> service_datas_{};
 };
 
 class ESP32BLETracker;
@@ -127,6 +162,8 @@ class ESPBTDeviceListener {
  public:
   virtual void on_scan_end() {}
   virtual bool parse_device(const ESPBTDevice &device) = 0;
+  /// The address of the only device this listener parses, or 0 if parse_device() should be called for all devices.
+  virtual uint64_t get_address_filter() const { return 0; }
   void set_parent(ESP32BLETracker *parent) { parent_ = parent; }
 
  protected:
@@ -191,6 +228,8 @@ class ESP32BLETracker : public Component {
   void real_gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
   /// Called when a `ESP_GAP_BLE_SCAN_RESULT_EVT` event is received.
   void gap_scan_result(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param &param);
+  /// Pass a scanned device to the listeners and clients.
+  void dispatch_device_(const ESPBTDevice &device);
   /// Called when a `ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT` event is received.
   void gap_scan_set_param_complete(const esp_ble_gap_cb_param_t::ble_scan_param_cmpl_evt_param &param);
   /// Called when a `ESP_GAP_BLE_SCAN_START_COMPLETE_EVT` event is received.
@@ -203,9 +242,13 @@ class ESP32BLETracker : public Component {
   static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t *param);
   void real_gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t *param);
 
-  /// Vector of addresses that have already been printed in print_bt_device_info
-  std::vector<uint64_t> already_discovered_;
+  /// Addresses that have already been printed in print_bt_device_info
+  std::unordered_set<uint64_t> already_discovered_;
   std::vector<ESPBTDeviceListener *> listeners_;
+  /// The listeners that only parse one device, by address.
+  std::unordered_map<uint64_t, std::vector<ESPBTDeviceListener *>> address_listeners_;
+  /// The listeners that parse all devices.
+  std::vector<ESPBTDeviceListener *> any_address_listeners_;
   /// Client parameters.
   std::vector<ESPBTClient *> clients_;
   /// A structure holding the ESP BLE scan parameters.
@@ -215,14 +258,15 @@ class ESP32BLETracker : public Component {
   uint32_t scan_interval_;
   uint32_t scan_window_;
   bool scan_active_;
-  SemaphoreHandle_t scan_result_lock_;
   SemaphoreHandle_t scan_end_lock_;
-  size_t scan_result_index_{0};
-  esp_ble_gap_cb_param_t::ble_scan_result_evt_param scan_result_buffer_[16];
   esp_bt_status_t scan_start_failed_{ESP_BT_STATUS_SUCCESS};
   esp_bt_status_t scan_set_param_failed_{ESP_BT_STATUS_SUCCESS};
 
-  Queue<BLEEvent> ble_events_;
+  /// Events from the Bluetooth task, handled in loop(). Up to a few hundred advertisements arrive per second.
+  LockFreeQueue<BLEEvent, 32> ble_events_;
+  /// The number of dropped events that were already logged, and when.
+  uint32_t ble_events_dropped_{0};
+  uint32_t ble_events_dropped_reported_{0};
 };
 
 extern ESP32BLETracker *global_esp32_ble_tracker;
@@ -2,9 +2,6 @@
 #include "esphome/core/component.h"
 #include "esphome/core/helpers.h"
 
-#include <queue>
-#include <mutex>
-
 #ifdef ARDUINO_ARCH_ESP32
 
 #include <esp_gap_ble_api.h>
@@ -13,49 +10,19 @@
 /*
  * BLE events come in from a separate Task (thread) in the ESP32 stack. Rather
  * than trying to deal with various locking strategies, all incoming GAP and GATT
- * events will simply be placed on a semaphore guarded queue. The next time the
- * component runs loop(), these events are popped off the queue and handed at
- * this safer time.
+ * events will simply be copied into a fixed-capacity lock-free queue. The next
+ * time the component runs loop(), these events are popped off the queue and
+ * handed at this safer time. Events that don't fit into the queue are dropped.
  */
 
 namespace esphome {
 namespace esp32_ble_tracker {
 
-template<class T> class Queue {
- public:
-  Queue() { m = xSemaphoreCreateMutex(); }
-
-  void push(T *element) {
-    if (element == nullptr)
-      return;
-    if (xSemaphoreTake(m, 5L / portTICK_PERIOD_MS)) {
-      q.push(element);
-      xSemaphoreGive(m);
-    }
-  }
-
-  T *pop() {
-    T *element = nullptr;
-
-    if (xSemaphoreTake(m, 5L / portTICK_PERIOD_MS)) {
-      if (!q.empty()) {
-        element = q.front();
-        q.pop();
-      }
-      xSemaphoreGive(m);
-    }
-    return element;
-  }
-
- protected:
-  std::queue<T *> q;
-  SemaphoreHandle_t m;
-};
-
 // Received GAP and GATTC events are only queued, and get processed in the main loop().
 // This class stores each event in a single type.
 class BLEEvent {
  public:
+  BLEEvent() = default;
   BLEEvent(esp_gap_ble_cb_event_t e, esp_ble_gap_cb_param_t *p) {
     this->event_.gap.gap_event = e;
     memcpy(&this->event_.gap.gap_param, p, sizeof(esp_ble_gap_cb_param_t));
@@ -60,6 +60,7 @@ CONF_VERTICAL_FLIP = "vertical_flip"
 CONF_HORIZONTAL_MIRROR = "horizontal_mirror"
 CONF_SATURATION = "saturation"
 CONF_TEST_PATTERN = "test_pattern"
+CONF_FRAME_BUFFER_COUNT = "frame_buffer_count"
 
 camera_range_param = cv.int_range(min=-2, max=2)
 
@@ -104,6 +105,7 @@ CONFIG_SCHEMA = cv.Schema(
         cv.Optional(CONF_VERTICAL_FLIP, default=True): cv.boolean,
         cv.Optional(CONF_HORIZONTAL_MIRROR, default=True): cv.boolean,
         cv.Optional(CONF_TEST_PATTERN, default=False): cv.boolean,
+        cv.Optional(CONF_FRAME_BUFFER_COUNT, default=1): cv.int_range(min=1, max=4),
     }
 ).extend(cv.COMPONENT_SCHEMA)
 
@@ -121,6 +123,7 @@ SETTERS = {
     CONF_BRIGHTNESS: "set_brightness",
     CONF_SATURATION: "set_saturation",
     CONF_TEST_PATTERN: "set_test_pattern",
+    CONF_FRAME_BUFFER_COUNT: "set_frame_buffer_count",
 }
 
 
@@ -27,8 +27,9 @@ void ESP32Camera::setup() {
   s->set_brightness(s, this->brightness_);
   s->set_saturation(s, this->saturation_);
   s->set_colorbar(s, this->test_pattern_);
-  this->framebuffer_get_queue_ = xQueueCreate(1, sizeof(camera_fb_t *));
-  this->framebuffer_return_queue_ = xQueueCreate(1, sizeof(camera_fb_t *));
+  // every frame buffer can be on its way to or from the main loop at the same time
+  this->framebuffer_get_queue_ = xQueueCreate(this->config_.fb_count, sizeof(camera_fb_t *));
+  this->framebuffer_return_queue_ = xQueueCreate(this->config_.fb_count, sizeof(camera_fb_t *));
   xTaskCreatePinnedToCore(&ESP32Camera::framebuffer_task,
                           "framebuffer_task",  // name
                           1024,                // stack size
@@ -51,6 +52,7 @@ void ESP32Camera::dump_config() {
   ESP_LOGCONFIG(TAG, "  External Clock: Pin:%d Frequency:%u", conf.pin_xclk, conf.xclk_freq_hz);
   ESP_LOGCONFIG(TAG, "  I2C Pins: SDA:%d SCL:%d", conf.pin_sscb_sda, conf.pin_sscb_scl);
   ESP_LOGCONFIG(TAG, "  Reset Pin: %d", conf.pin_reset);
+  ESP_LOGCONFIG(TAG, "  Frame Buffers: %d", conf.fb_count);
   switch (this->config_.frame_size) {
     case FRAMESIZE_QQVGA:
       ESP_LOGCONFIG(TAG, "  Resolution: 160x120 (QQVGA)");
@@ -119,52 +121,84 @@ void ESP32Camera::dump_config() {
   ESP_LOGCONFIG(TAG, "  Test Pattern: %s", YESNO(st.colorbar));
 }
 void ESP32Camera::loop() {
-  // check if we can return the image
-  if (this->can_return_image_()) {
-    // return image
-    auto *fb = this->current_image_->get_raw_buffer();
-    xQueueSend(this->framebuffer_return_queue_, &fb, portMAX_DELAY);
-    this->current_image_.reset();
+  this->return_images_();
+
+  const uint32_t now = millis();
+  if (now - this->fps_start_ >= 1000) {
+    this->fps_ = this->fps_frames_ * 1000.0f / (now - this->fps_start_);
+    if (this->fps_frames_ != 0) {
+      ESP_LOGV(TAG, "%.1f fps, %u frames dropped, %u skipped by consumers", this->fps_, this->dropped_frames_,
+               this->skipped_frames_.load());
+    }
+    this->fps_frames_ = 0;
+    this->fps_start_ = now;
   }
 
   // Check if we should fetch a new image
   if (!this->has_requested_image_())
     return;
-  if (this->current_image_.use_count() > 1) {
-    // image is still in use
-    return;
-  }
-  const uint32_t now = millis();
   if (now - this->last_update_ <= this->max_update_interval_)
     return;
 
-  // request new image
+  // request new image, frames that were captured before the newest one are outdated
   camera_fb_t *fb;
   if (xQueueReceive(this->framebuffer_get_queue_, &fb, 0L) != pdTRUE) {
     // no frame ready
     ESP_LOGVV(TAG, "No frame ready");
     return;
   }
+  camera_fb_t *newer;
+  while (xQueueReceive(this->framebuffer_get_queue_, &newer, 0L) == pdTRUE) {
+    xQueueSend(this->framebuffer_return_queue_, &fb, portMAX_DELAY);
+    if (fb != nullptr)
+      this->dropped_frames_++;
+    fb = newer;
+  }
 
   if (fb == nullptr) {
     ESP_LOGW(TAG, "Got invalid frame from camera!");
     xQueueSend(this->framebuffer_return_queue_, &fb, portMAX_DELAY);
     return;
   }
-  this->current_image_ = std::make_shared<CameraImage>(fb);
+  auto image = std::make_shared<CameraImage>(fb);
+  this->images_.push_back(image);
 
   ESP_LOGD(TAG, "Got Image: len=%u", fb->len);
-  this->new_image_callback_.call(this->current_image_);
+  // all consumers share the same frame, each one sends it at its own pace
+  this->new_image_callback_.call(image);
   this->last_update_ = now;
   this->single_requester_ = false;
+  this->fps_frames_++;
+}
+void ESP32Camera::return_images_() {
+  for (auto it = this->images_.begin(); it != this->images_.end();) {
+    if (it->use_count() == 1) {
+      auto *fb = (*it)->get_raw_buffer();
+      xQueueSend(this->framebuffer_return_queue_, &fb, portMAX_DELAY);
+      it = this->images_.erase(it);
+    } else {
+      it++;
+    }
+  }
 }
 void ESP32Camera::framebuffer_task(void *pv) {
+  // the number of frames passed to the main loop that have not been returned yet
+  int in_use = 0;
+  const int fb_count = global_esp32_camera->config_.fb_count;
   while (true) {
-    camera_fb_t *framebuffer = esp_camera_fb_get();
+    // return the frames the main loop is done with, waiting for one if all frame buffers are in use
+    camera_fb_t *framebuffer;
+    while (xQueueReceive(global_esp32_camera->framebuffer_return_queue_, &framebuffer,
+                         in_use >= fb_count ? portMAX_DELAY : 0) == pdTRUE) {
+      // return is no-op for config with 1 fb
+      if (framebuffer != nullptr)
+        esp_camera_fb_return(framebuffer);
+      in_use--;
+    }
+
+    framebuffer = esp_camera_fb_get();
     xQueueSend(global_esp32_camera->framebuffer_get_queue_, &framebuffer, portMAX_DELAY);
-    // return is no-op for config with 1 fb
-    xQueueReceive(global_esp32_camera->framebuffer_return_queue_, &framebuffer, portMAX_DELAY);
-    esp_camera_fb_return(framebuffer);
+    in_use++;
   }
 }
 ESP32Camera::ESP32Camera(const std::string &name) : Nameable(name) {
@@ -238,9 +272,6 @@ void ESP32Camera::set_frame_size(ESP32CameraFrameSize size) {
 void ESP32Camera::set_jpeg_quality(uint8_t quality) { this->config_.jpeg_quality = quality; }
 void ESP32Camera::set_reset_pin(uint8_t pin) { this->config_.pin_reset = pin; }
 void ESP32Camera::set_power_down_pin(uint8_t pin) { this->config_.pin_pwdn = pin; }
-void ESP32Camera::add_image_callback(std::function<void(std::shared_ptr<CameraImage>)> &&f) {
-  this->new_image_callback_.add(std::move(f));
-}
 void ESP32Camera::set_vertical_flip(bool vertical_flip) { this->vertical_flip_ = vertical_flip; }
 void ESP32Camera::set_horizontal_mirror(bool horizontal_mirror) { this->horizontal_mirror_ = horizontal_mirror; }
 void ESP32Camera::set_contrast(int contrast) { this->contrast_ = contrast; }
@@ -266,7 +297,6 @@ bool ESP32Camera::has_requested_image_() const {
 
   return false;
 }
-bool ESP32Camera::can_return_image_() const { return this->current_image_.use_count() == 1; }
 void ESP32Camera::set_max_update_interval(uint32_t max_update_interval) {
   this->max_update_interval_ = max_update_interval;
 }
@@ -274,6 +304,7 @@ void ESP32Camera::set_idle_update_interval(uint32_t idle_update_interval) {
   this->idle_update_interval_ = idle_update_interval;
 }
 void ESP32Camera::set_test_pattern(bool test_pattern) { this->test_pattern_ = test_pattern; }
+void ESP32Camera::set_frame_buffer_count(uint8_t frame_buffer_count) { this->config_.fb_count = frame_buffer_count; }
 
 ESP32Camera *global_esp32_camera;
 
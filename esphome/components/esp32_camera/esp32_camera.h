@@ -5,12 +5,19 @@
 #include "esphome/core/component.h"
 #include "esphome/core/helpers.h"
 #include <esp_camera.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace esphome {
 namespace esp32_camera {
 
 class ESP32Camera;
 
+/** A frame of the camera, shared by all consumers that send it.
+ *
+ * The frame buffer goes back to the camera driver once the last consumer released its shared_ptr.
+ */
 class CameraImage {
  public:
   CameraImage(camera_fb_t *buffer);
@@ -69,18 +76,30 @@ class ESP32Camera : public Component, public Nameable {
   void set_max_update_interval(uint32_t max_update_interval);
   void set_idle_update_interval(uint32_t idle_update_interval);
   void set_test_pattern(bool test_pattern);
+  /// The number of frame buffers, with more than one a slow consumer does not hold up the others.
+  void set_frame_buffer_count(uint8_t frame_buffer_count);
   void setup() override;
   void loop() override;
   void dump_config() override;
-  void add_image_callback(std::function<void(std::shared_ptr<CameraImage>)> &&f);
+  template<typename F> void add_image_callback(F &&f) { this->new_image_callback_.add(std::forward<F>(f)); }
   float get_setup_priority() const override;
   void request_stream();
   void request_image();
 
+  /// Called by a consumer that skips a frame because it is still sending an earlier one, from any task.
+  void report_skipped_frame() { this->skipped_frames_++; }
+  /// Frames per second passed to the consumers, over the last second.
+  float get_fps() const { return this->fps_; }
+  /// The number of frames that were captured, but replaced by a newer frame before they were requested.
+  uint32_t get_dropped_frames() const { return this->dropped_frames_; }
+  /// The number of frames that consumers skipped.
+  uint32_t get_skipped_frames() const { return this->skipped_frames_; }
+
  protected:
   uint32_t hash_base() override;
   bool has_requested_image_() const;
-  bool can_return_image_() const;
+  /// Give the frame buffers that no consumer holds anymore back to the driver.
+  void return_images_();
 
   static void framebuffer_task(void *pv);
 
@@ -93,7 +112,8 @@ class ESP32Camera : public Component, public Nameable {
   bool test_pattern_{false};
 
   esp_err_t init_error_{ESP_OK};
-  std::shared_ptr<CameraImage> current_image_;
+  /// The frames that were passed to the consumers and not returned yet.
+  std::vector<std::shared_ptr<CameraImage>> images_;
   uint32_t last_stream_request_{0};
   bool single_requester_{false};
   QueueHandle_t framebuffer_get_queue_;
@@ -102,6 +122,12 @@ class ESP32Camera : public Component, public Nameable {
   uint32_t max_update_interval_{1000};
   uint32_t idle_update_interval_{15000};
   uint32_t last_update_{0};
+
+  float fps_{0};
+  uint32_t fps_frames_{0};
+  uint32_t fps_start_{0};
+  uint32_t dropped_frames_{0};
+  std::atomic<uint32_t> skipped_frames_{0};
 };
 
 extern ESP32Camera *global_esp32_camera;
@@ -0,0 +1,179 @@
+#ifdef ARDUINO_ARCH_ESP32
+
+#include "camera_web_server.h"
+#include "esphome/core/log.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace esp32_camera_web_server {
+
+static const char *const TAG = "esp32_camera_web_server";
+
+static const char *const STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=frame";
+static const char *const PART_HEADER = "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+static const char *const PART_TRAILER = "\r\n";
+static const size_t PART_TRAILER_LEN = 2;
+
+CameraStreamClient::CameraStreamClient(CameraWebServer *parent, bool stream)
+    : parent_(parent), stream_(stream), start_(millis()) {}
+CameraStreamClient::~CameraStreamClient() {
+  if (this->stream_) {
+    ESP_LOGD(TAG, "Stream client disconnected after %u s: %u frames sent, %u skipped",
+             (millis() - this->start_) / 1000, this->frames_sent_, this->frames_skipped_);
+  }
+}
+
+bool CameraStreamClient::next_frame_() {
+  xSemaphoreTake(this->parent_->lock_, portMAX_DELAY);
+  this->current_ = std::move(this->next_);
+  this->next_ = nullptr;
+  xSemaphoreGive(this->parent_->lock_);
+  if (this->current_ == nullptr)
+    return false;
+
+  this->pos_ = 0;
+  this->header_len_ = 0;
+  if (this->stream_) {
+    this->header_len_ =
+        snprintf(this->header_, sizeof(this->header_), PART_HEADER, this->current_->get_data_length());
+  }
+  return true;
+}
+
+size_t CameraStreamClient::fill(uint8_t *buffer, size_t max_len) {
+  size_t written = 0;
+  while (written < max_len) {
+    if (this->current_ == nullptr) {
+      if (!this->stream_ && this->frames_sent_ != 0)
+        break;
+      if (!this->next_frame_())
+        break;
+    }
+
+    const size_t data_len = this->current_->get_data_length();
+    const size_t trailer_len = this->stream_ ? PART_TRAILER_LEN : 0;
+    const size_t part_len = this->header_len_ + data_len + trailer_len;
+    const uint8_t *src;
+    size_t avail;
+    if (this->pos_ < this->header_len_) {
+      src = reinterpret_cast<const uint8_t *>(this->header_) + this->pos_;
+      avail = this->header_len_ - this->pos_;
+    } else if (this->pos_ < this->header_len_ + data_len) {
+      // straight from the frame buffer, the frame is shared with all other clients
+      src = this->current_->get_data_buffer() + (this->pos_ - this->header_len_);
+      avail = this->header_len_ + data_len - this->pos_;
+    } else {
+      src = reinterpret_cast<const uint8_t *>(PART_TRAILER) + (this->pos_ - this->header_len_ - data_len);
+      avail = part_len - this->pos_;
+    }
+    const size_t len = std::min(max_len - written, avail);
+    memcpy(buffer + written, src, len);
+    written += len;
+    this->pos_ += len;
+
+    if (this->pos_ == part_len) {
+      // done with this frame, give it back to the camera as soon as possible
+      this->current_ = nullptr;
+      this->frames_sent_++;
+    }
+  }
+
+  if (written == 0) {
+    if (!this->stream_ && this->frames_sent_ != 0)
+      return 0;
+    // no frame yet, ask again later
+    return RESPONSE_TRY_AGAIN;
+  }
+  return written;
+}
+
+CameraWebServer::CameraWebServer(web_server_base::WebServerBase *base) : base_(base) {
+  this->lock_ = xSemaphoreCreateMutex();
+}
+
+void CameraWebServer::setup() {
+  if (esp32_camera::global_esp32_camera == nullptr || esp32_camera::global_esp32_camera->is_failed()) {
+    this->mark_failed();
+    return;
+  }
+  esp32_camera::global_esp32_camera->add_image_callback(
+      [this](std::shared_ptr<esp32_camera::CameraImage> image) { this->on_image_(image); });
+
+  this->base_->init();
+  this->base_->add_handler(this);
+}
+
+void CameraWebServer::loop() {
+  bool stream = false;
+  bool snapshot = false;
+  xSemaphoreTake(this->lock_, portMAX_DELAY);
+  for (auto it = this->clients_.begin(); it != this->clients_.end();) {
+    auto client = it->lock();
+    if (client == nullptr) {
+      it = this->clients_.erase(it);
+      continue;
+    }
+    if (client->stream_) {
+      stream = true;
+    } else {
+      snapshot = true;
+    }
+    it++;
+  }
+  xSemaphoreGive(this->lock_);
+
+  if (stream)
+    esp32_camera::global_esp32_camera->request_stream();
+  if (snapshot)
+    esp32_camera::global_esp32_camera->request_image();
+}
+
+void CameraWebServer::on_image_(const std::shared_ptr<esp32_camera::CameraImage> &image) {
+  xSemaphoreTake(this->lock_, portMAX_DELAY);
+  for (auto it = this->clients_.begin(); it != this->clients_.end();) {
+    auto client = it->lock();
+    if (client == nullptr) {
+      it = this->clients_.erase(it);
+      continue;
+    }
+    if (client->next_ != nullptr) {
+      // the client has not started sending the previous frame, only the latest one is kept
+      client->frames_skipped_++;
+      esp32_camera::global_esp32_camera->report_skipped_frame();
+    }
+    client->next_ = image;
+    if (!client->stream_) {
+      it = this->clients_.erase(it);
+      continue;
+    }
+    it++;
+  }
+  xSemaphoreGive(this->lock_);
+}
+
+void CameraWebServer::handleRequest(AsyncWebServerRequest *req) {
+  const bool stream = req->url() == "/camera/stream";
+  // The client is owned by the response and lives until the connection is closed.
+  auto client = std::make_shared<CameraStreamClient>(this, stream);
+  xSemaphoreTake(this->lock_, portMAX_DELAY);
+  this->clients_.push_back(client);
+  xSemaphoreGive(this->lock_);
+
+  AsyncWebServerResponse *response = req->beginChunkedResponse(
+      stream ? STREAM_CONTENT_TYPE : "image/jpeg",
+      [client](uint8_t *buffer, size_t max_len, size_t index) -> size_t { return client->fill(buffer, max_len); });
+  response->addHeader("Access-Control-Allow-Origin", "*");
+  req->send(response);
+}
+
+void CameraWebServer::dump_config() {
+  ESP_LOGCONFIG(TAG, "ESP32 Camera Web Server:");
+  ESP_LOGCONFIG(TAG, "  Stream: http://<address>/camera/stream");
+  ESP_LOGCONFIG(TAG, "  Snapshot: http://<address>/camera/snapshot");
+}
+
+}  // namespace esp32_camera_web_server
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#include "esphome/components/esp32_camera/esp32_camera.h"
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/core/component.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <memory>
+#include <vector>
+
+namespace esphome {
+namespace esp32_camera_web_server {
+
+class CameraWebServer;
+
+/** One HTTP connection that receives frames, either a MJPEG stream or a single snapshot.
+ *
+ * The client is owned by the response and filled from the web server task. The main loop hands it the newest frame,
+ * if the client is still busy with an earlier frame the pending one is replaced, so a slow client skips frames
+ * instead of holding up the camera and the other clients.
+ */
+class CameraStreamClient {
+ public:
+  CameraStreamClient(CameraWebServer *parent, bool stream);
+  ~CameraStreamClient();
+
+  /// Fill buffer with up to max_len bytes of the response, returns 0 once the response is complete.
+  size_t fill(uint8_t *buffer, size_t max_len);
+
+ protected:
+  friend CameraWebServer;
+
+  /// Start sending the pending frame, returns false if there is none.
+  bool next_frame_();
+
+  CameraWebServer *parent_;
+  bool stream_;
+  /// The frame handed over by the main loop, guarded by the lock of the parent.
+  std::shared_ptr<esp32_camera::CameraImage> next_;
+  /// The frame that is being sent, only used by the web server task.
+  std::shared_ptr<esp32_camera::CameraImage> current_;
+  /// The multipart header of the current frame.
+  char header_[80];
+  size_t header_len_{0};
+  /// Position in the part made of header, image data and trailing CRLF.
+  size_t pos_{0};
+  uint32_t start_;
+  uint32_t frames_sent_{0};
+  uint32_t frames_skipped_{0};
+};
+
+class CameraWebServer : public AsyncWebHandler, public Component {
+ public:
+  CameraWebServer(web_server_base::WebServerBase *base);
+
+  bool canHandle(AsyncWebServerRequest *request) override {
+    if (request->method() == HTTP_GET) {
+      if (request->url() == "/camera/stream" || request->url() == "/camera/snapshot")
+        return true;
+    }
+
+    return false;
+  }
+
+  void handleRequest(AsyncWebServerRequest *req) override;
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override {
+    // After WiFi
+    return setup_priority::WIFI - 1.0f;
+  }
+
+ protected:
+  friend CameraStreamClient;
+
+  /// Pass a new frame to all connected clients, called from the main loop.
+  void on_image_(const std::shared_ptr<esp32_camera::CameraImage> &image);
+
+  web_server_base::WebServerBase *base_;
+  /// Guards clients_ and the next_ frame of all clients, shared between the main loop and the web server task.
+  SemaphoreHandle_t lock_;
+  /// The connected clients, snapshot clients are removed once they got their frame.
+  std::vector<std::weak_ptr<CameraStreamClient>> clients_;
+};
+
+}  // namespace esp32_camera_web_server
+}  // namespace esphome
+
+#endif
@@ -35,24 +35,26 @@ void HDC1080Component::dump_config() {
   LOG_SENSOR("  ", "Humidity", this->humidity_);
 }
 void HDC1080Component::update() {
-  uint16_t raw_temp;
-  if (!this->read_byte_16(HDC1080_CMD_TEMPERATURE, &raw_temp, 20)) {
-    this->status_set_warning();
-    return;
-  }
-  float temp = raw_temp * 0.0025177f - 40.0f;  // raw * 2^-16 * 165 - 40
-  this->temperature_->publish_state(temp);
-
-  uint16_t raw_humidity;
-  if (!this->read_byte_16(HDC1080_CMD_HUMIDITY, &raw_humidity, 20)) {
-    this->status_set_warning();
-    return;
-  }
-  float humidity = raw_humidity * 0.001525879f;  // raw * 2^-16 * 100
-  this->humidity_->publish_state(humidity);
-
-  ESP_LOGD(TAG, "Got temperature=%.1f°C humidity=%.1f%%", temp, humidity);
-  this->status_clear_warning();
+  this->read_bytes_async(HDC1080_CMD_TEMPERATURE, 2, 20, [this](bool success, const uint8_t *data) {
+    if (!success) {
+      this->status_set_warning();
+      return;
+    }
+    float temp = encode_uint16(data[0], data[1]) * 0.0025177f - 40.0f;  // raw * 2^-16 * 165 - 40
+    this->temperature_->publish_state(temp);
+
+    this->read_bytes_async(HDC1080_CMD_HUMIDITY, 2, 20, [this, temp](bool success, const uint8_t *data) {
+      if (!success) {
+        this->status_set_warning();
+        return;
+      }
+      float humidity = encode_uint16(data[0], data[1]) * 0.001525879f;  // raw * 2^-16 * 100
+      this->humidity_->publish_state(humidity);
+
+      ESP_LOGD(TAG, "Got temperature=%.1f°C humidity=%.1f%%", temp, humidity);
+      this->status_clear_warning();
+    });
+  });
 }
 float HDC1080Component::get_setup_priority() const { return setup_priority::DATA; }
 
@@ -24,6 +24,10 @@ HttpRequestSendAction = http_request_ns.class_(
 HttpRequestResponseTrigger = http_request_ns.class_(
     "HttpRequestResponseTrigger", automation.Trigger
 )
+HttpRequestDataTrigger = http_request_ns.class_(
+    "HttpRequestDataTrigger", automation.Trigger
+)
+ConstUint8Span = cg.esphome_ns.class_("Span").template(cg.uint8.operator("const"))
 
 CONF_HEADERS = "headers"
 CONF_USERAGENT = "useragent"
@@ -31,6 +35,9 @@ CONF_BODY = "body"
 CONF_JSON = "json"
 CONF_VERIFY_SSL = "verify_ssl"
 CONF_ON_RESPONSE = "on_response"
+CONF_ON_DATA = "on_data"
+CONF_MAX_CONNECTIONS = "max_connections"
+CONF_KEEP_ALIVE_TIMEOUT = "keep_alive_timeout"
 
 
 def validate_url(value):
@@ -71,6 +78,10 @@ CONFIG_SCHEMA = cv.Schema(
         cv.GenerateID(): cv.declare_id(HttpRequestComponent),
         cv.Optional(CONF_USERAGENT, "ESPHome"): cv.string,
         cv.Optional(CONF_TIMEOUT, default="5s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_CONNECTIONS, default=2): cv.int_range(min=1, max=4),
+        cv.Optional(
+            CONF_KEEP_ALIVE_TIMEOUT, default="15s"
+        ): cv.positive_time_period_milliseconds,
     }
 ).extend(cv.COMPONENT_SCHEMA)
 
@@ -98,6 +109,8 @@ async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     cg.add(var.set_timeout(config[CONF_TIMEOUT]))
     cg.add(var.set_useragent(config[CONF_USERAGENT]))
+    cg.add(var.set_max_connections(config[CONF_MAX_CONNECTIONS]))
+    cg.add(var.set_keep_alive_timeout(config[CONF_KEEP_ALIVE_TIMEOUT]))
     await cg.register_component(var, config)
 
 
@@ -112,6 +125,9 @@ HTTP_REQUEST_ACTION_SCHEMA = cv.Schema(
         cv.Optional(CONF_ON_RESPONSE): automation.validate_automation(
             {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(HttpRequestResponseTrigger)}
         ),
+        cv.Optional(CONF_ON_DATA): automation.validate_automation(
+            {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(HttpRequestDataTrigger)}
+        ),
     }
 ).add_extra(validate_secure_url)
 HTTP_REQUEST_GET_ACTION_SCHEMA = automation.maybe_conf(
@@ -188,5 +204,11 @@ async def http_request_action_to_code(config, action_id, template_arg, args):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID])
         cg.add(var.register_response_trigger(trigger))
         await automation.build_automation(trigger, [(int, "status_code")], conf)
+    for conf in config.get(CONF_ON_DATA, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID])
+        cg.add(var.register_data_trigger(trigger))
+        await automation.build_automation(
+            trigger, [(ConstUint8Span, "data"), (bool, "last")], conf
+        )
 
     return var
@@ -1,105 +1,440 @@
 #include "http_request.h"
 #include "esphome/core/log.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace esphome {
 namespace http_request {
 
 static const char *const TAG = "http_request";
 
+static const size_t MAX_QUEUE_SIZE = 8;
+static const size_t RECEIVE_BUFFER_SIZE = 512;
+/// The number of receive buffers read per loop(), so a fast transfer doesn't hold up other components.
+static const uint8_t MAX_READS_PER_LOOP = 4;
+#ifdef ARDUINO_ARCH_ESP8266
+static const uint8_t MAX_REDIRECTS = 3;
+#else
+static const uint8_t MAX_REDIRECTS = 0;
+#endif
+
+/// The scheme, host and port of url, up to the path, query or fragment.
+static std::string url_host(const std::string &url) {
+  size_t start = url.find("://");
+  start = start == std::string::npos ? 0 : start + 3;
+  return url.substr(0, url.find_first_of("/?#", start));
+}
+
+/// The URL the Location of a redirect response points to, empty if it can't be followed.
+static std::string redirect_location(const std::string &url, const String &location) {
+  const std::string target = location.c_str();
+  if (target.compare(0, 7, "http://") == 0 || target.compare(0, 8, "https://") == 0)
+    return target;
+  if (target.compare(0, 2, "//") == 0)
+    return url.substr(0, url.find("://") + 1) + target;
+  if (!target.empty() && target[0] == '/')
+    return url_host(url) + target;
+  return "";
+}
+
+void HttpRequestComponent::setup() {
+  this->set_interval(1000, [this]() { this->close_idle_connections_(); });
+}
+
+void HttpRequestComponent::loop() {
+  if (this->connection_ != nullptr) {
+    this->receive_body_();
+    return;
+  }
+  if (this->queue_.empty()) {
+    this->high_freq_.stop();
+    return;
+  }
+
+  this->request_ = std::move(this->queue_.front());
+  this->queue_.erase(this->queue_.begin());
+  this->start_request_();
+}
+
 void HttpRequestComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "HTTP Request:");
   ESP_LOGCONFIG(TAG, "  Timeout: %ums", this->timeout_);
   ESP_LOGCONFIG(TAG, "  User-Agent: %s", this->useragent_);
+  ESP_LOGCONFIG(TAG, "  Max Connections: %u", this->max_connections_);
+  ESP_LOGCONFIG(TAG, "  Keep-Alive Timeout: %ums", this->keep_alive_timeout_);
+}
+
+bool HttpRequestComponent::queue(Request request) {
+  if (this->queue_.size() >= MAX_QUEUE_SIZE) {
+    ESP_LOGW(TAG, "Request queue full, dropping request for %s!", request.url.c_str());
+    this->status_set_warning();
+    // Reported like a request that failed to connect
+    if (request.on_response)
+      request.on_response(HTTP_REQUEST_ERROR_QUEUE_FULL);
+    if (request.on_complete)
+      request.on_complete();
+    return false;
+  }
+  if (request.useragent.empty() && this->useragent_ != nullptr)
+    request.useragent = this->useragent_;
+  if (request.timeout == 0)
+    request.timeout = this->timeout_;
+  this->queue_.push_back(std::move(request));
+  this->high_freq_.start();
+  return true;
 }
 
-void HttpRequestComponent::set_url(std::string url) {
-  this->url_ = std::move(url);
-  this->secure_ = this->url_.compare(0, 6, "https:") == 0;
+void HttpRequestComponent::start_request_() {
+  Request &request = this->request_;
+  Connection *connection = this->get_connection_(request.url);
+  HTTPClient *client = connection->client.get();
+  this->connection_ = connection;
+  this->response_ = String();
+  this->body_read_ = false;
+
+  if (!this->begin_(connection)) {
+    ESP_LOGW(TAG, "HTTP Request failed at the begin phase. Please check the configuration");
+    this->status_set_warning();
+    this->finish_request_(false);
+    return;
+  }
+
+  const bool reused = client->connected();
+  auto *body = reinterpret_cast<uint8_t *>(const_cast<char *>(request.body.data()));
+  int http_code = client->sendRequest(request.method, body, request.body.size());
+  if (http_code < 0 && http_code != HTTPC_ERROR_READ_TIMEOUT && reused) {
+    // The server closed the connection while it was idle, that's only noticed once it's used again
+    ESP_LOGD(TAG, "Kept-alive connection to %s was closed, reconnecting", connection->host.c_str());
+    this->stop_connection_(connection);
+    if (this->begin_(connection))
+      http_code = client->sendRequest(request.method, body, request.body.size());
+  }
+  connection->last_used = millis();
+
+  const bool head = strcmp(request.method, "HEAD") == 0;
+  const bool redirect = http_code == 301 || http_code == 302 || http_code == 303 || http_code == 307 || http_code == 308;
+  if (redirect && request.redirects < MAX_REDIRECTS)
+    this->redirect_url_ = redirect_location(request.url, client->header("Location"));
+
+  if (!this->redirect_url_.empty()) {
+    // Followed here instead of by HTTPClient, which would keep the connection to the new host in the pool entry of
+    // this one. The body of the redirect is skipped and the request sent again once it's complete.
+    ESP_LOGD(TAG, "HTTP Request redirected; URL: %s; Code: %d; Location: %s", request.url.c_str(), http_code,
+             this->redirect_url_.c_str());
+    if (http_code <= 303 && !head) {
+      request.method = "GET";
+      request.body.clear();
+    }
+    this->discard_body_ = true;
+  } else {
+    if (request.on_response)
+      request.on_response(http_code);
+
+    if (http_code < 0) {
+      ESP_LOGW(TAG, "HTTP Request failed; URL: %s; Error: %s", request.url.c_str(),
+               HTTPClient::errorToString(http_code).c_str());
+      this->status_set_warning();
+      this->finish_request_(false);
+      return;
+    }
+    this->discard_body_ = http_code < 200 || http_code >= 300;
+    if (this->discard_body_) {
+      ESP_LOGW(TAG, "HTTP Request failed; URL: %s; Code: %d", request.url.c_str(), http_code);
+      this->status_set_warning();
+    } else {
+      this->status_clear_warning();
+      ESP_LOGD(TAG, "HTTP Request completed; URL: %s; Code: %d", request.url.c_str(), http_code);
+    }
+  }
+
+  // The body was already read by get_string() from on_response
+  if (this->body_read_) {
+    this->finish_request_(true);
+    return;
+  }
+
+  String transfer_encoding = client->header("Transfer-Encoding");
+  transfer_encoding.toLowerCase();
+  if (head || http_code < 200 || http_code == 204 || http_code == 304) {
+    this->body_state_ = BODY_DONE;
+  } else if (transfer_encoding.indexOf("chunked") >= 0) {
+    this->body_state_ = BODY_CHUNK_SIZE;
+    this->body_remaining_ = 0;
+    this->line_length_ = 0;
+    this->chunk_extension_ = false;
+  } else if (client->getSize() >= 0) {
+    this->body_state_ = client->getSize() == 0 ? BODY_DONE : BODY_LENGTH;
+    this->body_remaining_ = client->getSize();
+  } else {
+    this->body_state_ = BODY_UNTIL_CLOSE;
+  }
 
-  if (!this->last_url_.empty() && this->url_ != this->last_url_) {
-    // Close connection if url has been changed
-    this->client_.setReuse(false);
-    this->client_.end();
+  if (this->body_state_ == BODY_DONE) {
+    this->finish_request_(true);
+    return;
   }
-  this->client_.setReuse(true);
+  // Kept, HTTPClient no longer returns it once the server closed the connection but data may still be buffered
+  this->stream_ = client->getStreamPtr();
+  this->last_received_ = millis();
 }
 
-void HttpRequestComponent::send(const std::vector<HttpRequestResponseTrigger *> &response_triggers) {
+bool HttpRequestComponent::begin_(Connection *connection) {
+  HTTPClient *client = connection->client.get();
+  const String url = this->request_.url.c_str();
   bool begin_status = false;
-  const String url = this->url_.c_str();
 #ifdef ARDUINO_ARCH_ESP32
-  begin_status = this->client_.begin(url);
+  begin_status = client->begin(url);
 #endif
 #ifdef ARDUINO_ARCH_ESP8266
 #ifndef CLANG_TIDY
-  this->client_.setFollowRedirects(true);
-  this->client_.setRedirectLimit(3);
-  begin_status = this->client_.begin(*this->get_wifi_client_(), url);
+  begin_status = client->begin(*connection->wifi_client, url);
 #endif
 #endif
+  if (!begin_status)
+    return false;
 
-  if (!begin_status) {
-    this->client_.end();
-    this->status_set_warning();
-    ESP_LOGW(TAG, "HTTP Request failed at the begin phase. Please check the configuration");
-    return;
-  }
-
-  this->client_.setTimeout(this->timeout_);
-  if (this->useragent_ != nullptr) {
-    this->client_.setUserAgent(this->useragent_);
+  client->setTimeout(this->request_.timeout);
+  if (!this->request_.useragent.empty()) {
+    client->setUserAgent(this->request_.useragent.c_str());
   }
-  for (const auto &header : this->headers_) {
-    this->client_.addHeader(header.name, header.value, false, true);
+  for (const auto &header : this->request_.headers) {
+    client->addHeader(header.name, header.value.c_str(), false, true);
   }
+  // Collected again for every request, this also clears the value of the previous response
+  const char *header_keys[] = {"Transfer-Encoding", "Location"};
+  client->collectHeaders(header_keys, 2);
+  return true;
+}
 
-  int http_code = this->client_.sendRequest(this->method_, this->body_.c_str());
-  for (auto *trigger : response_triggers)
-    trigger->process(http_code);
+void HttpRequestComponent::receive_body_() {
+  uint8_t buffer[RECEIVE_BUFFER_SIZE];
+  for (uint8_t i = 0; i < MAX_READS_PER_LOOP && this->stream_ != nullptr; i++) {
+    const int available = this->stream_->available();
+    if (available <= 0)
+      break;
+    const int len = this->stream_->read(buffer, std::min<size_t>(available, sizeof(buffer)));
+    if (len <= 0)
+      break;
+    this->last_received_ = millis();
+    this->parse_body_(buffer, len);
+    if (this->body_state_ == BODY_DONE || this->body_state_ == BODY_ERROR)
+      break;
+  }
 
-  if (http_code < 0) {
-    ESP_LOGW(TAG, "HTTP Request failed; URL: %s; Error: %s", this->url_.c_str(),
-             HTTPClient::errorToString(http_code).c_str());
-    this->status_set_warning();
+  if (this->body_state_ == BODY_DONE) {
+    this->finish_request_(true);
     return;
   }
-
-  if (http_code < 200 || http_code >= 300) {
-    ESP_LOGW(TAG, "HTTP Request failed; URL: %s; Code: %d", this->url_.c_str(), http_code);
+  if (this->body_state_ == BODY_ERROR) {
+    ESP_LOGW(TAG, "HTTP Request failed; URL: %s; Invalid chunked transfer encoding", this->request_.url.c_str());
     this->status_set_warning();
+    this->finish_request_(false);
     return;
   }
 
-  this->status_clear_warning();
-  ESP_LOGD(TAG, "HTTP Request completed; URL: %s; Code: %d", this->url_.c_str(), http_code);
+  if (this->stream_ == nullptr || (!this->stream_->connected() && this->stream_->available() == 0)) {
+    if (this->body_state_ == BODY_UNTIL_CLOSE) {
+      // Without a length the body ends when the server closes the connection
+      this->finish_request_(true);
+      return;
+    }
+    ESP_LOGW(TAG, "HTTP Request failed; URL: %s; Connection closed before the body was complete",
+             this->request_.url.c_str());
+  } else if (millis() - this->last_received_ > this->request_.timeout) {
+    ESP_LOGW(TAG, "HTTP Request failed; URL: %s; Timeout while receiving the body", this->request_.url.c_str());
+  } else {
+    return;
+  }
+  this->status_set_warning();
+  this->finish_request_(false);
 }
 
-#ifdef ARDUINO_ARCH_ESP8266
-WiFiClient *HttpRequestComponent::get_wifi_client_() {
-  if (this->secure_) {
-    if (this->wifi_client_secure_ == nullptr) {
-      this->wifi_client_secure_ = new BearSSL::WiFiClientSecure();
-      this->wifi_client_secure_->setInsecure();
-      this->wifi_client_secure_->setBufferSizes(512, 512);
+void HttpRequestComponent::parse_body_(const uint8_t *data, size_t len) {
+  size_t i = 0;
+  while (i < len && this->body_state_ != BODY_DONE && this->body_state_ != BODY_ERROR) {
+    switch (this->body_state_) {
+      case BODY_UNTIL_CLOSE:
+        this->on_body_data_(data + i, len - i);
+        i = len;
+        break;
+      case BODY_LENGTH:
+      case BODY_CHUNK_DATA: {
+        const size_t count = std::min<size_t>(len - i, this->body_remaining_);
+        this->on_body_data_(data + i, count);
+        i += count;
+        this->body_remaining_ -= count;
+        if (this->body_remaining_ == 0)
+          this->body_state_ = this->body_state_ == BODY_LENGTH ? BODY_DONE : BODY_CHUNK_DATA_END;
+        break;
+      }
+      case BODY_CHUNK_SIZE: {
+        // <hex size>[;extension]\r\n
+        const char c = data[i++];
+        if (c == '\n') {
+          if (this->line_length_ == 0) {
+            this->body_state_ = BODY_ERROR;
+          } else {
+            this->body_state_ = this->body_remaining_ == 0 ? BODY_TRAILER : BODY_CHUNK_DATA;
+            this->line_length_ = 0;
+          }
+        } else if (this->chunk_extension_ || c == '\r') {
+          continue;
+        } else if (c == ';' || c == ' ' || c == '\t') {
+          this->chunk_extension_ = this->line_length_ != 0;
+          if (!this->chunk_extension_)
+            this->body_state_ = BODY_ERROR;
+        } else {
+          uint8_t digit;
+          if (c >= '0' && c <= '9') {
+            digit = c - '0';
+          } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+            digit = (c | 0x20) - 'a' + 10;
+          } else {
+            this->body_state_ = BODY_ERROR;
+            break;
+          }
+          // Chunks don't get anywhere near 256MB, larger sizes can only be garbage
+          if (this->body_remaining_ >= 0x1000000) {
+            this->body_state_ = BODY_ERROR;
+            break;
+          }
+          this->body_remaining_ = (this->body_remaining_ << 4) | digit;
+          this->line_length_ = 1;
+        }
+        break;
+      }
+      case BODY_CHUNK_DATA_END: {
+        // The \r\n after the data of a chunk
+        const char c = data[i++];
+        if (c == '\n') {
+          this->body_state_ = BODY_CHUNK_SIZE;
+          this->chunk_extension_ = false;
+        } else if (c != '\r') {
+          this->body_state_ = BODY_ERROR;
+        }
+        break;
+      }
+      case BODY_TRAILER: {
+        // Trailer fields after the last chunk, up to an empty line
+        const char c = data[i++];
+        if (c == '\n') {
+          if (this->line_length_ == 0)
+            this->body_state_ = BODY_DONE;
+          this->line_length_ = 0;
+        } else if (c != '\r') {
+          this->line_length_ = 1;
+        }
+        break;
+      }
+      default:
+        break;
     }
-    return this->wifi_client_secure_;
   }
+}
+
+void HttpRequestComponent::on_body_data_(const uint8_t *data, size_t len) {
+  if (this->discard_body_ || !this->request_.on_data || len == 0)
+    return;
+  this->request_.on_data(Span<const uint8_t>(data, len), false);
+}
 
-  if (this->wifi_client_ == nullptr) {
-    this->wifi_client_ = new WiFiClient();
+void HttpRequestComponent::finish_request_(bool complete) {
+  Connection *connection = this->connection_;
+  if (complete) {
+    // Keeps the connection open for the next request to this host, unless the server asked to close it
+    connection->client->end();
+    connection->last_used = millis();
+    if (!this->discard_body_ && !this->body_read_ && this->request_.on_data)
+      this->request_.on_data(Span<const uint8_t>(), true);
+  } else {
+    // Whatever is left of the response would be read as the response to the next request
+    this->stop_connection_(connection);
+  }
+  this->connection_ = nullptr;
+  this->stream_ = nullptr;
+  if (!this->redirect_url_.empty()) {
+    this->request_.url = std::move(this->redirect_url_);
+    this->redirect_url_.clear();
+    this->request_.redirects++;
+    this->queue_.insert(this->queue_.begin(), std::move(this->request_));
+    this->request_ = Request();
+    return;
   }
-  return this->wifi_client_;
+  // Moved out first, on_complete may continue an automation that queues the next request
+  Request request = std::move(this->request_);
+  this->request_ = Request();
+  if (request.on_complete)
+    request.on_complete();
 }
+
+HttpRequestComponent::Connection *HttpRequestComponent::get_connection_(const std::string &url) {
+  const std::string host = url_host(url);
+
+  for (auto &connection : this->connections_) {
+    if (connection.host == host)
+      return &connection;
+  }
+
+  if (!this->connections_.empty() && this->connections_.size() >= this->max_connections_) {
+    const uint32_t now = millis();
+    auto lru = this->connections_.begin();
+    for (auto it = this->connections_.begin(); it != this->connections_.end(); it++) {
+      if (now - it->last_used > now - lru->last_used)
+        lru = it;
+    }
+    ESP_LOGV(TAG, "Closing connection to %s to connect to %s", lru->host.c_str(), host.c_str());
+    this->stop_connection_(&*lru);
+    this->connections_.erase(lru);
+  }
+
+  Connection connection;
+  connection.host = host;
+  connection.client.reset(new HTTPClient());
+  connection.client->setReuse(true);
+  connection.last_used = millis();
+#ifdef ARDUINO_ARCH_ESP8266
+  if (url.compare(0, 6, "https:") == 0) {
+    auto *wifi_client_secure = new BearSSL::WiFiClientSecure();
+    wifi_client_secure->setInsecure();
+    wifi_client_secure->setBufferSizes(512, 512);
+    connection.wifi_client.reset(wifi_client_secure);
+  } else {
+    connection.wifi_client.reset(new WiFiClient());
+  }
 #endif
+  this->connections_.push_back(std::move(connection));
+  return &this->connections_.back();
+}
 
-void HttpRequestComponent::close() {
-  this->last_url_ = this->url_;
-  this->client_.end();
+void HttpRequestComponent::stop_connection_(Connection *connection) {
+  connection->client->setReuse(false);
+  connection->client->end();
+  connection->client->setReuse(true);
+}
+
+void HttpRequestComponent::close_idle_connections_() {
+  // Connections can only be closed between requests, the one in progress points into connections_
+  if (this->connection_ != nullptr)
+    return;
+  const uint32_t now = millis();
+  for (auto it = this->connections_.begin(); it != this->connections_.end();) {
+    if (now - it->last_used > this->keep_alive_timeout_ || !it->client->connected()) {
+      ESP_LOGV(TAG, "Closing idle connection to %s", it->host.c_str());
+      this->stop_connection_(&*it);
+      it = this->connections_.erase(it);
+    } else {
+      it++;
+    }
+  }
 }
 
 const char *HttpRequestComponent::get_string() {
-  static const String STR = this->client_.getString();
-  return STR.c_str();
+  if (this->connection_ != nullptr && this->stream_ == nullptr && !this->body_read_) {
+    this->response_ = this->connection_->client->getString();
+    this->body_read_ = true;
+  }
+  return this->response_.c_str();
 }
 
 }  // namespace http_request
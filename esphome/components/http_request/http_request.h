@@ -3,9 +3,13 @@
 #include "esphome/components/json/json_util.h"
 #include "esphome/core/automation.h"
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #ifdef ARDUINO_ARCH_ESP32
 #include <HTTPClient.h>
@@ -20,41 +24,147 @@ namespace http_request {
 
 struct Header {
   const char *name;
-  const char *value;
+  std::string value;
 };
 
-class HttpRequestResponseTrigger;
+/// The status code on_response gets for a request that was dropped because the queue was full.
+static const int HTTP_REQUEST_ERROR_QUEUE_FULL = -100;
 
+/// A request queued with HttpRequestComponent::queue(), its callbacks are called from the component's loop().
+struct Request {
+  std::string url;
+  const char *method{"GET"};
+  std::string body;
+  std::list<Header> headers;
+  /// The User-Agent header, empty to use the one of the component.
+  std::string useragent;
+  /// The timeout in milliseconds, 0 to use the one of the component.
+  uint16_t timeout{0};
+  /// Called once the response headers arrived with the status code, or with a negative HTTPClient error code or
+  /// HTTP_REQUEST_ERROR_QUEUE_FULL.
+  std::function<void(int)> on_response;
+  /** Called with each part of the body of a successful (2xx) response as it is received.
+   *
+   * The data is only valid during the call. Once the body is complete, it is called a last time with empty data and
+   * last set.
+   */
+  std::function<void(Span<const uint8_t>, bool)> on_data;
+  /// Called once the request is complete or has failed, after the other callbacks.
+  std::function<void()> on_complete;
+  /// The number of redirects followed so far.
+  uint8_t redirects{0};
+};
+
+/** Executes HTTP requests one at a time without blocking the main loop for the whole transfer.
+ *
+ * Queued requests are started from loop(). Connecting and waiting for the response headers is still done by
+ * HTTPClient in one go, but the body is read over as many loop() iterations as it takes to arrive and passed on in
+ * parts, so it never has to be held in memory as a whole.
+ *
+ * Connections are kept alive for reuse by later requests to the same host (scheme, host and port), up to
+ * max_connections hosts at a time. Connections that were idle for keep_alive_timeout are closed.
+ */
 class HttpRequestComponent : public Component {
  public:
+  void setup() override;
+  void loop() override;
   void dump_config() override;
   float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
 
-  void set_url(std::string url);
-  void set_method(const char *method) { this->method_ = method; }
   void set_useragent(const char *useragent) { this->useragent_ = useragent; }
   void set_timeout(uint16_t timeout) { this->timeout_ = timeout; }
-  void set_body(std::string body) { this->body_ = std::move(body); }
-  void set_headers(std::list<Header> headers) { this->headers_ = std::move(headers); }
-  void send(const std::vector<HttpRequestResponseTrigger *> &response_triggers);
-  void close();
+  void set_max_connections(uint8_t max_connections) { this->max_connections_ = max_connections; }
+  void set_keep_alive_timeout(uint32_t keep_alive_timeout) { this->keep_alive_timeout_ = keep_alive_timeout; }
+
+  /** Queue a request, it's sent once all requests queued before it are complete.
+   *
+   * Returns false if the queue is full. The request has then already failed with HTTP_REQUEST_ERROR_QUEUE_FULL.
+   */
+  bool queue(Request request);
+
+  /** Read the whole body of the response and return it.
+   *
+   * Only reads the body when called from the on_response callback of a request, which then no longer gets on_data
+   * calls. The string stays valid until the next request is started.
+   */
   const char *get_string();
 
  protected:
-  HTTPClient client_{};
-  std::string url_;
-  std::string last_url_;
-  const char *method_;
-  const char *useragent_{nullptr};
-  bool secure_;
-  uint16_t timeout_{5000};
-  std::string body_;
-  std::list<Header> headers_;
+  struct Connection {
+    /// The scheme, host and port of the URLs this connection is used for.
+    std::string host;
 #ifdef ARDUINO_ARCH_ESP8266
-  WiFiClient *wifi_client_{nullptr};
-  BearSSL::WiFiClientSecure *wifi_client_secure_{nullptr};
-  WiFiClient *get_wifi_client_();
+    // Declared before client, which uses it until it's destroyed
+    std::unique_ptr<WiFiClient> wifi_client;
 #endif
+    std::unique_ptr<HTTPClient> client;
+    /// millis() at which the last response was received.
+    uint32_t last_used;
+  };
+
+  enum BodyState : uint8_t {
+    BODY_LENGTH,
+    BODY_UNTIL_CLOSE,
+    BODY_CHUNK_SIZE,
+    BODY_CHUNK_DATA,
+    BODY_CHUNK_DATA_END,
+    BODY_TRAILER,
+    BODY_DONE,
+    BODY_ERROR,
+  };
+
+  /// Send the request in request_ and handle the response headers.
+  void start_request_();
+  bool begin_(Connection *connection);
+  /// Read the part of the body that arrived.
+  void receive_body_();
+  /// Decode the body data in the transfer encoding of the response and pass it to on_data.
+  void parse_body_(const uint8_t *data, size_t len);
+  void on_body_data_(const uint8_t *data, size_t len);
+  /// Complete the request in progress, the connection is only kept alive if the whole response was received.
+  void finish_request_(bool complete);
+  /// Return the pooled connection for the host of url, opening a new one if needed.
+  Connection *get_connection_(const std::string &url);
+  void stop_connection_(Connection *connection);
+  void close_idle_connections_();
+
+  const char *useragent_{nullptr};
+  uint16_t timeout_{5000};
+  uint8_t max_connections_{2};
+  uint32_t keep_alive_timeout_{15000};
+
+  std::vector<Request> queue_;
+  std::vector<Connection> connections_;
+  HighFrequencyLoopRequester high_freq_;
+
+  /// The request in progress, while connection_ is set.
+  Request request_;
+  Connection *connection_{nullptr};
+  WiFiClient *stream_{nullptr};
+  BodyState body_state_{BODY_DONE};
+  /// The bytes left in the body or the current chunk.
+  uint32_t body_remaining_{0};
+  /// The length of the current line of the chunk size or trailer, to tell an empty line.
+  uint8_t line_length_{0};
+  bool chunk_extension_{false};
+  /// Set for error responses, their body is read to keep the connection usable but not passed to on_data.
+  bool discard_body_{false};
+  bool body_read_{false};
+  /// millis() at which the last part of the body was received.
+  uint32_t last_received_{0};
+  String response_;
+  /// Set while the body of a redirect response is skipped, the URL the request is sent to next.
+  std::string redirect_url_;
+};
+
+class HttpRequestResponseTrigger : public Trigger<int> {
+ public:
+  void process(int status_code) { this->trigger(status_code); }
+};
+
+class HttpRequestDataTrigger : public Trigger<Span<const uint8_t>, bool> {
+ public:
+  void process(Span<const uint8_t> data, bool last) { this->trigger(data, last); }
 };
 
 template<typename... Ts> class HttpRequestSendAction : public Action<Ts...> {
@@ -74,42 +184,64 @@ template<typename... Ts> class HttpRequestSendAction : public Action<Ts...> {
 
   void register_response_trigger(HttpRequestResponseTrigger *trigger) { this->response_triggers_.push_back(trigger); }
 
-  void play(Ts... x) override {
-    this->parent_->set_url(this->url_.value(x...));
-    this->parent_->set_method(this->method_.value(x...));
+  void register_data_trigger(HttpRequestDataTrigger *trigger) { this->data_triggers_.push_back(trigger); }
+
+  void play_complex(Ts... x) override {
+    this->num_running_++;
+    Request request;
+    request.url = this->url_.value(x...);
+    request.method = this->method_.value(x...);
     if (this->body_.has_value()) {
-      this->parent_->set_body(this->body_.value(x...));
+      request.body = this->body_.value(x...);
     }
     if (!this->json_.empty()) {
       auto f = std::bind(&HttpRequestSendAction<Ts...>::encode_json_, this, x..., std::placeholders::_1);
-      this->parent_->set_body(json::build_json(f));
+      request.body = json::build_json(f);
     }
     if (this->json_func_ != nullptr) {
       auto f = std::bind(&HttpRequestSendAction<Ts...>::encode_json_func_, this, x..., std::placeholders::_1);
-      this->parent_->set_body(json::build_json(f));
+      request.body = json::build_json(f);
     }
     if (this->useragent_.has_value()) {
-      this->parent_->set_useragent(this->useragent_.value(x...));
+      request.useragent = this->useragent_.value(x...);
     }
     if (this->timeout_.has_value()) {
-      this->parent_->set_timeout(this->timeout_.value(x...));
+      request.timeout = this->timeout_.value(x...);
     }
-    if (!this->headers_.empty()) {
-      std::list<Header> headers;
-      for (const auto &item : this->headers_) {
-        auto val = item.second;
-        Header header;
-        header.name = item.first;
-        header.value = val.value(x...);
-        headers.push_back(header);
-      }
-      this->parent_->set_headers(headers);
+    for (const auto &item : this->headers_) {
+      auto val = item.second;
+      // Copied, the value may point into a string that's gone by the time the request is sent
+      request.headers.push_back(Header{item.first, val.value(x...)});
+    }
+    if (!this->response_triggers_.empty()) {
+      request.on_response = [this](int status_code) {
+        for (auto *trigger : this->response_triggers_)
+          trigger->process(status_code);
+      };
     }
-    this->parent_->send(this->response_triggers_);
-    this->parent_->close();
+    if (!this->data_triggers_.empty()) {
+      request.on_data = [this](Span<const uint8_t> data, bool last) {
+        for (auto *trigger : this->data_triggers_)
+          trigger->process(data, last);
+      };
+    }
+    // The following actions run once the request is complete, like they did when requests were sent synchronously
+    request.on_complete = std::bind(&HttpRequestSendAction<Ts...>::complete_, this, this->generation_, x...);
+    // A dropped request completes right away with HTTP_REQUEST_ERROR_QUEUE_FULL
+    this->parent_->queue(std::move(request));
   }
 
+  void play(Ts... x) override { /* ignore - see play_complex */
+  }
+
+  void stop() override { this->generation_++; }
+
  protected:
+  void complete_(uint32_t generation, Ts... x) {
+    // Requests of runs that were stopped don't continue the runs started since
+    if (generation == this->generation_)
+      this->play_next_(x...);
+  }
   void encode_json_(Ts... x, JsonObject &root) {
     for (const auto &item : this->json_) {
       auto val = item.second;
@@ -122,11 +254,8 @@ template<typename... Ts> class HttpRequestSendAction : public Action<Ts...> {
   std::map<const char *, TemplatableValue<std::string, Ts...>> json_{};
   std::function<void(Ts..., JsonObject &)> json_func_{nullptr};
   std::vector<HttpRequestResponseTrigger *> response_triggers_;
-};
-
-class HttpRequestResponseTrigger : public Trigger<int> {
- public:
-  void process(int status_code) { this->trigger(status_code); }
+  std::vector<HttpRequestDataTrigger *> data_triggers_;
+  uint32_t generation_{0};
 };
 
 }  // namespace http_request
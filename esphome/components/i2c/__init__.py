@@ -21,6 +21,8 @@ I2CDevice = i2c_ns.class_("I2CDevice")
 I2CMultiplexer = i2c_ns.class_("I2CMultiplexer", I2CDevice)
 
 MULTI_CONF = True
+CONF_LATENCY_BUDGET = "latency_budget"
+
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(I2CComponent),
@@ -37,6 +39,9 @@ I2CMULTIPLEXER_SCHEMA = cv.Schema(
     {
         cv.Required(CONF_ID): cv.use_id(I2CMultiplexer),
         cv.Required(CONF_CHANNEL): cv.uint8_t,
+        cv.Optional(
+            CONF_LATENCY_BUDGET, default="50ms"
+        ): cv.positive_time_period_milliseconds,
     }
 )
 
@@ -87,3 +92,6 @@ async def register_i2c_device(var, config):
         cg.add(
             var.set_i2c_multiplexer(multiplexer, config[CONF_MULTIPLEXER][CONF_CHANNEL])
         )
+        cg.add(
+            var.set_i2c_latency_budget(config[CONF_MULTIPLEXER][CONF_LATENCY_BUDGET])
+        )
@@ -8,6 +8,8 @@ namespace i2c {
 
 static const char *const TAG = "i2c";
 
+static const uint32_t I2C_REPORT_INTERVAL = 60000;
+
 I2CComponent::I2CComponent() {
 #ifdef ARDUINO_ARCH_ESP32
   if (next_i2c_bus_num_ == 0)
@@ -24,6 +26,70 @@ void I2CComponent::setup() {
   this->wire_->begin(this->sda_pin_, this->scl_pin_);
   this->wire_->setClock(this->frequency_);
 }
+void I2CComponent::loop() {
+  const uint32_t now = millis();
+  while (!this->transactions_.empty()) {
+    auto it = this->next_transaction_(now);
+    if (it == this->transactions_.end())
+      break;
+    std::function<void()> f = std::move(it->f);
+    this->transactions_.erase(it);
+    f();
+  }
+
+  if (now - this->last_report_ >= I2C_REPORT_INTERVAL) {
+    if (this->busy_time_ > 0) {
+      ESP_LOGV(TAG, "Bus utilization %.1f%%, %u multiplexer channel switches in the last %us",
+               this->busy_time_ / ((now - this->last_report_) * 10.0f), this->channel_switches_,
+               (now - this->last_report_) / 1000);
+    }
+    this->busy_time_ = 0;
+    this->channel_switches_ = 0;
+    this->last_report_ = now;
+  }
+}
+void I2CComponent::queue_transaction_(I2CDevice *device, uint32_t delay, std::function<void()> &&f) {
+  if (delay == 0 && device->is_channel_selected_()) {
+    f();
+    return;
+  }
+  QueuedTransaction transaction;
+  transaction.device = device;
+  transaction.ready = millis() + delay;
+  transaction.deadline = transaction.ready;
+#ifdef USE_I2C_MULTIPLEXER
+  transaction.deadline += device->latency_budget_;
+#endif
+  transaction.f = std::move(f);
+  this->transactions_.push_back(std::move(transaction));
+}
+std::vector<I2CComponent::QueuedTransaction>::iterator I2CComponent::next_transaction_(uint32_t now) {
+  auto overdue = this->transactions_.end();
+  auto other_channel = this->transactions_.end();
+  bool channel_busy = false;
+  for (auto it = this->transactions_.begin(); it != this->transactions_.end(); ++it) {
+    const bool selected = it->device->is_channel_selected_();
+    if (int32_t(now - it->ready) < 0) {
+      channel_busy |= selected;
+      continue;
+    }
+    if (selected)
+      return it;
+    if (int32_t(now - it->deadline) >= 0) {
+      if (overdue == this->transactions_.end() || int32_t(it->deadline - overdue->deadline) < 0)
+        overdue = it;
+    } else if (other_channel == this->transactions_.end()) {
+      other_channel = it;
+    }
+  }
+  // Switch the channel for the transaction that waited the longest past its deadline. Otherwise only switch once no
+  // transaction on the current channel is converting anymore, so that its reads do not need to switch back.
+  if (overdue != this->transactions_.end())
+    return overdue;
+  if (channel_busy)
+    return this->transactions_.end();
+  return other_channel;
+}
 void I2CComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "I2C Bus:");
   ESP_LOGCONFIG(TAG, "  SDA Pin: GPIO%u", this->sda_pin_);
@@ -57,7 +123,9 @@ void I2CComponent::raw_begin_transmission(uint8_t address) {
   this->wire_->beginTransmission(address);
 }
 bool I2CComponent::raw_end_transmission(uint8_t address, bool send_stop) {
+  const uint32_t start = micros();
   uint8_t status = this->wire_->endTransmission(send_stop);
+  this->busy_time_ += micros() - start;
   ESP_LOGVV(TAG, "    Transmission ended. Status code: 0x%02X", status);
 
   switch (status) {
@@ -81,7 +149,9 @@ bool I2CComponent::raw_end_transmission(uint8_t address, bool send_stop) {
 }
 bool I2CComponent::raw_request_from(uint8_t address, uint8_t len) {
   ESP_LOGVV(TAG, "Requesting %u bytes from 0x%02X:", len, address);
+  const uint32_t start = micros();
   uint8_t ret = this->wire_->requestFrom(address, len);
+  this->busy_time_ += micros() - start;
   if (ret != len) {
     ESP_LOGW(TAG, "Requesting %u bytes from 0x%02X failed!", len, address);
     return false;
@@ -188,11 +258,21 @@ void I2CDevice::set_i2c_multiplexer(I2CMultiplexer *multiplexer, uint8_t channel
 void I2CDevice::check_multiplexer_() {
   if (this->multiplexer_ != nullptr) {
     ESP_LOGVV(TAG, "Multiplexer setting channel to %d", this->channel_);
+    if (this->multiplexer_->get_channel() != this->channel_)
+      this->parent_->channel_switches_++;
     this->multiplexer_->set_channel(this->channel_);
   }
 }
 #endif
 
+bool I2CDevice::is_channel_selected_() const {
+#ifdef USE_I2C_MULTIPLEXER
+  if (this->multiplexer_ != nullptr)
+    return this->multiplexer_->get_channel() == this->channel_;
+#endif
+  return true;
+}
+
 void I2CDevice::raw_begin_transmission() {  // NOLINT
 #ifdef USE_I2C_MULTIPLEXER
   this->check_multiplexer_();
@@ -271,6 +351,38 @@ bool I2CDevice::write_byte_16(uint8_t a_register, uint16_t data) {  // NOLINT
 #endif
   return this->parent_->write_byte_16(this->address_, a_register, data);
 }
+void I2CDevice::read_bytes_async(uint8_t a_register, uint8_t len, uint32_t conversion,  // NOLINT
+                                 I2CReadCallback &&callback) {
+  this->parent_->queue_transaction_(this, 0, [this, a_register, len, conversion, callback]() {
+    if (!this->write_bytes(a_register, nullptr, 0)) {
+      callback(false, nullptr);
+      return;
+    }
+    this->read_bytes_raw_after_(len, conversion, I2CReadCallback(callback));
+  });
+}
+void I2CDevice::write_read_async(const uint8_t *data, uint8_t data_len, uint8_t len, uint32_t conversion,  // NOLINT
+                                 I2CReadCallback &&callback) {
+  std::vector<uint8_t> command(data, data + data_len);
+  this->parent_->queue_transaction_(this, 0, [this, command, len, conversion, callback]() {
+    if (!this->write_bytes_raw(command)) {
+      callback(false, nullptr);
+      return;
+    }
+    this->read_bytes_raw_after_(len, conversion, I2CReadCallback(callback));
+  });
+}
+void I2CDevice::read_bytes_raw_after_(uint8_t len, uint32_t conversion, I2CReadCallback &&callback) {  // NOLINT
+  auto read = [this, len, callback]() {
+    uint8_t data[I2C_MAX_ASYNC_READ_LENGTH];
+    if (len > I2C_MAX_ASYNC_READ_LENGTH || !this->read_bytes_raw(data, len)) {
+      callback(false, nullptr);
+      return;
+    }
+    callback(true, data);
+  };
+  this->parent_->queue_transaction_(this, conversion, read);
+}
 void I2CDevice::set_i2c_parent(I2CComponent *parent) { this->parent_ = parent; }
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -8,8 +8,20 @@
 namespace esphome {
 namespace i2c {
 
+class I2CDevice;
+
 #define LOG_I2C_DEVICE(this) ESP_LOGCONFIG(TAG, "  Address: 0x%02X", this->address_);
 
+/// The maximum number of bytes an asynchronous read can return.
+static const uint8_t I2C_MAX_ASYNC_READ_LENGTH = 32;
+
+/** Called with the result of an asynchronous read.
+ *
+ * @param success If both the write and the read of the transaction were successful.
+ * @param data The bytes that were read, only valid during the call.
+ */
+using I2CReadCallback = std::function<void(bool success, const uint8_t *data)>;
+
 /** The I2CComponent is the base of ESPHome's i2c communication.
  *
  * It handles setting up the bus (with pins, clock frequency) and provides nice helper functions to
@@ -119,16 +131,42 @@ class I2CComponent : public Component {
 
   /// Setup the i2c. bus
   void setup() override;
+  void loop() override;
   void dump_config() override;
   /// Set a very high setup priority to make sure it's loaded before all other hardware.
   float get_setup_priority() const override;
 
  protected:
+  friend class I2CDevice;
+
+  /// A transaction of a device that is waiting for its conversion time, or for its multiplexer channel.
+  struct QueuedTransaction {
+    I2CDevice *device;
+    /// millis() from which on the transaction can run.
+    uint32_t ready;
+    /// millis() from which on the transaction runs even if that means switching the multiplexer channel.
+    uint32_t deadline;
+    std::function<void()> f;
+  };
+
+  /** Queue f to run delay ms from now, batched with the other transactions on the channel of device.
+   *
+   * If delay is 0 and no channel switch is needed f runs right away.
+   */
+  void queue_transaction_(I2CDevice *device, uint32_t delay, std::function<void()> &&f);
+  /// Find the next transaction to run, prefers transactions that do not need a channel switch.
+  std::vector<QueuedTransaction>::iterator next_transaction_(uint32_t now);
+
   TwoWire *wire_;
   uint8_t sda_pin_;
   uint8_t scl_pin_;
   uint32_t frequency_;
   bool scan_;
+  std::vector<QueuedTransaction> transactions_;
+  /// Time in us spent waiting for the bus since the last report.
+  uint32_t busy_time_{0};
+  uint32_t channel_switches_{0};
+  uint32_t last_report_{0};
 };
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -171,6 +209,8 @@ class I2CDevice {
 #ifdef USE_I2C_MULTIPLEXER
   /// Manually set the i2c multiplexer of this device.
   void set_i2c_multiplexer(I2CMultiplexer *multiplexer, uint8_t channel);
+  /// Set how long in ms an asynchronous read may be delayed to batch it with other reads on the same channel.
+  void set_i2c_latency_budget(uint32_t latency_budget) { this->latency_budget_ = latency_budget; }
 #endif
   /// Manually set the parent i2c bus for this device.
   void set_i2c_parent(I2CComponent *parent);
@@ -192,7 +232,8 @@ class I2CDevice {
    * @param a_register The register number to write to the bus before reading.
    * @param data An array to store len amount of 8-bit bytes into.
    * @param len The amount of bytes to request and write into data.
-   * @param conversion The time in ms between writing the register value and reading out the value.
+   * @param conversion The time in ms between writing the register value and reading out the value, the loop is
+   *                   blocked during that time (see read_bytes_async()).
    * @return If the operation was successful.
    */
   bool read_bytes(uint8_t a_register, uint8_t *data, uint8_t len, uint32_t conversion = 0);
@@ -279,20 +320,46 @@ class I2CDevice {
   /// Write a single 16-bit word of data into the specified register. Return true if successful.
   bool write_byte_16(uint8_t a_register, uint16_t data);
 
+  /** Write a register number, then read len bytes conversion ms later without blocking.
+   *
+   * The transaction is queued on the bus, so the loop and the transactions of other devices keep running while this
+   * device converts. Behind a multiplexer, both steps may be delayed by up to the latency budget of the device, to
+   * batch them with the transactions of other devices on the same channel.
+   *
+   * @param a_register The register number to write to the bus before reading.
+   * @param len The amount of bytes to read, at most I2C_MAX_ASYNC_READ_LENGTH.
+   * @param conversion The time in ms between writing the register value and reading out the value.
+   * @param callback Called with the result once the read is done, or once the write failed.
+   */
+  void read_bytes_async(uint8_t a_register, uint8_t len, uint32_t conversion, I2CReadCallback &&callback);
+
+  /// Like read_bytes_async(), but write data_len raw bytes from data (for example a command) before reading.
+  void write_read_async(const uint8_t *data, uint8_t data_len, uint8_t len, uint32_t conversion,
+                        I2CReadCallback &&callback);
+
  protected:
+  friend class I2CComponent;
+
+  /// Read len raw bytes conversion ms from now and pass them to callback.
+  void read_bytes_raw_after_(uint8_t len, uint32_t conversion, I2CReadCallback &&callback);
   // Checks for multiplexer set and set channel
   void check_multiplexer_();
+  /// Whether the bus can talk to this device without switching the multiplexer channel.
+  bool is_channel_selected_() const;
   uint8_t address_{0x00};
   I2CComponent *parent_{nullptr};
 #ifdef USE_I2C_MULTIPLEXER
   I2CMultiplexer *multiplexer_{nullptr};
   uint8_t channel_;
+  uint32_t latency_budget_{0};
 #endif
 };
 class I2CMultiplexer : public I2CDevice {
  public:
   I2CMultiplexer() = default;
   virtual void set_channel(uint8_t channelno);
+  /// The currently selected channel, 0xFF if unknown.
+  virtual uint8_t get_channel() const { return 0xFF; }
 };
 }  // namespace i2c
 }  // namespace esphome
@@ -46,6 +46,47 @@ const char *build_json(const json_build_t &f, size_t *length) {
   *length = bytes_written;
   return global_json_build_buffer;
 }
+
+/// A Print that appends to the global JSON build buffer, growing it as needed.
+class GlobalJsonBuildBufferPrint : public Print {
+ public:
+  size_t write(uint8_t c) override { return this->write(&c, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    // keep room for the null terminator
+    size_t required = this->length_ + size + 1;
+    if (required > global_json_build_buffer_size) {
+      size_t new_size = std::max(required, global_json_build_buffer_size * 2);
+      char *new_buffer = new char[new_size];
+      if (this->length_ != 0)
+        memcpy(new_buffer, global_json_build_buffer, this->length_);
+      delete[] global_json_build_buffer;
+      global_json_build_buffer = new_buffer;
+      global_json_build_buffer_size = new_size;
+    }
+    memcpy(global_json_build_buffer + this->length_, buffer, size);
+    this->length_ += size;
+    return size;
+  }
+  size_t get_length() const { return this->length_; }
+
+ protected:
+  size_t length_{0};
+};
+
+const char *write_json(const json_write_t &f, size_t *length) {
+  // start with the size of the last build, that's usually enough
+  reserve_global_json_build_buffer(64);
+  GlobalJsonBuildBufferPrint print;
+  JsonWriter writer(&print);
+  writer.begin_object();
+  f(writer);
+  writer.end_object();
+
+  *length = print.get_length();
+  global_json_build_buffer[*length] = '\0';
+  return global_json_build_buffer;
+}
+
 void parse_json(const std::string &data, const json_parse_t &f) {
   global_json_buffer.clear();
   JsonObject &root = global_json_buffer.parseObject(data);
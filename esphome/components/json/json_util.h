@@ -2,6 +2,7 @@
 
 #include "esphome/core/helpers.h"
 #include <ArduinoJson.h>
+#include "json_writer.h"
 
 namespace esphome {
 namespace json {
@@ -17,6 +18,16 @@ const char *build_json(const json_build_t &f, size_t *length);
 
 std::string build_json(const json_build_t &f);
 
+/// Callback function typedef for streaming JSON objects with a JsonWriter.
+using json_write_t = std::function<void(JsonWriter &)>;
+
+/** Stream a JSON object with the provided writer function into the shared JSON build buffer, without a DOM.
+ *
+ * The writer is already inside the root object when f is called. The returned string is null-terminated and
+ * stays valid until the next call to build_json() or write_json().
+ */
+const char *write_json(const json_write_t &f, size_t *length);
+
 /// Parse a JSON string and run the provided json parse function if it's valid.
 void parse_json(const std::string &data, const json_parse_t &f);
 
@@ -0,0 +1,210 @@
+#include "json_writer.h"
+#include "esphome/core/log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace esphome {
+namespace json {
+
+static const char *const TAG = "json";
+
+/// Discards everything written to it.
+class NullPrint : public Print {
+ public:
+  size_t write(uint8_t c) override { return 1; }
+  size_t write(const uint8_t *buffer, size_t size) override { return size; }
+};
+static NullPrint null_print;  // NOLINT
+
+const uint8_t JsonWriter::MAX_DEPTH;
+
+bool JsonWriter::enter_() {
+  if (this->dropped_depth_ == 0 && this->depth_ < MAX_DEPTH)
+    return true;
+  if (this->dropped_depth_ == 0) {
+    ESP_LOGE(TAG, "JSON is nested deeper than %u levels, dropping the inner containers", MAX_DEPTH);
+    this->kept_out_ = this->out_;
+    this->out_ = &null_print;
+  }
+  this->dropped_depth_++;
+  return false;
+}
+void JsonWriter::open_(char c) {
+  this->out_->write(c);
+  this->depth_++;
+  // bit 0 is never used at depth 0, so it serves depth 32
+  this->has_elements_ &= ~(1UL << (this->depth_ & 31));
+}
+void JsonWriter::close_(char c) {
+  if (this->dropped_depth_ > 0) {
+    if (--this->dropped_depth_ == 0)
+      this->out_ = this->kept_out_;
+    return;
+  }
+  if (this->depth_ == 0) {
+    ESP_LOGE(TAG, "Closing a JSON container that isn't open");
+    return;
+  }
+  this->depth_--;
+  this->out_->write(c);
+}
+void JsonWriter::begin_object() {
+  if (!this->enter_())
+    return;
+  this->write_separator_();
+  this->open_('{');
+}
+void JsonWriter::begin_object(const char *key) {
+  if (!this->enter_())
+    return;
+  this->write_key_(key);
+  this->open_('{');
+}
+void JsonWriter::end_object() { this->close_('}'); }
+void JsonWriter::begin_array() {
+  if (!this->enter_())
+    return;
+  this->write_separator_();
+  this->open_('[');
+}
+void JsonWriter::begin_array(const char *key) {
+  if (!this->enter_())
+    return;
+  this->write_key_(key);
+  this->open_('[');
+}
+void JsonWriter::end_array() { this->close_(']'); }
+
+void JsonWriter::add(const char *key, const char *value) {
+  this->write_key_(key);
+  this->write_string_(value, strlen(value));
+}
+void JsonWriter::add(const char *key, const std::string &value) {
+  this->write_key_(key);
+  this->write_string_(value.data(), value.size());
+}
+void JsonWriter::add(const char *key, bool value) {
+  this->write_key_(key);
+  this->out_->print(value ? "true" : "false");
+}
+void JsonWriter::add(const char *key, float value) {
+  this->write_key_(key);
+  this->write_float_(value);
+}
+void JsonWriter::add_raw(const char *key, const char *value, size_t length) {
+  this->write_key_(key);
+  this->out_->write(reinterpret_cast<const uint8_t *>(value), length);
+}
+void JsonWriter::add_null(const char *key) {
+  this->write_key_(key);
+  this->out_->print("null");
+}
+
+void JsonWriter::add(const char *value) {
+  this->write_separator_();
+  this->write_string_(value, strlen(value));
+}
+void JsonWriter::add(const std::string &value) {
+  this->write_separator_();
+  this->write_string_(value.data(), value.size());
+}
+void JsonWriter::add(bool value) {
+  this->write_separator_();
+  this->out_->print(value ? "true" : "false");
+}
+void JsonWriter::add(float value) {
+  this->write_separator_();
+  this->write_float_(value);
+}
+
+void JsonWriter::write_separator_() {
+  // the elements of dropped containers don't count for the container around them
+  if (this->depth_ == 0 || this->dropped_depth_ > 0)
+    return;
+  uint32_t bit = 1UL << (this->depth_ & 31);
+  if (this->has_elements_ & bit) {
+    this->out_->write(',');
+  } else {
+    this->has_elements_ |= bit;
+  }
+}
+void JsonWriter::write_key_(const char *key) {
+  this->write_separator_();
+  this->write_string_(key, strlen(key));
+  this->out_->write(':');
+}
+void JsonWriter::write_string_(const char *value, size_t length) {
+  this->out_->write('"');
+  // write unescaped runs in one go, only special characters are written separately
+  size_t run_start = 0;
+  for (size_t i = 0; i < length; i++) {
+    auto c = static_cast<uint8_t>(value[i]);
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+    if (i > run_start)
+      this->out_->write(reinterpret_cast<const uint8_t *>(value + run_start), i - run_start);
+    run_start = i + 1;
+    switch (c) {
+      case '"':
+        this->out_->print("\\\"");
+        break;
+      case '\\':
+        this->out_->print("\\\\");
+        break;
+      case '\n':
+        this->out_->print("\\n");
+        break;
+      case '\r':
+        this->out_->print("\\r");
+        break;
+      case '\t':
+        this->out_->print("\\t");
+        break;
+      default: {
+        char buf[7];
+        snprintf(buf, sizeof(buf), "\\u%04x", c);
+        this->out_->print(buf);
+        break;
+      }
+    }
+  }
+  if (length > run_start)
+    this->out_->write(reinterpret_cast<const uint8_t *>(value + run_start), length - run_start);
+  this->out_->write('"');
+}
+void JsonWriter::write_float_(float value) {
+  if (std::isnan(value) || std::isinf(value)) {
+    // NaN and infinity can't be represented in JSON
+    this->out_->print("null");
+    return;
+  }
+  char buf[24];
+  int len = snprintf(buf, sizeof(buf), "%.7g", value);
+  if (len > 0)
+    this->out_->write(reinterpret_cast<const uint8_t *>(buf), std::min(size_t(len), sizeof(buf) - 1));
+}
+void JsonWriter::write_integer_(bool negative, uint64_t value) {
+  char buf[21];
+  char *p = buf + sizeof(buf);
+  if (value <= UINT32_MAX) {
+    // avoid the slow 64-bit division in the common case
+    auto value32 = uint32_t(value);
+    do {
+      *--p = char('0' + value32 % 10);
+      value32 /= 10;
+    } while (value32 != 0);
+  } else {
+    do {
+      *--p = char('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+  }
+  if (negative)
+    this->out_->write('-');
+  this->out_->write(reinterpret_cast<const uint8_t *>(p), buf + sizeof(buf) - p);
+}
+
+}  // namespace json
+}  // namespace esphome
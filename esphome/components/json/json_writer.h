@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <Print.h>
+
+namespace esphome {
+namespace json {
+
+/** A minimal, DOM-free JSON writer that streams its output directly into a Print.
+ *
+ * Unlike ArduinoJson, no document is built in memory: every key and value is escaped and written to the output
+ * as soon as it's added. This makes it possible to render JSON straight into an AsyncResponseStream or the
+ * shared JSON build buffer (see write_json()) without holding both a DOM and the serialized string.
+ *
+ * Object members are added with add(key, value), array elements with add(value). Nesting is limited to MAX_DEPTH
+ * levels: containers opened deeper than that are logged as an error and dropped together with everything in them.
+ */
+class JsonWriter {
+ public:
+  static const uint8_t MAX_DEPTH = 32;
+
+  explicit JsonWriter(Print *out) : out_(out) {}
+
+  void begin_object();
+  void begin_object(const char *key);
+  void end_object();
+  void begin_array();
+  void begin_array(const char *key);
+  void end_array();
+
+  void add(const char *key, const char *value);
+  void add(const char *key, const std::string &value);
+  void add(const char *key, bool value);
+  void add(const char *key, float value);
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type add(const char *key,
+                                                                                                  T value) {
+    this->write_key_(key);
+    this->write_integer_(value < 0, value < 0 ? 0 - uint64_t(value) : uint64_t(value));
+  }
+  /// Add a pre-formatted JSON value (for example a number with a fixed accuracy) without escaping it.
+  void add_raw(const char *key, const char *value, size_t length);
+  void add_null(const char *key);
+
+  void add(const char *value);
+  void add(const std::string &value);
+  void add(bool value);
+  void add(float value);
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type add(T value) {
+    this->write_separator_();
+    this->write_integer_(value < 0, value < 0 ? 0 - uint64_t(value) : uint64_t(value));
+  }
+
+ protected:
+  void write_separator_();
+  void write_key_(const char *key);
+  void write_string_(const char *value, size_t length);
+  void write_float_(float value);
+  void write_integer_(bool negative, uint64_t value);
+  /// Whether a new container can be opened, otherwise it is dropped until it is closed again.
+  bool enter_();
+  void open_(char c);
+  void close_(char c);
+
+  Print *out_;
+  /// Bit n is set if the container at depth n already has an element.
+  uint32_t has_elements_{0};
+  uint8_t depth_{0};
+  /// The number of open containers that were too deep and are dropped.
+  uint32_t dropped_depth_{0};
+  /// Where the output goes while containers are dropped.
+  Print *kept_out_{nullptr};
+};
+
+}  // namespace json
+}  // namespace esphome
@@ -174,9 +174,6 @@ void Logger::set_log_level(const std::string &tag, int log_level) {
   this->log_levels_.push_back(LogLevelOverride{tag, log_level});
 }
 UARTSelection Logger::get_uart() const { return this->uart_; }
-void Logger::add_on_log_callback(std::function<void(int, const char *, const char *)> &&callback) {
-  this->log_callback_.add(std::move(callback));
-}
 float Logger::get_setup_priority() const { return setup_priority::HARDWARE - 1.0f; }
 const char *const LOG_LEVELS[] = {"NONE", "ERROR", "WARN", "INFO", "CONFIG", "DEBUG", "VERBOSE", "VERY_VERBOSE"};
 #ifdef ARDUINO_ARCH_ESP32
@@ -2,7 +2,12 @@ import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.cpp_helpers import gpio_pin_expression
 from esphome.components import uart
-from esphome.const import CONF_FLOW_CONTROL_PIN, CONF_ID, CONF_ADDRESS
+from esphome.const import (
+    CONF_FLOW_CONTROL_PIN,
+    CONF_ID,
+    CONF_ADDRESS,
+    CONF_PRIORITY,
+)
 from esphome import pins
 
 DEPENDENCIES = ["uart"]
@@ -13,11 +18,17 @@ ModbusDevice = modbus_ns.class_("ModbusDevice")
 MULTI_CONF = True
 
 CONF_MODBUS_ID = "modbus_id"
+CONF_RESPONSE_TIMEOUT = "response_timeout"
+CONF_MAX_RETRIES = "max_retries"
 CONFIG_SCHEMA = (
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(Modbus),
             cv.Optional(CONF_FLOW_CONTROL_PIN): pins.gpio_output_pin_schema,
+            cv.Optional(
+                CONF_RESPONSE_TIMEOUT, default="500ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_MAX_RETRIES, default=1): cv.int_range(min=0, max=10),
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
@@ -36,10 +47,14 @@ async def to_code(config):
         pin = await gpio_pin_expression(config[CONF_FLOW_CONTROL_PIN])
         cg.add(var.set_flow_control_pin(pin))
 
+    cg.add(var.set_response_timeout(config[CONF_RESPONSE_TIMEOUT]))
+    cg.add(var.set_max_retries(config[CONF_MAX_RETRIES]))
+
 
 def modbus_device_schema(default_address):
     schema = {
         cv.GenerateID(CONF_MODBUS_ID): cv.use_id(Modbus),
+        cv.Optional(CONF_PRIORITY, default=0): cv.uint8_t,
     }
     if default_address is None:
         schema[cv.Required(CONF_ADDRESS)] = cv.hex_uint8_t
@@ -52,4 +67,5 @@ async def register_modbus_device(var, config):
     parent = await cg.get_variable(config[CONF_MODBUS_ID])
     cg.add(var.set_parent(parent))
     cg.add(var.set_address(config[CONF_ADDRESS]))
+    cg.add(var.set_priority(config[CONF_PRIORITY]))
     cg.add(parent.register_device(var))
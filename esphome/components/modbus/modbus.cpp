@@ -1,15 +1,22 @@
 #include "modbus.h"
 #include "esphome/core/log.h"
 
+#include <cstring>
+
 namespace esphome {
 namespace modbus {
 
 static const char *const TAG = "modbus";
 
+static const size_t MAX_QUEUE_SIZE = 32;
+
 void Modbus::setup() {
   if (this->flow_control_pin_ != nullptr) {
     this->flow_control_pin_->setup();
   }
+  // 3.5 character times of 11 bits each, above 19200 baud the spec fixes the gap to 1750us
+  const uint32_t baud_rate = this->parent_->get_baud_rate();
+  this->silent_interval_ = baud_rate > 19200 ? 1750 : 38500000UL / baud_rate;
 }
 void Modbus::loop() {
   const uint32_t now = millis();
@@ -18,15 +25,34 @@ void Modbus::loop() {
     this->last_modbus_byte_ = now;
   }
 
-  while (this->available()) {
-    uint8_t byte;
-    this->read_byte(&byte);
-    if (this->parse_modbus_byte_(byte)) {
-      this->last_modbus_byte_ = now;
+  while (true) {
+    auto data = this->read_span();
+    if (data.empty())
+      break;
+    this->last_bus_activity_ = micros();
+    for (uint8_t byte : data) {
+      if (this->parse_modbus_byte_(byte)) {
+        this->last_modbus_byte_ = now;
+      } else {
+        this->rx_buffer_.clear();
+      }
+    }
+  }
+
+  if (this->waiting_for_response_ && millis() - this->request_sent_ > this->response_timeout_) {
+    this->waiting_for_response_ = false;
+    const Request &request = this->queue_.front();
+    if (request.attempts <= this->max_retries_) {
+      ESP_LOGV(TAG, "No response from 0x%02X, retrying", request.frame[0]);
+      this->retries_++;
     } else {
-      this->rx_buffer_.clear();
+      ESP_LOGW(TAG, "No response from 0x%02X for function 0x%02X!", request.frame[0], request.frame[1]);
+      this->timeouts_++;
+      this->queue_.erase(this->queue_.begin());
     }
   }
+
+  this->send_next_();
 }
 
 uint16_t crc16(const uint8_t *data, uint8_t len) {
@@ -57,74 +83,154 @@ bool Modbus::parse_modbus_byte_(uint8_t byte) {
 
   // Byte 1: Function (msb indicates error)
   if (at == 1)
-    return (byte & 0x80) != 0x80;
+    return true;
+  uint8_t function_code = raw[1];
 
   // Byte 2: Size (with modbus rtu function code 4/3)
   // See also https://en.wikipedia.org/wiki/Modbus
   if (at == 2)
     return true;
 
+  uint8_t data_offset = 3;
   uint8_t data_len = raw[2];
-  // Byte 3..3+data_len-1: Data
-  if (at < 3 + data_len)
+  if ((function_code & 0x80) == 0x80) {
+    // Error response: byte 2 is the exception code and there is no size
+    data_offset = 2;
+    data_len = 1;
+  }
+  // Byte data_offset..data_offset+data_len-1: Data
+  if (at < data_offset + data_len)
     return true;
 
-  // Byte 3+data_len: CRC_LO (over all bytes)
-  if (at == 3 + data_len)
+  // Byte data_offset+data_len: CRC_LO (over all bytes)
+  if (at == data_offset + data_len)
     return true;
-  // Byte 3+len+1: CRC_HI (over all bytes)
-  uint16_t computed_crc = crc16(raw, 3 + data_len);
-  uint16_t remote_crc = uint16_t(raw[3 + data_len]) | (uint16_t(raw[3 + data_len + 1]) << 8);
+  // Byte data_offset+data_len+1: CRC_HI (over all bytes)
+  const uint8_t crc_offset = data_offset + data_len;
+  uint16_t computed_crc = crc16(raw, crc_offset);
+  uint16_t remote_crc = uint16_t(raw[crc_offset]) | (uint16_t(raw[crc_offset + 1]) << 8);
   if (computed_crc != remote_crc) {
     ESP_LOGW(TAG, "Modbus CRC Check failed! %02X!=%02X", computed_crc, remote_crc);
     return false;
   }
 
-  std::vector<uint8_t> data(this->rx_buffer_.begin() + 3, this->rx_buffer_.begin() + 3 + data_len);
+  this->on_frame_(address, function_code, Span<const uint8_t>(raw + data_offset, data_len));
+
+  // return false to reset buffer
+  return false;
+}
+
+void Modbus::on_frame_(uint8_t address, uint8_t function_code, Span<const uint8_t> data) {
+  if (this->waiting_for_response_) {
+    const Request &request = this->queue_.front();
+    if (request.frame[0] == address && request.frame[1] == (function_code & 0x7F)) {
+      this->waiting_for_response_ = false;
+      this->responses_++;
+      this->queue_.erase(this->queue_.begin());
+    }
+  }
+
+  const bool error = (function_code & 0x80) == 0x80;
+  if (error) {
+    ESP_LOGW(TAG, "Modbus error response from 0x%02X for function 0x%02X: exception %u", address,
+             function_code & 0x7F, data[0]);
+  }
 
   bool found = false;
   for (auto *device : this->devices_) {
     if (device->address_ == address) {
-      device->on_modbus_data(data);
+      if (error) {
+        device->on_modbus_error(function_code & 0x7F, data[0]);
+      } else {
+        device->on_modbus_data(data);
+      }
       found = true;
     }
   }
   if (!found) {
     ESP_LOGW(TAG, "Got Modbus frame from unknown address 0x%02X!", address);
   }
-
-  // return false to reset buffer
-  return false;
 }
 
 void Modbus::dump_config() {
   ESP_LOGCONFIG(TAG, "Modbus:");
   LOG_PIN("  Flow Control Pin: ", this->flow_control_pin_);
+  ESP_LOGCONFIG(TAG, "  Response Timeout: %u ms", this->response_timeout_);
+  ESP_LOGCONFIG(TAG, "  Max Retries: %u", this->max_retries_);
 }
 float Modbus::get_setup_priority() const {
   // After UART bus
   return setup_priority::BUS - 1.0f;
 }
-void Modbus::send(uint8_t address, uint8_t function, uint16_t start_address, uint16_t register_count) {
-  uint8_t frame[8];
-  frame[0] = address;
-  frame[1] = function;
-  frame[2] = start_address >> 8;
-  frame[3] = start_address >> 0;
-  frame[4] = register_count >> 8;
-  frame[5] = register_count >> 0;
-  auto crc = crc16(frame, 6);
-  frame[6] = crc >> 0;
-  frame[7] = crc >> 8;
+void Modbus::send(uint8_t address, uint8_t function, uint16_t start_address, uint16_t register_count,
+                  uint8_t priority) {
+  Request request{};
+  request.frame[0] = address;
+  request.frame[1] = function;
+  request.frame[2] = start_address >> 8;
+  request.frame[3] = start_address >> 0;
+  request.frame[4] = register_count >> 8;
+  request.frame[5] = register_count >> 0;
+  auto crc = crc16(request.frame, 6);
+  request.frame[6] = crc >> 0;
+  request.frame[7] = crc >> 8;
+  request.priority = priority;
+
+  // A device that polls faster than it is answered would otherwise fill the queue with copies of the same request
+  for (auto &queued : this->queue_) {
+    if (memcmp(queued.frame, request.frame, sizeof(request.frame)) == 0) {
+      ESP_LOGV(TAG, "Request for 0x%02X is already queued", address);
+      return;
+    }
+  }
+  if (this->queue_.size() >= MAX_QUEUE_SIZE) {
+    ESP_LOGW(TAG, "Request queue full, dropping request for 0x%02X!", address);
+    return;
+  }
+
+  // Queue behind all requests with the same or a higher priority, but never in front of the request in flight
+  auto it = this->queue_.begin();
+  if (this->waiting_for_response_)
+    it++;
+  while (it != this->queue_.end() && it->priority >= priority)
+    it++;
+  this->queue_.insert(it, request);
+
+  this->high_freq_.start();
+  this->send_next_();
+}
+void Modbus::send_next_() {
+  if (this->waiting_for_response_)
+    return;
+  if (this->queue_.empty()) {
+    this->high_freq_.stop();
+    return;
+  }
+  // Wait until a frame that is being received is complete and the bus was silent for the inter-frame gap
+  if (!this->rx_buffer_.empty() || micros() - this->last_bus_activity_ < this->silent_interval_)
+    return;
 
+  this->write_request_(this->queue_.front());
+}
+void Modbus::write_request_(Request &request) {
   if (this->flow_control_pin_ != nullptr)
     this->flow_control_pin_->digital_write(true);
 
-  this->write_array(frame, 8);
+  this->write_array(request.frame, sizeof(request.frame));
   this->flush();
 
   if (this->flow_control_pin_ != nullptr)
     this->flow_control_pin_->digital_write(false);
+
+  this->last_bus_activity_ = micros();
+  if (request.frame[0] == 0) {
+    // Broadcasts are not answered
+    this->queue_.erase(this->queue_.begin());
+    return;
+  }
+  request.attempts++;
+  this->request_sent_ = millis();
+  this->waiting_for_response_ = true;
 }
 
 }  // namespace modbus
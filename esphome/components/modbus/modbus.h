@@ -1,13 +1,22 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
 #include "esphome/components/uart/uart.h"
 
+#include <vector>
+
 namespace esphome {
 namespace modbus {
 
 class ModbusDevice;
 
+/** A Modbus RTU master that serializes the requests of all devices on one bus.
+ *
+ * Requests are queued and sent one at a time: the next request is only sent once the previous one has been answered
+ * or has timed out, and the bus has been silent for at least 3.5 character times. Requests of devices with a higher
+ * priority are sent first, requests of the same priority in the order they were queued.
+ */
 class Modbus : public uart::UARTDevice, public Component {
  public:
   Modbus() = default;
@@ -22,18 +31,56 @@ class Modbus : public uart::UARTDevice, public Component {
 
   float get_setup_priority() const override;
 
-  void send(uint8_t address, uint8_t function, uint16_t start_address, uint16_t register_count);
+  /// Queue a request, the response is passed to all devices with the given address.
+  void send(uint8_t address, uint8_t function, uint16_t start_address, uint16_t register_count, uint8_t priority = 0);
 
   void set_flow_control_pin(GPIOPin *flow_control_pin) { this->flow_control_pin_ = flow_control_pin; }
+  void set_response_timeout(uint32_t response_timeout) { this->response_timeout_ = response_timeout; }
+  void set_max_retries(uint8_t max_retries) { this->max_retries_ = max_retries; }
+
+  /// The number of requests that were answered.
+  uint32_t get_responses() const { return this->responses_; }
+  /// The number of requests that were given up on after all retries timed out.
+  uint32_t get_timeouts() const { return this->timeouts_; }
+  /// The number of requests that were sent again after a timeout.
+  uint32_t get_retries() const { return this->retries_; }
 
  protected:
+  struct Request {
+    uint8_t frame[8];
+    uint8_t priority;
+    uint8_t attempts;
+  };
+
   GPIOPin *flow_control_pin_{nullptr};
 
   bool parse_modbus_byte_(uint8_t byte);
+  /// Handle a frame with a valid CRC, data is the payload or the exception code of an error response.
+  void on_frame_(uint8_t address, uint8_t function_code, Span<const uint8_t> data);
+  /// Send the first request of the queue if the bus is free.
+  void send_next_();
+  void write_request_(Request &request);
 
   std::vector<uint8_t> rx_buffer_;
   uint32_t last_modbus_byte_{0};
   std::vector<ModbusDevice *> devices_;
+
+  /// Pending requests, the first one is in flight while waiting_for_response_ is set.
+  std::vector<Request> queue_;
+  bool waiting_for_response_{false};
+  /// millis() at which the request in flight was sent.
+  uint32_t request_sent_{0};
+  /// micros() of the last byte sent or received, used to keep the inter-frame gap.
+  uint32_t last_bus_activity_{0};
+  /// The minimum gap between frames in microseconds (3.5 character times).
+  uint32_t silent_interval_{0};
+  uint32_t response_timeout_{500};
+  uint8_t max_retries_{1};
+  HighFrequencyLoopRequester high_freq_;
+
+  uint32_t responses_{0};
+  uint32_t timeouts_{0};
+  uint32_t retries_{0};
 };
 
 uint16_t crc16(const uint8_t *data, uint8_t len);
@@ -42,10 +89,14 @@ class ModbusDevice {
  public:
   void set_parent(Modbus *parent) { parent_ = parent; }
   void set_address(uint8_t address) { address_ = address; }
-  virtual void on_modbus_data(const std::vector<uint8_t> &data) = 0;
+  void set_priority(uint8_t priority) { priority_ = priority; }
+  /// Called with the payload of a response, data points into the receive buffer and is only valid during the call.
+  virtual void on_modbus_data(Span<const uint8_t> data) = 0;
+  /// Called when the device answered a request with an exception response.
+  virtual void on_modbus_error(uint8_t function_code, uint8_t exception_code) {}
 
   void send(uint8_t function, uint16_t start_address, uint16_t register_count) {
-    this->parent_->send(this->address_, function, start_address, register_count);
+    this->parent_->send(this->address_, function, start_address, register_count, this->priority_);
   }
 
  protected:
@@ -53,6 +104,7 @@ class ModbusDevice {
 
   Modbus *parent_;
   uint8_t address_;
+  uint8_t priority_{0};
 };
 
 }  // namespace modbus
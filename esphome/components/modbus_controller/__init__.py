@@ -0,0 +1,151 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import modbus
+from esphome.const import CONF_ADDRESS, CONF_ID, CONF_PLATFORM
+from esphome.core import CORE
+
+DEPENDENCIES = ["modbus"]
+MULTI_CONF = True
+
+modbus_controller_ns = cg.esphome_ns.namespace("modbus_controller")
+ModbusController = modbus_controller_ns.class_(
+    "ModbusController", cg.PollingComponent, modbus.ModbusDevice
+)
+ModbusItem = modbus_controller_ns.class_("ModbusItem")
+
+ModbusRegisterType = modbus_controller_ns.enum("ModbusRegisterType", is_class=True)
+MODBUS_REGISTER_TYPES = {
+    "holding": ModbusRegisterType.HOLDING_REGISTER,
+    "input": ModbusRegisterType.INPUT_REGISTER,
+}
+
+SensorValueType = modbus_controller_ns.enum("SensorValueType", is_class=True)
+SENSOR_VALUE_TYPES = {
+    "U_WORD": SensorValueType.U_WORD,
+    "S_WORD": SensorValueType.S_WORD,
+    "U_DWORD": SensorValueType.U_DWORD,
+    "S_DWORD": SensorValueType.S_DWORD,
+    "U_DWORD_R": SensorValueType.U_DWORD_R,
+    "S_DWORD_R": SensorValueType.S_DWORD_R,
+    "FP32": SensorValueType.FP32,
+    "FP32_R": SensorValueType.FP32_R,
+}
+# Number of registers each value type occupies
+SENSOR_VALUE_TYPE_SIZES = {
+    "U_WORD": 1,
+    "S_WORD": 1,
+    "U_DWORD": 2,
+    "S_DWORD": 2,
+    "U_DWORD_R": 2,
+    "S_DWORD_R": 2,
+    "FP32": 2,
+    "FP32_R": 2,
+}
+
+# The largest number of registers a single read may return
+MAX_REGISTERS_PER_READ = 125
+
+CONF_MODBUS_CONTROLLER_ID = "modbus_controller_id"
+CONF_REGISTER_TYPE = "register_type"
+CONF_VALUE_TYPE = "value_type"
+CONF_MAX_REGISTER_GAP = "max_register_gap"
+
+CONFIG_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(ModbusController),
+            cv.Optional(CONF_MAX_REGISTER_GAP, default=8): cv.int_range(
+                min=0, max=MAX_REGISTERS_PER_READ
+            ),
+        }
+    )
+    .extend(cv.polling_component_schema("60s"))
+    .extend(modbus.modbus_device_schema(None))
+)
+
+
+def coalesce_registers(registers, max_gap):
+    """Merge registers into as few reads as possible.
+
+    registers is a list of (register_type, address, register_count) tuples. Registers of the same
+    type are read together when at most max_gap unused registers lie between them and the read
+    does not exceed MAX_REGISTERS_PER_READ.
+
+    Returns a list of (register_type, start_address, register_count) tuples.
+    """
+    reads = []
+    for register_type, address, count in sorted(registers):
+        if reads:
+            last_type, start, last_count = reads[-1]
+            end = max(start + last_count, address + count)
+            if (
+                last_type == register_type
+                and address <= start + last_count + max_gap
+                and end - start <= MAX_REGISTERS_PER_READ
+            ):
+                reads[-1] = (last_type, start, end - start)
+                continue
+        reads.append((register_type, address, count))
+    return reads
+
+
+def get_read_plan(controller_id):
+    """Get the reads of a controller and where the value of each of its items is found.
+
+    Returns the list of reads and a dict mapping the ID of each item to the index of the read
+    containing it and the byte offset of its value in the response.
+    """
+    plans = CORE.data.setdefault("modbus_controller", {})
+    if controller_id.id in plans:
+        return plans[controller_id.id]
+
+    controller = next(
+        conf
+        for conf in CORE.config["modbus_controller"]
+        if conf[CONF_ID] == controller_id
+    )
+    items = [
+        conf
+        for conf in CORE.config.get("sensor", [])
+        if conf[CONF_PLATFORM] == "modbus_controller"
+        and conf[CONF_MODBUS_CONTROLLER_ID] == controller_id
+    ]
+    reads = coalesce_registers(
+        [
+            (
+                conf[CONF_REGISTER_TYPE],
+                conf[CONF_ADDRESS],
+                SENSOR_VALUE_TYPE_SIZES[conf[CONF_VALUE_TYPE]],
+            )
+            for conf in items
+        ],
+        controller[CONF_MAX_REGISTER_GAP],
+    )
+
+    locations = {}
+    for conf in items:
+        for index, (register_type, start, count) in enumerate(reads):
+            if (
+                register_type == conf[CONF_REGISTER_TYPE]
+                and start <= conf[CONF_ADDRESS] < start + count
+            ):
+                locations[conf[CONF_ID]] = (index, (conf[CONF_ADDRESS] - start) * 2)
+                break
+
+    plans[controller_id.id] = (reads, locations)
+    return plans[controller_id.id]
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    # The commands have to exist before any of the items is added to them
+    reads, _ = get_read_plan(config[CONF_ID])
+    for register_type, start_address, register_count in reads:
+        cg.add(
+            var.add_command(
+                MODBUS_REGISTER_TYPES[register_type], start_address, register_count
+            )
+        )
+
+    await cg.register_component(var, config)
+    await modbus.register_modbus_device(var, config)
@@ -0,0 +1,120 @@
+#include "modbus_controller.h"
+#include "esphome/core/log.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace esphome {
+namespace modbus_controller {
+
+static const char *const TAG = "modbus_controller";
+
+float payload_to_float(Span<const uint8_t> data, uint16_t offset, SensorValueType value_type) {
+  const uint8_t *raw = &data[offset];
+  uint32_t dword = 0;
+  switch (value_type) {
+    case SensorValueType::U_WORD:
+      return encode_uint16(raw[0], raw[1]);
+    case SensorValueType::S_WORD:
+      return int16_t(encode_uint16(raw[0], raw[1]));
+    case SensorValueType::U_DWORD:
+      return encode_uint32(raw[0], raw[1], raw[2], raw[3]);
+    case SensorValueType::S_DWORD:
+      return int32_t(encode_uint32(raw[0], raw[1], raw[2], raw[3]));
+    case SensorValueType::U_DWORD_R:
+      return encode_uint32(raw[2], raw[3], raw[0], raw[1]);
+    case SensorValueType::S_DWORD_R:
+      return int32_t(encode_uint32(raw[2], raw[3], raw[0], raw[1]));
+    case SensorValueType::FP32:
+      dword = encode_uint32(raw[0], raw[1], raw[2], raw[3]);
+      break;
+    case SensorValueType::FP32_R:
+      dword = encode_uint32(raw[2], raw[3], raw[0], raw[1]);
+      break;
+    default:
+      return NAN;
+  }
+  float value;
+  memcpy(&value, &dword, sizeof(value));
+  return value;
+}
+
+void ModbusController::add_command(ModbusRegisterType register_type, uint16_t start_address,
+                                   uint16_t register_count) {
+  ReadCommand command;
+  command.register_type = register_type;
+  command.start_address = start_address;
+  command.register_count = register_count;
+  this->commands_.push_back(command);
+}
+
+void ModbusController::update() {
+  if (this->commands_.empty())
+    return;
+  if (this->polling_ && this->progress_) {
+    // The previous poll is still being answered, let it finish instead of starting over
+    ESP_LOGV(TAG, "Previous poll of 0x%02X still in progress", this->address_);
+    this->progress_ = false;
+    return;
+  }
+
+  this->polling_ = true;
+  this->progress_ = false;
+  this->command_index_ = 0;
+  this->send_command_();
+}
+
+void ModbusController::send_command_() {
+  const ReadCommand &command = this->commands_[this->command_index_];
+  this->send(static_cast<uint8_t>(command.register_type), command.start_address, command.register_count);
+}
+
+void ModbusController::next_command_() {
+  this->progress_ = true;
+  if (++this->command_index_ < this->commands_.size()) {
+    this->send_command_();
+  } else {
+    this->polling_ = false;
+  }
+}
+
+void ModbusController::on_modbus_data(Span<const uint8_t> data) {
+  if (!this->polling_) {
+    ESP_LOGW(TAG, "Got unexpected response from 0x%02X!", this->address_);
+    return;
+  }
+
+  const ReadCommand &command = this->commands_[this->command_index_];
+  if (data.size() != command.register_count * 2u) {
+    ESP_LOGW(TAG, "Invalid size %u for read of %u registers at 0x%04X!", data.size(), command.register_count,
+             command.start_address);
+  } else {
+    for (auto *item : command.items)
+      item->parse(data);
+  }
+  this->next_command_();
+}
+
+void ModbusController::on_modbus_error(uint8_t function_code, uint8_t exception_code) {
+  if (!this->polling_)
+    return;
+
+  const ReadCommand &command = this->commands_[this->command_index_];
+  ESP_LOGW(TAG, "Read of %u registers at 0x%04X failed with exception %u", command.register_count,
+           command.start_address, exception_code);
+  this->next_command_();
+}
+
+void ModbusController::dump_config() {
+  ESP_LOGCONFIG(TAG, "Modbus Controller:");
+  ESP_LOGCONFIG(TAG, "  Address: 0x%02X", this->address_);
+  LOG_UPDATE_INTERVAL(this);
+  for (auto &command : this->commands_) {
+    ESP_LOGCONFIG(TAG, "  Read: function 0x%02X, %u registers at 0x%04X, %u items",
+                  static_cast<uint8_t>(command.register_type), command.register_count, command.start_address,
+                  command.items.size());
+  }
+}
+
+}  // namespace modbus_controller
+}  // namespace esphome
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/components/modbus/modbus.h"
+
+#include <vector>
+
+namespace esphome {
+namespace modbus_controller {
+
+/// The register types that can be read, the value is the function code of the read.
+enum class ModbusRegisterType : uint8_t {
+  HOLDING_REGISTER = 0x03,
+  INPUT_REGISTER = 0x04,
+};
+
+/// How a value is stored in the registers, `_R` types have their low word in the first register.
+enum class SensorValueType : uint8_t {
+  U_WORD,
+  S_WORD,
+  U_DWORD,
+  S_DWORD,
+  U_DWORD_R,
+  S_DWORD_R,
+  FP32,
+  FP32_R,
+};
+
+/// Decode the value starting at byte offset of the payload of a read.
+float payload_to_float(Span<const uint8_t> data, uint16_t offset, SensorValueType value_type);
+
+/// A value that is parsed from the response of one of the reads of a ModbusController.
+class ModbusItem {
+ public:
+  void set_address(uint16_t address) { this->address_ = address; }
+  void set_offset(uint16_t offset) { this->offset_ = offset; }
+  void set_value_type(SensorValueType value_type) { this->value_type_ = value_type; }
+
+  /// Called with the payload of the read that contains this item.
+  virtual void parse(Span<const uint8_t> data) = 0;
+
+ protected:
+  uint16_t address_{0};
+  /// Byte offset of the value in the payload of the read, computed at compile time.
+  uint16_t offset_{0};
+  SensorValueType value_type_{SensorValueType::U_WORD};
+};
+
+/** Polls a Modbus device for the registers of all its items.
+ *
+ * The registers are merged into as few reads as possible at compile time. On each update the reads are sent one
+ * after another and every response is handed to the items it contains.
+ */
+class ModbusController : public PollingComponent, public modbus::ModbusDevice {
+ public:
+  void update() override;
+  void dump_config() override;
+
+  void on_modbus_data(Span<const uint8_t> data) override;
+  void on_modbus_error(uint8_t function_code, uint8_t exception_code) override;
+
+  void add_command(ModbusRegisterType register_type, uint16_t start_address, uint16_t register_count);
+  /// Add an item that is parsed from the response of the command with the given index.
+  void add_item(uint8_t command, ModbusItem *item) { this->commands_[command].items.push_back(item); }
+
+ protected:
+  struct ReadCommand {
+    ModbusRegisterType register_type;
+    uint16_t start_address;
+    uint16_t register_count;
+    std::vector<ModbusItem *> items;
+  };
+
+  void send_command_();
+  void next_command_();
+
+  std::vector<ReadCommand> commands_;
+  /// The command whose response is expected while polling_ is set.
+  uint8_t command_index_{0};
+  bool polling_{false};
+  /// Whether a response was received since the last update.
+  bool progress_{false};
+};
+
+}  // namespace modbus_controller
+}  // namespace esphome
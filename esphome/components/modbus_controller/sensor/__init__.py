@@ -0,0 +1,52 @@
+from esphome.components import sensor
+import esphome.config_validation as cv
+import esphome.codegen as cg
+from esphome.const import CONF_ADDRESS, CONF_ID, CONF_MULTIPLY
+from .. import (
+    modbus_controller_ns,
+    get_read_plan,
+    CONF_MODBUS_CONTROLLER_ID,
+    CONF_REGISTER_TYPE,
+    CONF_VALUE_TYPE,
+    ModbusController,
+    ModbusItem,
+    MODBUS_REGISTER_TYPES,
+    SENSOR_VALUE_TYPES,
+)
+
+DEPENDENCIES = ["modbus_controller"]
+
+ModbusSensor = modbus_controller_ns.class_(
+    "ModbusSensor", sensor.Sensor, cg.Component, ModbusItem
+)
+
+CONFIG_SCHEMA = sensor.SENSOR_SCHEMA.extend(
+    {
+        cv.GenerateID(): cv.declare_id(ModbusSensor),
+        cv.GenerateID(CONF_MODBUS_CONTROLLER_ID): cv.use_id(ModbusController),
+        cv.Required(CONF_ADDRESS): cv.hex_uint16_t,
+        cv.Optional(CONF_REGISTER_TYPE, default="holding"): cv.enum(
+            MODBUS_REGISTER_TYPES, lower=True
+        ),
+        cv.Optional(CONF_VALUE_TYPE, default="U_WORD"): cv.enum(
+            SENSOR_VALUE_TYPES, upper=True
+        ),
+        cv.Optional(CONF_MULTIPLY, default=1.0): cv.float_,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await sensor.register_sensor(var, config)
+
+    cg.add(var.set_address(config[CONF_ADDRESS]))
+    cg.add(var.set_value_type(SENSOR_VALUE_TYPES[config[CONF_VALUE_TYPE]]))
+    cg.add(var.set_multiply(config[CONF_MULTIPLY]))
+
+    paren = await cg.get_variable(config[CONF_MODBUS_CONTROLLER_ID])
+    _, locations = get_read_plan(config[CONF_MODBUS_CONTROLLER_ID])
+    command, offset = locations[config[CONF_ID]]
+    cg.add(var.set_offset(offset))
+    cg.add(paren.add_item(command, var))
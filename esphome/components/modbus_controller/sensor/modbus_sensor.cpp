@@ -0,0 +1,19 @@
+#include "esphome/core/log.h"
+#include "modbus_sensor.h"
+
+namespace esphome {
+namespace modbus_controller {
+
+static const char *const TAG = "modbus_controller.sensor";
+
+void ModbusSensor::parse(Span<const uint8_t> data) {
+  this->publish_state(payload_to_float(data, this->offset_, this->value_type_) * this->multiply_);
+}
+
+void ModbusSensor::dump_config() {
+  LOG_SENSOR("", "Modbus Sensor", this);
+  ESP_LOGCONFIG(TAG, "  Register: 0x%04X", this->address_);
+}
+
+}  // namespace modbus_controller
+}  // namespace esphome
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/modbus_controller/modbus_controller.h"
+#include "esphome/components/sensor/sensor.h"
+
+namespace esphome {
+namespace modbus_controller {
+
+class ModbusSensor : public sensor::Sensor, public Component, public ModbusItem {
+ public:
+  void dump_config() override;
+  void set_multiply(float multiply) { this->multiply_ = multiply; }
+
+  void parse(Span<const uint8_t> data) override;
+
+ protected:
+  float multiply_{1.0f};
+};
+
+}  // namespace modbus_controller
+}  // namespace esphome
@@ -42,6 +42,8 @@ from esphome.core import coroutine_with_priority, CORE
 DEPENDENCIES = ["network"]
 AUTO_LOAD = ["json", "async_tcp"]
 
+CONF_PUBLISH_QUEUE_SIZE = "publish_queue_size"
+
 
 def validate_message_just_topic(value):
     value = cv.publish_topic(value)
@@ -172,6 +174,9 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(
                 CONF_REBOOT_TIMEOUT, default="15min"
             ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_PUBLISH_QUEUE_SIZE, default=64): cv.int_range(
+                min=0, max=1024
+            ),
             cv.Optional(CONF_ON_MESSAGE): automation.validate_automation(
                 {
                     cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(MQTTMessageTrigger),
@@ -275,6 +280,7 @@ async def to_code(config):
     cg.add(var.set_keep_alive(config[CONF_KEEPALIVE]))
 
     cg.add(var.set_reboot_timeout(config[CONF_REBOOT_TIMEOUT]))
+    cg.add(var.set_publish_queue_size(config[CONF_PUBLISH_QUEUE_SIZE]))
 
     for conf in config.get(CONF_ON_MESSAGE, []):
         trig = cg.new_Pvariable(conf[CONF_TRIGGER_ID], conf[CONF_TOPIC])
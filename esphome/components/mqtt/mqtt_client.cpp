@@ -35,7 +35,7 @@ void MQTTClientComponent::setup() {
 
     // MQTT fully received
     if (len + index == total) {
-      this->on_message(topic, this->payload_buffer_);
+      this->on_message(topic, std::move(this->payload_buffer_));
       this->payload_buffer_.clear();
     }
   });
@@ -74,6 +74,7 @@ void MQTTClientComponent::dump_config() {
   if (!this->availability_.topic.empty()) {
     ESP_LOGCONFIG(TAG, "  Availability: '%s'", this->availability_.topic.c_str());
   }
+  ESP_LOGCONFIG(TAG, "  Publish Queue Size: %u", this->publish_queue_size_);
 }
 bool MQTTClientComponent::can_proceed() { return this->is_connected(); }
 
@@ -82,6 +83,7 @@ void MQTTClientComponent::start_dnslookup_() {
     subscription.subscribed = false;
     subscription.resubscribe_timeout = 0;
   }
+  this->clear_publish_queue_();
 
   this->status_set_warning();
   this->dns_resolve_error_ = false;
@@ -282,6 +284,9 @@ void MQTTClientComponent::loop() {
           this->sent_birth_message_ = this->publish(this->birth_message_);
         }
 
+        if (this->flush_publish_queue_(this->high_priority_queue_))
+          this->flush_publish_queue_(this->publish_queue_);
+
         this->last_connected_ = now;
         this->resubscribe_subscriptions_();
       }
@@ -330,11 +335,23 @@ void MQTTClientComponent::resubscribe_subscriptions_() {
   }
 }
 
-void MQTTClientComponent::subscribe(const std::string &topic, mqtt_callback_t callback, uint8_t qos) {
+void MQTTClientComponent::add_subscription_(const std::string &topic, uint8_t qos) {
+  for (auto &subscription : this->subscriptions_) {
+    if (subscription.topic != topic)
+      continue;
+    // already subscribed at the broker, only upgrade the QoS if needed
+    if (qos > subscription.qos) {
+      subscription.qos = qos;
+      subscription.subscribed = false;
+      subscription.resubscribe_timeout = 0;
+      this->resubscribe_subscription_(&subscription);
+    }
+    return;
+  }
+
   MQTTSubscription subscription{
       .topic = topic,
       .qos = qos,
-      .callback = std::move(callback),
       .subscribed = false,
       .resubscribe_timeout = 0,
   };
@@ -342,19 +359,17 @@ void MQTTClientComponent::subscribe(const std::string &topic, mqtt_callback_t ca
   this->subscriptions_.push_back(subscription);
 }
 
+void MQTTClientComponent::subscribe(const std::string &topic, mqtt_callback_t callback, uint8_t qos) {
+  this->subscription_trie_.insert(topic, std::move(callback));
+  this->add_subscription_(topic, qos);
+}
+
 void MQTTClientComponent::subscribe_json(const std::string &topic, const mqtt_json_callback_t &callback, uint8_t qos) {
   auto f = [callback](const std::string &topic, const std::string &payload) {
     json::parse_json(payload, [topic, callback](JsonObject &root) { callback(topic, root); });
   };
-  MQTTSubscription subscription{
-      .topic = topic,
-      .qos = qos,
-      .callback = f,
-      .subscribed = false,
-      .resubscribe_timeout = 0,
-  };
-  this->resubscribe_subscription_(&subscription);
-  this->subscriptions_.push_back(subscription);
+  this->subscription_trie_.insert(topic, f);
+  this->add_subscription_(topic, qos);
 }
 
 void MQTTClientComponent::unsubscribe(const std::string &topic) {
@@ -368,6 +383,7 @@ void MQTTClientComponent::unsubscribe(const std::string &topic) {
     this->status_momentary_warning("unsubscribe", 1000);
   }
 
+  this->subscription_trie_.remove(topic);
   auto it = subscriptions_.begin();
   while (it != subscriptions_.end()) {
     if (it->topic == topic)
@@ -384,33 +400,113 @@ bool MQTTClientComponent::publish(const std::string &topic, const std::string &p
 
 bool MQTTClientComponent::publish(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos,
                                   bool retain) {
+  return this->publish(topic, payload, payload_length, qos, retain, MQTT_PUBLISH_PRIORITY_NORMAL);
+}
+
+bool MQTTClientComponent::publish(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos,
+                                  bool retain, MQTTPublishPriority priority) {
   if (!this->is_connected()) {
     // critical components will re-transmit their messages
     return false;
   }
-  bool logging_topic = topic == this->log_message_.topic;
-  uint16_t ret = this->mqtt_client_.publish(topic.c_str(), qos, retain, payload, payload_length);
+  if (topic == this->log_message_.topic) {
+    // log messages are never queued or logged themselves, that would recurse through the logger
+    return this->send_publish_(topic.c_str(), payload, payload_length, qos, retain);
+  }
+
+  // only bypass the queue if that doesn't reorder messages
+  bool queue_empty = this->high_priority_queue_.empty() &&
+                     (priority == MQTT_PUBLISH_PRIORITY_HIGH || this->publish_queue_.empty());
+  if (queue_empty && this->send_publish_(topic.c_str(), payload, payload_length, qos, retain)) {
+    ESP_LOGV(TAG, "Publish(topic='%s' payload='%.*s' retain=%d)", topic.c_str(), (int) payload_length, payload, retain);
+    return true;
+  }
+
+  return this->enqueue_publish_(topic, payload, payload_length, qos, retain, priority);
+}
+
+bool MQTTClientComponent::send_publish_(const char *topic, const char *payload, size_t payload_length, uint8_t qos,
+                                        bool retain) {
+  // AsyncMqttClient refuses the message if it doesn't fit into the TCP send buffer
+  uint16_t ret = this->mqtt_client_.publish(topic, qos, retain, payload, payload_length);
   delay(0);
-  if (ret == 0 && !logging_topic && this->is_connected()) {
-    delay(0);
-    ret = this->mqtt_client_.publish(topic.c_str(), qos, retain, payload, payload_length);
-    delay(0);
+  return ret != 0;
+}
+
+bool MQTTClientComponent::enqueue_publish_(const std::string &topic, const char *payload, size_t payload_length,
+                                           uint8_t qos, bool retain, MQTTPublishPriority priority) {
+  if (priority == MQTT_PUBLISH_PRIORITY_STATE) {
+    for (auto &message : this->publish_queue_) {
+      if (message.coalesce && message.topic == topic) {
+        // a newer state supersedes the queued one, keep its position in the queue
+        message.payload.assign(payload, payload_length);
+        message.qos = qos;
+        message.retain = retain;
+        this->publish_coalesced_count_++;
+        ESP_LOGV(TAG, "Coalesced publish for topic='%s'", topic.c_str());
+        return true;
+      }
+    }
   }
 
-  if (!logging_topic) {
-    if (ret != 0) {
-      ESP_LOGV(TAG, "Publish(topic='%s' payload='%s' retain=%d)", topic.c_str(), payload, retain);
+  if (this->get_publish_queue_depth() >= this->publish_queue_size_) {
+    // make room by dropping the oldest message, high priority messages are only dropped for each other
+    if (!this->publish_queue_.empty()) {
+      ESP_LOGV(TAG, "Publish queue full, dropping message for topic='%s'", this->publish_queue_.front().topic.c_str());
+      this->publish_queue_.pop_front();
+    } else if (priority == MQTT_PUBLISH_PRIORITY_HIGH && !this->high_priority_queue_.empty()) {
+      ESP_LOGV(TAG, "Publish queue full, dropping message for topic='%s'",
+               this->high_priority_queue_.front().topic.c_str());
+      this->high_priority_queue_.pop_front();
     } else {
       ESP_LOGV(TAG, "Publish failed for topic='%s' (len=%u). will retry later..", topic.c_str(),
                payload_length);  // NOLINT
+      this->publish_dropped_count_++;
       this->status_momentary_warning("publish", 1000);
+      return false;
     }
+    this->publish_dropped_count_++;
+    this->status_momentary_warning("publish", 1000);
   }
-  return ret != 0;
+
+  MQTTQueuedMessage message{
+      .topic = topic,
+      .payload = std::string(payload, payload_length),
+      .qos = qos,
+      .retain = retain,
+      .coalesce = priority == MQTT_PUBLISH_PRIORITY_STATE,
+  };
+  if (priority == MQTT_PUBLISH_PRIORITY_HIGH) {
+    this->high_priority_queue_.push_back(std::move(message));
+  } else {
+    this->publish_queue_.push_back(std::move(message));
+  }
+  ESP_LOGV(TAG, "Queued publish for topic='%s' (queue depth %u)", topic.c_str(), this->get_publish_queue_depth());
+  return true;
+}
+
+bool MQTTClientComponent::flush_publish_queue_(std::deque<MQTTQueuedMessage> &queue) {
+  while (!queue.empty()) {
+    const MQTTQueuedMessage &message = queue.front();
+    if (!this->send_publish_(message.topic.c_str(), message.payload.data(), message.payload.size(), message.qos,
+                             message.retain))
+      return false;
+    ESP_LOGV(TAG, "Publish(topic='%s' payload='%s' retain=%d)", message.topic.c_str(), message.payload.c_str(),
+             message.retain);
+    queue.pop_front();
+  }
+  return true;
+}
+
+void MQTTClientComponent::clear_publish_queue_() {
+  // all components re-send their state after reconnecting, so there's no point in keeping stale messages
+  this->high_priority_queue_.clear();
+  this->publish_queue_.clear();
 }
 
 bool MQTTClientComponent::publish(const MQTTMessage &message) {
-  return this->publish(message.topic, message.payload, message.qos, message.retain);
+  return this->publish(message.topic, message.payload.data(), message.payload.size(), message.qos, message.retain,
+                       MQTT_PUBLISH_PRIORITY_HIGH);
 }
 bool MQTTClientComponent::publish_json(const std::string &topic, const json::json_build_t &f, uint8_t qos,
                                        bool retain) {
@@ -419,74 +515,13 @@ bool MQTTClientComponent::publish_json(const std::string &topic, const json::jso
   return this->publish(topic, message, len, qos, retain);
 }
 
-/** Check if the message topic matches the given subscription topic
- *
- * INFO: MQTT spec mandates that topics must not be empty and must be valid NULL-terminated UTF-8 strings.
- *
- * @param message The message topic that was received from the MQTT server. Note: this must not contain
- *                wildcard characters as mandated by the MQTT spec.
- * @param subscription The subscription topic we are matching against.
- * @param is_normal Is this a "normal" topic - Does the message topic not begin with a "$".
- * @param past_separator Are we past the first '/' topic separator.
- * @return true if the subscription topic matches the message topic, false otherwise.
- */
-static bool topic_match(const char *message, const char *subscription, bool is_normal, bool past_separator) {
-  // Reached end of both strings at the same time, this means we have a successful match
-  if (*message == '\0' && *subscription == '\0')
-    return true;
-
-  // Either the message or the subscribe are at the end. This means they don't match.
-  if (*message == '\0' || *subscription == '\0')
-    return false;
-
-  bool do_wildcards = is_normal || past_separator;
-
-  if (*subscription == '+' && do_wildcards) {
-    // single level wildcard
-    // consume + from subscription
-    subscription++;
-    // consume everything from message until '/' found or end of string
-    while (*message != '\0' && *message != '/') {
-      message++;
-    }
-    // after this, both pointers will point to a '/' or to the end of the string
-
-    return topic_match(message, subscription, is_normal, true);
-  }
-
-  if (*subscription == '#' && do_wildcards) {
-    // multilevel wildcard - MQTT mandates that this must be at end of subscribe topic
-    return true;
-  }
-
-  // this handles '/' and normal characters at the same time.
-  if (*message != *subscription)
-    return false;
-
-  past_separator = past_separator || *subscription == '/';
-
-  // consume characters
-  subscription++;
-  message++;
-
-  return topic_match(message, subscription, is_normal, past_separator);
-}
-
-static bool topic_match(const char *message, const char *subscription) {
-  return topic_match(message, subscription, *message != '\0' && *message != '$', false);
-}
-
-void MQTTClientComponent::on_message(const std::string &topic, const std::string &payload) {
+void MQTTClientComponent::on_message(std::string topic, std::string payload) {
 #ifdef ARDUINO_ARCH_ESP8266
   // on ESP8266, this is called in LWiP thread; some components do not like running
-  // in an ISR.
-  this->defer([this, topic, payload]() {
-#endif
-    for (auto &subscription : this->subscriptions_)
-      if (topic_match(topic.c_str(), subscription.topic.c_str()))
-        subscription.callback(topic, payload);
-#ifdef ARDUINO_ARCH_ESP8266
-  });
+  // in an ISR. Topic and payload are moved into the deferred call instead of copied.
+  this->defer(std::bind(&MQTTTopicTrie::dispatch, &this->subscription_trie_, std::move(topic), std::move(payload)));
+#else
+  this->subscription_trie_.dispatch(topic, payload);
 #endif
 }
 
@@ -499,7 +534,11 @@ void MQTTClientComponent::set_log_level(int level) { this->log_level_ = level; }
 void MQTTClientComponent::set_keep_alive(uint16_t keep_alive_s) { this->mqtt_client_.setKeepAlive(keep_alive_s); }
 void MQTTClientComponent::set_log_message_template(MQTTMessage &&message) { this->log_message_ = std::move(message); }
 const MQTTDiscoveryInfo &MQTTClientComponent::get_discovery_info() const { return this->discovery_info_; }
-void MQTTClientComponent::set_topic_prefix(std::string topic_prefix) { this->topic_prefix_ = std::move(topic_prefix); }
+void MQTTClientComponent::set_topic_prefix(std::string topic_prefix) {
+  this->topic_prefix_ = std::move(topic_prefix);
+  for (MQTTComponent *component : this->children_)
+    component->invalidate_topic_cache();
+}
 const std::string &MQTTClientComponent::get_topic_prefix() const { return this->topic_prefix_; }
 void MQTTClientComponent::disable_birth_message() {
   this->birth_message_.topic = "";
@@ -545,9 +584,12 @@ void MQTTClientComponent::disable_discovery() {
   this->discovery_info_ = MQTTDiscoveryInfo{.prefix = "", .retain = false};
 }
 void MQTTClientComponent::on_shutdown() {
-  if (!this->shutdown_message_.topic.empty()) {
+  if (!this->shutdown_message_.topic.empty() && this->is_connected()) {
+    // bypass the queue, it won't be flushed anymore
     yield();
-    this->publish(this->shutdown_message_);
+    this->send_publish_(this->shutdown_message_.topic.c_str(), this->shutdown_message_.payload.data(),
+                        this->shutdown_message_.payload.size(), this->shutdown_message_.qos,
+                        this->shutdown_message_.retain);
     yield();
   }
   this->mqtt_client_.disconnect(true);
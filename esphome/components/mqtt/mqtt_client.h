@@ -6,16 +6,13 @@
 #include "esphome/core/log.h"
 #include "esphome/components/json/json_util.h"
 #include <AsyncMqttClient.h>
+#include <deque>
 #include "lwip/ip_addr.h"
+#include "mqtt_topic_trie.h"
 
 namespace esphome {
 namespace mqtt {
 
-/** Callback for MQTT subscriptions.
- *
- * First parameter is the topic, the second one is the payload.
- */
-using mqtt_callback_t = std::function<void(const std::string &, const std::string &)>;
 using mqtt_json_callback_t = std::function<void(const std::string &, JsonObject &)>;
 
 /// internal struct for MQTT messages.
@@ -26,11 +23,29 @@ struct MQTTMessage {
   bool retain;
 };
 
-/// internal struct for MQTT subscriptions.
+/// How an outgoing message is queued when it can't be sent immediately.
+enum MQTTPublishPriority {
+  /// Sent before all other queued messages, e.g. the birth message and automations.
+  MQTT_PUBLISH_PRIORITY_HIGH = 0,
+  /// Sent in order after all high priority messages, e.g. discovery.
+  MQTT_PUBLISH_PRIORITY_NORMAL,
+  /// Like normal, but replaces a queued message for the same topic so only the latest state is sent.
+  MQTT_PUBLISH_PRIORITY_STATE,
+};
+
+/// internal struct for queued outgoing MQTT messages.
+struct MQTTQueuedMessage {
+  std::string topic;
+  std::string payload;
+  uint8_t qos;
+  bool retain;
+  bool coalesce;
+};
+
+/// internal struct for MQTT subscriptions, the callbacks are stored in the subscription trie.
 struct MQTTSubscription {
   std::string topic;
   uint8_t qos;
-  mqtt_callback_t callback;
   bool subscribed;
   uint32_t resubscribe_timeout;
 };
@@ -185,6 +200,13 @@ class MQTTClientComponent : public Component {
   bool publish(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos = 0,
                bool retain = false);
 
+  /** Publish a MQTT message, queueing it with the given priority if the TCP send buffer is full.
+   *
+   * @return false if the client is not connected or the message had to be dropped.
+   */
+  bool publish(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos, bool retain,
+               MQTTPublishPriority priority);
+
   /** Construct and send a JSON MQTT message.
    *
    * @param topic The topic.
@@ -201,7 +223,8 @@ class MQTTClientComponent : public Component {
   /// MQTT client setup priority
   float get_setup_priority() const override;
 
-  void on_message(const std::string &topic, const std::string &payload);
+  /// Dispatch a received message to all matching subscriptions, takes ownership of topic and payload.
+  void on_message(std::string topic, std::string payload);
 
   bool can_proceed() override;
 
@@ -220,6 +243,17 @@ class MQTTClientComponent : public Component {
   void set_username(const std::string &username) { this->credentials_.username = username; }
   void set_password(const std::string &password) { this->credentials_.password = password; }
   void set_client_id(const std::string &client_id) { this->credentials_.client_id = client_id; }
+  /// Set the maximum number of messages held back while the TCP send buffer is full, 0 disables queueing.
+  void set_publish_queue_size(size_t publish_queue_size) { this->publish_queue_size_ = publish_queue_size; }
+
+  /// The number of messages currently waiting to be sent.
+  size_t get_publish_queue_depth() const {
+    return this->high_priority_queue_.size() + this->publish_queue_.size();
+  }
+  /// The number of messages dropped because the publish queue was full.
+  uint32_t get_publish_dropped_count() const { return this->publish_dropped_count_; }
+  /// The number of queued state messages that were replaced by a newer state before being sent.
+  uint32_t get_publish_coalesced_count() const { return this->publish_coalesced_count_; }
 
  protected:
   /// Reconnect to the MQTT broker if not already connected.
@@ -235,7 +269,16 @@ class MQTTClientComponent : public Component {
   /// Re-calculate the availability property.
   void recalculate_availability_();
 
+  /// Hand a message to the MQTT client, returns false if the TCP send buffer is full.
+  bool send_publish_(const char *topic, const char *payload, size_t payload_length, uint8_t qos, bool retain);
+  bool enqueue_publish_(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos,
+                        bool retain, MQTTPublishPriority priority);
+  /// Send queued messages until the queue is empty or the TCP send buffer is full, returns true if drained.
+  bool flush_publish_queue_(std::deque<MQTTQueuedMessage> &queue);
+  void clear_publish_queue_();
+
   bool subscribe_(const char *topic, uint8_t qos);
+  void add_subscription_(const std::string &topic, uint8_t qos);
   void resubscribe_subscription_(MQTTSubscription *sub);
   void resubscribe_subscriptions_();
 
@@ -262,7 +305,14 @@ class MQTTClientComponent : public Component {
   std::string payload_buffer_;
   int log_level_{ESPHOME_LOG_LEVEL};
 
+  /// The topics subscribed to at the broker, one entry per distinct topic filter.
   std::vector<MQTTSubscription> subscriptions_;
+  MQTTTopicTrie subscription_trie_;
+  std::deque<MQTTQueuedMessage> high_priority_queue_;
+  std::deque<MQTTQueuedMessage> publish_queue_;
+  size_t publish_queue_size_{64};
+  uint32_t publish_dropped_count_{0};
+  uint32_t publish_coalesced_count_{0};
   AsyncMqttClient mqtt_client_;
   MQTTClientState state_{MQTT_CLIENT_DISCONNECTED};
   IPAddress ip_;
@@ -310,8 +360,10 @@ template<typename... Ts> class MQTTPublishAction : public Action<Ts...> {
   TEMPLATABLE_VALUE(bool, retain)
 
   void play(Ts... x) override {
-    this->parent_->publish(this->topic_.value(x...), this->payload_.value(x...), this->qos_.value(x...),
-                           this->retain_.value(x...));
+    auto topic = this->topic_.value(x...);
+    auto payload = this->payload_.value(x...);
+    this->parent_->publish(topic, payload.data(), payload.size(), this->qos_.value(x...), this->retain_.value(x...),
+                           MQTT_PUBLISH_PRIORITY_HIGH);
   }
 
  protected:
@@ -22,28 +22,52 @@ std::string MQTTComponent::get_default_topic_for_(const std::string &suffix) con
          "/" + suffix;
 }
 
-const std::string MQTTComponent::get_state_topic_() const {
-  if (this->custom_state_topic_.empty())
-    return this->get_default_topic_for_("state");
-  return this->custom_state_topic_;
+const std::string &MQTTComponent::get_state_topic_() const {
+  if (!this->custom_state_topic_.empty())
+    return this->custom_state_topic_;
+  if (this->state_topic_cache_.empty())
+    this->state_topic_cache_ = this->get_default_topic_for_("state");
+  return this->state_topic_cache_;
 }
 
-const std::string MQTTComponent::get_command_topic_() const {
-  if (this->custom_command_topic_.empty())
-    return this->get_default_topic_for_("command");
-  return this->custom_command_topic_;
+const std::string &MQTTComponent::get_command_topic_() const {
+  if (!this->custom_command_topic_.empty())
+    return this->custom_command_topic_;
+  if (this->command_topic_cache_.empty())
+    this->command_topic_cache_ = this->get_default_topic_for_("command");
+  return this->command_topic_cache_;
+}
+
+void MQTTComponent::invalidate_topic_cache() {
+  this->state_topic_cache_.clear();
+  this->command_topic_cache_.clear();
 }
 
 bool MQTTComponent::publish(const std::string &topic, const std::string &payload) {
+  return this->publish(topic, payload.data(), payload.size());
+}
+
+bool MQTTComponent::publish(const std::string &topic, const char *payload, size_t payload_length) {
   if (topic.empty())
     return false;
-  return global_mqtt_client->publish(topic, payload, 0, this->retain_);
+  // states are coalesced per topic when the client has to queue them
+  return global_mqtt_client->publish(topic, payload, payload_length, 0, this->retain_, MQTT_PUBLISH_PRIORITY_STATE);
 }
 
 bool MQTTComponent::publish_json(const std::string &topic, const json::json_build_t &f) {
   if (topic.empty())
     return false;
-  return global_mqtt_client->publish_json(topic, f, 0, this->retain_);
+  size_t len;
+  const char *message = json::build_json(f, &len);
+  return global_mqtt_client->publish(topic, message, len, 0, this->retain_, MQTT_PUBLISH_PRIORITY_STATE);
+}
+
+bool MQTTComponent::publish_json_stream(const std::string &topic, const json::json_write_t &f) {
+  if (topic.empty())
+    return false;
+  size_t len;
+  const char *message = json::write_json(f, &len);
+  return global_mqtt_client->publish(topic, message, len, 0, this->retain_, MQTT_PUBLISH_PRIORITY_STATE);
 }
 
 bool MQTTComponent::send_discovery_() {
@@ -56,56 +80,53 @@ bool MQTTComponent::send_discovery_() {
 
   ESP_LOGV(TAG, "'%s': Sending discovery...", this->friendly_name().c_str());
 
-  return global_mqtt_client->publish_json(
-      this->get_discovery_topic_(discovery_info),
-      [this](JsonObject &root) {
+  size_t len;
+  const char *message = json::write_json(
+      [this](json::JsonWriter &root) {
         SendDiscoveryConfig config;
         config.state_topic = true;
         config.command_topic = true;
 
         this->send_discovery(root, config);
 
-        std::string name = this->friendly_name();
-        root["name"] = name;
+        root.add("name", this->friendly_name());
         if (config.state_topic)
-          root["state_topic"] = this->get_state_topic_();
+          root.add("state_topic", this->get_state_topic_());
         if (config.command_topic)
-          root["command_topic"] = this->get_command_topic_();
-
-        if (this->availability_ == nullptr) {
-          if (!global_mqtt_client->get_availability().topic.empty()) {
-            root["availability_topic"] = global_mqtt_client->get_availability().topic;
-            if (global_mqtt_client->get_availability().payload_available != "online")
-              root["payload_available"] = global_mqtt_client->get_availability().payload_available;
-            if (global_mqtt_client->get_availability().payload_not_available != "offline")
-              root["payload_not_available"] = global_mqtt_client->get_availability().payload_not_available;
-          }
-        } else if (!this->availability_->topic.empty()) {
-          root["availability_topic"] = this->availability_->topic;
-          if (this->availability_->payload_available != "online")
-            root["payload_available"] = this->availability_->payload_available;
-          if (this->availability_->payload_not_available != "offline")
-            root["payload_not_available"] = this->availability_->payload_not_available;
+          root.add("command_topic", this->get_command_topic_());
+
+        const Availability *availability = this->availability_;
+        if (availability == nullptr)
+          availability = &global_mqtt_client->get_availability();
+        if (!availability->topic.empty()) {
+          root.add("availability_topic", availability->topic);
+          if (availability->payload_available != "online")
+            root.add("payload_available", availability->payload_available);
+          if (availability->payload_not_available != "offline")
+            root.add("payload_not_available", availability->payload_not_available);
         }
 
-        const std::string &node_name = App.get_name();
         std::string unique_id = this->unique_id();
         if (!unique_id.empty()) {
-          root["unique_id"] = unique_id;
+          root.add("unique_id", unique_id);
         } else {
           // default to almost-unique ID. It's a hack but the only way to get that
           // gorgeous device registry view.
-          root["unique_id"] = "ESP" + this->component_type() + this->get_default_object_id_();
+          root.add("unique_id", "ESP" + this->component_type() + this->get_default_object_id_());
         }
 
-        JsonObject &device_info = root.createNestedObject("device");
-        device_info["identifiers"] = get_mac_address();
-        device_info["name"] = node_name;
-        device_info["sw_version"] = "esphome v" ESPHOME_VERSION " " + App.get_compilation_time();
-        device_info["model"] = ESPHOME_BOARD;
-        device_info["manufacturer"] = "espressif";
+        root.begin_object("device");
+        root.add("identifiers", get_mac_address());
+        root.add("name", App.get_name());
+        root.add("sw_version", "esphome v" ESPHOME_VERSION " " + App.get_compilation_time());
+        root.add("model", ESPHOME_BOARD);
+        root.add("manufacturer", "espressif");
+        root.end_object();
       },
-      0, discovery_info.retain);
+      &len);
+
+  return global_mqtt_client->publish(this->get_discovery_topic_(discovery_info), message, len, 0,
+                                     discovery_info.retain);
 }
 
 bool MQTTComponent::get_retain() const { return this->retain_; }
@@ -42,7 +42,10 @@ struct SendDiscoveryConfig {
  *
  * In order to implement automatic Home Assistant discovery, all sub-classes should:
  *
- *  1. Implement send_discovery that creates a Home Assistant discovery payload.
+ *  1. Implement send_discovery that writes a Home Assistant discovery payload.
+ *     The payload is streamed with a json::JsonWriter instead of being built in an ArduinoJson JsonObject, so
+ *     `root["key"] = value;` becomes `root.add("key", value);` and nested objects and arrays are written between
+ *     begin_object("key")/end_object() and begin_array("key")/end_array().
  *  2. Override component_type() to return the appropriate component type such as "light" or "sensor".
  *  3. Subscribe to command topics using subscribe() or subscribe_json() during setup().
  *
@@ -60,8 +63,8 @@ class MQTTComponent : public Component {
 
   void call_loop() override;
 
-  /// Send discovery info the Home Assistant, override this.
-  virtual void send_discovery(JsonObject &root, SendDiscoveryConfig &config) = 0;
+  /// Send discovery info the Home Assistant, override this. The writer is inside the discovery payload's root object.
+  virtual void send_discovery(json::JsonWriter &root, SendDiscoveryConfig &config) = 0;
 
   virtual bool send_initial_state() = 0;
 
@@ -96,6 +99,9 @@ class MQTTComponent : public Component {
   /// Internal method for the MQTT client base to schedule a resend of the state on reconnect.
   void schedule_resend_state();
 
+  /// Internal method for the MQTT client base to drop the cached state/command topics when the prefix changes.
+  void invalidate_topic_cache();
+
   /** Send a MQTT message.
    *
    * @param topic The topic.
@@ -103,6 +109,14 @@ class MQTTComponent : public Component {
    */
   bool publish(const std::string &topic, const std::string &payload);
 
+  /** Send a MQTT message without copying the payload into a std::string.
+   *
+   * @param topic The topic.
+   * @param payload The payload buffer, does not need to be null-terminated.
+   * @param payload_length The length of the payload.
+   */
+  bool publish(const std::string &topic, const char *payload, size_t payload_length);
+
   /** Construct and send a JSON MQTT message.
    *
    * @param topic The topic.
@@ -110,6 +124,13 @@ class MQTTComponent : public Component {
    */
   bool publish_json(const std::string &topic, const json::json_build_t &f);
 
+  /** Stream and send a JSON MQTT message without building a JSON document in memory.
+   *
+   * @param topic The topic.
+   * @param f The Json writer function, called inside the root object.
+   */
+  bool publish_json_stream(const std::string &topic, const json::json_write_t &f);
+
   /** Subscribe to a MQTT topic.
    *
    * @param topic The topic. Wildcards are currently not supported.
@@ -150,11 +171,11 @@ class MQTTComponent : public Component {
    */
   virtual std::string unique_id();
 
-  /// Get the MQTT topic that new states will be shared to.
-  const std::string get_state_topic_() const;
+  /// Get the MQTT topic that new states will be shared to. The result is cached after the first call.
+  const std::string &get_state_topic_() const;
 
-  /// Get the MQTT topic for listening to commands.
-  const std::string get_command_topic_() const;
+  /// Get the MQTT topic for listening to commands. The result is cached after the first call.
+  const std::string &get_command_topic_() const;
 
   bool is_connected_() const;
 
@@ -169,6 +190,8 @@ class MQTTComponent : public Component {
  protected:
   std::string custom_state_topic_{};
   std::string custom_command_topic_{};
+  mutable std::string state_topic_cache_{};
+  mutable std::string command_topic_cache_{};
   bool retain_{true};
   bool discovery_enabled_{true};
   Availability *availability_{nullptr};
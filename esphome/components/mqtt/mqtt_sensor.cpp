@@ -45,24 +45,24 @@ uint32_t MQTTSensorComponent::get_expire_after() const {
 void MQTTSensorComponent::set_expire_after(uint32_t expire_after) { this->expire_after_ = expire_after; }
 void MQTTSensorComponent::disable_expire_after() { this->expire_after_ = 0; }
 std::string MQTTSensorComponent::friendly_name() const { return this->sensor_->get_name(); }
-void MQTTSensorComponent::send_discovery(JsonObject &root, mqtt::SendDiscoveryConfig &config) {
+void MQTTSensorComponent::send_discovery(json::JsonWriter &root, mqtt::SendDiscoveryConfig &config) {
   if (!this->sensor_->get_device_class().empty())
-    root["device_class"] = this->sensor_->get_device_class();
+    root.add("device_class", this->sensor_->get_device_class());
 
   if (!this->sensor_->get_unit_of_measurement().empty())
-    root["unit_of_measurement"] = this->sensor_->get_unit_of_measurement();
+    root.add("unit_of_measurement", this->sensor_->get_unit_of_measurement());
 
   if (this->get_expire_after() > 0)
-    root["expire_after"] = this->get_expire_after() / 1000;
+    root.add("expire_after", this->get_expire_after() / 1000);
 
   if (!this->sensor_->get_icon().empty())
-    root["icon"] = this->sensor_->get_icon();
+    root.add("icon", this->sensor_->get_icon());
 
   if (this->sensor_->get_force_update())
-    root["force_update"] = true;
+    root.add("force_update", true);
 
   if (this->sensor_->state_class != STATE_CLASS_NONE)
-    root["state_class"] = state_class_to_string(this->sensor_->state_class);
+    root.add("state_class", state_class_to_string(this->sensor_->state_class));
 
   config.command_topic = false;
 }
@@ -76,7 +76,9 @@ bool MQTTSensorComponent::send_initial_state() {
 bool MQTTSensorComponent::is_internal() { return this->sensor_->is_internal(); }
 bool MQTTSensorComponent::publish_state(float value) {
   int8_t accuracy = this->sensor_->get_accuracy_decimals();
-  return this->publish(this->get_state_topic_(), value_accuracy_to_string(value, accuracy));
+  char buffer[VALUE_ACCURACY_MAX_LEN];
+  size_t len = value_accuracy_to_buf(buffer, sizeof(buffer), value, accuracy);
+  return this->publish(this->get_state_topic_(), buffer, len);
 }
 std::string MQTTSensorComponent::unique_id() { return this->sensor_->unique_id(); }
 
@@ -0,0 +1,126 @@
+#include "mqtt_topic_trie.h"
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace mqtt {
+
+MQTTTopicTrie::Node *MQTTTopicTrie::find_filter_node_(const std::string &filter, bool create, bool *multi_level) {
+  Node *node = &this->root_;
+  *multi_level = false;
+  size_t start = 0;
+  while (true) {
+    size_t end = filter.find('/', start);
+    if (end == std::string::npos)
+      end = filter.size();
+    std::string level = filter.substr(start, end - start);
+
+    if (level == "#") {
+      // multi level wildcard - MQTT mandates that this must be at end of subscribe topic
+      *multi_level = true;
+      return node;
+    }
+
+    Node *next;
+    if (level == "+") {
+      if (!node->single_level && create)
+        node->single_level.reset(new Node());  // NOLINT(cppcoreguidelines-owning-memory)
+      next = node->single_level.get();
+    } else {
+      auto it = std::lower_bound(node->children.begin(), node->children.end(), level,
+                                 [](const std::unique_ptr<Node> &a, const std::string &b) { return a->level < b; });
+      if (it == node->children.end() || (*it)->level != level) {
+        if (!create)
+          return nullptr;
+        std::unique_ptr<Node> child(new Node());  // NOLINT(cppcoreguidelines-owning-memory)
+        child->level = level;
+        it = node->children.insert(it, std::move(child));
+      }
+      next = it->get();
+    }
+    if (next == nullptr)
+      return nullptr;
+    node = next;
+
+    if (end == filter.size())
+      return node;
+    start = end + 1;
+  }
+}
+
+void MQTTTopicTrie::insert(const std::string &filter, mqtt_callback_t callback) {
+  bool multi_level;
+  Node *node = this->find_filter_node_(filter, true, &multi_level);
+  if (multi_level) {
+    node->multi_level_callbacks.push_back(std::move(callback));
+  } else {
+    node->callbacks.push_back(std::move(callback));
+  }
+}
+
+void MQTTTopicTrie::remove(const std::string &filter) {
+  bool multi_level;
+  Node *node = this->find_filter_node_(filter, false, &multi_level);
+  if (node == nullptr)
+    return;
+  if (multi_level) {
+    node->multi_level_callbacks.clear();
+  } else {
+    node->callbacks.clear();
+  }
+}
+
+MQTTTopicTrie::Node *MQTTTopicTrie::find_child_(const Node *node, const char *level, size_t level_len) {
+  // binary search without materializing the topic level as a std::string
+  size_t lo = 0, hi = node->children.size();
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    int cmp = node->children[mid]->level.compare(0, std::string::npos, level, level_len);
+    if (cmp == 0)
+      return node->children[mid].get();
+    if (cmp < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return nullptr;
+}
+
+void MQTTTopicTrie::dispatch_(const Node *node, const char *level, bool first_level, const std::string &topic,
+                              const std::string &payload) {
+  // Topics beginning with '$' are not matched by wildcards at the first level.
+  bool do_wildcards = !first_level || topic[0] != '$';
+
+  if (do_wildcards) {
+    // '#' also matches the parent level, so "a/#" matches "a" as well as "a/b/c".
+    for (const auto &callback : node->multi_level_callbacks)
+      callback(topic, payload);
+  }
+
+  if (level == nullptr) {
+    for (const auto &callback : node->callbacks)
+      callback(topic, payload);
+    return;
+  }
+
+  const char *sep = strchr(level, '/');
+  size_t level_len = sep == nullptr ? strlen(level) : sep - level;
+  const char *next_level = sep == nullptr ? nullptr : sep + 1;
+
+  const Node *child = find_child_(node, level, level_len);
+  if (child != nullptr)
+    dispatch_(child, next_level, false, topic, payload);
+  if (do_wildcards && node->single_level)
+    dispatch_(node->single_level.get(), next_level, false, topic, payload);
+}
+
+void MQTTTopicTrie::dispatch(const std::string &topic, const std::string &payload) const {
+  // MQTT spec mandates that topics must not be empty.
+  if (topic.empty())
+    return;
+  dispatch_(&this->root_, topic.c_str(), true, topic, payload);
+}
+
+}  // namespace mqtt
+}  // namespace esphome
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace esphome {
+namespace mqtt {
+
+/** Callback for MQTT subscriptions.
+ *
+ * First parameter is the topic, the second one is the payload.
+ */
+using mqtt_callback_t = std::function<void(const std::string &, const std::string &)>;
+
+/** A trie of MQTT subscription topic filters, split at each '/' topic level.
+ *
+ * Literal levels are stored as sorted children of each node, a '+' single level wildcard is a dedicated child
+ * and a trailing '#' multi level wildcard attaches its callbacks to the node it follows. Dispatching a message
+ * therefore only visits the nodes along the topic levels (plus '+' branches) instead of matching every
+ * subscription against the topic.
+ */
+class MQTTTopicTrie {
+ public:
+  /// Register a callback for the given topic filter, which may contain '+' and '#' wildcards.
+  void insert(const std::string &filter, mqtt_callback_t callback);
+
+  /// Remove all callbacks that were registered with exactly this topic filter.
+  void remove(const std::string &filter);
+
+  /// Call all callbacks whose topic filter matches the (wildcard-free) message topic.
+  void dispatch(const std::string &topic, const std::string &payload) const;
+
+ protected:
+  struct Node {
+    std::string level;
+    /// Literal child levels, sorted by level.
+    std::vector<std::unique_ptr<Node>> children;
+    /// Child for the '+' single level wildcard.
+    std::unique_ptr<Node> single_level;
+    /// Callbacks of topic filters ending at this node.
+    std::vector<mqtt_callback_t> callbacks;
+    /// Callbacks of topic filters ending with '#' after this node.
+    std::vector<mqtt_callback_t> multi_level_callbacks;
+  };
+
+  /// Find the node for the topic filter, creating it if create is true.
+  Node *find_filter_node_(const std::string &filter, bool create, bool *multi_level);
+  static Node *find_child_(const Node *node, const char *level, size_t level_len);
+  static void dispatch_(const Node *node, const char *level, bool first_level, const std::string &topic,
+                        const std::string &payload);
+
+  Node root_;
+};
+
+}  // namespace mqtt
+}  // namespace esphome
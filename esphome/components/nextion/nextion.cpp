@@ -3,11 +3,22 @@
 #include "esphome/core/log.h"
 #include "esphome/core/application.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 namespace esphome {
 namespace nextion {
 
 static const char *const TAG = "nextion";
 
+// The length of the left side of an assignment like `t0.txt="abc"` including the `=`, 0 for other commands
+static size_t assignment_length(const std::string &command) {
+  const size_t pos = command.find('=');
+  if (pos == std::string::npos || pos == 0 || command.find_first_of(" \"(", 0) < pos)
+    return 0;
+  return pos + 1;
+}
+
 void Nextion::setup() {
   this->is_setup_ = false;
   this->ignore_is_setup_ = true;
@@ -110,6 +121,8 @@ void Nextion::reset_(bool reset_nextion) {
   while (this->available()) {  // Clear receive buffer
     this->read_byte(&d);
   };
+  for (auto *entry : this->nextion_queue_)
+    this->release_queue_entry_(entry);
   this->nextion_queue_.clear();
 }
 
@@ -140,18 +153,6 @@ void Nextion::update() {
   }
 }
 
-void Nextion::add_sleep_state_callback(std::function<void()> &&callback) {
-  this->sleep_callback_.add(std::move(callback));
-}
-
-void Nextion::add_wake_state_callback(std::function<void()> &&callback) {
-  this->wake_callback_.add(std::move(callback));
-}
-
-void Nextion::add_setup_state_callback(std::function<void()> &&callback) {
-  this->setup_callback_.add(std::move(callback));
-}
-
 void Nextion::update_all_components() {
   if ((!this->is_setup() && !this->ignore_is_setup_) || this->is_sleeping())
     return;
@@ -184,11 +185,7 @@ bool Nextion::send_command_printf(const char *format, ...) {
     return false;
   }
 
-  if (this->send_command_(buffer)) {
-    this->add_no_result_to_queue_("send_command_printf");
-    return true;
-  }
-  return false;
+  return this->add_to_queue_(nullptr, "send_command_printf", buffer);
 }
 
 #ifdef NEXTION_PROTOCOL_LOG
@@ -203,8 +200,8 @@ void Nextion::print_queue_members_() {
     if (i == nullptr) {
       ESP_LOGN(TAG, "Nextion queue is null");
     } else {
-      ESP_LOGN(TAG, "Nextion queue type: %d:%s , name: %s", i->component->get_queue_type(),
-               i->component->get_queue_type_string().c_str(), i->component->get_variable_name().c_str());
+      ESP_LOGN(TAG, "Nextion queue type: %d:%s , name: %s, sent: %s", i->get_queue_type(),
+               NEXTION_QUEUE_TYPE_STRINGS[i->get_queue_type()], i->get_variable_name().c_str(), YESNO(i->sent));
     }
   }
   ESP_LOGN(TAG, "*******************************************");
@@ -238,6 +235,8 @@ void Nextion::loop() {
 
   this->process_serial_();            // Receive serial data
   this->process_nextion_commands_();  // Process nextion return commands
+  this->remove_old_from_q_();
+  this->send_queued_commands_();
 
   if (!this->nextion_reports_is_setup_) {
     if (this->started_ms_ == 0)
@@ -258,21 +257,112 @@ bool Nextion::remove_from_q_(bool report_empty) {
   }
 
   NextionQueue *nb = this->nextion_queue_.front();
-  NextionComponentBase *component = nb->component;
+  if (!nb->sent) {
+    // the response is to a command that was written directly
+    return false;
+  }
 
-  ESP_LOGN(TAG, "Removing %s from the queue", component->get_variable_name().c_str());
+  ESP_LOGN(TAG, "Removing %s from the queue", nb->get_variable_name().c_str());
 
-  if (component->get_queue_type() == NextionQueueType::NO_RESULT) {
-    if (component->get_variable_name() == "sleep_wake") {
-      this->is_sleeping_ = false;
-    }
-    delete component;
+  if (nb->get_queue_type() == NextionQueueType::NO_RESULT && nb->get_variable_name() == "sleep_wake") {
+    this->is_sleeping_ = false;
   }
-  delete nb;
   this->nextion_queue_.pop_front();
+  this->release_queue_entry_(nb);
   return true;
 }
 
+bool Nextion::add_to_queue_(NextionComponentBase *component, const std::string &variable_name,
+                            const std::string &command) {
+  if (!this->ignore_is_setup_ && !this->is_setup())
+    return false;
+
+  // A pending assignment to the same variable, like `t0.txt="abc"`, is outdated by this one. The search stops at the
+  // first command that is not an assignment, since the outdated assignment may have had to come after it.
+  const size_t assignment = assignment_length(command);
+  if (component == nullptr && assignment != 0) {
+    for (auto it = this->nextion_queue_.rbegin(); it != this->nextion_queue_.rend() && !(*it)->sent; ++it) {
+      NextionQueue *entry = *it;
+      if (entry->component != nullptr || assignment_length(entry->command) == 0)
+        break;
+      if (assignment_length(entry->command) == assignment &&
+          entry->command.compare(0, assignment, command, 0, assignment) == 0) {
+        ESP_LOGN(TAG, "Replacing queued command %s with %s", entry->command.c_str(), command.c_str());
+        entry->variable_name = variable_name;
+        entry->command = command;
+        return true;
+      }
+    }
+  }
+
+  NextionQueue *entry;
+  if (this->queue_pool_.empty()) {
+    entry = new NextionQueue;  // NOLINT(cppcoreguidelines-owning-memory)
+  } else {
+    entry = this->queue_pool_.back();
+    this->queue_pool_.pop_back();
+  }
+  entry->component = component;
+  entry->variable_name = variable_name;
+  entry->command = command;
+  entry->queue_time = millis();
+  entry->sent = false;
+  this->nextion_queue_.push_back(entry);
+
+  ESP_LOGN(TAG, "Add to queue type: %s component %s", NEXTION_QUEUE_TYPE_STRINGS[entry->get_queue_type()],
+           entry->get_variable_name().c_str());
+
+  // written from loop(), so that all commands queued until then go out in one write
+  return true;
+}
+
+void Nextion::send_queued_commands_() {
+  if (this->is_updating_)
+    return;
+
+  size_t in_flight = 0;
+  this->command_batch_.clear();
+  for (auto *entry : this->nextion_queue_) {
+    if (in_flight >= MAX_COMMANDS_IN_FLIGHT)
+      break;
+    // the waveform data follows the ready response to addt, nothing else may be written in between
+    const bool is_addt = entry->command.compare(0, 5, "addt ") == 0;
+    if (entry->sent) {
+      if (is_addt)
+        break;
+      in_flight++;
+      continue;
+    }
+    if (!this->command_batch_.empty() &&
+        this->command_batch_.size() + entry->command.size() + COMMAND_DELIMITER.size() > MAX_COMMAND_BATCH_SIZE)
+      break;
+
+    ESP_LOGN(TAG, "send_command %s", entry->command.c_str());
+    this->command_batch_ += entry->command;
+    this->command_batch_ += COMMAND_DELIMITER;
+    entry->sent = true;
+    in_flight++;
+    if (is_addt)
+      break;
+  }
+
+  if (!this->command_batch_.empty()) {
+    this->write_array(reinterpret_cast<const uint8_t *>(this->command_batch_.data()), this->command_batch_.size());
+  }
+}
+
+void Nextion::release_queue_entry_(NextionQueue *entry) {
+  if (entry->sent) {
+    const uint32_t latency = millis() - entry->queue_time;
+    this->queue_latency_ = this->queue_latency_ == 0 ? latency : (this->queue_latency_ * 7 + latency) / 8;
+    ESP_LOGV(TAG, "Response to %s after %u ms, %zu commands queued", entry->get_variable_name().c_str(), latency,
+             this->nextion_queue_.size());
+  }
+  entry->component = nullptr;
+  entry->sent = false;
+  this->queue_pool_.push_back(entry);
+}
+
 void Nextion::process_serial_() {
   uint8_t d;
 
@@ -360,7 +450,7 @@ void Nextion::process_nextion_commands_() {
           for (auto &nb : this->nextion_queue_) {
             NextionComponentBase *component = nb->component;
 
-            if (component->get_queue_type() == NextionQueueType::WAVEFORM_SENSOR) {
+            if (nb->sent && nb->get_queue_type() == NextionQueueType::WAVEFORM_SENSOR) {
               ESP_LOGW(TAG, "Nextion reported invalid Waveform ID %d or Channel # %d was used!",
                        component->get_component_id(), component->get_wave_channel_id());
 
@@ -369,8 +459,7 @@ void Nextion::process_nextion_commands_() {
 
               found = index;
 
-              delete component;
-              delete nb;
+              this->release_queue_entry_(nb);
 
               break;
             }
@@ -471,17 +560,17 @@ void Nextion::process_nextion_commands_() {
         NextionQueue *nb = this->nextion_queue_.front();
         NextionComponentBase *component = nb->component;
 
-        if (component->get_queue_type() != NextionQueueType::TEXT_SENSOR) {
+        if (nb->get_queue_type() != NextionQueueType::TEXT_SENSOR) {
           ESP_LOGE(TAG, "ERROR: Received string return but next in queue \"%s\" is not a text sensor",
-                   component->get_variable_name().c_str());
+                   nb->get_variable_name().c_str());
         } else {
           ESP_LOGN(TAG, "Received get_string response: \"%s\" for component id: %s, type: %s", to_process.c_str(),
                    component->get_variable_name().c_str(), component->get_queue_type_string().c_str());
           component->set_state_from_string(to_process, true, false);
         }
 
-        delete nb;
         this->nextion_queue_.pop_front();
+        this->release_queue_entry_(nb);
 
         break;
       }
@@ -514,11 +603,11 @@ void Nextion::process_nextion_commands_() {
         NextionQueue *nb = this->nextion_queue_.front();
         NextionComponentBase *component = nb->component;
 
-        if (component->get_queue_type() != NextionQueueType::SENSOR &&
-            component->get_queue_type() != NextionQueueType::BINARY_SENSOR &&
-            component->get_queue_type() != NextionQueueType::SWITCH) {
+        if (nb->get_queue_type() != NextionQueueType::SENSOR &&
+            nb->get_queue_type() != NextionQueueType::BINARY_SENSOR &&
+            nb->get_queue_type() != NextionQueueType::SWITCH) {
           ESP_LOGE(TAG, "ERROR: Received numeric return but next in queue \"%s\" is not a valid sensor type %d",
-                   component->get_variable_name().c_str(), component->get_queue_type());
+                   nb->get_variable_name().c_str(), nb->get_queue_type());
         } else {
           ESP_LOGN(TAG, "Received numeric return for variable %s, queue type %d:%s, value %d",
                    component->get_variable_name().c_str(), component->get_queue_type(),
@@ -526,8 +615,8 @@ void Nextion::process_nextion_commands_() {
           component->set_state_from_int(value, true, false);
         }
 
-        delete nb;
         this->nextion_queue_.pop_front();
+        this->release_queue_entry_(nb);
 
         break;
       }
@@ -691,24 +780,20 @@ void Nextion::process_nextion_commands_() {
         int found = -1;
         for (auto &nb : this->nextion_queue_) {
           auto component = nb->component;
-          if (component->get_queue_type() == NextionQueueType::WAVEFORM_SENSOR) {
-            size_t buffer_to_send = component->get_wave_buffer().size() < 255 ? component->get_wave_buffer().size()
-                                                                              : 255;  // ADDT command can only send 255
+          if (nb->sent && nb->get_queue_type() == NextionQueueType::WAVEFORM_SENSOR) {
+            // Exactly the number of values announced by the addt command, more may have been added since it was sent
+            size_t buffer_to_send = strtoul(nb->command.c_str() + nb->command.rfind(',') + 1, nullptr, 10);
+            buffer_to_send = std::min(buffer_to_send, component->get_wave_buffer().size());
 
             this->write_array(component->get_wave_buffer().data(), static_cast<int>(buffer_to_send));
 
             ESP_LOGN(TAG, "Nextion sending waveform data for component id %d and waveform id %d, size %zu",
                      component->get_component_id(), component->get_wave_channel_id(), buffer_to_send);
 
-            if (component->get_wave_buffer().size() <= 255) {
-              component->get_wave_buffer().clear();
-            } else {
-              component->get_wave_buffer().erase(component->get_wave_buffer().begin(),
-                                                 component->get_wave_buffer().begin() + buffer_to_send);
-            }
+            component->get_wave_buffer().erase(component->get_wave_buffer().begin(),
+                                               component->get_wave_buffer().begin() + buffer_to_send);
             found = index;
-            delete component;
-            delete nb;
+            this->release_queue_entry_(nb);
             break;
           }
           ++index;
@@ -733,44 +818,27 @@ void Nextion::process_nextion_commands_() {
     this->process_serial_();
   }
 
-  uint32_t ms = millis();
-
-  if (!this->nextion_queue_.empty() && this->nextion_queue_.front()->queue_time + this->max_q_age_ms_ < ms) {
-    for (int i = 0; i < this->nextion_queue_.size(); i++) {
-      NextionComponentBase *component = this->nextion_queue_[i]->component;
-      if (this->nextion_queue_[i]->queue_time + this->max_q_age_ms_ < ms) {
-        if (this->nextion_queue_[i]->queue_time == 0)
-          ESP_LOGD(TAG, "Removing old queue type \"%s\" name \"%s\" queue_time 0",
-                   component->get_queue_type_string().c_str(), component->get_variable_name().c_str());
-
-        if (component->get_variable_name() == "sleep_wake") {
-          this->is_sleeping_ = false;
-        }
-
-        ESP_LOGD(TAG, "Removing old queue type \"%s\" name \"%s\"", component->get_queue_type_string().c_str(),
-                 component->get_variable_name().c_str());
-
-        if (component->get_queue_type() == NextionQueueType::NO_RESULT) {
-          if (component->get_variable_name() == "sleep_wake") {
-            this->is_sleeping_ = false;
-          }
-          delete component;
-        }
-
-        delete this->nextion_queue_[i];
-
-        this->nextion_queue_.erase(this->nextion_queue_.begin() + i);
-
-      } else {
-        break;
-      }
-    }
-  }
   ESP_LOGN(TAG, "Loop End");
   // App.feed_wdt(); Remove before master merge
   this->process_serial_();
 }  // namespace nextion
 
+void Nextion::remove_old_from_q_() {
+  const uint32_t ms = millis();
+  while (!this->nextion_queue_.empty() && this->nextion_queue_.front()->queue_time + this->max_q_age_ms_ < ms) {
+    NextionQueue *nb = this->nextion_queue_.front();
+    ESP_LOGD(TAG, "Removing old queue type \"%s\" name \"%s\"", NEXTION_QUEUE_TYPE_STRINGS[nb->get_queue_type()],
+             nb->get_variable_name().c_str());
+
+    if (nb->get_variable_name() == "sleep_wake") {
+      this->is_sleeping_ = false;
+    }
+
+    this->nextion_queue_.pop_front();
+    this->release_queue_entry_(nb);
+  }
+}
+
 void Nextion::set_nextion_sensor_state(int queue_type, const std::string &name, float state) {
   this->set_nextion_sensor_state(static_cast<NextionQueueType>(queue_type), name, state);
 }
@@ -905,24 +973,6 @@ uint16_t Nextion::recv_ret_string_(std::string &response, uint32_t timeout, bool
   return ret;
 }
 
-/**
- * @brief
- *
- * @param variable_name Name for the queue
- */
-void Nextion::add_no_result_to_queue_(const std::string &variable_name) {
-  nextion::NextionQueue *nextion_queue = new nextion::NextionQueue;
-
-  nextion_queue->component = new nextion::NextionComponentBase;
-  nextion_queue->component->set_variable_name(variable_name);
-
-  nextion_queue->queue_time = millis();
-
-  this->nextion_queue_.push_back(nextion_queue);
-
-  ESP_LOGN(TAG, "Add to queue type: NORESULT component %s", nextion_queue->component->get_variable_name().c_str());
-}
-
 /**
  * @brief
  *
@@ -933,9 +983,7 @@ void Nextion::add_no_result_to_queue_with_command_(const std::string &variable_n
   if ((!this->is_setup() && !this->ignore_is_setup_) || command.empty())
     return;
 
-  if (this->send_command_(command)) {
-    this->add_no_result_to_queue_(variable_name);
-  }
+  this->add_to_queue_(nullptr, variable_name, command);
 }
 
 bool Nextion::add_no_result_to_queue_with_ignore_sleep_printf_(const std::string &variable_name, const char *format,
@@ -1043,19 +1091,7 @@ void Nextion::add_to_get_queue(NextionComponentBase *component) {
   if ((!this->is_setup() && !this->ignore_is_setup_))
     return;
 
-  nextion::NextionQueue *nextion_queue = new nextion::NextionQueue;
-
-  nextion_queue->component = component;
-  nextion_queue->queue_time = millis();
-
-  ESP_LOGN(TAG, "Add to queue type: %s component %s", component->get_queue_type_string().c_str(),
-           component->get_variable_name().c_str());
-
-  std::string command = "get " + component->get_variable_name_to_send();
-
-  if (this->send_command_(command)) {
-    this->nextion_queue_.push_back(nextion_queue);
-  }
+  this->add_to_queue_(component, "", "get " + component->get_variable_name_to_send());
 }
 
 /**
@@ -1070,19 +1106,21 @@ void Nextion::add_addt_command_to_queue(NextionComponentBase *component) {
   if ((!this->is_setup() && !this->ignore_is_setup_) || this->is_sleeping())
     return;
 
-  nextion::NextionQueue *nextion_queue = new nextion::NextionQueue;
-
-  nextion_queue->component = new nextion::NextionComponentBase;
-  nextion_queue->queue_time = millis();
-
   size_t buffer_to_send = component->get_wave_buffer_size() < 255 ? component->get_wave_buffer_size()
                                                                   : 255;  // ADDT command can only send 255
 
   std::string command = "addt " + to_string(component->get_component_id()) + "," +
                         to_string(component->get_wave_channel_id()) + "," + to_string(buffer_to_send);
-  if (this->send_command_(command)) {
-    this->nextion_queue_.push_back(nextion_queue);
+  // An addt that is still queued sends the values added since with the updated count, a second one would find the
+  // buffer already sent
+  for (auto *entry : this->nextion_queue_) {
+    if (entry->component == component && !entry->sent) {
+      entry->command = command;
+      return;
+    }
   }
+  // Queued with the waveform component, the ready response (0xFE) to it is answered with the component's data
+  this->add_to_queue_(component, "", command);
 }
 
 void Nextion::set_writer(const nextion_writer_t &writer) { this->writer_ = writer; }
@@ -30,6 +30,10 @@ class NextionComponentBase;
 using nextion_writer_t = std::function<void(Nextion &)>;
 
 static const std::string COMMAND_DELIMITER{static_cast<char>(255), static_cast<char>(255), static_cast<char>(255)};
+/// The number of queued commands that are written before the Nextion has to respond to the first of them.
+static const size_t MAX_COMMANDS_IN_FLIGHT = 8;
+/// Commands are written together as long as they fit in this many bytes.
+static const size_t MAX_COMMAND_BATCH_SIZE = 256;
 
 class Nextion : public NextionBase, public PollingComponent, public uart::UARTDevice {
  public:
@@ -675,19 +679,25 @@ class Nextion : public NextionBase, public PollingComponent, public uart::UARTDe
    *
    * @param callback The void() callback.
    */
-  void add_sleep_state_callback(std::function<void()> &&callback);
+  template<typename F> void add_sleep_state_callback(F &&callback) {
+    this->sleep_callback_.add(std::forward<F>(callback));
+  }
 
   /** Add a callback to be notified of wake state changes.
    *
    * @param callback The void() callback.
    */
-  void add_wake_state_callback(std::function<void()> &&callback);
+  template<typename F> void add_wake_state_callback(F &&callback) {
+    this->wake_callback_.add(std::forward<F>(callback));
+  }
 
   /** Add a callback to be notified when the nextion completes its initialize setup.
    *
    * @param callback The void() callback.
    */
-  void add_setup_state_callback(std::function<void()> &&callback);
+  template<typename F> void add_setup_state_callback(F &&callback) {
+    this->setup_callback_.add(std::forward<F>(callback));
+  }
 
   void update_all_components();
 
@@ -727,12 +737,34 @@ class Nextion : public NextionBase, public PollingComponent, public uart::UARTDe
   void set_wake_up_page_internal(uint8_t wake_up_page) { this->wake_up_page_ = wake_up_page; }
   void set_auto_wake_on_touch_internal(bool auto_wake_on_touch) { this->auto_wake_on_touch_ = auto_wake_on_touch; }
 
+  /// The number of commands that are queued or wait for their response.
+  size_t get_queue_size() const { return this->nextion_queue_.size(); }
+  /// The average time in ms between queueing a command and the response of the Nextion.
+  uint32_t get_queue_latency() const { return this->queue_latency_; }
+
  protected:
+  /** Commands in the order they were queued.
+   *
+   * The first up to MAX_COMMANDS_IN_FLIGHT commands have been written and wait for their response, the others are
+   * written as responses come in. Entries are taken from and returned to queue_pool_.
+   */
   std::deque<NextionQueue *> nextion_queue_;
+  std::vector<NextionQueue *> queue_pool_;
+  /// Reused buffer for writing several commands at once.
+  std::string command_batch_;
+  uint32_t queue_latency_{0};
+  /// Queue a command, a pending assignment to the same variable is replaced.
+  bool add_to_queue_(NextionComponentBase *component, const std::string &variable_name, const std::string &command);
+  /// Write as many queued commands as the ack window allows.
+  void send_queued_commands_();
+  /// Return an entry that was removed from the queue to the pool.
+  void release_queue_entry_(NextionQueue *entry);
   uint16_t recv_ret_string_(std::string &response, uint32_t timeout, bool recv_flag);
   void all_components_send_state_(bool force_update = false);
   uint64_t comok_sent_ = 0;
   bool remove_from_q_(bool report_empty = true);
+  /// Remove the commands that were not responded to within max_q_age_ms_.
+  void remove_old_from_q_();
   /**
    * @brief
    * Sends commands ignoring of the Nextion has been setup.
@@ -753,7 +785,6 @@ class Nextion : public NextionBase, public PollingComponent, public uart::UARTDe
    * @param command The command to write, for example "vis b0,0".
    */
   bool send_command_(const std::string &command);
-  void add_no_result_to_queue_(const std::string &variable_name);
   bool add_no_result_to_queue_with_ignore_sleep_printf_(const std::string &variable_name, const char *format, ...)
       __attribute__((format(printf, 3, 4)));
   void add_no_result_to_queue_with_command_(const std::string &variable_name, const std::string &command);
@@ -1,4 +1,5 @@
 #pragma once
+#include <string>
 #include <utility>
 #include "esphome/core/defines.h"
 
@@ -19,11 +20,22 @@ static const char *const NEXTION_QUEUE_TYPE_STRINGS[] = {"NO_RESULT", "SENSOR",
 
 class NextionComponentBase;
 
+/// A command for the Nextion, from the moment it is queued until the Nextion responded to it.
 class NextionQueue {
  public:
   virtual ~NextionQueue() = default;
-  NextionComponentBase *component;
+  /// The component that waits for the result, nullptr for commands without a result.
+  NextionComponentBase *component{nullptr};
+  /// The name of the variable or action, for commands without a result.
+  std::string variable_name;
+  /// The command, written to the Nextion when there is room in the ack window.
+  std::string command;
   uint32_t queue_time = 0;
+  /// Whether the command was written and its response is outstanding.
+  bool sent = false;
+
+  NextionQueueType get_queue_type() const;
+  const std::string &get_variable_name() const;
 };
 
 class NextionComponentBase {
@@ -66,7 +78,7 @@ class NextionComponentBase {
   uint8_t get_wave_channel_id() { return this->wave_chan_id_; }
   void set_wave_channel_id(uint8_t wave_chan_id) { this->wave_chan_id_ = wave_chan_id; }
 
-  std::vector<uint8_t> get_wave_buffer() { return this->wave_buffer_; }
+  std::vector<uint8_t> &get_wave_buffer() { return this->wave_buffer_; }
   size_t get_wave_buffer_size() { return this->wave_buffer_.size(); }
 
   std::string get_variable_name() { return this->variable_name_; }
@@ -81,6 +93,8 @@ class NextionComponentBase {
   void set_wave_max_length(int wave_max_length) { this->wave_max_length_ = wave_max_length; }
 
  protected:
+  friend NextionQueue;
+
   std::string variable_name_;
   std::string variable_name_to_send_;
 
@@ -91,5 +105,12 @@ class NextionComponentBase {
 
   bool needs_to_send_update_;
 };
+
+inline NextionQueueType NextionQueue::get_queue_type() const {
+  return this->component == nullptr ? NextionQueueType::NO_RESULT : this->component->get_queue_type();
+}
+inline const std::string &NextionQueue::get_variable_name() const {
+  return this->component == nullptr ? this->variable_name : this->component->variable_name_;
+}
 }  // namespace nextion
 }  // namespace esphome
@@ -65,6 +65,10 @@ template<typename... Ts> class NumberInRangeCondition : public Condition<Ts...>
       return this->min_ <= state && state <= this->max_;
     }
   }
+  bool add_listener(ConditionListener *listener) override {
+    this->parent_->add_on_state_callback([listener](float state) { listener->on_condition_change(); });
+    return true;
+  }
 
  protected:
   Number *parent_;
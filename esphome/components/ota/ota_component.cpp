@@ -3,11 +3,14 @@
 #include "esphome/core/log.h"
 #include "esphome/core/application.h"
 #include "esphome/core/util.h"
+#include "esphome/core/macros.h"
 
 #include <cstdio>
+#include <cstring>
 #include <MD5Builder.h>
 #ifdef ARDUINO_ARCH_ESP32
 #include <Update.h>
+#include <esp_ota_ops.h>
 #endif
 #include <StreamString.h>
 
@@ -17,6 +20,24 @@ namespace ota {
 static const char *const TAG = "ota";
 
 static const uint8_t OTA_VERSION_1_0 = 1;
+#ifdef ARDUINO_ARCH_ESP32
+static const uint8_t OTA_SUPPORTED_FEATURES = OTA_FEATURE_COMPRESSION | OTA_FEATURE_RESUME | OTA_FEATURE_DELTA;
+#elif ARDUINO_VERSION_CODE >= VERSION_CODE(2, 7, 0)
+// compressed binaries are decompressed by the bootloader, patches could only be sent uncompressed
+static const uint8_t OTA_SUPPORTED_FEATURES = OTA_FEATURE_COMPRESSION | OTA_FEATURE_RESUME;
+#else
+// older cores reject compressed binaries ("Magic byte is wrong")
+static const uint8_t OTA_SUPPORTED_FEATURES = OTA_FEATURE_RESUME;
+#endif
+/// How long an interrupted upload is kept for the uploader to reconnect.
+static const uint32_t OTA_RESUME_TIMEOUT = 60000;
+#ifdef ARDUINO_ARCH_ESP32
+static const size_t OTA_BUFFER_SIZE = 4096;
+/// The largest window the uploader compresses with, a power of two.
+static const size_t OTA_INFLATE_WINDOW = 4096;
+#else
+static const size_t OTA_BUFFER_SIZE = 2048;
+#endif
 
 void OTAComponent::setup() {
   this->server_ = new WiFiServer(this->port_);
@@ -38,6 +59,15 @@ void OTAComponent::dump_config() {
 }
 
 void OTAComponent::loop() {
+  if (this->update_interrupted_ && millis() - this->interrupted_at_ > OTA_RESUME_TIMEOUT) {
+    ESP_LOGW(TAG, "Interrupted OTA update was not resumed, discarding it.");
+    this->abort_update_();
+    this->status_momentary_error("onerror", 5000);
+#ifdef USE_OTA_STATE_CALLBACK
+    this->state_callback_.call(OTA_ERROR, 0.0f, static_cast<uint8_t>(OTA_RESPONSE_ERROR_UNKNOWN));
+#endif
+  }
+
   this->handle_();
 
   if (this->has_safe_mode_ && (millis() - this->safe_mode_start_time_) > this->safe_mode_enable_time_) {
@@ -50,14 +80,14 @@ void OTAComponent::loop() {
 
 void OTAComponent::handle_() {
   OTAResponseTypes error_code = OTA_RESPONSE_ERROR_UNKNOWN;
-  bool update_started = false;
-  uint32_t total = 0;
+  bool resuming = false;
+  bool connection_lost = false;
   uint32_t last_progress = 0;
-  uint8_t buf[1024];
+  uint8_t buf[128];
   char *sbuf = reinterpret_cast<char *>(buf);
+  std::unique_ptr<uint8_t[]> data;
   uint32_t ota_size;
   uint8_t ota_features;
-  (void) ota_features;
 
   if (!this->client_.connected()) {
     this->client_ = this->server_->available();
@@ -99,8 +129,33 @@ void OTAComponent::handle_() {
   ota_features = buf[0];  // NOLINT
   ESP_LOGV(TAG, "OTA features is 0x%02X", ota_features);
 
-  // Acknowledge header - 1 byte
-  this->client_.write(OTA_RESPONSE_HEADER_OK);
+  if (ota_features == 0) {
+    // Acknowledge header - 1 byte
+    this->client_.write(OTA_RESPONSE_HEADER_OK);
+  } else {
+    // Acknowledge header with the requested features this device supports - 2 bytes
+    ota_features &= OTA_SUPPORTED_FEATURES;
+    this->client_.write(OTA_RESPONSE_FEATURES_OK);
+    this->client_.write(ota_features);
+  }
+
+#ifdef ARDUINO_ARCH_ESP32
+  if (ota_features & OTA_FEATURE_DELTA) {
+    // Send MD5 of the running firmware - 32 bytes
+    String running_md5 = ESP.getSketchMD5();
+    if (this->client_.write(reinterpret_cast<const uint8_t *>(running_md5.c_str()), 32) != 32) {
+      ESP_LOGW(TAG, "Writing firmware MD5 failed!");
+      goto error;
+    }
+    // Read whether a patch against it is sent - 1 byte
+    if (!this->wait_receive_(buf, 1)) {
+      ESP_LOGW(TAG, "Reading delta mode failed!");
+      goto error;
+    }
+    if (buf[0] == 0)
+      ota_features &= ~OTA_FEATURE_DELTA;
+  }
+#endif
 
   if (!this->password_.empty()) {
     this->client_.write(OTA_RESPONSE_REQUEST_AUTH);
@@ -173,43 +228,15 @@ void OTAComponent::handle_() {
   }
   ESP_LOGV(TAG, "OTA size is %u bytes", ota_size);
 
-#ifdef ARDUINO_ARCH_ESP8266
-  global_preferences.prevent_write(true);
-#endif
-
-  if (!Update.begin(ota_size, U_FLASH)) {
-    uint8_t error = Update.getError();
-    StreamString ss;
-    Update.printError(ss);
-#ifdef ARDUINO_ARCH_ESP8266
-    if (error == UPDATE_ERROR_BOOTSTRAP) {
-      error_code = OTA_RESPONSE_ERROR_INVALID_BOOTSTRAPPING;
-      goto error;
-    }
-    if (error == UPDATE_ERROR_NEW_FLASH_CONFIG) {
-      error_code = OTA_RESPONSE_ERROR_WRONG_NEW_FLASH_CONFIG;
-      goto error;
-    }
-    if (error == UPDATE_ERROR_FLASH_CONFIG) {
-      error_code = OTA_RESPONSE_ERROR_WRONG_CURRENT_FLASH_CONFIG;
-      goto error;
-    }
-    if (error == UPDATE_ERROR_SPACE) {
-      error_code = OTA_RESPONSE_ERROR_ESP8266_NOT_ENOUGH_SPACE;
-      goto error;
-    }
-#endif
-#ifdef ARDUINO_ARCH_ESP32
-    if (error == UPDATE_ERROR_SIZE) {
-      error_code = OTA_RESPONSE_ERROR_ESP32_NOT_ENOUGH_SPACE;
+  // An interrupted upload of the same size might be continued, that is decided once the MD5 is known
+  resuming = this->update_interrupted_ && (ota_features & OTA_FEATURE_RESUME) && ota_size == this->update_size_ &&
+             ota_features == this->update_features_;
+  this->update_interrupted_ = false;
+  if (!resuming) {
+    this->abort_update_();
+    if (!this->begin_update_(ota_size, ota_features, &error_code))
       goto error;
-    }
-#endif
-    ESP_LOGW(TAG, "Preparing OTA partition failed! '%s'", ss.c_str());
-    error_code = OTA_RESPONSE_ERROR_UPDATE_PREPARE;
-    goto error;
   }
-  update_started = true;
 
   // Acknowledge prepare OK - 1 byte
   this->client_.write(OTA_RESPONSE_UPDATE_PREPARE_OK);
@@ -221,29 +248,57 @@ void OTAComponent::handle_() {
   }
   sbuf[32] = '\0';
   ESP_LOGV(TAG, "Update: Binary MD5 is %s", sbuf);
-  Update.setMD5(sbuf);
 
-  // Acknowledge MD5 OK - 1 byte
-  this->client_.write(OTA_RESPONSE_BIN_MD5_OK);
+  if (resuming && strcmp(sbuf, this->update_md5_) != 0) {
+    ESP_LOGD(TAG, "Binary does not match the interrupted OTA update, starting over");
+    resuming = false;
+    this->abort_update_();
+    if (!this->begin_update_(ota_size, ota_features, &error_code))
+      goto error;
+  }
+
+  if (resuming) {
+    ESP_LOGI(TAG, "Resuming OTA update at %u of %u bytes", this->update_received_, ota_size);
+    // Acknowledge MD5 and send the offset to continue at - 5 bytes
+    this->client_.write(OTA_RESPONSE_BIN_MD5_RESUME);
+    for (uint8_t i = 0; i < 4; i++)
+      buf[i] = this->update_received_ >> (24 - 8 * i);
+    this->client_.write(buf, 4);
+  } else {
+    memcpy(this->update_md5_, sbuf, sizeof(this->update_md5_));
+#ifdef ARDUINO_ARCH_ESP32
+    if ((ota_features & OTA_FEATURE_COMPRESSION) && !(ota_features & OTA_FEATURE_DELTA)) {
+      this->stream_md5_.begin();
+    } else {
+      Update.setMD5(sbuf);
+    }
+#else
+    // the ESP8266 writes compressed binaries as they are, the bootloader decompresses them
+    Update.setMD5(sbuf);
+#endif
+
+    // Acknowledge MD5 OK - 1 byte
+    this->client_.write(OTA_RESPONSE_BIN_MD5_OK);
+  }
 
-  while (!Update.isFinished()) {
-    size_t available = this->wait_receive_(buf, 0);
+  data.reset(new uint8_t[OTA_BUFFER_SIZE]);  // NOLINT
+  while (this->update_received_ < ota_size) {
+    size_t available = this->wait_receive_(data.get(), 0);
     if (!available) {
+      connection_lost = true;
       goto error;
     }
+    available = std::min(available, size_t(ota_size - this->update_received_));
 
-    uint32_t written = Update.write(buf, available);
-    if (written != available) {
-      ESP_LOGW(TAG, "Error writing binary data to flash: %u != %u!", written, available);  // NOLINT
-      error_code = OTA_RESPONSE_ERROR_WRITING_FLASH;
+    error_code = this->write_update_(data.get(), available);
+    if (error_code != OTA_RESPONSE_OK)
       goto error;
-    }
-    total += written;
+    this->update_received_ += available;
 
     uint32_t now = millis();
     if (now - last_progress > 1000) {
       last_progress = now;
-      float percentage = (total * 100.0f) / ota_size;
+      float percentage = (this->update_received_ * 100.0f) / ota_size;
       ESP_LOGD(TAG, "OTA in progress: %0.1f%%", percentage);
 #ifdef USE_OTA_STATE_CALLBACK
       this->state_callback_.call(OTA_IN_PROGRESS, percentage, 0);
@@ -252,14 +307,40 @@ void OTAComponent::handle_() {
       delay(10);
     }
   }
+  data.reset();
+
+#ifdef ARDUINO_ARCH_ESP32
+  if ((this->update_features_ & OTA_FEATURE_COMPRESSION) && !this->inflate_done_) {
+    ESP_LOGW(TAG, "Compressed binary ended early!");
+    error_code = OTA_RESPONSE_ERROR_DECOMPRESSING;
+    goto error;
+  }
+  if ((this->update_features_ & OTA_FEATURE_COMPRESSION) && !(this->update_features_ & OTA_FEATURE_DELTA)) {
+    this->stream_md5_.calculate();
+    this->stream_md5_.getChars(sbuf);
+    if (strcmp(sbuf, this->update_md5_) != 0) {
+      ESP_LOGW(TAG, "MD5 of the compressed binary does not match: %s != %s", sbuf, this->update_md5_);
+      error_code = OTA_RESPONSE_ERROR_UPDATE_END;
+      goto error;
+    }
+  }
+  if ((this->update_features_ & OTA_FEATURE_DELTA) && (this->patch_diff_left_ != 0 || this->patch_extra_left_ != 0 ||
+                                                       this->patch_header_pos_ != 0)) {
+    ESP_LOGW(TAG, "Patch ended early!");
+    error_code = OTA_RESPONSE_ERROR_PATCH;
+    goto error;
+  }
+#endif
 
   // Acknowledge receive OK - 1 byte
   this->client_.write(OTA_RESPONSE_RECEIVE_OK);
 
-  if (!Update.end()) {
+  // the size of a decompressed binary is only known now
+  if (!Update.end(true)) {
     error_code = OTA_RESPONSE_ERROR_UPDATE_END;
     goto error;
   }
+  this->update_started_ = false;
 
   // Acknowledge Update end OK - 1 byte
   this->client_.write(OTA_RESPONSE_UPDATE_END_OK);
@@ -282,7 +363,17 @@ void OTAComponent::handle_() {
   App.safe_reboot();
 
 error:
-  if (update_started) {
+  if (connection_lost && (this->update_features_ & OTA_FEATURE_RESUME)) {
+    // keep what was written so far, the uploader reconnects and continues where the connection was lost
+    ESP_LOGW(TAG, "Connection lost after %u of %u bytes, waiting for the OTA update to be resumed",
+             this->update_received_, this->update_size_);
+    this->client_.stop();
+    this->update_interrupted_ = true;
+    this->interrupted_at_ = millis();
+    return;
+  }
+
+  if (this->update_started_) {
     StreamString ss;
     Update.printError(ss);
     ESP_LOGW(TAG, "Update end failed! Error: %s", ss.c_str());
@@ -293,21 +384,221 @@ error:
   }
   this->client_.stop();
 
+  this->abort_update_();
+
+  this->status_momentary_error("onerror", 5000);
+#ifdef USE_OTA_STATE_CALLBACK
+  this->state_callback_.call(OTA_ERROR, 0.0f, static_cast<uint8_t>(error_code));
+#endif
+}
+
+bool OTAComponent::begin_update_(uint32_t size, uint8_t features, OTAResponseTypes *error_code) {
+#ifdef ARDUINO_ARCH_ESP8266
+  global_preferences.prevent_write(true);
+#endif
+
+  size_t update_size = size;
 #ifdef ARDUINO_ARCH_ESP32
-  if (update_started) {
-    Update.abort();
+  if (features & OTA_FEATURE_COMPRESSION) {
+    // the size of the decompressed binary is not known up front, it is checked against the partition as it is written
+    update_size = UPDATE_SIZE_UNKNOWN;
+    this->inflator_.reset(new tinfl_decompressor);  // NOLINT
+    this->window_.reset(new uint8_t[OTA_INFLATE_WINDOW]);  // NOLINT
+    tinfl_init(this->inflator_.get());
+    this->window_pos_ = 0;
+    this->gzip_header_pos_ = 0;
+    this->inflate_done_ = false;
+  }
+  if (features & OTA_FEATURE_DELTA) {
+    // the size of the patched binary is only known at the end as well
+    update_size = UPDATE_SIZE_UNKNOWN;
+    this->running_partition_ = esp_ota_get_running_partition();
+    this->running_size_ = ESP.getSketchSize();
+    this->patch_header_pos_ = 0;
+    this->patch_diff_left_ = 0;
+    this->patch_extra_left_ = 0;
   }
 #endif
 
+  if (!Update.begin(update_size, U_FLASH)) {
+    uint8_t error = Update.getError();
+    StreamString ss;
+    Update.printError(ss);
 #ifdef ARDUINO_ARCH_ESP8266
-  if (update_started) {
-    Update.end();
+    if (error == UPDATE_ERROR_BOOTSTRAP) {
+      *error_code = OTA_RESPONSE_ERROR_INVALID_BOOTSTRAPPING;
+      return false;
+    }
+    if (error == UPDATE_ERROR_NEW_FLASH_CONFIG) {
+      *error_code = OTA_RESPONSE_ERROR_WRONG_NEW_FLASH_CONFIG;
+      return false;
+    }
+    if (error == UPDATE_ERROR_FLASH_CONFIG) {
+      *error_code = OTA_RESPONSE_ERROR_WRONG_CURRENT_FLASH_CONFIG;
+      return false;
+    }
+    if (error == UPDATE_ERROR_SPACE) {
+      *error_code = OTA_RESPONSE_ERROR_ESP8266_NOT_ENOUGH_SPACE;
+      return false;
+    }
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+    if (error == UPDATE_ERROR_SIZE) {
+      *error_code = OTA_RESPONSE_ERROR_ESP32_NOT_ENOUGH_SPACE;
+      return false;
+    }
+#endif
+    ESP_LOGW(TAG, "Preparing OTA partition failed! '%s'", ss.c_str());
+    *error_code = OTA_RESPONSE_ERROR_UPDATE_PREPARE;
+    return false;
+  }
+
+  this->update_started_ = true;
+  this->update_size_ = size;
+  this->update_features_ = features;
+  this->update_received_ = 0;
+  return true;
+}
+
+OTAResponseTypes OTAComponent::write_update_(uint8_t *data, size_t len) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->update_features_ & OTA_FEATURE_COMPRESSION) {
+    if (!(this->update_features_ & OTA_FEATURE_DELTA))
+      this->stream_md5_.add(data, len);
+    return this->write_compressed_(data, len);
   }
 #endif
+  return this->write_image_(data, len);
+}
 
-  this->status_momentary_error("onerror", 5000);
-#ifdef USE_OTA_STATE_CALLBACK
-  this->state_callback_.call(OTA_ERROR, 0.0f, static_cast<uint8_t>(error_code));
+OTAResponseTypes OTAComponent::write_image_(uint8_t *data, size_t len) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (this->update_features_ & OTA_FEATURE_DELTA)
+    return this->write_patch_(data, len);
+#endif
+
+  uint32_t written = Update.write(data, len);
+  if (written != len) {
+    ESP_LOGW(TAG, "Error writing binary data to flash: %u != %u!", written, len);  // NOLINT
+    return OTA_RESPONSE_ERROR_WRITING_FLASH;
+  }
+  return OTA_RESPONSE_OK;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+OTAResponseTypes OTAComponent::write_compressed_(const uint8_t *data, size_t len) {
+  // gzip header, the uploader never sets any of the optional fields
+  while (this->gzip_header_pos_ < 10 && len > 0) {
+    const uint8_t pos = this->gzip_header_pos_++;
+    const uint8_t byte = *data++;
+    len--;
+    if ((pos == 0 && byte != 0x1F) || (pos == 1 && byte != 0x8B) || (pos == 2 && byte != 8) || (pos == 3 && byte != 0)) {
+      ESP_LOGW(TAG, "Invalid gzip header!");
+      return OTA_RESPONSE_ERROR_DECOMPRESSING;
+    }
+  }
+
+  while (!this->inflate_done_) {
+    // decompress into the window, which also holds the history the compressed data refers back to
+    size_t in_len = len;
+    size_t out_len = OTA_INFLATE_WINDOW - this->window_pos_;
+    uint8_t *out = this->window_.get() + this->window_pos_;
+    tinfl_status status = tinfl_decompress(this->inflator_.get(), data, &in_len, this->window_.get(), out, &out_len,
+                                           TINFL_FLAG_HAS_MORE_INPUT);
+    data += in_len;
+    len -= in_len;
+
+    if (out_len != 0) {
+      OTAResponseTypes result = this->write_image_(out, out_len);
+      if (result != OTA_RESPONSE_OK)
+        return result;
+      this->window_pos_ = (this->window_pos_ + out_len) & (OTA_INFLATE_WINDOW - 1);
+    }
+
+    if (status == TINFL_STATUS_DONE) {
+      // only the gzip trailer is left, its CRC is covered by the MD5 of the stream
+      this->inflate_done_ = true;
+    } else if (status < TINFL_STATUS_DONE) {
+      ESP_LOGW(TAG, "Decompressing binary failed: %d", status);
+      return OTA_RESPONSE_ERROR_DECOMPRESSING;
+    } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+      break;
+    }
+  }
+  return OTA_RESPONSE_OK;
+}
+
+OTAResponseTypes OTAComponent::write_patch_(const uint8_t *data, size_t len) {
+  while (len > 0) {
+    if (this->patch_diff_left_ == 0 && this->patch_extra_left_ == 0) {
+      // header of the next record
+      size_t n = std::min(len, sizeof(this->patch_header_) - this->patch_header_pos_);
+      memcpy(this->patch_header_ + this->patch_header_pos_, data, n);
+      this->patch_header_pos_ += n;
+      data += n;
+      len -= n;
+      if (this->patch_header_pos_ < sizeof(this->patch_header_))
+        break;
+      this->patch_header_pos_ = 0;
+      this->patch_diff_left_ = encode_uint32(this->patch_header_[3], this->patch_header_[2], this->patch_header_[1],
+                                             this->patch_header_[0]);
+      this->patch_extra_left_ = encode_uint32(this->patch_header_[7], this->patch_header_[6], this->patch_header_[5],
+                                              this->patch_header_[4]);
+      this->patch_old_pos_ = encode_uint32(this->patch_header_[11], this->patch_header_[10], this->patch_header_[9],
+                                           this->patch_header_[8]);
+      if (this->patch_old_pos_ > this->running_size_ ||
+          this->patch_diff_left_ > this->running_size_ - this->patch_old_pos_) {
+        ESP_LOGW(TAG, "Patch refers to data beyond the running firmware!");
+        return OTA_RESPONSE_ERROR_PATCH;
+      }
+      continue;
+    }
+
+    uint8_t out[256];
+    size_t n;
+    if (this->patch_diff_left_ != 0) {
+      // add the difference to the running firmware
+      n = std::min(std::min(len, sizeof(out)), size_t(this->patch_diff_left_));
+      if (esp_partition_read(this->running_partition_, this->patch_old_pos_, out, n) != ESP_OK) {
+        ESP_LOGW(TAG, "Reading running firmware failed!");
+        return OTA_RESPONSE_ERROR_PATCH;
+      }
+      for (size_t i = 0; i < n; i++)
+        out[i] += data[i];
+      this->patch_old_pos_ += n;
+      this->patch_diff_left_ -= n;
+    } else {
+      n = std::min(std::min(len, sizeof(out)), size_t(this->patch_extra_left_));
+      memcpy(out, data, n);
+      this->patch_extra_left_ -= n;
+    }
+    data += n;
+    len -= n;
+
+    uint32_t written = Update.write(out, n);
+    if (written != n) {
+      ESP_LOGW(TAG, "Error writing binary data to flash: %u != %u!", written, n);  // NOLINT
+      return OTA_RESPONSE_ERROR_WRITING_FLASH;
+    }
+  }
+  return OTA_RESPONSE_OK;
+}
+#endif
+
+void OTAComponent::abort_update_() {
+  if (this->update_started_) {
+#ifdef ARDUINO_ARCH_ESP32
+    Update.abort();
+#endif
+#ifdef ARDUINO_ARCH_ESP8266
+    Update.end();
+#endif
+  }
+  this->update_started_ = false;
+  this->update_interrupted_ = false;
+#ifdef ARDUINO_ARCH_ESP32
+  this->inflator_.reset();
+  this->window_.reset();
 #endif
 
 #ifdef ARDUINO_ARCH_ESP8266
@@ -316,51 +607,38 @@ error:
 }
 
 size_t OTAComponent::wait_receive_(uint8_t *buf, size_t bytes, bool check_disconnected) {
-  size_t available = 0;
-  uint32_t start = millis();
-  do {
+  const size_t max_bytes = bytes == 0 ? OTA_BUFFER_SIZE : bytes;
+  size_t received = 0;
+  uint32_t last_data = millis();
+  while (bytes == 0 ? received == 0 : received < bytes) {
     App.feed_wdt();
-    if (check_disconnected && !this->client_.connected()) {
-      ESP_LOGW(TAG, "Error client disconnected while receiving data!");
-      return 0;
-    }
     int availi = this->client_.available();
     if (availi < 0) {
       ESP_LOGW(TAG, "Error reading data!");
       return 0;
     }
-    uint32_t now = millis();
-    if (availi == 0 && now - start > 10000) {
+    if (availi > 0) {
+      // read whatever is there, a full receive window is drained in one go
+      int res = this->client_.read(buf + received, std::min(size_t(availi), max_bytes - received));
+      if (res > 0) {
+        received += res;
+        last_data = millis();
+        continue;
+      }
+      // ESP32 implementation has an issue where calling read can fail with EAGAIN (race condition),
+      // the data is still there so just try again
+    } else if (check_disconnected && !this->client_.connected()) {
+      ESP_LOGW(TAG, "Error client disconnected while receiving data!");
+      return 0;
+    }
+    if (millis() - last_data > 10000) {
       ESP_LOGW(TAG, "Timeout waiting for data!");
       return 0;
     }
-    available = size_t(availi);
     yield();
-  } while (bytes == 0 ? available == 0 : available < bytes);
-
-  if (bytes == 0)
-    bytes = std::min(available, size_t(1024));
-
-  bool success = false;
-  for (uint32_t i = 0; !success && i < 100; i++) {
-    int res = this->client_.read(buf, bytes);
-
-    if (res != int(bytes)) {
-      // ESP32 implementation has an issue where calling read can fail with EAGAIN (race condition)
-      // so just re-try it until it works (with generous timeout of 1s)
-      // because we check with available() first this should not cause us any trouble in all other cases
-      delay(10);
-    } else {
-      success = true;
-    }
   }
 
-  if (!success) {
-    ESP_LOGW(TAG, "Reading %u bytes of binary data failed!", bytes);  // NOLINT
-    return 0;
-  }
-
-  return bytes;
+  return received;
 }
 
 void OTAComponent::set_auth_password(const std::string &password) { this->password_ = password; }
@@ -414,9 +692,6 @@ void OTAComponent::on_safe_shutdown() {
 }
 
 #ifdef USE_OTA_STATE_CALLBACK
-void OTAComponent::add_on_state_callback(std::function<void(OTAState, float, uint8_t)> &&callback) {
-  this->state_callback_.add(std::move(callback));
-}
 #endif
 
 }  // namespace ota
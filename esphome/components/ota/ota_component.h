@@ -5,6 +5,12 @@
 #include "esphome/core/helpers.h"
 #include <WiFiServer.h>
 #include <WiFiClient.h>
+#include <MD5Builder.h>
+#include <memory>
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_partition.h>
+#include <rom/miniz.h>
+#endif
 
 namespace esphome {
 namespace ota {
@@ -19,6 +25,8 @@ enum OTAResponseTypes {
   OTA_RESPONSE_BIN_MD5_OK = 67,
   OTA_RESPONSE_RECEIVE_OK = 68,
   OTA_RESPONSE_UPDATE_END_OK = 69,
+  OTA_RESPONSE_FEATURES_OK = 70,
+  OTA_RESPONSE_BIN_MD5_RESUME = 71,
 
   OTA_RESPONSE_ERROR_MAGIC = 128,
   OTA_RESPONSE_ERROR_UPDATE_PREPARE = 129,
@@ -30,9 +38,36 @@ enum OTAResponseTypes {
   OTA_RESPONSE_ERROR_WRONG_NEW_FLASH_CONFIG = 135,
   OTA_RESPONSE_ERROR_ESP8266_NOT_ENOUGH_SPACE = 136,
   OTA_RESPONSE_ERROR_ESP32_NOT_ENOUGH_SPACE = 137,
+  OTA_RESPONSE_ERROR_DECOMPRESSING = 138,
+  OTA_RESPONSE_ERROR_PATCH = 139,
   OTA_RESPONSE_ERROR_UNKNOWN = 255,
 };
 
+/** Protocol extensions, the uploader sends the ones it supports in the features byte.
+ *
+ * If any feature is requested the device answers with OTA_RESPONSE_FEATURES_OK and the subset it supports, older
+ * devices answer with OTA_RESPONSE_HEADER_OK and the upload continues without extensions.
+ */
+enum OTAFeatures {
+  /// The binary is sent gzip compressed with a window of at most 4 KiB, size and MD5 are those of the gzip stream.
+  OTA_FEATURE_COMPRESSION = 0x01,
+  /** An upload that lost its connection can be continued from where it stopped.
+   *
+   * The device then answers the MD5 of a matching interrupted upload with OTA_RESPONSE_BIN_MD5_RESUME followed by the
+   * 4 byte offset (MSB first) the uploader continues at.
+   */
+  OTA_FEATURE_RESUME = 0x02,
+  /** The binary can be sent as a patch against the running firmware.
+   *
+   * The device then sends the MD5 of the running firmware (32 bytes hex) and the uploader answers whether it sends a
+   * patch against it (1 byte). A patch is a sequence of records: the lengths of a diff and an extra block and the
+   * offset in the running firmware the diff block applies to (4 bytes LSB first each), followed by the diff block,
+   * whose bytes are added to those of the running firmware, and the extra block, which is copied. The MD5 is that of
+   * the resulting binary.
+   */
+  OTA_FEATURE_DELTA = 0x04,
+};
+
 enum OTAState { OTA_COMPLETED = 0, OTA_STARTED, OTA_IN_PROGRESS, OTA_ERROR };
 
 /// OTAComponent provides a simple way to integrate Over-the-Air updates into your app using ArduinoOTA.
@@ -53,7 +88,9 @@ class OTAComponent : public Component {
   bool should_enter_safe_mode(uint8_t num_attempts, uint32_t enable_time);
 
 #ifdef USE_OTA_STATE_CALLBACK
-  void add_on_state_callback(std::function<void(OTAState, float, uint8_t)> &&callback);
+  template<typename F> void add_on_state_callback(F &&callback) {
+    this->state_callback_.add(std::forward<F>(callback));
+  }
 #endif
 
   // ========== INTERNAL METHODS ==========
@@ -74,8 +111,22 @@ class OTAComponent : public Component {
   uint32_t read_rtc_();
 
   void handle_();
+  /// Receive exactly bytes bytes, or whatever is available up to the size of the receive buffer if bytes is 0.
   size_t wait_receive_(uint8_t *buf, size_t bytes, bool check_disconnected = true);
 
+  /// Prepare the flash for an upload of size bytes as sent over the connection.
+  bool begin_update_(uint32_t size, uint8_t features, OTAResponseTypes *error_code);
+  /// Write a piece of the uploaded binary, decompressing it if needed.
+  OTAResponseTypes write_update_(uint8_t *data, size_t len);
+  /// Write a piece of the decompressed upload, applying it as patch if needed.
+  OTAResponseTypes write_image_(uint8_t *data, size_t len);
+  /// Abort the update in progress, if any, and release everything held for it.
+  void abort_update_();
+#ifdef ARDUINO_ARCH_ESP32
+  OTAResponseTypes write_compressed_(const uint8_t *data, size_t len);
+  OTAResponseTypes write_patch_(const uint8_t *data, size_t len);
+#endif
+
   std::string password_;
 
   uint16_t port_;
@@ -90,6 +141,39 @@ class OTAComponent : public Component {
   uint8_t safe_mode_num_attempts_;
   ESPPreferenceObject rtc_;
 
+  /// Update.begin() was called for the upload in update_md5_, it is neither finished nor aborted yet.
+  bool update_started_{false};
+  /// The connection was lost during a resumable upload, which waits to be continued.
+  bool update_interrupted_{false};
+  /// millis() at which the connection of the interrupted upload was lost.
+  uint32_t interrupted_at_{0};
+  uint32_t update_size_{0};
+  /// Bytes of the upload received and written so far, where an interrupted upload continues.
+  uint32_t update_received_{0};
+  uint8_t update_features_{0};
+  char update_md5_[33];
+#ifdef ARDUINO_ARCH_ESP32
+  /// Decompression state of a compressed upload, the flash only sees the decompressed binary.
+  std::unique_ptr<tinfl_decompressor> inflator_;
+  /// The last OTA_INFLATE_WINDOW bytes of decompressed output, which compressed data can refer back to.
+  std::unique_ptr<uint8_t[]> window_;
+  size_t window_pos_{0};
+  uint8_t gzip_header_pos_{0};
+  bool inflate_done_{false};
+  /// MD5 of the compressed stream, Update can only check the MD5 of what is written to flash.
+  MD5Builder stream_md5_;
+
+  /// The partition of the running firmware, which patches are applied to.
+  const esp_partition_t *running_partition_{nullptr};
+  uint32_t running_size_{0};
+  /// The header of the current patch record: diff length, extra length and offset in the running firmware.
+  uint8_t patch_header_[12];
+  uint8_t patch_header_pos_{0};
+  uint32_t patch_diff_left_{0};
+  uint32_t patch_extra_left_{0};
+  uint32_t patch_old_pos_{0};
+#endif
+
 #ifdef USE_OTA_STATE_CALLBACK
   CallbackManager<void(OTAState, float, uint8_t)> state_callback_{};
 #endif
@@ -35,8 +35,8 @@ class PIDClimate : public climate::Climate, public Component {
   float get_proportional_term() const { return controller_.proportional_term; }
   float get_integral_term() const { return controller_.integral_term; }
   float get_derivative_term() const { return controller_.derivative_term; }
-  void add_on_pid_computed_callback(std::function<void()> &&callback) {
-    pid_computed_callback_.add(std::move(callback));
+  template<typename F> void add_on_pid_computed_callback(F &&callback) {
+    this->pid_computed_callback_.add(std::forward<F>(callback));
   }
   void set_default_target_temperature(float default_target_temperature) {
     default_target_temperature_ = default_target_temperature;
@@ -12,9 +12,7 @@ void Pipsolar::setup() {
 }
 
 void Pipsolar::empty_uart_buffer_() {
-  uint8_t byte;
-  while (this->available()) {
-    this->read_byte(&byte);
+  while (!this->read_span().empty()) {
   }
 }
 
@@ -714,29 +712,35 @@ void Pipsolar::loop() {
   }
 
   if (this->state_ == STATE_COMMAND || this->state_ == STATE_POLL) {
-    while (this->available()) {
-      uint8_t byte;
-      this->read_byte(&byte);
-
-      if (this->read_pos_ == PIPSOLAR_READ_BUFFER_LENGTH) {
-        this->read_pos_ = 0;
-        this->empty_uart_buffer_();
-      }
-      this->read_buffer_[this->read_pos_] = byte;
-      this->read_pos_++;
+    bool complete = false;
+    while (!complete) {
+      auto data = this->read_span();
+      if (data.empty())
+        break;
+      for (uint8_t byte : data) {
+        if (this->read_pos_ == PIPSOLAR_READ_BUFFER_LENGTH) {
+          this->read_pos_ = 0;
+          this->empty_uart_buffer_();
+          break;
+        }
+        this->read_buffer_[this->read_pos_] = byte;
+        this->read_pos_++;
 
-      // end of answer
-      if (byte == 0x0D) {
-        this->read_buffer_[this->read_pos_] = 0;
-        this->empty_uart_buffer_();
-        if (this->state_ == STATE_POLL) {
-          this->state_ = STATE_POLL_COMPLETE;
-        }
-        if (this->state_ == STATE_COMMAND) {
-          this->state_ = STATE_COMMAND_COMPLETE;
+        // end of answer, anything after it is dropped
+        if (byte == 0x0D) {
+          this->read_buffer_[this->read_pos_] = 0;
+          this->empty_uart_buffer_();
+          if (this->state_ == STATE_POLL) {
+            this->state_ = STATE_POLL_COMPLETE;
+          }
+          if (this->state_ == STATE_COMMAND) {
+            this->state_ = STATE_COMMAND_COMPLETE;
+          }
+          complete = true;
+          break;
         }
       }
-    }  // available
+    }
   }
   if (this->state_ == STATE_COMMAND) {
     if (millis() - this->command_start_millis_ > esphome::pipsolar::Pipsolar::COMMAND_TIMEOUT) {
@@ -54,23 +54,25 @@ void PMSX003Component::loop() {
     this->data_index_ = 0;
   }
 
-  if (this->available() == 0)
-    return;
-
-  this->last_transmission_ = now;
-  while (this->available() != 0) {
-    this->read_byte(&this->data_[this->data_index_]);
-    auto check = this->check_byte_();
-    if (!check.has_value()) {
-      // finished
-      this->parse_data_();
-      this->data_index_ = 0;
-    } else if (!*check) {
-      // wrong data
-      this->data_index_ = 0;
-    } else {
-      // next byte
-      this->data_index_++;
+  while (true) {
+    auto data = this->read_span();
+    if (data.empty())
+      break;
+    this->last_transmission_ = now;
+    for (uint8_t byte : data) {
+      this->data_[this->data_index_] = byte;
+      auto check = this->check_byte_();
+      if (!check.has_value()) {
+        // finished
+        this->parse_data_();
+        this->data_index_ = 0;
+      } else if (!*check) {
+        // wrong data
+        this->data_index_ = 0;
+      } else {
+        // next byte
+        this->data_index_++;
+      }
     }
   }
 }
@@ -1,310 +1,416 @@
 #include "prometheus_handler.h"
 #include "esphome/core/application.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
 namespace esphome {
 namespace prometheus {
 
-void PrometheusHandler::handleRequest(AsyncWebServerRequest *req) {
-  AsyncResponseStream *stream = req->beginResponseStream("text/plain");
+void append_escaped_label_value(std::string &out, const char *value) {
+  for (; *value != '\0'; value++) {
+    switch (*value) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += *value;
+        break;
+    }
+  }
+}
 
+void PrometheusHandler::setup() {
 #ifdef USE_SENSOR
-  this->sensor_type_(stream);
   for (auto *obj : App.get_sensors())
-    this->sensor_row_(stream, obj);
+    this->add_labels_(obj);
 #endif
-
 #ifdef USE_BINARY_SENSOR
-  this->binary_sensor_type_(stream);
   for (auto *obj : App.get_binary_sensors())
-    this->binary_sensor_row_(stream, obj);
+    this->add_labels_(obj);
 #endif
-
 #ifdef USE_FAN
-  this->fan_type_(stream);
   for (auto *obj : App.get_fans())
-    this->fan_row_(stream, obj);
+    this->add_labels_(obj);
 #endif
-
 #ifdef USE_LIGHT
-  this->light_type_(stream);
   for (auto *obj : App.get_lights())
-    this->light_row_(stream, obj);
+    this->add_labels_(obj);
 #endif
-
 #ifdef USE_COVER
-  this->cover_type_(stream);
   for (auto *obj : App.get_covers())
-    this->cover_row_(stream, obj);
+    this->add_labels_(obj);
 #endif
-
 #ifdef USE_SWITCH
-  this->switch_type_(stream);
   for (auto *obj : App.get_switches())
-    this->switch_row_(stream, obj);
+    this->add_labels_(obj);
+#endif
+#ifdef USE_TEXT_SENSOR
+  for (auto *obj : App.get_text_sensors())
+    this->add_labels_(obj);
+#endif
+#ifdef USE_CLIMATE
+  for (auto *obj : App.get_climates())
+    this->add_labels_(obj);
 #endif
+#ifdef USE_NUMBER
+  for (auto *obj : App.get_numbers())
+    this->add_labels_(obj);
+#endif
+#ifdef USE_SELECT
+  for (auto *obj : App.get_selects())
+    this->add_labels_(obj);
+#endif
+  std::sort(this->labels_.begin(), this->labels_.end(),
+            [](const EntityLabels &a, const EntityLabels &b) { return a.obj < b.obj; });
 
-  req->send(stream);
+  this->base_->init();
+  this->base_->add_handler(this);
+}
+void PrometheusHandler::add_labels_(Nameable *obj) {
+  if (obj->is_internal())
+    return;
+  EntityLabels entry;
+  entry.obj = obj;
+  entry.labels = "id=\"";
+  append_escaped_label_value(entry.labels, obj->get_object_id().c_str());
+  entry.labels += "\",name=\"";
+  append_escaped_label_value(entry.labels, obj->get_name().c_str());
+  entry.labels += '"';
+  this->labels_.push_back(std::move(entry));
+}
+const std::string &PrometheusHandler::get_labels(const Nameable *obj) const {
+  static const std::string EMPTY;
+  auto it = std::lower_bound(this->labels_.begin(), this->labels_.end(), obj,
+                             [](const EntityLabels &a, const Nameable *b) { return a.obj < b; });
+  if (it == this->labels_.end() || it->obj != obj)
+    return EMPTY;
+  return it->labels;
 }
 
-// Type-specific implementation
-#ifdef USE_SENSOR
-void PrometheusHandler::sensor_type_(AsyncResponseStream *stream) {
-  stream->print(F("#TYPE esphome_sensor_value GAUGE\n"));
-  stream->print(F("#TYPE esphome_sensor_failed GAUGE\n"));
+void PrometheusHandler::handleRequest(AsyncWebServerRequest *req) {
+  // The renderer is owned by the response and lives until the last chunk has been sent.
+  auto renderer = std::make_shared<MetricsRenderer>(this);
+  AsyncWebServerResponse *response = req->beginChunkedResponse(
+      "text/plain; version=0.0.4",
+      [renderer](uint8_t *buffer, size_t max_len, size_t index) -> size_t { return renderer->fill(buffer, max_len); });
+  req->send(response);
 }
-void PrometheusHandler::sensor_row_(AsyncResponseStream *stream, sensor::Sensor *obj) {
-  if (obj->is_internal())
+
+MetricsRenderer::MetricsRenderer(PrometheusHandler *handler) : handler_(handler) { this->begin(); }
+
+size_t MetricsRenderer::fill(uint8_t *buffer, size_t max_len) {
+  size_t written = 0;
+  while (written < max_len) {
+    if (this->rows_pos_ == this->rows_.size()) {
+      if (this->state_ == IteratorState::NONE)
+        break;
+      // Render the next entity, the buffer keeps its capacity so this only allocates for the first few entities.
+      this->rows_.clear();
+      this->rows_pos_ = 0;
+      this->advance();
+      continue;
+    }
+    size_t len = std::min(max_len - written, this->rows_.size() - this->rows_pos_);
+    memcpy(buffer + written, this->rows_.data() + this->rows_pos_, len);
+    written += len;
+    this->rows_pos_ += len;
+  }
+  return written;
+}
+
+void MetricsRenderer::add_type_(const char *metric, const char *help) {
+  this->rows_ += "# HELP ";
+  this->rows_ += metric;
+  this->rows_ += ' ';
+  this->rows_ += help;
+  this->rows_ += "\n# TYPE ";
+  this->rows_ += metric;
+  this->rows_ += " gauge\n";
+}
+void MetricsRenderer::add_row_(const char *metric, const std::string &labels, const char *value,
+                               const char *extra_key, const char *extra_value) {
+  this->rows_ += metric;
+  this->rows_ += '{';
+  this->rows_ += labels;
+  if (extra_key != nullptr) {
+    this->rows_ += ',';
+    this->rows_ += extra_key;
+    this->rows_ += "=\"";
+    append_escaped_label_value(this->rows_, extra_value);
+    this->rows_ += '"';
+  }
+  this->rows_ += "} ";
+  this->rows_ += value;
+  this->rows_ += '\n';
+}
+const char *MetricsRenderer::format_value_(float value, int8_t accuracy_decimals) {
+  value_accuracy_to_buf(this->value_buf_, sizeof(this->value_buf_), value, accuracy_decimals);
+  return this->value_buf_;
+}
+
+void MetricsRenderer::add_types_() {
+  if (this->types_state_ == this->state_)
     return;
+  this->types_state_ = this->state_;
+  switch (this->state_) {
+#ifdef USE_SENSOR
+    case IteratorState::SENSOR:
+      this->add_type_("esphome_sensor_value", "State of the sensor.");
+      this->add_type_("esphome_sensor_failed", "1 if the sensor has no valid state.");
+      break;
+#endif
+#ifdef USE_BINARY_SENSOR
+    case IteratorState::BINARY_SENSOR:
+      this->add_type_("esphome_binary_sensor_value", "State of the binary sensor.");
+      this->add_type_("esphome_binary_sensor_failed", "1 if the binary sensor has no state.");
+      break;
+#endif
+#ifdef USE_FAN
+    case IteratorState::FAN:
+      this->add_type_("esphome_fan_value", "1 if the fan is on.");
+      this->add_type_("esphome_fan_failed", "1 if the fan has no valid state.");
+      this->add_type_("esphome_fan_speed", "Speed level of the fan.");
+      this->add_type_("esphome_fan_oscillation", "1 if the fan is oscillating.");
+      break;
+#endif
+#ifdef USE_LIGHT
+    case IteratorState::LIGHT:
+      this->add_type_("esphome_light_state", "1 if the light is on.");
+      this->add_type_("esphome_light_color", "Brightness and color channels of the light.");
+      this->add_type_("esphome_light_effect_active", "1 if the light effect is active.");
+      break;
+#endif
+#ifdef USE_COVER
+    case IteratorState::COVER:
+      this->add_type_("esphome_cover_value", "Position of the cover.");
+      this->add_type_("esphome_cover_tilt", "Tilt of the cover.");
+      this->add_type_("esphome_cover_failed", "1 if the cover has no valid position.");
+      break;
+#endif
+#ifdef USE_SWITCH
+    case IteratorState::SWITCH:
+      this->add_type_("esphome_switch_value", "1 if the switch is on.");
+      this->add_type_("esphome_switch_failed", "1 if the switch has no valid state.");
+      break;
+#endif
+#ifdef USE_TEXT_SENSOR
+    case IteratorState::TEXT_SENSOR:
+      this->add_type_("esphome_text_sensor_value", "State of the text sensor as the value label.");
+      this->add_type_("esphome_text_sensor_failed", "1 if the text sensor has no state.");
+      break;
+#endif
+#ifdef USE_CLIMATE
+    case IteratorState::CLIMATE:
+      this->add_type_("esphome_climate_mode", "Mode of the climate device as the mode label.");
+      this->add_type_("esphome_climate_action", "Current action of the climate device as the action label.");
+      this->add_type_("esphome_climate_target_temperature", "Target temperature of the climate device.");
+      this->add_type_("esphome_climate_target_temperature_low", "Lower target temperature of the climate device.");
+      this->add_type_("esphome_climate_target_temperature_high", "Upper target temperature of the climate device.");
+      this->add_type_("esphome_climate_current_temperature", "Current temperature of the climate device.");
+      break;
+#endif
+#ifdef USE_NUMBER
+    case IteratorState::NUMBER:
+      this->add_type_("esphome_number_value", "State of the number.");
+      this->add_type_("esphome_number_failed", "1 if the number has no valid state.");
+      break;
+#endif
+#ifdef USE_SELECT
+    case IteratorState::SELECT:
+      this->add_type_("esphome_select_value", "Selected option of the select as the value label.");
+      this->add_type_("esphome_select_failed", "1 if the select has no state.");
+      break;
+#endif
+    default:
+      break;
+  }
+}
+
+// Type-specific implementation
+#ifdef USE_SENSOR
+bool MetricsRenderer::on_sensor(sensor::Sensor *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
   if (!isnan(obj->state)) {
     // We have a valid value, output this value
-    stream->print(F("esphome_sensor_failed{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} 0\n"));
+    this->add_row_("esphome_sensor_failed", labels, "0");
     // Data itself
-    stream->print(F("esphome_sensor_value{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\",unit=\""));
-    stream->print(obj->get_unit_of_measurement().c_str());
-    stream->print(F("\"} "));
-    stream->print(value_accuracy_to_string(obj->state, obj->get_accuracy_decimals()).c_str());
-    stream->print('\n');
+    this->add_row_("esphome_sensor_value", labels, this->format_value_(obj->state, obj->get_accuracy_decimals()),
+                   "unit", obj->get_unit_of_measurement().c_str());
   } else {
     // Invalid state
-    stream->print(F("esphome_sensor_failed{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} 1\n"));
+    this->add_row_("esphome_sensor_failed", labels, "1");
   }
+  return true;
 }
 #endif
 
-// Type-specific implementation
 #ifdef USE_BINARY_SENSOR
-void PrometheusHandler::binary_sensor_type_(AsyncResponseStream *stream) {
-  stream->print(F("#TYPE esphome_binary_sensor_value GAUGE\n"));
-  stream->print(F("#TYPE esphome_binary_sensor_failed GAUGE\n"));
-}
-void PrometheusHandler::binary_sensor_row_(AsyncResponseStream *stream, binary_sensor::BinarySensor *obj) {
-  if (obj->is_internal())
-    return;
+bool MetricsRenderer::on_binary_sensor(binary_sensor::BinarySensor *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
   if (obj->has_state()) {
     // We have a valid value, output this value
-    stream->print(F("esphome_binary_sensor_failed{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} 0\n"));
+    this->add_row_("esphome_binary_sensor_failed", labels, "0");
     // Data itself
-    stream->print(F("esphome_binary_sensor_value{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} "));
-    stream->print(obj->state);
-    stream->print('\n');
+    this->add_row_("esphome_binary_sensor_value", labels, obj->state ? "1" : "0");
   } else {
     // Invalid state
-    stream->print(F("esphome_binary_sensor_failed{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} 1\n"));
+    this->add_row_("esphome_binary_sensor_failed", labels, "1");
   }
+  return true;
 }
 #endif
 
 #ifdef USE_FAN
-void PrometheusHandler::fan_type_(AsyncResponseStream *stream) {
-  stream->print(F("#TYPE esphome_fan_value GAUGE\n"));
-  stream->print(F("#TYPE esphome_fan_failed GAUGE\n"));
-  stream->print(F("#TYPE esphome_fan_speed GAUGE\n"));
-  stream->print(F("#TYPE esphome_fan_oscillation GAUGE\n"));
-}
-void PrometheusHandler::fan_row_(AsyncResponseStream *stream, fan::FanState *obj) {
-  if (obj->is_internal())
-    return;
-  stream->print(F("esphome_fan_failed{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\"} 0\n"));
+bool MetricsRenderer::on_fan(fan::FanState *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
+  this->add_row_("esphome_fan_failed", labels, "0");
   // Data itself
-  stream->print(F("esphome_fan_value{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\"} "));
-  stream->print(obj->state);
-  stream->print('\n');
+  this->add_row_("esphome_fan_value", labels, obj->state ? "1" : "0");
+  const auto traits = obj->get_traits();
   // Speed if available
-  if (obj->get_traits().supports_speed()) {
-    stream->print(F("esphome_fan_speed{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} "));
-    stream->print(obj->speed);
-    stream->print('\n');
-  }
+  if (traits.supports_speed())
+    this->add_row_("esphome_fan_speed", labels, this->format_value_(obj->speed, 0));
   // Oscillation if available
-  if (obj->get_traits().supports_oscillation()) {
-    stream->print(F("esphome_fan_oscillation{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} "));
-    stream->print(obj->oscillating);
-    stream->print('\n');
-  }
+  if (traits.supports_oscillation())
+    this->add_row_("esphome_fan_oscillation", labels, obj->oscillating ? "1" : "0");
+  return true;
 }
 #endif
 
 #ifdef USE_LIGHT
-void PrometheusHandler::light_type_(AsyncResponseStream *stream) {
-  stream->print(F("#TYPE esphome_light_state GAUGE\n"));
-  stream->print(F("#TYPE esphome_light_color GAUGE\n"));
-  stream->print(F("#TYPE esphome_light_effect_active GAUGE\n"));
-}
-void PrometheusHandler::light_row_(AsyncResponseStream *stream, light::LightState *obj) {
-  if (obj->is_internal())
-    return;
+bool MetricsRenderer::on_light(light::LightState *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
   // State
-  stream->print(F("esphome_light_state{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\"} "));
-  stream->print(obj->remote_values.is_on());
-  stream->print(F("\n"));
+  this->add_row_("esphome_light_state", labels, obj->remote_values.is_on() ? "1" : "0");
   // Brightness and RGBW
   light::LightColorValues color = obj->current_values;
   float brightness, r, g, b, w;
   color.as_brightness(&brightness);
   color.as_rgbw(&r, &g, &b, &w);
-  stream->print(F("esphome_light_color{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\",channel=\"brightness\"} "));
-  stream->print(brightness);
-  stream->print(F("\n"));
-  stream->print(F("esphome_light_color{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\",channel=\"r\"} "));
-  stream->print(r);
-  stream->print(F("\n"));
-  stream->print(F("esphome_light_color{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\",channel=\"g\"} "));
-  stream->print(g);
-  stream->print(F("\n"));
-  stream->print(F("esphome_light_color{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\",channel=\"b\"} "));
-  stream->print(b);
-  stream->print(F("\n"));
-  stream->print(F("esphome_light_color{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\",channel=\"w\"} "));
-  stream->print(w);
-  stream->print(F("\n"));
+  this->add_row_("esphome_light_color", labels, this->format_value_(brightness), "channel", "brightness");
+  this->add_row_("esphome_light_color", labels, this->format_value_(r), "channel", "r");
+  this->add_row_("esphome_light_color", labels, this->format_value_(g), "channel", "g");
+  this->add_row_("esphome_light_color", labels, this->format_value_(b), "channel", "b");
+  this->add_row_("esphome_light_color", labels, this->format_value_(w), "channel", "w");
   // Effect
   std::string effect = obj->get_effect_name();
   if (effect == "None") {
-    stream->print(F("esphome_light_effect_active{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\",effect=\"None\"} 0\n"));
+    this->add_row_("esphome_light_effect_active", labels, "0", "effect", "None");
   } else {
-    stream->print(F("esphome_light_effect_active{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\",effect=\""));
-    stream->print(effect.c_str());
-    stream->print(F("\"} 1\n"));
+    this->add_row_("esphome_light_effect_active", labels, "1", "effect", effect.c_str());
   }
+  return true;
 }
 #endif
 
 #ifdef USE_COVER
-void PrometheusHandler::cover_type_(AsyncResponseStream *stream) {
-  stream->print(F("#TYPE esphome_cover_value GAUGE\n"));
-  stream->print(F("#TYPE esphome_cover_failed GAUGE\n"));
-}
-void PrometheusHandler::cover_row_(AsyncResponseStream *stream, cover::Cover *obj) {
-  if (obj->is_internal())
-    return;
+bool MetricsRenderer::on_cover(cover::Cover *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
   if (!isnan(obj->position)) {
     // We have a valid value, output this value
-    stream->print(F("esphome_cover_failed{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} 0\n"));
+    this->add_row_("esphome_cover_failed", labels, "0");
     // Data itself
-    stream->print(F("esphome_cover_value{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} "));
-    stream->print(obj->position);
-    stream->print('\n');
-    if (obj->get_traits().get_supports_tilt()) {
-      stream->print(F("esphome_cover_tilt{id=\""));
-      stream->print(obj->get_object_id().c_str());
-      stream->print(F("\",name=\""));
-      stream->print(obj->get_name().c_str());
-      stream->print(F("\"} "));
-      stream->print(obj->tilt);
-      stream->print('\n');
-    }
+    this->add_row_("esphome_cover_value", labels, this->format_value_(obj->position));
+    if (obj->get_traits().get_supports_tilt())
+      this->add_row_("esphome_cover_tilt", labels, this->format_value_(obj->tilt));
   } else {
     // Invalid state
-    stream->print(F("esphome_cover_failed{id=\""));
-    stream->print(obj->get_object_id().c_str());
-    stream->print(F("\",name=\""));
-    stream->print(obj->get_name().c_str());
-    stream->print(F("\"} 1\n"));
+    this->add_row_("esphome_cover_failed", labels, "1");
   }
+  return true;
 }
 #endif
 
 #ifdef USE_SWITCH
-void PrometheusHandler::switch_type_(AsyncResponseStream *stream) {
-  stream->print(F("#TYPE esphome_switch_value GAUGE\n"));
-  stream->print(F("#TYPE esphome_switch_failed GAUGE\n"));
-}
-void PrometheusHandler::switch_row_(AsyncResponseStream *stream, switch_::Switch *obj) {
-  if (obj->is_internal())
-    return;
-  stream->print(F("esphome_switch_failed{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\"} 0\n"));
+bool MetricsRenderer::on_switch(switch_::Switch *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
+  this->add_row_("esphome_switch_failed", labels, "0");
   // Data itself
-  stream->print(F("esphome_switch_value{id=\""));
-  stream->print(obj->get_object_id().c_str());
-  stream->print(F("\",name=\""));
-  stream->print(obj->get_name().c_str());
-  stream->print(F("\"} "));
-  stream->print(obj->state);
-  stream->print('\n');
+  this->add_row_("esphome_switch_value", labels, obj->state ? "1" : "0");
+  return true;
+}
+#endif
+
+#ifdef USE_TEXT_SENSOR
+bool MetricsRenderer::on_text_sensor(text_sensor::TextSensor *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
+  if (obj->has_state()) {
+    // Prometheus has no string values, the state is exported as a label
+    this->add_row_("esphome_text_sensor_failed", labels, "0");
+    this->add_row_("esphome_text_sensor_value", labels, "1", "value", obj->state.c_str());
+  } else {
+    this->add_row_("esphome_text_sensor_failed", labels, "1");
+  }
+  return true;
+}
+#endif
+
+#ifdef USE_CLIMATE
+bool MetricsRenderer::on_climate(climate::Climate *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
+  auto traits = obj->get_traits();
+  int8_t accuracy = traits.get_temperature_accuracy_decimals();
+  this->add_row_("esphome_climate_mode", labels, "1", "mode", climate::climate_mode_to_string(obj->mode));
+  if (traits.get_supports_action())
+    this->add_row_("esphome_climate_action", labels, "1", "action", climate::climate_action_to_string(obj->action));
+  if (traits.get_supports_two_point_target_temperature()) {
+    this->add_row_("esphome_climate_target_temperature_low", labels,
+                   this->format_value_(obj->target_temperature_low, accuracy));
+    this->add_row_("esphome_climate_target_temperature_high", labels,
+                   this->format_value_(obj->target_temperature_high, accuracy));
+  } else {
+    this->add_row_("esphome_climate_target_temperature", labels,
+                   this->format_value_(obj->target_temperature, accuracy));
+  }
+  if (traits.get_supports_current_temperature() && !isnan(obj->current_temperature))
+    this->add_row_("esphome_climate_current_temperature", labels,
+                   this->format_value_(obj->current_temperature, accuracy));
+  return true;
+}
+#endif
+
+#ifdef USE_NUMBER
+bool MetricsRenderer::on_number(number::Number *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
+  if (obj->has_state() && !isnan(obj->state)) {
+    this->add_row_("esphome_number_failed", labels, "0");
+    this->add_row_("esphome_number_value", labels, this->format_value_(obj->state, 6));
+  } else {
+    this->add_row_("esphome_number_failed", labels, "1");
+  }
+  return true;
+}
+#endif
+
+#ifdef USE_SELECT
+bool MetricsRenderer::on_select(select::Select *obj) {
+  this->add_types_();
+  const std::string &labels = this->handler_->get_labels(obj);
+  if (obj->has_state()) {
+    // Prometheus has no string values, the selected option is exported as a label
+    this->add_row_("esphome_select_failed", labels, "0");
+    this->add_row_("esphome_select_value", labels, "1", "value", obj->state.c_str());
+  } else {
+    this->add_row_("esphome_select_failed", labels, "1");
+  }
+  return true;
 }
 #endif
 
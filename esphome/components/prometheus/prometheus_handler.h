@@ -3,10 +3,77 @@
 #include "esphome/components/web_server_base/web_server_base.h"
 #include "esphome/core/controller.h"
 #include "esphome/core/component.h"
+#include "esphome/core/component_iterator.h"
+#include "esphome/core/helpers.h"
+
+#include <string>
+#include <vector>
 
 namespace esphome {
 namespace prometheus {
 
+class PrometheusHandler;
+
+/** Renders the metrics of all entities for one request, one entity at a time.
+ *
+ * The rows of the current entity are formatted into a small reusable buffer and copied into the chunks of the
+ * response as the connection asks for more data, so the full response never has to be held in memory.
+ */
+class MetricsRenderer : public ComponentIterator {
+ public:
+  explicit MetricsRenderer(PrometheusHandler *handler);
+
+  /// Fill buffer with up to max_len bytes of the response, returns 0 once all metrics have been written.
+  size_t fill(uint8_t *buffer, size_t max_len);
+
+#ifdef USE_BINARY_SENSOR
+  bool on_binary_sensor(binary_sensor::BinarySensor *obj) override;
+#endif
+#ifdef USE_COVER
+  bool on_cover(cover::Cover *obj) override;
+#endif
+#ifdef USE_FAN
+  bool on_fan(fan::FanState *obj) override;
+#endif
+#ifdef USE_LIGHT
+  bool on_light(light::LightState *obj) override;
+#endif
+#ifdef USE_SENSOR
+  bool on_sensor(sensor::Sensor *obj) override;
+#endif
+#ifdef USE_SWITCH
+  bool on_switch(switch_::Switch *obj) override;
+#endif
+#ifdef USE_TEXT_SENSOR
+  bool on_text_sensor(text_sensor::TextSensor *obj) override;
+#endif
+#ifdef USE_CLIMATE
+  bool on_climate(climate::Climate *obj) override;
+#endif
+#ifdef USE_NUMBER
+  bool on_number(number::Number *obj) override;
+#endif
+#ifdef USE_SELECT
+  bool on_select(select::Select *obj) override;
+#endif
+
+ protected:
+  /// Write the HELP and TYPE lines of the current platform, once before its first entity.
+  void add_types_();
+  void add_type_(const char *metric, const char *help);
+  /// Write a row `metric{<labels>,extra_key="extra_value"} value`, the extra label is optional.
+  void add_row_(const char *metric, const std::string &labels, const char *value, const char *extra_key = nullptr,
+                const char *extra_value = nullptr);
+  /// Format value into the value buffer.
+  const char *format_value_(float value, int8_t accuracy_decimals = 2);
+
+  PrometheusHandler *handler_;
+  std::string rows_;
+  size_t rows_pos_{0};
+  IteratorState types_state_{IteratorState::NONE};
+  char value_buf_[VALUE_ACCURACY_MAX_LEN];
+};
+
 class PrometheusHandler : public AsyncWebHandler, public Component {
  public:
   PrometheusHandler(web_server_base::WebServerBase *base) : base_(base) {}
@@ -22,60 +89,30 @@ class PrometheusHandler : public AsyncWebHandler, public Component {
 
   void handleRequest(AsyncWebServerRequest *req) override;
 
-  void setup() override {
-    this->base_->init();
-    this->base_->add_handler(this);
-  }
+  void setup() override;
   float get_setup_priority() const override {
     // After WiFi
     return setup_priority::WIFI - 1.0f;
   }
 
- protected:
-#ifdef USE_SENSOR
-  /// Return the type for prometheus
-  void sensor_type_(AsyncResponseStream *stream);
-  /// Return the sensor state as prometheus data point
-  void sensor_row_(AsyncResponseStream *stream, sensor::Sensor *obj);
-#endif
-
-#ifdef USE_BINARY_SENSOR
-  /// Return the type for prometheus
-  void binary_sensor_type_(AsyncResponseStream *stream);
-  /// Return the sensor state as prometheus data point
-  void binary_sensor_row_(AsyncResponseStream *stream, binary_sensor::BinarySensor *obj);
-#endif
-
-#ifdef USE_FAN
-  /// Return the type for prometheus
-  void fan_type_(AsyncResponseStream *stream);
-  /// Return the sensor state as prometheus data point
-  void fan_row_(AsyncResponseStream *stream, fan::FanState *obj);
-#endif
-
-#ifdef USE_LIGHT
-  /// Return the type for prometheus
-  void light_type_(AsyncResponseStream *stream);
-  /// Return the Light Values state as prometheus data point
-  void light_row_(AsyncResponseStream *stream, light::LightState *obj);
-#endif
+  /// Get the cached `id="...",name="..."` labels of an entity.
+  const std::string &get_labels(const Nameable *obj) const;
 
-#ifdef USE_COVER
-  /// Return the type for prometheus
-  void cover_type_(AsyncResponseStream *stream);
-  /// Return the switch Values state as prometheus data point
-  void cover_row_(AsyncResponseStream *stream, cover::Cover *obj);
-#endif
+ protected:
+  struct EntityLabels {
+    const Nameable *obj;
+    std::string labels;
+  };
 
-#ifdef USE_SWITCH
-  /// Return the type for prometheus
-  void switch_type_(AsyncResponseStream *stream);
-  /// Return the switch Values state as prometheus data point
-  void switch_row_(AsyncResponseStream *stream, switch_::Switch *obj);
-#endif
+  void add_labels_(Nameable *obj);
 
   web_server_base::WebServerBase *base_;
+  /// Label strings of all entities, sorted by entity pointer.
+  std::vector<EntityLabels> labels_;
 };
 
+/// Append value to out, escaped for use as a Prometheus label value.
+void append_escaped_label_value(std::string &out, const char *value);
+
 }  // namespace prometheus
 }  // namespace esphome
@@ -17,7 +17,7 @@ class PZEMDC : public PollingComponent, public modbus::ModbusDevice {
 
   void update() override;
 
-  void on_modbus_data(const std::vector<uint8_t> &data) override;
+  void on_modbus_data(Span<const uint8_t> data) override;
 
   void dump_config() override;
 
@@ -67,12 +67,12 @@ class RotaryEncoderSensor : public sensor::Sensor, public Component {
 
   float get_setup_priority() const override;
 
-  void add_on_clockwise_callback(std::function<void()> callback) {
-    this->on_clockwise_callback_.add(std::move(callback));
+  template<typename F> void add_on_clockwise_callback(F &&callback) {
+    this->on_clockwise_callback_.add(std::forward<F>(callback));
   }
 
-  void add_on_anticlockwise_callback(std::function<void()> callback) {
-    this->on_anticlockwise_callback_.add(std::move(callback));
+  template<typename F> void add_on_anticlockwise_callback(F &&callback) {
+    this->on_anticlockwise_callback_.add(std::forward<F>(callback));
   }
 
  protected:
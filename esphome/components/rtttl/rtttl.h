@@ -20,8 +20,8 @@ class Rtttl : public Component {
   bool is_playing() { return note_duration_ != 0; }
   void loop() override;
 
-  void add_on_finished_playback_callback(std::function<void()> callback) {
-    this->on_finished_playback_callback_.add(std::move(callback));
+  template<typename F> void add_on_finished_playback_callback(F &&callback) {
+    this->on_finished_playback_callback_.add(std::forward<F>(callback));
   }
 
  protected:
@@ -78,7 +78,9 @@ async def to_code(config):
         triggers.append((trigger, conf))
 
     for trigger, conf in triggers:
-        await automation.build_automation(trigger, [], conf)
+        obj = await automation.build_automation(trigger, [], conf)
+        # Tells script.wait and script.is_running when an instance has finished
+        cg.add(obj.add_action(trigger.get_finished_action()))
 
 
 @automation.register_action(
@@ -6,13 +6,15 @@ namespace script {
 
 static const char *const TAG = "script";
 
+void ScriptFinishedAction::play_complex() { this->script_->state_callback_.call(); }
+
 void SingleScript::execute() {
   if (this->is_action_running()) {
     ESP_LOGW(TAG, "Script '%s' is already running! (mode: single)", this->name_.c_str());
     return;
   }
 
-  this->trigger();
+  this->start_();
 }
 
 void RestartScript::execute() {
@@ -21,7 +23,7 @@ void RestartScript::execute() {
     this->stop_action();
   }
 
-  this->trigger();
+  this->start_();
 }
 
 void QueueingScript::execute() {
@@ -38,7 +40,7 @@ void QueueingScript::execute() {
     return;
   }
 
-  this->trigger();
+  this->start_();
   // Check if the trigger was immediate and we can continue right away.
   this->loop();
 }
@@ -51,7 +53,7 @@ void QueueingScript::stop() {
 void QueueingScript::loop() {
   if (this->num_runs_ != 0 && !this->is_action_running()) {
     this->num_runs_--;
-    this->trigger();
+    this->start_();
   }
 }
 
@@ -60,7 +62,7 @@ void ParallelScript::execute() {
     ESP_LOGW(TAG, "Script '%s' maximum number of parallel runs exceeded!", this->name_.c_str());
     return;
   }
-  this->trigger();
+  this->start_();
 }
 
 }  // namespace script
@@ -6,6 +6,22 @@
 namespace esphome {
 namespace script {
 
+class Script;
+
+/// The last action of every script, tells the script that one of its instances has finished.
+class ScriptFinishedAction : public Action<> {
+ public:
+  explicit ScriptFinishedAction(Script *script) : script_(script) {}
+
+  // Not counted as running, so that the script is no longer running when the callbacks are called
+  void play_complex() override;
+
+ protected:
+  void play() override {}
+
+  Script *script_;
+};
+
 /// The abstract base class for all script types.
 class Script : public Trigger<> {
  public:
@@ -17,13 +33,34 @@ class Script : public Trigger<> {
   /// Check if any instance of this script is currently running.
   virtual bool is_running() { return this->is_action_running(); }
   /// Stop all instances of this script.
-  virtual void stop() { this->stop_action(); }
+  virtual void stop() {
+    this->stop_action();
+    this->state_callback_.call();
+  }
 
   // Internal function to give scripts readable names.
   void set_name(const std::string &name) { name_ = name; }
 
+  /// The action that codegen appends to the actions of this script.
+  Action<> *get_finished_action() { return &this->finished_action_; }
+
+  /// Add a callback that is called whenever an instance of this script has started or finished.
+  template<typename F> void add_on_state_callback(F &&callback) {
+    this->state_callback_.add(std::forward<F>(callback));
+  }
+
  protected:
+  friend ScriptFinishedAction;
+
+  /// Start a new instance of this script.
+  void start_() {
+    this->trigger();
+    this->state_callback_.call();
+  }
+
   std::string name_;
+  ScriptFinishedAction finished_action_{this};
+  CallbackManager<void()> state_callback_;
 };
 
 /** A script type for which only a single instance at a time is allowed.
@@ -101,15 +138,26 @@ template<typename... Ts> class IsRunningCondition : public Condition<Ts...> {
   explicit IsRunningCondition(Script *parent) : parent_(parent) {}
 
   bool check(Ts... x) override { return this->parent_->is_running(); }
+  bool add_listener(ConditionListener *listener) override {
+    this->parent_->add_on_state_callback([listener]() { listener->on_condition_change(); });
+    return true;
+  }
 
  protected:
   Script *parent_;
 };
 
+/// Waits until the script has finished, woken up by the state callback of the script instead of polling it.
 template<typename... Ts> class ScriptWaitAction : public Action<Ts...>, public Component {
  public:
   ScriptWaitAction(Script *script) : script_(script) {}
 
+  void setup() override {
+    this->script_->add_on_state_callback([this]() { this->loop(); });
+    if (this->num_running_ == 0)
+      this->disable_loop();
+  }
+
   void play_complex(Ts... x) override {
     this->num_running_++;
     // Check if we can continue immediately.
@@ -118,17 +166,26 @@ template<typename... Ts> class ScriptWaitAction : public Action<Ts...>, public C
       return;
     }
     this->var_ = std::make_tuple(x...);
-    this->loop();
   }
 
   void loop() override {
-    if (this->num_running_ == 0)
+    if (this->num_running_ == 0) {
+      this->disable_loop();
       return;
+    }
 
-    if (this->script_->is_running())
+    if (this->script_->is_running()) {
+      this->disable_loop();
       return;
+    }
 
     this->play_next_tuple_(this->var_);
+    // Further waiting instances continue one per loop iteration
+    if (this->num_running_ == 0) {
+      this->disable_loop();
+    } else {
+      this->enable_loop();
+    }
   }
 
   float get_setup_priority() const override { return setup_priority::DATA; }
@@ -137,6 +194,8 @@ template<typename... Ts> class ScriptWaitAction : public Action<Ts...>, public C
   }
 
  protected:
+  void stop() override { this->disable_loop(); }
+
   Script *script_;
   std::tuple<Ts...> var_{};
 };
@@ -10,7 +10,7 @@ static const char *const TAG = "sdm_meter";
 static const uint8_t MODBUS_CMD_READ_IN_REGISTERS = 0x04;
 static const uint8_t MODBUS_REGISTER_COUNT = 80;  // 74 x 16-bit registers
 
-void SDMMeter::on_modbus_data(const std::vector<uint8_t> &data) {
+void SDMMeter::on_modbus_data(Span<const uint8_t> data) {
   if (data.size() < MODBUS_REGISTER_COUNT * 2) {
     ESP_LOGW(TAG, "Invalid size for SDMMeter!");
     return;
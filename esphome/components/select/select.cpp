@@ -33,10 +33,6 @@ void Select::publish_state(const std::string &state) {
   this->state_callback_.call(state);
 }
 
-void Select::add_on_state_callback(std::function<void(std::string)> &&callback) {
-  this->state_callback_.add(std::move(callback));
-}
-
 uint32_t Select::hash_base() { return 2812997003UL; }
 
 }  // namespace select
@@ -42,8 +42,8 @@ class Sim800LComponent : public uart::UARTDevice, public PollingComponent {
   void update() override;
   void loop() override;
   void dump_config() override;
-  void add_on_sms_received_callback(std::function<void(std::string, std::string)> callback) {
-    this->callback_.add(std::move(callback));
+  template<typename F> void add_on_sms_received_callback(F &&callback) {
+    this->callback_.add(std::forward<F>(callback));
   }
   void send_sms(const std::string &recipient, const std::string &message);
   void dial(const std::string &recipient);
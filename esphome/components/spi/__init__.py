@@ -31,6 +31,10 @@ CONFIG_SCHEMA = cv.All(
 )
 
 
+def _is_internal_pin(pin_config):
+    return not any(key in pin_config for key in pins.PIN_SCHEMA_REGISTRY)
+
+
 @coroutine_with_priority(1.0)
 async def to_code(config):
     cg.add_global(spi_ns.using)
@@ -45,6 +49,9 @@ async def to_code(config):
     if CONF_MOSI_PIN in config:
         mosi = await cg.gpio_pin_expression(config[CONF_MOSI_PIN])
         cg.add(var.set_mosi(mosi))
+    pin_keys = [CONF_CLK_PIN, CONF_MISO_PIN, CONF_MOSI_PIN]
+    if all(_is_internal_pin(config[key]) for key in pin_keys if key in config):
+        cg.add(var.set_internal_pins(True))
 
 
 def spi_device_schema(cs_pin_required=True):
@@ -3,6 +3,8 @@
 #include "esphome/core/helpers.h"
 #include "esphome/core/application.h"
 
+#include <utility>
+
 namespace esphome {
 namespace spi {
 
@@ -76,6 +78,11 @@ void SPIComponent::setup() {
     this->mosi_->setup();
     this->mosi_->digital_write(false);
   }
+
+  // Pins on I/O expanders can only be driven through their GPIOPin
+  this->fast_gpio_ = this->internal_pins_ && make_fast_pin_(this->clk_, &this->clk_fast_) &&
+                     (this->miso_ == nullptr || make_fast_pin_(this->miso_, &this->miso_fast_)) &&
+                     (this->mosi_ == nullptr || make_fast_pin_(this->mosi_, &this->mosi_fast_));
 }
 void SPIComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "SPI bus:");
@@ -83,6 +90,9 @@ void SPIComponent::dump_config() {
   LOG_PIN("  MISO Pin: ", this->miso_);
   LOG_PIN("  MOSI Pin: ", this->mosi_);
   ESP_LOGCONFIG(TAG, "  Using HW SPI: %s", YESNO(this->hw_spi_ != nullptr));
+  if (this->hw_spi_ == nullptr) {
+    ESP_LOGCONFIG(TAG, "  Direct GPIO Access: %s", YESNO(this->fast_gpio_));
+  }
 }
 float SPIComponent::get_setup_priority() const { return setup_priority::BUS; }
 
@@ -94,25 +104,65 @@ void SPIComponent::debug_rx(uint8_t value) {
 }
 void SPIComponent::debug_enable(uint8_t pin) { ESP_LOGVV(TAG, "Enabling SPI Chip on pin %u...", pin); }
 
-void SPIComponent::cycle_clock_(bool value) {
+bool SPIComponent::make_fast_pin_(GPIOPin *pin, FastPin *fast) {
+  const uint8_t num = pin->get_pin();
+#ifdef ARDUINO_ARCH_ESP8266
+  // GPIO16 is not part of the regular GPIO registers
+  if (num >= 16)
+    return false;
+  fast->set = &GPOS;
+  fast->clear = &GPOC;
+  fast->read = &GPI;
+  fast->mask = 1UL << num;
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+#ifdef CONFIG_IDF_TARGET_ESP32C3
+  fast->set = &GPIO.out_w1ts.val;
+  fast->clear = &GPIO.out_w1tc.val;
+  fast->read = &GPIO.in.val;
+#else
+  fast->set = num < 32 ? &GPIO.out_w1ts : &GPIO.out1_w1ts.val;
+  fast->clear = num < 32 ? &GPIO.out_w1tc : &GPIO.out1_w1tc.val;
+  fast->read = num < 32 ? &GPIO.in : &GPIO.in1.val;
+#endif
+  fast->mask = num < 32 ? (1UL << num) : (1UL << (num - 32));
+#endif
+  fast->inverted = pin->is_inverted();
+  if (fast->inverted)
+    std::swap(fast->set, fast->clear);
+  return true;
+}
+
+// NOLINTNEXTLINE
+#pragma GCC optimize("unroll-loops")
+// NOLINTNEXTLINE
+#pragma GCC optimize("O2")
+
+template<bool FAST_GPIO> void ALWAYS_INLINE SPIComponent::write_pin_(GPIOPin *pin, const FastPin &fast, bool value) {
+  if (FAST_GPIO) {
+    *(value ? fast.set : fast.clear) = fast.mask;
+  } else {
+    pin->digital_write(value);
+  }
+}
+template<bool FAST_GPIO> bool ALWAYS_INLINE SPIComponent::read_pin_(GPIOPin *pin, const FastPin &fast) {
+  if (FAST_GPIO)
+    return bool(*fast.read & fast.mask) != fast.inverted;
+  return pin->digital_read();
+}
+template<bool FAST_GPIO> void ALWAYS_INLINE SPIComponent::cycle_clock_(bool value) {
   uint32_t start = ESP.getCycleCount();
   while (start - ESP.getCycleCount() < this->wait_cycle_)
     ;
-  this->clk_->digital_write(value);
+  this->write_pin_<FAST_GPIO>(this->clk_, this->clk_fast_, value);
   start += this->wait_cycle_;
   while (start - ESP.getCycleCount() < this->wait_cycle_)
     ;
 }
 
-// NOLINTNEXTLINE
-#pragma GCC optimize("unroll-loops")
-// NOLINTNEXTLINE
-#pragma GCC optimize("O2")
-
-template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, bool READ, bool WRITE>
-uint8_t HOT SPIComponent::transfer_(uint8_t data) {
-  // Clock starts out at idle level
-  this->clk_->digital_write(CLOCK_POLARITY);
+template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, bool READ, bool WRITE,
+         bool FAST_GPIO>
+uint8_t ALWAYS_INLINE SPIComponent::transfer_bits_(uint8_t data) {
   uint8_t out_data = 0;
 
   for (uint8_t i = 0; i < 8; i++) {
@@ -125,30 +175,30 @@ uint8_t HOT SPIComponent::transfer_(uint8_t data) {
     if (CLOCK_PHASE == CLOCK_PHASE_LEADING) {
       // sampling on leading edge
       if (WRITE) {
-        this->mosi_->digital_write(data & (1 << shift));
+        this->write_pin_<FAST_GPIO>(this->mosi_, this->mosi_fast_, data & (1 << shift));
       }
 
       // SAMPLE!
-      this->cycle_clock_(!CLOCK_POLARITY);
+      this->cycle_clock_<FAST_GPIO>(!CLOCK_POLARITY);
 
       if (READ) {
-        out_data |= uint8_t(this->miso_->digital_read()) << shift;
+        out_data |= uint8_t(this->read_pin_<FAST_GPIO>(this->miso_, this->miso_fast_)) << shift;
       }
 
-      this->cycle_clock_(CLOCK_POLARITY);
+      this->cycle_clock_<FAST_GPIO>(CLOCK_POLARITY);
     } else {
       // sampling on trailing edge
-      this->cycle_clock_(!CLOCK_POLARITY);
+      this->cycle_clock_<FAST_GPIO>(!CLOCK_POLARITY);
 
       if (WRITE) {
-        this->mosi_->digital_write(data & (1 << shift));
+        this->write_pin_<FAST_GPIO>(this->mosi_, this->mosi_fast_, data & (1 << shift));
       }
 
       // SAMPLE!
-      this->cycle_clock_(CLOCK_POLARITY);
+      this->cycle_clock_<FAST_GPIO>(CLOCK_POLARITY);
 
       if (READ) {
-        out_data |= uint8_t(this->miso_->digital_read()) << shift;
+        out_data |= uint8_t(this->read_pin_<FAST_GPIO>(this->miso_, this->miso_fast_)) << shift;
       }
     }
   }
@@ -162,11 +212,33 @@ uint8_t HOT SPIComponent::transfer_(uint8_t data) {
   }
 #endif
 
-  App.feed_wdt();
-
   return out_data;
 }
 
+template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, bool READ, bool WRITE>
+void HOT SPIComponent::transfer_burst_(const uint8_t *tx, uint8_t *rx, size_t length) {
+  if (this->fast_gpio_) {
+    // Clock starts out at idle level
+    this->write_pin_<true>(this->clk_, this->clk_fast_, CLOCK_POLARITY);
+    for (size_t i = 0; i < length; i++) {
+      uint8_t out_data = this->transfer_bits_<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE, READ, WRITE, true>(
+          WRITE ? tx[i] : 0x00);
+      if (READ)
+        rx[i] = out_data;
+      App.feed_wdt();
+    }
+  } else {
+    this->write_pin_<false>(this->clk_, this->clk_fast_, CLOCK_POLARITY);
+    for (size_t i = 0; i < length; i++) {
+      uint8_t out_data = this->transfer_bits_<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE, READ, WRITE, false>(
+          WRITE ? tx[i] : 0x00);
+      if (READ)
+        rx[i] = out_data;
+      App.feed_wdt();
+    }
+  }
+}
+
 // Generate with (py3):
 //
 // from itertools import product
@@ -179,57 +251,57 @@ uint8_t HOT SPIComponent::transfer_(uint8_t data) {
 // for b, cpol, cph, r, w in product(bit_orders, clock_pols, clock_phases, reads, writes):
 //     if not r and not w:
 //         continue
-//     print(f"template uint8_t SPIComponent::transfer_<{b}, {cpol}, {cph}, {cpp_bool[r]}, {cpp_bool[w]}>(uint8_t
-//     data);")
-
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, false, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, true, false>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, true, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, false, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, true, false>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, true, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, false, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, true, false>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, true, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, false, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, true, false>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, true, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, false, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, true, false>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, true, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, false, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, true, false>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, true, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, false, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, true, false>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, true, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, false, true>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, true, false>(
-    uint8_t data);
-template uint8_t SPIComponent::transfer_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, true, true>(
-    uint8_t data);
+//     print(f"template void SPIComponent::transfer_burst_<{b}, {cpol}, {cph}, {cpp_bool[r]}, {cpp_bool[w]}>(")
+//     print("    const uint8_t *tx, uint8_t *rx, size_t length);")
+
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, false, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, true, false>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, true, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, false, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, true, false>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, true, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, false, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, true, false>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, true, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, false, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, true, false>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_LSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, true, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, false, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, true, false>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_LEADING, true, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, false, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, true, false>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_LOW, CLOCK_PHASE_TRAILING, true, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, false, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, true, false>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_LEADING, true, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, false, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, true, false>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
+template void SPIComponent::transfer_burst_<BIT_ORDER_MSB_FIRST, CLOCK_POLARITY_HIGH, CLOCK_PHASE_TRAILING, true, true>(
+    const uint8_t *tx, uint8_t *rx, size_t length);
 
 }  // namespace spi
 }  // namespace esphome
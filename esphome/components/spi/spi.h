@@ -66,6 +66,8 @@ class SPIComponent : public Component {
   void set_clk(GPIOPin *clk) { clk_ = clk; }
   void set_miso(GPIOPin *miso) { miso_ = miso; }
   void set_mosi(GPIOPin *mosi) { mosi_ = mosi; }
+  /// Set when all pins of the bus are internal GPIOs, their registers can then be written directly in software SPI.
+  void set_internal_pins(bool internal_pins) { internal_pins_ = internal_pins; }
 
   void setup() override;
 
@@ -84,9 +86,7 @@ class SPIComponent : public Component {
       this->hw_spi_->transfer(data, length);
       return;
     }
-    for (size_t i = 0; i < length; i++) {
-      data[i] = this->read_byte<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE>();
-    }
+    this->transfer_burst_<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE, true, false>(nullptr, data, length);
   }
 
   template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE>
@@ -129,9 +129,7 @@ class SPIComponent : public Component {
       this->hw_spi_->writeBytes(data_c, length);
       return;
     }
-    for (size_t i = 0; i < length; i++) {
-      this->write_byte<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE>(data[i]);
-    }
+    this->transfer_burst_<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE, false, true>(data, nullptr, length);
   }
 
   template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE>
@@ -159,9 +157,7 @@ class SPIComponent : public Component {
     }
 
     if (this->miso_ != nullptr) {
-      for (size_t i = 0; i < length; i++) {
-        data[i] = this->transfer_byte<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE>(data[i]);
-      }
+      this->transfer_burst_<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE, true, true>(data, data, length);
     } else {
       this->write_array<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE>(data, length);
     }
@@ -193,14 +189,43 @@ class SPIComponent : public Component {
   float get_setup_priority() const override;
 
  protected:
-  inline void cycle_clock_(bool value);
+  /// The registers and bit mask of an internal GPIO pin, set and clear are swapped for inverted pins.
+  struct FastPin {
+    volatile uint32_t *set;
+    volatile uint32_t *clear;
+    volatile uint32_t *read;
+    uint32_t mask;
+    bool inverted;
+  };
+
+  static bool make_fast_pin_(GPIOPin *pin, FastPin *fast);
+
+  template<bool FAST_GPIO> inline void write_pin_(GPIOPin *pin, const FastPin &fast, bool value);
+  template<bool FAST_GPIO> inline bool read_pin_(GPIOPin *pin, const FastPin &fast);
+  template<bool FAST_GPIO> inline void cycle_clock_(bool value);
 
   static void debug_enable(uint8_t pin);
   static void debug_tx(uint8_t value);
   static void debug_rx(uint8_t value);
 
   template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, bool READ, bool WRITE>
-  uint8_t transfer_(uint8_t data);
+  uint8_t transfer_(uint8_t data) {
+    uint8_t out_data = 0;
+    this->transfer_burst_<BIT_ORDER, CLOCK_POLARITY, CLOCK_PHASE, READ, WRITE>(&data, &out_data, 1);
+    return out_data;
+  }
+
+  /** Transfer length bytes in software SPI, tx is only used if WRITE and rx only if READ (they may be the same).
+   *
+   * The pins are resolved once for the whole burst and the watchdog is fed after every byte, like a transfer of
+   * single bytes did.
+   */
+  template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, bool READ, bool WRITE>
+  void transfer_burst_(const uint8_t *tx, uint8_t *rx, size_t length);
+
+  template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, bool READ, bool WRITE,
+           bool FAST_GPIO>
+  inline uint8_t transfer_bits_(uint8_t data);
 
   GPIOPin *clk_;
   GPIOPin *miso_{nullptr};
@@ -208,6 +233,12 @@ class SPIComponent : public Component {
   GPIOPin *active_cs_{nullptr};
   SPIClass *hw_spi_{nullptr};
   uint32_t wait_cycle_;
+  bool internal_pins_{false};
+  /// Whether the software SPI writes the GPIO registers directly instead of going through GPIOPin.
+  bool fast_gpio_{false};
+  FastPin clk_fast_{};
+  FastPin miso_fast_{};
+  FastPin mosi_fast_{};
 };
 
 template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, SPIDataRate DATA_RATE>
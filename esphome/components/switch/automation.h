@@ -41,6 +41,10 @@ template<typename... Ts> class SwitchCondition : public Condition<Ts...> {
  public:
   SwitchCondition(Switch *parent, bool state) : parent_(parent), state_(state) {}
   bool check(Ts... x) override { return this->parent_->state == this->state_; }
+  bool add_listener(ConditionListener *listener) override {
+    this->parent_->add_on_state_callback([listener](bool state) { listener->on_condition_change(); });
+    return true;
+  }
 
  protected:
   Switch *parent_;
@@ -13,8 +13,6 @@ void TCA9548AComponent::setup() {
     ESP_LOGI(TAG, "TCA9548A failed");
     return;
   }
-  // out of range to make sure on first set_channel a new one will be set
-  this->current_channelno_ = 8;
   ESP_LOGCONFIG(TAG, "Channels currently open: %d", status);
 }
 void TCA9548AComponent::dump_config() {
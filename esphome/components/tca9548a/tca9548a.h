@@ -13,10 +13,12 @@ class TCA9548AComponent : public Component, public i2c::I2CMultiplexer {
   void dump_config() override;
   void update();
   void set_channel(uint8_t channelno) override;
+  uint8_t get_channel() const override { return this->current_channelno_; }
 
  protected:
   bool scan_;
-  uint8_t current_channelno_;
+  // out of range to make sure on first set_channel a new one will be set
+  uint8_t current_channelno_{8};
 };
 }  // namespace tca9548a
 }  // namespace esphome
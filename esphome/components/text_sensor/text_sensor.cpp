@@ -16,9 +16,6 @@ void TextSensor::publish_state(const std::string &state) {
   this->callback_.call(state);
 }
 void TextSensor::set_icon(const std::string &icon) { this->icon_ = icon; }
-void TextSensor::add_on_state_callback(std::function<void(std::string)> callback) {
-  this->callback_.add(std::move(callback));
-}
 std::string TextSensor::get_icon() {
   if (this->icon_.has_value())
     return *this->icon_;
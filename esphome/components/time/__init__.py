@@ -36,9 +36,12 @@ _LOGGER = logging.getLogger(__name__)
 CODEOWNERS = ["@OttoWinter"]
 IS_PLATFORM_COMPONENT = True
 
+CONF_CRON_SCHEDULER_ID = "cron_scheduler_id"
+
 time_ns = cg.esphome_ns.namespace("time")
 RealTimeClock = time_ns.class_("RealTimeClock", cg.PollingComponent)
-CronTrigger = time_ns.class_("CronTrigger", automation.Trigger.template(), cg.Component)
+CronTrigger = time_ns.class_("CronTrigger", automation.Trigger.template())
+CronScheduler = time_ns.class_("CronScheduler", cg.Component)
 SyncTrigger = time_ns.class_("SyncTrigger", automation.Trigger.template(), cg.Component)
 ESPTime = time_ns.struct("ESPTime")
 TimeHasTimeCondition = time_ns.class_("TimeHasTimeCondition", Condition)
@@ -357,6 +360,7 @@ def validate_tz(value):
 TIME_SCHEMA = cv.Schema(
     {
         cv.Optional(CONF_TIMEZONE, default=detect_tz): validate_tz,
+        cv.GenerateID(CONF_CRON_SCHEDULER_ID): cv.declare_id(CronScheduler),
         cv.Optional(CONF_ON_TIME): automation.validate_automation(
             {
                 cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(CronTrigger),
@@ -383,6 +387,10 @@ TIME_SCHEMA = cv.Schema(
 async def setup_time_core_(time_var, config):
     cg.add(time_var.set_timezone(config[CONF_TIMEZONE]))
 
+    if config.get(CONF_ON_TIME):
+        scheduler = cg.new_Pvariable(config[CONF_CRON_SCHEDULER_ID], time_var)
+        await cg.register_component(scheduler, {})
+
     for conf in config.get(CONF_ON_TIME, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], time_var)
 
@@ -399,7 +407,7 @@ async def setup_time_core_(time_var, config):
         days_of_week = conf.get(CONF_DAYS_OF_WEEK, list(range(1, 8)))
         cg.add(trigger.add_days_of_week(days_of_week))
 
-        await cg.register_component(trigger, conf)
+        cg.add(scheduler.add_trigger(trigger))
         await automation.build_automation(trigger, [], conf)
 
     for conf in config.get(CONF_ON_TIME_SYNC, []):
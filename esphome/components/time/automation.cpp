@@ -1,11 +1,48 @@
 #include "automation.h"
 #include "esphome/core/log.h"
 
+#include <algorithm>
+#include <sys/time.h>
+
 namespace esphome {
 namespace time {
 
 static const char *const TAG = "automation";
 
+static uint8_t days_in_month(uint8_t month, uint16_t year) {
+  static const uint8_t DAYS_IN_MONTH[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if (month == 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)))
+    return 29;
+  return DAYS_IN_MONTH[month - 1];
+}
+
+/// Convert a local time to the first timestamp at or after min_timestamp, 0 if the local time doesn't exist then.
+static time_t local_to_epoch(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second,
+                             time_t min_timestamp) {
+  time_t result = 0;
+  // A local time that occurs twice when DST ends has one timestamp with and one without DST
+  for (int is_dst = 0; is_dst < 2; is_dst++) {
+    struct tm c_tm {};
+    c_tm.tm_year = year - 1900;
+    c_tm.tm_mon = month - 1;
+    c_tm.tm_mday = day;
+    c_tm.tm_hour = hour;
+    c_tm.tm_min = minute;
+    c_tm.tm_sec = second;
+    c_tm.tm_isdst = is_dst;
+    const time_t timestamp = ::mktime(&c_tm);
+    if (timestamp == time_t(-1) || timestamp < min_timestamp)
+      continue;
+    // mktime() moves local times that don't exist, like the ones skipped when DST begins
+    const ESPTime check = ESPTime::from_epoch_local(timestamp);
+    if (check.second != second || check.minute != minute || check.hour != hour || check.day_of_month != day)
+      continue;
+    if (result == 0 || timestamp < result)
+      result = timestamp;
+  }
+  return result;
+}
+
 void CronTrigger::add_second(uint8_t second) { this->seconds_[second] = true; }
 void CronTrigger::add_minute(uint8_t minute) { this->minutes_[minute] = true; }
 void CronTrigger::add_hour(uint8_t hour) { this->hours_[hour] = true; }
@@ -16,40 +53,87 @@ bool CronTrigger::matches(const ESPTime &time) {
   return time.is_valid() && this->seconds_[time.second] && this->minutes_[time.minute] && this->hours_[time.hour] &&
          this->days_of_month_[time.day_of_month] && this->months_[time.month] && this->days_of_week_[time.day_of_week];
 }
-void CronTrigger::loop() {
-  ESPTime time = this->rtc_->now();
-  if (!time.is_valid())
-    return;
-
-  if (this->last_check_.has_value()) {
-    if (*this->last_check_ > time && this->last_check_->timestamp - time.timestamp > 900) {
-      // We went back in time (a lot), probably caused by time synchronization
-      ESP_LOGW(TAG, "Time has jumped back!");
-    } else if (*this->last_check_ >= time) {
-      // already handled this one
-      return;
+time_t CronTrigger::next_match_after(time_t timestamp) const {
+  const time_t start = timestamp + 1;
+  time_t match = this->next_match_from_(start);
+  if (match == 0)
+    return 0;
+  if (ESPTime::from_epoch_local(start).is_dst && !ESPTime::from_epoch_local(match).is_dst) {
+    // DST ends before the match, so the local times of the hour before the change occur a second time after it.
+    // Search again from the first second without DST.
+    time_t with_dst = start, without_dst = match;
+    while (without_dst - with_dst > 1) {
+      const time_t mid = with_dst + (without_dst - with_dst) / 2;
+      if (ESPTime::from_epoch_local(mid).is_dst) {
+        with_dst = mid;
+      } else {
+        without_dst = mid;
+      }
     }
+    const time_t repeated = this->next_match_from_(without_dst);
+    if (repeated != 0 && repeated < match)
+      match = repeated;
+  }
+  return match;
+}
+time_t CronTrigger::next_match_from_(time_t start) const {
+  const ESPTime from = ESPTime::from_epoch_local(start);
+  uint16_t year = from.year;
+  uint8_t month = from.month, day = from.day_of_month, day_of_week = from.day_of_week;
+  uint8_t hour = from.hour, minute = from.minute, second = from.second;
 
-    while (true) {
-      this->last_check_->increment_second();
-      if (*this->last_check_ >= time)
-        break;
-
-      if (this->matches(*this->last_check_))
-        this->trigger();
+  // A day that matches all fields can be up to 28 years away (29th of February on a certain weekday)
+  while (year <= from.year + 28) {
+    const uint8_t month_days = days_in_month(month, year);
+    if (!this->months_[month]) {
+      // Skip the rest of the month
+      day_of_week = (day_of_week - 1 + month_days - day + 1) % 7 + 1;
+      day = month_days + 1;
+    } else if (this->days_of_month_[day] && this->days_of_week_[day_of_week] &&
+               this->next_time_of_day_(hour, minute, second)) {
+      const time_t match = local_to_epoch(year, month, day, hour, minute, second, start);
+      if (match != 0)
+        return match;
+      // This local time doesn't exist, continue one second later
+      if (++second < 60)
+        continue;
+      second = 0;
+      if (++minute < 60)
+        continue;
+      minute = 0;
+      if (++hour < 24)
+        continue;
+      day++;
+      day_of_week = day_of_week % 7 + 1;
+    } else {
+      day++;
+      day_of_week = day_of_week % 7 + 1;
+    }
+    hour = minute = second = 0;
+    if (day > month_days) {
+      day = 1;
+      if (++month > 12) {
+        month = 1;
+        year++;
+      }
     }
   }
-
-  this->last_check_ = time;
-  if (!time.fields_in_range()) {
-    ESP_LOGW(TAG, "Time is out of range!");
-    ESP_LOGD(TAG, "Second=%02u Minute=%02u Hour=%02u DayOfWeek=%u DayOfMonth=%u DayOfYear=%u Month=%u time=%ld",
-             time.second, time.minute, time.hour, time.day_of_week, time.day_of_month, time.day_of_year, time.month,
-             time.timestamp);
+  return 0;
+}
+bool CronTrigger::next_time_of_day_(uint8_t &hour, uint8_t &minute, uint8_t &second) const {
+  for (; hour < 24; hour++, minute = 0, second = 0) {
+    if (!this->hours_[hour])
+      continue;
+    for (; minute < 60; minute++, second = 0) {
+      if (!this->minutes_[minute])
+        continue;
+      for (; second < 60; second++) {
+        if (this->seconds_[second])
+          return true;
+      }
+    }
   }
-
-  if (this->matches(time))
-    this->trigger();
+  return false;
 }
 CronTrigger::CronTrigger(RealTimeClock *rtc) : rtc_(rtc) {}
 void CronTrigger::add_seconds(const std::vector<uint8_t> &seconds) {
@@ -76,7 +160,94 @@ void CronTrigger::add_days_of_week(const std::vector<uint8_t> &days_of_week) {
   for (uint8_t it : days_of_week)
     this->add_day_of_week(it);
 }
-float CronTrigger::get_setup_priority() const { return setup_priority::HARDWARE; }
+
+/// Don't sleep longer than this, to notice when the time jumped without a time sync (SNTP adjusts it on its own).
+static const time_t MAX_CRON_SLEEP = 60;
+/// Time changes by more than this are handled like a time sync.
+static const time_t MAX_CRON_DRIFT = 900;
+
+void CronScheduler::setup() {
+  this->rtc_->add_on_time_sync_callback([this]() { this->reschedule_(); });
+  // Some clocks keep the time across a reboot or have synchronized it already
+  this->reschedule_();
+}
+// After all time sources, the local time is only correct once the RTC has applied the timezone in call_setup()
+float CronScheduler::get_setup_priority() const { return setup_priority::LATE; }
+bool CronScheduler::fires_later_(const CronTrigger *a, const CronTrigger *b) { return a->next_fire_ > b->next_fire_; }
+void CronScheduler::reschedule_() {
+  const time_t now = this->rtc_->timestamp_now();
+  if (!ESPTime::from_epoch_local(now).is_valid())
+    return;
+
+  // Triggers skipped by a small correction still fire, after larger jumps they are only rescheduled
+  const bool fire_missed = now >= this->last_check_ && now - this->last_check_ <= MAX_CRON_DRIFT;
+  std::vector<CronTrigger *> due;
+  for (auto *trigger : this->triggers_) {
+    if (trigger->next_fire_ != 0 && trigger->next_fire_ <= now) {
+      // Jumped forward over the fire time: fire once instead of for every match that was skipped
+      if (fire_missed)
+        due.push_back(trigger);
+      trigger->next_fire_ = trigger->next_match_after(now);
+    } else {
+      // Not scheduled yet, or jumped back: the current second can still fire
+      trigger->next_fire_ = trigger->next_match_after(now - 1);
+    }
+  }
+  this->heap_.clear();
+  for (auto *trigger : this->triggers_) {
+    if (trigger->next_fire_ != 0)
+      this->heap_.push_back(trigger);
+  }
+  std::make_heap(this->heap_.begin(), this->heap_.end(), CronScheduler::fires_later_);
+  this->last_check_ = now;
+
+  if (!due.empty())
+    ESP_LOGD(TAG, "Time has changed, firing %u missed time triggers", static_cast<unsigned>(due.size()));
+  // Only fire once the heap is consistent again, the actions might synchronize the time
+  for (auto *trigger : due)
+    trigger->trigger();
+  this->process_();
+}
+void CronScheduler::process_() {
+  const time_t now = this->rtc_->timestamp_now();
+  if (now + MAX_CRON_DRIFT < this->last_check_ || now > this->last_check_ + MAX_CRON_SLEEP + MAX_CRON_DRIFT) {
+    ESP_LOGW(TAG, "Time has jumped!");
+    this->reschedule_();
+    return;
+  }
+  this->last_check_ = now;
+
+  std::vector<CronTrigger *> due;
+  while (!this->heap_.empty() && this->heap_.front()->next_fire_ <= now) {
+    std::pop_heap(this->heap_.begin(), this->heap_.end(), CronScheduler::fires_later_);
+    CronTrigger *trigger = this->heap_.back();
+    due.push_back(trigger);
+    trigger->next_fire_ = trigger->next_match_after(trigger->next_fire_);
+    if (trigger->next_fire_ != 0) {
+      std::push_heap(this->heap_.begin(), this->heap_.end(), CronScheduler::fires_later_);
+    } else {
+      this->heap_.pop_back();
+    }
+  }
+  this->schedule_timeout_();
+
+  for (auto *trigger : due)
+    trigger->trigger();
+}
+void CronScheduler::schedule_timeout_() {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  uint32_t delay = MAX_CRON_SLEEP * 1000;
+  if (!this->heap_.empty()) {
+    const time_t next = this->heap_.front()->next_fire_;
+    if (next <= now.tv_sec) {
+      delay = 0;
+    } else if (next - now.tv_sec <= MAX_CRON_SLEEP) {
+      delay = (next - now.tv_sec) * 1000 - now.tv_usec / 1000;
+    }
+  }
+  this->set_timeout("cron", delay, [this]() { this->process_(); });
+}
 
 SyncTrigger::SyncTrigger(RealTimeClock *rtc) : rtc_(rtc) {
   rtc->add_on_time_sync_callback([this]() { this->trigger(); });
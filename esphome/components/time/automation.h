@@ -4,10 +4,14 @@
 #include "esphome/core/automation.h"
 #include "real_time_clock.h"
 
+#include <vector>
+
 namespace esphome {
 namespace time {
 
-class CronTrigger : public Trigger<>, public Component {
+class CronScheduler;
+
+class CronTrigger : public Trigger<> {
  public:
   explicit CronTrigger(RealTimeClock *rtc);
   void add_second(uint8_t second);
@@ -23,10 +27,21 @@ class CronTrigger : public Trigger<>, public Component {
   void add_day_of_week(uint8_t day_of_week);
   void add_days_of_week(const std::vector<uint8_t> &days_of_week);
   bool matches(const ESPTime &time);
-  void loop() override;
-  float get_setup_priority() const override;
+  /** The first time after the given one at which this trigger matches in local time, 0 if there is none.
+   *
+   * Local times that don't exist because of a DST change are skipped and local times that occur twice match twice,
+   * just like when checking every second of local time.
+   */
+  time_t next_match_after(time_t timestamp) const;
 
  protected:
+  friend CronScheduler;
+
+  /// The first time at or after start at which the local time fields match, without handling a repeated hour.
+  time_t next_match_from_(time_t start) const;
+  /// Find the first time of day at or after the given one that matches, returns false if there is none that day.
+  bool next_time_of_day_(uint8_t &hour, uint8_t &minute, uint8_t &second) const;
+
   std::bitset<61> seconds_;
   std::bitset<60> minutes_;
   std::bitset<24> hours_;
@@ -34,7 +49,38 @@ class CronTrigger : public Trigger<>, public Component {
   std::bitset<13> months_;
   std::bitset<8> days_of_week_;
   RealTimeClock *rtc_;
-  optional<ESPTime> last_check_;
+  /// The time this trigger fires next, 0 if it isn't scheduled.
+  time_t next_fire_{0};
+};
+
+/** Fires the cron triggers of one clock.
+ *
+ * The next fire time of each trigger is computed from its fields and kept in a min-heap, and a single timeout is set
+ * for the earliest one, so the triggers cost nothing between firings. After the time has jumped, triggers that were
+ * due in between fire once and all fire times are computed again.
+ */
+class CronScheduler : public Component {
+ public:
+  explicit CronScheduler(RealTimeClock *rtc) : rtc_(rtc) {}
+  void add_trigger(CronTrigger *trigger) { this->triggers_.push_back(trigger); }
+  void setup() override;
+  float get_setup_priority() const override;
+
+ protected:
+  /// Catch up after the time was set and compute all fire times from the current time.
+  void reschedule_();
+  /// Fire all triggers that are due and set the timeout for the next one.
+  void process_();
+  void schedule_timeout_();
+  /// Heap order, the trigger that fires first is at the front.
+  static bool fires_later_(const CronTrigger *a, const CronTrigger *b);
+
+  RealTimeClock *rtc_;
+  std::vector<CronTrigger *> triggers_;
+  /// The scheduled triggers, a min-heap by next_fire_.
+  std::vector<CronTrigger *> heap_;
+  /// The time of the last check, used to detect time jumps that weren't reported by a time sync.
+  time_t last_check_{0};
 };
 
 class SyncTrigger : public Trigger<>, public Component {
@@ -124,8 +124,8 @@ class RealTimeClock : public PollingComponent {
 
   void call_setup() override;
 
-  void add_on_time_sync_callback(std::function<void()> callback) {
-    this->time_sync_callback_.add(std::move(callback));
+  template<typename F> void add_on_time_sync_callback(F &&callback) {
+    this->time_sync_callback_.add(std::forward<F>(callback));
   };
 
  protected:
@@ -27,18 +27,19 @@ void TMP102Component::dump_config() {
 }
 
 void TMP102Component::update() {
-  uint16_t raw_temperature;
-  if (!this->read_byte_16(TMP102_REGISTER_TEMPERATURE, &raw_temperature, 50)) {
-    this->status_set_warning();
-    return;
-  }
-
-  raw_temperature = raw_temperature >> 4;
-  float temperature = raw_temperature * TMP102_CONVERSION_FACTOR;
-  ESP_LOGD(TAG, "Got Temperature=%.1f°C", temperature);
-
-  this->publish_state(temperature);
-  this->status_clear_warning();
+  this->read_bytes_async(TMP102_REGISTER_TEMPERATURE, 2, 50, [this](bool success, const uint8_t *data) {
+    if (!success) {
+      this->status_set_warning();
+      return;
+    }
+
+    uint16_t raw_temperature = encode_uint16(data[0], data[1]) >> 4;
+    float temperature = raw_temperature * TMP102_CONVERSION_FACTOR;
+    ESP_LOGD(TAG, "Got Temperature=%.1f°C", temperature);
+
+    this->publish_state(temperature);
+    this->status_clear_warning();
+  });
 }
 
 float TMP102Component::get_setup_priority() const { return setup_priority::DATA; }
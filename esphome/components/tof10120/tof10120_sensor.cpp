@@ -30,23 +30,24 @@ void TOF10120Sensor::update() {
     return;
   }
 
-  uint8_t data[2];
-  if (!this->read_bytes(TOF10120_DISTANCE_REGISTER, data, 2, TOF10120_DEFAULT_DELAY)) {
-    ESP_LOGE(TAG, "Communication with TOF10120 failed on read");
-    this->status_set_warning();
-    return;
-  }
-
-  uint32_t distance_mm = (data[0] << 8) | data[1];
-  ESP_LOGI(TAG, "Data read: %dmm", distance_mm);
-
-  if (distance_mm == TOF10120_OUT_OF_RANGE_VALUE) {
-    ESP_LOGW(TAG, "Distance measurement out of range");
-    this->publish_state(NAN);
-  } else {
-    this->publish_state(distance_mm / 1000.0);
-  }
-  this->status_clear_warning();
+  this->read_bytes_async(TOF10120_DISTANCE_REGISTER, 2, TOF10120_DEFAULT_DELAY, [this](bool ok, const uint8_t *data) {
+    if (!ok) {
+      ESP_LOGE(TAG, "Communication with TOF10120 failed on read");
+      this->status_set_warning();
+      return;
+    }
+
+    uint32_t distance_mm = (data[0] << 8) | data[1];
+    ESP_LOGI(TAG, "Data read: %dmm", distance_mm);
+
+    if (distance_mm == TOF10120_OUT_OF_RANGE_VALUE) {
+      ESP_LOGW(TAG, "Distance measurement out of range");
+      this->publish_state(NAN);
+    } else {
+      this->publish_state(distance_mm / 1000.0);
+    }
+    this->status_clear_warning();
+  });
 }
 
 }  // namespace tof10120
@@ -3,6 +3,9 @@
 #include "esphome/core/util.h"
 #include "esphome/core/helpers.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace esphome {
 namespace tuya {
 
@@ -15,10 +18,12 @@ void Tuya::setup() {
 }
 
 void Tuya::loop() {
-  while (this->available()) {
-    uint8_t c;
-    this->read_byte(&c);
-    this->handle_char_(c);
+  while (true) {
+    auto data = this->read_span();
+    if (data.empty())
+      break;
+    for (uint8_t c : data)
+      this->handle_char_(c);
   }
   process_command_queue_();
 }
@@ -31,15 +36,17 @@ void Tuya::dump_config() {
     ESP_LOGCONFIG(TAG, "  If no further output is received, confirm that this is a supported Tuya device.");
     return;
   }
-  for (auto &info : this->datapoints_) {
+  for (auto &stored : this->datapoints_) {
+    auto &info = stored.datapoint;
     if (info.type == TuyaDatapointType::RAW)
-      ESP_LOGCONFIG(TAG, "  Datapoint %u: raw (value: %s)", info.id, hexencode(info.value_raw).c_str());
+      ESP_LOGCONFIG(TAG, "  Datapoint %u: raw (value: %s)", info.id, hexencode(stored.value).c_str());
     else if (info.type == TuyaDatapointType::BOOLEAN)
       ESP_LOGCONFIG(TAG, "  Datapoint %u: switch (value: %s)", info.id, ONOFF(info.value_bool));
     else if (info.type == TuyaDatapointType::INTEGER)
       ESP_LOGCONFIG(TAG, "  Datapoint %u: int value (value: %d)", info.id, info.value_int);
     else if (info.type == TuyaDatapointType::STRING)
-      ESP_LOGCONFIG(TAG, "  Datapoint %u: string value (value: %s)", info.id, info.value_string.c_str());
+      ESP_LOGCONFIG(TAG, "  Datapoint %u: string value (value: %s)", info.id,
+                    std::string(stored.value.begin(), stored.value.end()).c_str());
     else if (info.type == TuyaDatapointType::ENUM)
       ESP_LOGCONFIG(TAG, "  Datapoint %u: enum (value: %d)", info.id, info.value_enum);
     else if (info.type == TuyaDatapointType::BITMASK)
@@ -55,68 +62,59 @@ void Tuya::dump_config() {
   this->check_uart_settings(9600);
 }
 
-bool Tuya::validate_message_() {
-  uint32_t at = this->rx_message_.size() - 1;
-  auto *data = &this->rx_message_[0];
-  uint8_t new_byte = data[at];
+void Tuya::handle_char_(uint8_t c) {
+  const size_t at = this->rx_len_;
 
   // Byte 0: HEADER1 (always 0x55)
-  if (at == 0)
-    return new_byte == 0x55;
   // Byte 1: HEADER2 (always 0xAA)
-  if (at == 1)
-    return new_byte == 0xAA;
+  if ((at == 0 && c != 0x55) || (at == 1 && c != 0xAA)) {
+    // a header byte that arrived in place of the second one starts a new frame
+    this->rx_len_ = 0;
+    if (c != 0x55)
+      return;
+  }
+  this->last_rx_char_timestamp_ = millis();
 
   // Byte 2: VERSION
-  // no validation for the following fields:
-  uint8_t version = data[2];
-  if (at == 2)
-    return true;
   // Byte 3: COMMAND
-  uint8_t command = data[3];
-  if (at == 3)
-    return true;
-
   // Byte 4: LENGTH1
   // Byte 5: LENGTH2
-  if (at <= 5)
-    // no validation for these fields
-    return true;
-
-  uint16_t length = (uint16_t(data[4]) << 8) | (uint16_t(data[5]));
+  // no validation for these fields, except for the length limit
+  uint8_t *data = this->rx_buffer_;
+  if (this->rx_len_ < TUYA_HEADER_LENGTH) {
+    if (this->rx_len_ == 0)
+      this->rx_checksum_ = 0;
+    data[this->rx_len_++] = c;
+    this->rx_checksum_ += c;
+    if (this->rx_len_ == TUYA_HEADER_LENGTH && encode_uint16(data[4], data[5]) > TUYA_MAX_PAYLOAD_LENGTH) {
+      ESP_LOGW(TAG, "Tuya Received message larger than %u bytes, dropping it", TUYA_MAX_PAYLOAD_LENGTH);
+      this->rx_len_ = 0;
+    }
+    return;
+  }
 
   // wait until all data is read
-  if (at - 6 < length)
-    return true;
+  const size_t length = encode_uint16(data[4], data[5]);
+  if (this->rx_len_ < TUYA_HEADER_LENGTH + length) {
+    data[this->rx_len_++] = c;
+    this->rx_checksum_ += c;
+    return;
+  }
 
   // Byte 6+LEN: CHECKSUM - sum of all bytes (including header) modulo 256
-  uint8_t rx_checksum = new_byte;
-  uint8_t calc_checksum = 0;
-  for (uint32_t i = 0; i < 6 + length; i++)
-    calc_checksum += data[i];
-
-  if (rx_checksum != calc_checksum) {
-    ESP_LOGW(TAG, "Tuya Received invalid message checksum %02X!=%02X", rx_checksum, calc_checksum);
-    return false;
+  this->rx_len_ = 0;
+  if (c != this->rx_checksum_) {
+    ESP_LOGW(TAG, "Tuya Received invalid message checksum %02X!=%02X", c, this->rx_checksum_);
+    return;
   }
 
-  // valid message
-  const uint8_t *message_data = data + 6;
+  // valid message, handled in place: the buffer is only reused by the next frame
+  const uint8_t version = data[2];
+  const uint8_t command = data[3];
+  const uint8_t *message_data = data + TUYA_HEADER_LENGTH;
   ESP_LOGV(TAG, "Received Tuya: CMD=0x%02X VERSION=%u DATA=[%s] INIT_STATE=%u", command, version,
            hexencode(message_data, length).c_str(), static_cast<uint8_t>(this->init_state_));
   this->handle_command_(command, version, message_data, length);
-
-  // return false to reset rx buffer
-  return false;
-}
-
-void Tuya::handle_char_(uint8_t c) {
-  this->rx_message_.push_back(c);
-  if (!this->validate_message_()) {
-    this->rx_message_.clear();
-  } else {
-    this->last_rx_char_timestamp_ = millis();
-  }
 }
 
 void Tuya::handle_command_(uint8_t command, uint8_t version, const uint8_t *buffer, size_t len) {
@@ -195,7 +193,7 @@ void Tuya::handle_command_(uint8_t command, uint8_t version, const uint8_t *buff
         this->init_state_ = TuyaInitState::INIT_DONE;
         this->set_timeout("datapoint_dump", 1000, [this] { this->dump_config(); });
       }
-      this->handle_datapoint_(buffer, len);
+      this->handle_datapoints_(buffer, len);
       break;
     case TuyaCommandType::DATAPOINT_QUERY:
       break;
@@ -220,15 +218,26 @@ void Tuya::handle_command_(uint8_t command, uint8_t version, const uint8_t *buff
   }
 }
 
-void Tuya::handle_datapoint_(const uint8_t *buffer, size_t len) {
-  if (len < 2)
-    return;
-
-  TuyaDatapoint datapoint{};
-  datapoint.id = buffer[0];
-  datapoint.type = (TuyaDatapointType) buffer[1];
-  datapoint.value_uint = 0;
+void Tuya::handle_datapoints_(const uint8_t *buffer, size_t len) {
+  // A report may contain several datapoints, each one is id, type, length and value
+  while (len >= 4) {
+    TuyaDatapoint datapoint{};
+    datapoint.id = buffer[0];
+    datapoint.type = (TuyaDatapointType) buffer[1];
+    datapoint.value_uint = 0;
+    datapoint.len = encode_uint16(buffer[2], buffer[3]);
+    datapoint.value_raw = buffer + 4;
+    if (datapoint.len > len - 4) {
+      ESP_LOGW(TAG, "Datapoint %u is not expected size (%zu > %zu)", datapoint.id, datapoint.len, len - 4);
+      return;
+    }
+    buffer += 4 + datapoint.len;
+    len -= 4 + datapoint.len;
+    this->handle_datapoint_(datapoint);
+  }
+}
 
+void Tuya::handle_datapoint_(TuyaDatapoint datapoint) {
   // Drop update if datapoint is in ignore_mcu_datapoint_update list
   for (uint8_t i : this->ignore_mcu_update_on_datapoints_) {
     if (datapoint.id == i) {
@@ -237,19 +246,11 @@ void Tuya::handle_datapoint_(const uint8_t *buffer, size_t len) {
     }
   }
 
-  size_t data_size = (buffer[2] << 8) + buffer[3];
-  const uint8_t *data = buffer + 4;
-  size_t data_len = len - 4;
-  if (data_size != data_len) {
-    ESP_LOGW(TAG, "Datapoint %u is not expected size (%zu != %zu)", datapoint.id, data_size, data_len);
-    return;
-  }
-  datapoint.len = data_len;
-
+  const uint8_t *data = datapoint.value_raw;
+  const size_t data_len = datapoint.len;
   switch (datapoint.type) {
     case TuyaDatapointType::RAW:
-      datapoint.value_raw = std::vector<uint8_t>(data, data + data_len);
-      ESP_LOGD(TAG, "Datapoint %u update to %s", datapoint.id, hexencode(datapoint.value_raw).c_str());
+      ESP_LOGD(TAG, "Datapoint %u update to %s", datapoint.id, hexencode(data, data_len).c_str());
       break;
     case TuyaDatapointType::BOOLEAN:
       if (data_len != 1) {
@@ -268,8 +269,7 @@ void Tuya::handle_datapoint_(const uint8_t *buffer, size_t len) {
       ESP_LOGD(TAG, "Datapoint %u update to %d", datapoint.id, datapoint.value_int);
       break;
     case TuyaDatapointType::STRING:
-      datapoint.value_string = std::string(reinterpret_cast<const char *>(data), data_len);
-      ESP_LOGD(TAG, "Datapoint %u update to %s", datapoint.id, datapoint.value_string.c_str());
+      ESP_LOGD(TAG, "Datapoint %u update to %.*s", datapoint.id, (int) data_len, reinterpret_cast<const char *>(data));
       break;
     case TuyaDatapointType::ENUM:
       if (data_len != 1) {
@@ -301,25 +301,28 @@ void Tuya::handle_datapoint_(const uint8_t *buffer, size_t len) {
       return;
   }
 
-  // Update internal datapoints
-  bool found = false;
-  for (auto &other : this->datapoints_) {
-    if (other.id == datapoint.id) {
-      other = datapoint;
-      found = true;
-    }
+  // Update internal datapoints, only the values of RAW and STRING datapoints are copied
+  StoredDatapoint *stored = this->get_datapoint_(datapoint.id);
+  if (stored == nullptr) {
+    this->datapoints_.push_back(StoredDatapoint{datapoint, {}});
+    stored = &this->datapoints_.back();
   }
-  if (!found) {
-    this->datapoints_.push_back(datapoint);
+  stored->datapoint = datapoint;
+  if (datapoint.type == TuyaDatapointType::RAW || datapoint.type == TuyaDatapointType::STRING) {
+    stored->value.assign(data, data + data_len);
+  } else {
+    stored->value.clear();
   }
 
-  // Run through listeners
-  for (auto &listener : this->listeners_)
-    if (listener.datapoint_id == datapoint.id)
-      listener.on_datapoint(datapoint);
+  // Run through the listeners of this datapoint
+  auto it =
+      std::lower_bound(this->listeners_.begin(), this->listeners_.end(), datapoint.id,
+                       [](const TuyaDatapointListener &listener, uint8_t id) { return listener.datapoint_id < id; });
+  for (; it != this->listeners_.end() && it->datapoint_id == datapoint.id; it++)
+    it->on_datapoint(datapoint);
 }
 
-void Tuya::send_raw_command_(TuyaCommand command) {
+void Tuya::send_raw_command_(const TuyaCommand &command) {
   uint8_t len_hi = (uint8_t)(command.payload.size() >> 8);
   uint8_t len_lo = (uint8_t)(command.payload.size() & 0xFF);
   uint8_t version = 0;
@@ -363,7 +366,7 @@ void Tuya::process_command_queue_() {
   uint32_t delay = now - this->last_command_timestamp_;
 
   if (now - this->last_rx_char_timestamp_ > RECEIVE_TIMEOUT) {
-    this->rx_message_.clear();
+    this->rx_len_ = 0;
   }
 
   if (this->expected_response_.has_value() && delay > RECEIVE_TIMEOUT) {
@@ -371,15 +374,15 @@ void Tuya::process_command_queue_() {
   }
 
   // Left check of delay since last command in case there's ever a command sent by calling send_raw_command_ directly
-  if (delay > COMMAND_DELAY && !this->command_queue_.empty() && this->rx_message_.empty() &&
+  if (delay > COMMAND_DELAY && !this->command_queue_.empty() && this->rx_len_ == 0 &&
       !this->expected_response_.has_value()) {
     this->send_raw_command_(command_queue_.front());
     this->command_queue_.erase(command_queue_.begin());
   }
 }
 
-void Tuya::send_command_(const TuyaCommand &command) {
-  command_queue_.push_back(command);
+void Tuya::send_command_(TuyaCommand command) {
+  command_queue_.push_back(std::move(command));
   process_command_queue_();
 }
 
@@ -439,17 +442,17 @@ void Tuya::send_local_time_() {
 
 void Tuya::set_raw_datapoint_value(uint8_t datapoint_id, const std::vector<uint8_t> &value) {
   ESP_LOGD(TAG, "Setting datapoint %u to %s", datapoint_id, hexencode(value).c_str());
-  optional<TuyaDatapoint> datapoint = this->get_datapoint_(datapoint_id);
-  if (!datapoint.has_value()) {
+  StoredDatapoint *datapoint = this->get_datapoint_(datapoint_id);
+  if (datapoint == nullptr) {
     ESP_LOGW(TAG, "Setting unknown datapoint %u", datapoint_id);
-  } else if (datapoint->type != TuyaDatapointType::RAW) {
+  } else if (datapoint->datapoint.type != TuyaDatapointType::RAW) {
     ESP_LOGE(TAG, "Attempt to set datapoint %u with incorrect type", datapoint_id);
     return;
-  } else if (datapoint->value_raw == value) {
+  } else if (datapoint->value == value) {
     ESP_LOGV(TAG, "Not sending unchanged value");
     return;
   }
-  this->send_datapoint_command_(datapoint_id, TuyaDatapointType::RAW, value);
+  this->send_datapoint_command_(datapoint_id, TuyaDatapointType::RAW, value.data(), value.size());
 }
 
 void Tuya::set_boolean_datapoint_value(uint8_t datapoint_id, bool value) {
@@ -462,21 +465,19 @@ void Tuya::set_integer_datapoint_value(uint8_t datapoint_id, uint32_t value) {
 
 void Tuya::set_string_datapoint_value(uint8_t datapoint_id, const std::string &value) {
   ESP_LOGD(TAG, "Setting datapoint %u to %s", datapoint_id, value.c_str());
-  optional<TuyaDatapoint> datapoint = this->get_datapoint_(datapoint_id);
-  if (!datapoint.has_value()) {
+  StoredDatapoint *datapoint = this->get_datapoint_(datapoint_id);
+  if (datapoint == nullptr) {
     ESP_LOGW(TAG, "Setting unknown datapoint %u", datapoint_id);
-  } else if (datapoint->type != TuyaDatapointType::STRING) {
+  } else if (datapoint->datapoint.type != TuyaDatapointType::STRING) {
     ESP_LOGE(TAG, "Attempt to set datapoint %u with incorrect type", datapoint_id);
     return;
-  } else if (datapoint->value_string == value) {
+  } else if (datapoint->value.size() == value.size() &&
+             memcmp(datapoint->value.data(), value.data(), value.size()) == 0) {
     ESP_LOGV(TAG, "Not sending unchanged value");
     return;
   }
-  std::vector<uint8_t> data;
-  for (char const &c : value) {
-    data.push_back(c);
-  }
-  this->send_datapoint_command_(datapoint->id, datapoint->type, data);
+  this->send_datapoint_command_(datapoint_id, TuyaDatapointType::STRING,
+                                reinterpret_cast<const uint8_t *>(value.data()), value.size());
 }
 
 void Tuya::set_enum_datapoint_value(uint8_t datapoint_id, uint8_t value) {
@@ -487,66 +488,91 @@ void Tuya::set_bitmask_datapoint_value(uint8_t datapoint_id, uint32_t value, uin
   this->set_numeric_datapoint_value_(datapoint_id, TuyaDatapointType::BITMASK, value, length);
 }
 
-optional<TuyaDatapoint> Tuya::get_datapoint_(uint8_t datapoint_id) {
+Tuya::StoredDatapoint *Tuya::get_datapoint_(uint8_t datapoint_id) {
   for (auto &datapoint : this->datapoints_)
-    if (datapoint.id == datapoint_id)
-      return datapoint;
-  return {};
+    if (datapoint.datapoint.id == datapoint_id)
+      return &datapoint;
+  return nullptr;
 }
 
 void Tuya::set_numeric_datapoint_value_(uint8_t datapoint_id, TuyaDatapointType datapoint_type, const uint32_t value,
                                         uint8_t length) {
   ESP_LOGD(TAG, "Setting datapoint %u to %u", datapoint_id, value);
-  optional<TuyaDatapoint> datapoint = this->get_datapoint_(datapoint_id);
-  if (!datapoint.has_value()) {
+  StoredDatapoint *datapoint = this->get_datapoint_(datapoint_id);
+  if (datapoint == nullptr) {
     ESP_LOGW(TAG, "Setting unknown datapoint %u", datapoint_id);
-  } else if (datapoint->type != datapoint_type) {
+  } else if (datapoint->datapoint.type != datapoint_type) {
     ESP_LOGE(TAG, "Attempt to set datapoint %u with incorrect type", datapoint_id);
     return;
-  } else if (datapoint->value_uint == value) {
+  } else if (datapoint->datapoint.value_uint == value) {
     ESP_LOGV(TAG, "Not sending unchanged value");
     return;
   }
 
-  std::vector<uint8_t> data;
+  uint8_t data[4];
   switch (length) {
     case 4:
-      data.push_back(value >> 24);
-      data.push_back(value >> 16);
+      data[0] = value >> 24;
+      data[1] = value >> 16;
+      data[2] = value >> 8;
+      data[3] = value >> 0;
+      break;
     case 2:
-      data.push_back(value >> 8);
+      data[0] = value >> 8;
+      data[1] = value >> 0;
+      break;
     case 1:
-      data.push_back(value >> 0);
+      data[0] = value >> 0;
       break;
     default:
       ESP_LOGE(TAG, "Unexpected datapoint length %u", length);
       return;
   }
-  this->send_datapoint_command_(datapoint_id, datapoint_type, data);
+  this->send_datapoint_command_(datapoint_id, datapoint_type, data, length);
 }
 
-void Tuya::send_datapoint_command_(uint8_t datapoint_id, TuyaDatapointType datapoint_type, std::vector<uint8_t> data) {
+void Tuya::send_datapoint_command_(uint8_t datapoint_id, TuyaDatapointType datapoint_type, const uint8_t *data,
+                                   size_t len) {
+  // A value that is still queued is outdated by the new one: drop it and send the new value in its place at the end
+  // of the queue, reusing its buffer. A value that was already sent is not touched, the MCU acks it with a report.
   std::vector<uint8_t> buffer;
+  for (auto it = this->command_queue_.begin(); it != this->command_queue_.end(); it++) {
+    if (it->cmd == TuyaCommandType::DATAPOINT_DELIVER && !it->payload.empty() && it->payload[0] == datapoint_id) {
+      ESP_LOGV(TAG, "Replacing queued value of datapoint %u", datapoint_id);
+      buffer = std::move(it->payload);
+      this->command_queue_.erase(it);
+      break;
+    }
+  }
+
+  buffer.clear();
+  buffer.reserve(4 + len);
   buffer.push_back(datapoint_id);
   buffer.push_back(static_cast<uint8_t>(datapoint_type));
-  buffer.push_back(data.size() >> 8);
-  buffer.push_back(data.size() >> 0);
-  buffer.insert(buffer.end(), data.begin(), data.end());
+  buffer.push_back(len >> 8);
+  buffer.push_back(len >> 0);
+  buffer.insert(buffer.end(), data, data + len);
 
-  this->send_command_(TuyaCommand{.cmd = TuyaCommandType::DATAPOINT_DELIVER, .payload = buffer});
+  this->send_command_(TuyaCommand{.cmd = TuyaCommandType::DATAPOINT_DELIVER, .payload = std::move(buffer)});
 }
 
-void Tuya::register_listener(uint8_t datapoint_id, const std::function<void(TuyaDatapoint)> &func) {
-  auto listener = TuyaDatapointListener{
-      .datapoint_id = datapoint_id,
-      .on_datapoint = func,
-  };
-  this->listeners_.push_back(listener);
+void Tuya::register_listener(uint8_t datapoint_id, Callback<void(const TuyaDatapoint &)> func) {
+  // Keep the listeners sorted by datapoint id, behind the listeners that were registered before for the same id
+  auto it =
+      std::upper_bound(this->listeners_.begin(), this->listeners_.end(), datapoint_id,
+                       [](uint8_t id, const TuyaDatapointListener &listener) { return id < listener.datapoint_id; });
+  it = this->listeners_.insert(it, TuyaDatapointListener{
+                                       .datapoint_id = datapoint_id,
+                                       .on_datapoint = std::move(func),
+                                   });
 
   // Run through existing datapoints
-  for (auto &datapoint : this->datapoints_)
-    if (datapoint.id == datapoint_id)
-      func(datapoint);
+  StoredDatapoint *stored = this->get_datapoint_(datapoint_id);
+  if (stored != nullptr) {
+    TuyaDatapoint datapoint = stored->datapoint;
+    datapoint.value_raw = stored->value.data();
+    it->on_datapoint(datapoint);
+  }
 }
 
 }  // namespace tuya
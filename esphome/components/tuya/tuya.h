@@ -2,6 +2,7 @@
 
 #include "esphome/core/component.h"
 #include "esphome/core/defines.h"
+#include "esphome/core/helpers.h"
 #include "esphome/components/uart/uart.h"
 
 #ifdef USE_TIME
@@ -11,6 +12,11 @@
 namespace esphome {
 namespace tuya {
 
+/// Frames from the MCU with a longer payload are dropped.
+static const uint16_t TUYA_MAX_PAYLOAD_LENGTH = 512;
+/// Header, version, command and length of a frame.
+static const uint8_t TUYA_HEADER_LENGTH = 6;
+
 enum class TuyaDatapointType : uint8_t {
   RAW = 0x00,      // variable length
   BOOLEAN = 0x01,  // 1 byte (0/1)
@@ -20,6 +26,11 @@ enum class TuyaDatapointType : uint8_t {
   BITMASK = 0x05,  // 1/2/4 bytes
 };
 
+/** A datapoint reported by the MCU.
+ *
+ * The value of RAW and STRING datapoints is not copied, value_raw points into the frame it was received in and is
+ * only valid while the listeners are called.
+ */
 struct TuyaDatapoint {
   uint8_t id;
   TuyaDatapointType type;
@@ -31,13 +42,12 @@ struct TuyaDatapoint {
     uint8_t value_enum;
     uint32_t value_bitmask;
   };
-  std::string value_string;
-  std::vector<uint8_t> value_raw;
+  const uint8_t *value_raw;
 };
 
 struct TuyaDatapointListener {
   uint8_t datapoint_id;
-  std::function<void(TuyaDatapoint)> on_datapoint;
+  Callback<void(const TuyaDatapoint &)> on_datapoint;
 };
 
 enum class TuyaCommandType : uint8_t {
@@ -74,7 +84,8 @@ class Tuya : public Component, public uart::UARTDevice {
   void setup() override;
   void loop() override;
   void dump_config() override;
-  void register_listener(uint8_t datapoint_id, const std::function<void(TuyaDatapoint)> &func);
+  /// Call func with every update of a datapoint, and right away with its current value if it is already known.
+  void register_listener(uint8_t datapoint_id, Callback<void(const TuyaDatapoint &)> func);
   void set_raw_datapoint_value(uint8_t datapoint_id, const std::vector<uint8_t> &value);
   void set_boolean_datapoint_value(uint8_t datapoint_id, bool value);
   void set_integer_datapoint_value(uint8_t datapoint_id, uint32_t value);
@@ -89,19 +100,30 @@ class Tuya : public Component, public uart::UARTDevice {
   }
 
  protected:
+  /// The last value the MCU reported for a datapoint.
+  struct StoredDatapoint {
+    TuyaDatapoint datapoint;
+    /// Copy of the value of RAW and STRING datapoints.
+    std::vector<uint8_t> value;
+  };
+
+  /// Add a byte to the frame being received, the frame is handled as soon as its checksum arrived.
   void handle_char_(uint8_t c);
-  void handle_datapoint_(const uint8_t *buffer, size_t len);
-  optional<TuyaDatapoint> get_datapoint_(uint8_t datapoint_id);
-  bool validate_message_();
+  /// Handle the datapoints of a DATAPOINT_REPORT frame in place.
+  void handle_datapoints_(const uint8_t *buffer, size_t len);
+  void handle_datapoint_(TuyaDatapoint datapoint);
+  StoredDatapoint *get_datapoint_(uint8_t datapoint_id);
 
   void handle_command_(uint8_t command, uint8_t version, const uint8_t *buffer, size_t len);
-  void send_raw_command_(TuyaCommand command);
+  void send_raw_command_(const TuyaCommand &command);
   void process_command_queue_();
-  void send_command_(const TuyaCommand &command);
+  void send_command_(TuyaCommand command);
   void send_empty_command_(TuyaCommandType command);
   void set_numeric_datapoint_value_(uint8_t datapoint_id, TuyaDatapointType datapoint_type, uint32_t value,
                                     uint8_t length);
-  void send_datapoint_command_(uint8_t datapoint_id, TuyaDatapointType datapoint_type, std::vector<uint8_t> data);
+  /// Queue a new value for a datapoint, replacing a value for the same datapoint that has not been sent yet.
+  void send_datapoint_command_(uint8_t datapoint_id, TuyaDatapointType datapoint_type, const uint8_t *data,
+                               size_t len);
   void send_wifi_status_();
 
 #ifdef USE_TIME
@@ -115,9 +137,14 @@ class Tuya : public Component, public uart::UARTDevice {
   uint32_t last_command_timestamp_ = 0;
   uint32_t last_rx_char_timestamp_ = 0;
   std::string product_ = "";
+  /// Listeners sorted by datapoint id, listeners of the same datapoint in the order they were registered.
   std::vector<TuyaDatapointListener> listeners_;
-  std::vector<TuyaDatapoint> datapoints_;
-  std::vector<uint8_t> rx_message_;
+  std::vector<StoredDatapoint> datapoints_;
+  /// Header and payload of the frame being received.
+  uint8_t rx_buffer_[TUYA_HEADER_LENGTH + TUYA_MAX_PAYLOAD_LENGTH];
+  size_t rx_len_{0};
+  /// Sum of the received bytes of the frame, modulo 256.
+  uint8_t rx_checksum_{0};
   std::vector<uint8_t> ignore_mcu_update_on_datapoints_{};
   std::vector<TuyaCommand> command_queue_;
   optional<TuyaCommandType> expected_response_{};
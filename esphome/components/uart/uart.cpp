@@ -43,6 +43,18 @@ void UARTComponent::check_logger_conflict_() {
 #endif
 }
 
+void UARTComponent::check_rx_overrun_(size_t available) {
+  bool overrun = available >= this->rx_buffer_size_;
+#ifdef ARDUINO_ARCH_ESP8266
+  if (this->hw_serial_ != nullptr && this->hw_serial_->hasOverrun())
+    overrun = true;
+#endif
+  if (overrun) {
+    this->rx_overruns_++;
+    ESP_LOGW(TAG, "RX buffer full, received bytes may have been lost (%u times)", this->rx_overruns_);
+  }
+}
+
 void UARTDevice::check_uart_settings(uint32_t baud_rate, uint8_t stop_bits, UARTParityOptions parity,
                                      uint8_t data_bits) {
   if (this->parent_->baud_rate_ != baud_rate) {
@@ -63,6 +75,43 @@ void UARTDevice::check_uart_settings(uint32_t baud_rate, uint8_t stop_bits, UART
   }
 }
 
+void UARTFrameReader::loop() {
+  const uint32_t now = millis();
+  while (true) {
+    auto data = this->device_->read_span();
+    if (data.empty())
+      break;
+    this->last_byte_ = now;
+    for (uint8_t byte : data) {
+      if (!this->overflow_) {
+        if (this->buffer_.size() < this->max_length_) {
+          this->buffer_.push_back(byte);
+        } else {
+          ESP_LOGW(TAG, "Dropping frame longer than %u bytes", this->max_length_);
+          this->dropped_frames_++;
+          this->buffer_.clear();
+          this->overflow_ = true;
+        }
+      }
+      if (this->has_delimiter_ && byte == this->delimiter_)
+        this->end_frame_();
+    }
+  }
+
+  if (this->idle_timeout_ != 0 && (!this->buffer_.empty() || this->overflow_) &&
+      now - this->last_byte_ >= this->idle_timeout_)
+    this->end_frame_();
+}
+void UARTFrameReader::reset() {
+  this->buffer_.clear();
+  this->overflow_ = false;
+}
+void UARTFrameReader::end_frame_() {
+  if (!this->overflow_ && this->callback_)
+    this->callback_(Span<const uint8_t>(this->buffer_.data(), this->buffer_.size()));
+  this->reset();
+}
+
 const char *parity_to_str(UARTParityOptions parity) {
   switch (parity) {
     case UART_CONFIG_PARITY_NONE:
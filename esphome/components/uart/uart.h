@@ -4,6 +4,7 @@
 #include <HardwareSerial.h>
 #include "esphome/core/esphal.h"
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
 
 namespace esphome {
 namespace uart {
@@ -16,6 +17,9 @@ enum UARTParityOptions {
 
 const char *parity_to_str(UARTParityOptions parity);
 
+/// The default maximum number of bytes read_span() returns at once.
+static const size_t UART_READ_CHUNK_SIZE = 64;
+
 #ifdef ARDUINO_ARCH_ESP8266
 class ESP8266SoftwareSerial {
  public:
@@ -78,6 +82,16 @@ class UARTComponent : public Component, public Stream {
 
   bool read_array(uint8_t *data, size_t len);
 
+  /** Read up to max_len of the bytes that have already been received, without waiting for more.
+   *
+   * The bytes are taken in one block from the receive buffer that is filled by the UART interrupt. The returned span
+   * points into a buffer of this component and is only valid until the next call, it is empty if nothing was received.
+   */
+  Span<const uint8_t> read_span(size_t max_len = UART_READ_CHUNK_SIZE);
+
+  /// The number of times the receive buffer was full and received bytes may have been lost.
+  uint32_t get_rx_overruns() const { return this->rx_overruns_; }
+
   int available() override;
 
   /// Block until all bytes have been written to the UART bus.
@@ -102,6 +116,8 @@ class UARTComponent : public Component, public Stream {
  protected:
   void check_logger_conflict_();
   bool check_read_timeout_(size_t len = 1);
+  /// Count and report a receive buffer overrun, available is the number of buffered bytes.
+  void check_rx_overrun_(size_t available);
   friend class UARTDevice;
 
   HardwareSerial *hw_serial_{nullptr};
@@ -118,6 +134,8 @@ class UARTComponent : public Component, public Stream {
   uint8_t stop_bits_;
   uint8_t data_bits_;
   UARTParityOptions parity_;
+  std::vector<uint8_t> read_chunk_;
+  uint32_t rx_overruns_{0};
 
  private:
 #ifdef ARDUINO_ARCH_ESP8266
@@ -150,6 +168,7 @@ class UARTDevice : public Stream {
   bool peek_byte(uint8_t *data) { return this->parent_->peek_byte(data); }
 
   bool read_array(uint8_t *data, size_t len) { return this->parent_->read_array(data, len); }
+  Span<const uint8_t> read_span(size_t max_len = UART_READ_CHUNK_SIZE) { return this->parent_->read_span(max_len); }
   template<size_t N> optional<std::array<uint8_t, N>> read_array() {  // NOLINT
     std::array<uint8_t, N> res;
     if (!this->read_array(res.data(), N)) {
@@ -174,5 +193,47 @@ class UARTDevice : public Stream {
   UARTComponent *parent_{nullptr};
 };
 
+/** Splits the bytes received by a UART device into frames.
+ *
+ * A frame ends with the delimiter byte, which is part of the frame, or once no byte was received for the idle
+ * timeout. The idle time can only be measured with the resolution of the loop. Frames longer than the maximum length
+ * are dropped. Call loop() from the loop() of the device.
+ */
+class UARTFrameReader {
+ public:
+  explicit UARTFrameReader(UARTDevice *device) : device_(device) {}
+
+  void set_delimiter(uint8_t delimiter) {
+    this->delimiter_ = delimiter;
+    this->has_delimiter_ = true;
+  }
+  void set_idle_timeout(uint32_t idle_timeout) { this->idle_timeout_ = idle_timeout; }
+  void set_max_length(size_t max_length) { this->max_length_ = max_length; }
+  /// Called with each complete frame, the data is only valid during the call.
+  void set_callback(std::function<void(Span<const uint8_t>)> &&callback) { this->callback_ = std::move(callback); }
+
+  void loop();
+  /// Drop the bytes of the frame that is being received.
+  void reset();
+
+  /// The number of frames that were dropped because they were too long.
+  uint32_t get_dropped_frames() const { return this->dropped_frames_; }
+
+ protected:
+  void end_frame_();
+
+  UARTDevice *device_;
+  std::function<void(Span<const uint8_t>)> callback_;
+  std::vector<uint8_t> buffer_;
+  size_t max_length_{256};
+  uint32_t idle_timeout_{0};
+  uint32_t last_byte_{0};
+  uint32_t dropped_frames_{0};
+  uint8_t delimiter_{0};
+  bool has_delimiter_{false};
+  /// Set while the rest of a frame that was too long is skipped.
+  bool overflow_{false};
+};
+
 }  // namespace uart
 }  // namespace esphome
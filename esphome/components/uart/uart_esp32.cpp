@@ -5,6 +5,8 @@
 #include "esphome/core/application.h"
 #include "esphome/core/defines.h"
 
+#include <algorithm>
+
 namespace esphome {
 namespace uart {
 static const char *const TAG = "uart_esp32";
@@ -137,6 +139,20 @@ bool UARTComponent::read_array(uint8_t *data, size_t len) {
 
   return true;
 }
+Span<const uint8_t> UARTComponent::read_span(size_t max_len) {
+  const size_t available = this->hw_serial_->available();
+  if (available == 0)
+    return {};
+  this->check_rx_overrun_(available);
+
+  const size_t len = std::min(available, max_len);
+  if (this->read_chunk_.size() < len)
+    this->read_chunk_.resize(len);
+  // Only bytes that are already buffered are read, so this never waits for the stream timeout
+  this->hw_serial_->readBytes(this->read_chunk_.data(), len);
+  ESP_LOGVV(TAG, "    Read %u bytes", len);
+  return {this->read_chunk_.data(), len};
+}
 bool UARTComponent::check_read_timeout_(size_t len) {
   if (this->available() >= len)
     return true;
@@ -0,0 +1,83 @@
+#include "initial_state_iterator.h"
+#include "web_server.h"
+
+namespace esphome {
+namespace web_server {
+
+#ifdef USE_BINARY_SENSOR
+bool InitialStateIterator::on_binary_sensor(binary_sensor::BinarySensor *binary_sensor) {
+  this->web_server_->send_initial_state([this, binary_sensor](json::JsonWriter &root) {
+    this->web_server_->binary_sensor_json(root, binary_sensor, binary_sensor->state);
+  });
+  return true;
+}
+#endif
+#ifdef USE_COVER
+bool InitialStateIterator::on_cover(cover::Cover *cover) {
+  this->web_server_->send_initial_state(
+      [this, cover](json::JsonWriter &root) { this->web_server_->cover_json(root, cover); });
+  return true;
+}
+#endif
+#ifdef USE_FAN
+bool InitialStateIterator::on_fan(fan::FanState *fan) {
+  this->web_server_->send_initial_state(
+      [this, fan](json::JsonWriter &root) { this->web_server_->fan_json(root, fan); });
+  return true;
+}
+#endif
+#ifdef USE_LIGHT
+bool InitialStateIterator::on_light(light::LightState *light) {
+  this->web_server_->send_initial_state(
+      [this, light](json::JsonWriter &root) { this->web_server_->light_json(root, light); });
+  return true;
+}
+#endif
+#ifdef USE_SENSOR
+bool InitialStateIterator::on_sensor(sensor::Sensor *sensor) {
+  this->web_server_->send_initial_state(
+      [this, sensor](json::JsonWriter &root) { this->web_server_->sensor_json(root, sensor, sensor->state); });
+  return true;
+}
+#endif
+#ifdef USE_SWITCH
+bool InitialStateIterator::on_switch(switch_::Switch *a_switch) {
+  this->web_server_->send_initial_state(
+      [this, a_switch](json::JsonWriter &root) { this->web_server_->switch_json(root, a_switch, a_switch->state); });
+  return true;
+}
+#endif
+#ifdef USE_TEXT_SENSOR
+bool InitialStateIterator::on_text_sensor(text_sensor::TextSensor *text_sensor) {
+  this->web_server_->send_initial_state([this, text_sensor](json::JsonWriter &root) {
+    this->web_server_->text_sensor_json(root, text_sensor, text_sensor->state);
+  });
+  return true;
+}
+#endif
+#ifdef USE_CLIMATE
+// climates are not exposed by the web server
+bool InitialStateIterator::on_climate(climate::Climate *climate) { return true; }
+#endif
+#ifdef USE_NUMBER
+bool InitialStateIterator::on_number(number::Number *number) {
+  this->web_server_->send_initial_state(
+      [this, number](json::JsonWriter &root) { this->web_server_->number_json(root, number, number->state); });
+  return true;
+}
+#endif
+#ifdef USE_SELECT
+bool InitialStateIterator::on_select(select::Select *select) {
+  this->web_server_->send_initial_state(
+      [this, select](json::JsonWriter &root) { this->web_server_->select_json(root, select, select->state); });
+  return true;
+}
+#endif
+bool InitialStateIterator::on_end() {
+  this->web_server_->initial_states_sent();
+  return true;
+}
+InitialStateIterator::InitialStateIterator(WebServer *web_server) : web_server_(web_server) {}
+
+}  // namespace web_server
+}  // namespace esphome
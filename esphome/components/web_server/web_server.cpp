@@ -6,6 +6,7 @@
 
 #include "StreamString.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 #ifdef USE_LIGHT
@@ -24,6 +25,17 @@ namespace esphome {
 namespace web_server {
 
 static const char *const TAG = "web_server";
+static const size_t MAX_EVENT_PACKETS_WAITING = 8;
+
+// AsyncEventSource doesn't expose its list of clients, which it deletes on the AsyncTCP task when they disconnect.
+// Access checks don't apply to explicit template instantiations, which lets this friend function return a pointer to
+// the private member.
+using EventSourceClients = LinkedList<AsyncEventSourceClient *>;
+EventSourceClients AsyncEventSource::*event_source_clients();
+template<EventSourceClients AsyncEventSource::*M> struct EventSourceClientsAccessor {
+  friend EventSourceClients AsyncEventSource::*event_source_clients() { return M; }
+};
+template struct EventSourceClientsAccessor<&AsyncEventSource::_clients>;
 
 void write_row(AsyncResponseStream *stream, Nameable *obj, const std::string &klass, const std::string &action) {
   if (obj->is_internal())
@@ -81,60 +93,9 @@ void WebServer::setup() {
   this->events_.onConnect([this](AsyncEventSourceClient *client) {
     // Configure reconnect timeout
     client->send("", "ping", millis(), 30000);
-
-#ifdef USE_SENSOR
-    for (auto *obj : App.get_sensors())
-      if (!obj->is_internal())
-        client->send(this->sensor_json(obj, obj->state).c_str(), "state");
-#endif
-
-#ifdef USE_SWITCH
-    for (auto *obj : App.get_switches())
-      if (!obj->is_internal())
-        client->send(this->switch_json(obj, obj->state).c_str(), "state");
-#endif
-
-#ifdef USE_BINARY_SENSOR
-    for (auto *obj : App.get_binary_sensors())
-      if (!obj->is_internal())
-        client->send(this->binary_sensor_json(obj, obj->state).c_str(), "state");
-#endif
-
-#ifdef USE_FAN
-    for (auto *obj : App.get_fans())
-      if (!obj->is_internal())
-        client->send(this->fan_json(obj).c_str(), "state");
-#endif
-
-#ifdef USE_LIGHT
-    for (auto *obj : App.get_lights())
-      if (!obj->is_internal())
-        client->send(this->light_json(obj).c_str(), "state");
-#endif
-
-#ifdef USE_TEXT_SENSOR
-    for (auto *obj : App.get_text_sensors())
-      if (!obj->is_internal())
-        client->send(this->text_sensor_json(obj, obj->state).c_str(), "state");
-#endif
-
-#ifdef USE_COVER
-    for (auto *obj : App.get_covers())
-      if (!obj->is_internal())
-        client->send(this->cover_json(obj).c_str(), "state");
-#endif
-
-#ifdef USE_NUMBER
-    for (auto *obj : App.get_numbers())
-      if (!obj->is_internal())
-        client->send(this->number_json(obj, obj->state).c_str(), "state");
-#endif
-
-#ifdef USE_SELECT
-    for (auto *obj : App.get_selects())
-      if (!obj->is_internal())
-        client->send(this->select_json(obj, obj->state).c_str(), "state");
-#endif
+    // The states are sent from loop(), a few at a time and only to this client, instead of all at once from the
+    // connection's context.
+    this->connected_clients_.push(client);
   });
 
 #ifdef USE_LOGGER
@@ -155,8 +116,75 @@ void WebServer::dump_config() {
     ESP_LOGCONFIG(TAG, "  Basic authentication enabled");
   }
 }
+void WebServer::loop() {
+  AsyncEventSourceClient **connected;
+  while ((connected = this->connected_clients_.front()) != nullptr) {
+    // a client allocated at the address of one that disconnected earlier only needs the initial states once
+    this->remove_initial_state_client_(*connected);
+    this->initial_state_clients_.push_back(*connected);
+    this->connected_clients_.pop();
+  }
+  uint32_t dropped = this->connected_clients_.get_dropped();
+  if (dropped != this->connected_clients_dropped_) {
+    ESP_LOGW(TAG, "Too many clients connected at once, %u did not get the initial states",
+             dropped - this->connected_clients_dropped_);
+    this->connected_clients_dropped_ = dropped;
+  }
+
+  // The event source deletes clients when they disconnect, only use the ones it still knows.
+  while (!this->initial_state_clients_.empty() &&
+         !this->is_event_source_client_(this->initial_state_clients_.front()))
+    this->remove_initial_state_client_(this->initial_state_clients_.front());
+  if (this->initial_state_clients_.empty())
+    return;
+  AsyncEventSourceClient *client = this->initial_state_clients_.front();
+  if (client != this->initial_state_client_) {
+    this->initial_state_client_ = client;
+    this->initial_state_iterator_.begin();
+  }
+  // Only send the next initial state once the client has drained its event queue, the event source drops events
+  // beyond its queue limit.
+  if (client->packetsWaiting() < MAX_EVENT_PACKETS_WAITING)
+    this->initial_state_iterator_.advance();
+}
 float WebServer::get_setup_priority() const { return setup_priority::WIFI - 1.0f; }
 
+void WebServer::send_state_event_(const json::json_write_t &f) {
+  // don't encode state events nobody is listening to
+  if (this->events_.count() == 0)
+    return;
+  size_t len;
+  this->events_.send(json::write_json(f, &len), "state");
+}
+void WebServer::send_initial_state(const json::json_write_t &f) {
+  size_t len;
+  this->initial_state_client_->send(json::write_json(f, &len), "state");
+}
+void WebServer::initial_states_sent() { this->remove_initial_state_client_(this->initial_state_client_); }
+void WebServer::remove_initial_state_client_(AsyncEventSourceClient *client) {
+  auto it = std::find(this->initial_state_clients_.begin(), this->initial_state_clients_.end(), client);
+  if (it != this->initial_state_clients_.end())
+    this->initial_state_clients_.erase(it);
+  // another client might be allocated at the same address later
+  if (client == this->initial_state_client_)
+    this->initial_state_client_ = nullptr;
+}
+bool WebServer::is_event_source_client_(AsyncEventSourceClient *client) {
+  for (AsyncEventSourceClient *c : this->events_.*event_source_clients()) {
+    if (c == client)
+      return c->connected();
+  }
+  return false;
+}
+void WebServer::send_json_response_(AsyncWebServerRequest *request, const json::json_write_t &f) {
+  AsyncResponseStream *stream = request->beginResponseStream("text/json");
+  json::JsonWriter writer(stream);
+  writer.begin_object();
+  f(writer);
+  writer.end_object();
+  request->send(stream);
+}
+
 void WebServer::handle_index_request(AsyncWebServerRequest *request) {
   AsyncResponseStream *stream = request->beginResponseStream("text/html");
   std::string title = App.get_name() + " Web Server";
@@ -266,7 +294,7 @@ void WebServer::handle_js_request(AsyncWebServerRequest *request) {
 
 #ifdef USE_SENSOR
 void WebServer::on_sensor_update(sensor::Sensor *obj, float state) {
-  this->events_.send(this->sensor_json(obj, state).c_str(), "state");
+  this->send_state_event_([this, obj, state](json::JsonWriter &root) { this->sensor_json(root, obj, state); });
 }
 void WebServer::handle_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (sensor::Sensor *obj : App.get_sensors()) {
@@ -274,27 +302,27 @@ void WebServer::handle_sensor_request(AsyncWebServerRequest *request, const UrlM
       continue;
     if (obj->get_object_id() != match.id)
       continue;
-    std::string data = this->sensor_json(obj, obj->state);
-    request->send(200, "text/json", data.c_str());
+    this->send_json_response_(request,
+                              [this, obj](json::JsonWriter &root) { this->sensor_json(root, obj, obj->state); });
     return;
   }
   request->send(404);
 }
-std::string WebServer::sensor_json(sensor::Sensor *obj, float value) {
-  return json::build_json([obj, value](JsonObject &root) {
-    root["id"] = "sensor-" + obj->get_object_id();
-    std::string state = value_accuracy_to_string(value, obj->get_accuracy_decimals());
-    if (!obj->get_unit_of_measurement().empty())
-      state += " " + obj->get_unit_of_measurement();
-    root["state"] = state;
-    root["value"] = value;
-  });
+void WebServer::sensor_json(json::JsonWriter &root, sensor::Sensor *obj, float value) {
+  root.add("id", "sensor-" + obj->get_object_id());
+  char state[VALUE_ACCURACY_MAX_LEN];
+  size_t len = value_accuracy_to_buf(state, sizeof(state), value, obj->get_accuracy_decimals());
+  const std::string &unit = obj->get_unit_of_measurement();
+  if (!unit.empty())
+    snprintf(state + len, sizeof(state) - len, " %s", unit.c_str());
+  root.add("state", state);
+  root.add("value", value);
 }
 #endif
 
 #ifdef USE_TEXT_SENSOR
 void WebServer::on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) {
-  this->events_.send(this->text_sensor_json(obj, state).c_str(), "state");
+  this->send_state_event_([this, obj, &state](json::JsonWriter &root) { this->text_sensor_json(root, obj, state); });
 }
 void WebServer::handle_text_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (text_sensor::TextSensor *obj : App.get_text_sensors()) {
@@ -302,31 +330,27 @@ void WebServer::handle_text_sensor_request(AsyncWebServerRequest *request, const
       continue;
     if (obj->get_object_id() != match.id)
       continue;
-    std::string data = this->text_sensor_json(obj, obj->state);
-    request->send(200, "text/json", data.c_str());
+    this->send_json_response_(request,
+                              [this, obj](json::JsonWriter &root) { this->text_sensor_json(root, obj, obj->state); });
     return;
   }
   request->send(404);
 }
-std::string WebServer::text_sensor_json(text_sensor::TextSensor *obj, const std::string &value) {
-  return json::build_json([obj, value](JsonObject &root) {
-    root["id"] = "text_sensor-" + obj->get_object_id();
-    root["state"] = value;
-    root["value"] = value;
-  });
+void WebServer::text_sensor_json(json::JsonWriter &root, text_sensor::TextSensor *obj, const std::string &value) {
+  root.add("id", "text_sensor-" + obj->get_object_id());
+  root.add("state", value);
+  root.add("value", value);
 }
 #endif
 
 #ifdef USE_SWITCH
 void WebServer::on_switch_update(switch_::Switch *obj, bool state) {
-  this->events_.send(this->switch_json(obj, state).c_str(), "state");
+  this->send_state_event_([this, obj, state](json::JsonWriter &root) { this->switch_json(root, obj, state); });
 }
-std::string WebServer::switch_json(switch_::Switch *obj, bool value) {
-  return json::build_json([obj, value](JsonObject &root) {
-    root["id"] = "switch-" + obj->get_object_id();
-    root["state"] = value ? "ON" : "OFF";
-    root["value"] = value;
-  });
+void WebServer::switch_json(json::JsonWriter &root, switch_::Switch *obj, bool value) {
+  root.add("id", "switch-" + obj->get_object_id());
+  root.add("state", value ? "ON" : "OFF");
+  root.add("value", value);
 }
 void WebServer::handle_switch_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (switch_::Switch *obj : App.get_switches()) {
@@ -336,8 +360,8 @@ void WebServer::handle_switch_request(AsyncWebServerRequest *request, const UrlM
       continue;
 
     if (request->method() == HTTP_GET) {
-      std::string data = this->switch_json(obj, obj->state);
-      request->send(200, "text/json", data.c_str());
+      this->send_json_response_(request,
+                                [this, obj](json::JsonWriter &root) { this->switch_json(root, obj, obj->state); });
     } else if (match.method == "toggle") {
       this->defer([obj]() { obj->toggle(); });
       request->send(200);
@@ -360,14 +384,12 @@ void WebServer::handle_switch_request(AsyncWebServerRequest *request, const UrlM
 void WebServer::on_binary_sensor_update(binary_sensor::BinarySensor *obj, bool state) {
   if (obj->is_internal())
     return;
-  this->events_.send(this->binary_sensor_json(obj, state).c_str(), "state");
+  this->send_state_event_([this, obj, state](json::JsonWriter &root) { this->binary_sensor_json(root, obj, state); });
 }
-std::string WebServer::binary_sensor_json(binary_sensor::BinarySensor *obj, bool value) {
-  return json::build_json([obj, value](JsonObject &root) {
-    root["id"] = "binary_sensor-" + obj->get_object_id();
-    root["state"] = value ? "ON" : "OFF";
-    root["value"] = value;
-  });
+void WebServer::binary_sensor_json(json::JsonWriter &root, binary_sensor::BinarySensor *obj, bool value) {
+  root.add("id", "binary_sensor-" + obj->get_object_id());
+  root.add("state", value ? "ON" : "OFF");
+  root.add("value", value);
 }
 void WebServer::handle_binary_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (binary_sensor::BinarySensor *obj : App.get_binary_sensors()) {
@@ -375,8 +397,8 @@ void WebServer::handle_binary_sensor_request(AsyncWebServerRequest *request, con
       continue;
     if (obj->get_object_id() != match.id)
       continue;
-    std::string data = this->binary_sensor_json(obj, obj->state);
-    request->send(200, "text/json", data.c_str());
+    this->send_json_response_(request,
+                              [this, obj](json::JsonWriter &root) { this->binary_sensor_json(root, obj, obj->state); });
     return;
   }
   request->send(404);
@@ -387,31 +409,29 @@ void WebServer::handle_binary_sensor_request(AsyncWebServerRequest *request, con
 void WebServer::on_fan_update(fan::FanState *obj) {
   if (obj->is_internal())
     return;
-  this->events_.send(this->fan_json(obj).c_str(), "state");
-}
-std::string WebServer::fan_json(fan::FanState *obj) {
-  return json::build_json([obj](JsonObject &root) {
-    root["id"] = "fan-" + obj->get_object_id();
-    root["state"] = obj->state ? "ON" : "OFF";
-    root["value"] = obj->state;
-    const auto traits = obj->get_traits();
-    if (traits.supports_speed()) {
-      root["speed_level"] = obj->speed;
-      switch (fan::speed_level_to_enum(obj->speed, traits.supported_speed_count())) {
-        case fan::FAN_SPEED_LOW:  // NOLINT(clang-diagnostic-deprecated-declarations)
-          root["speed"] = "low";
-          break;
-        case fan::FAN_SPEED_MEDIUM:  // NOLINT(clang-diagnostic-deprecated-declarations)
-          root["speed"] = "medium";
-          break;
-        case fan::FAN_SPEED_HIGH:  // NOLINT(clang-diagnostic-deprecated-declarations)
-          root["speed"] = "high";
-          break;
-      }
+  this->send_state_event_([this, obj](json::JsonWriter &root) { this->fan_json(root, obj); });
+}
+void WebServer::fan_json(json::JsonWriter &root, fan::FanState *obj) {
+  root.add("id", "fan-" + obj->get_object_id());
+  root.add("state", obj->state ? "ON" : "OFF");
+  root.add("value", obj->state);
+  const auto traits = obj->get_traits();
+  if (traits.supports_speed()) {
+    root.add("speed_level", obj->speed);
+    switch (fan::speed_level_to_enum(obj->speed, traits.supported_speed_count())) {
+      case fan::FAN_SPEED_LOW:  // NOLINT(clang-diagnostic-deprecated-declarations)
+        root.add("speed", "low");
+        break;
+      case fan::FAN_SPEED_MEDIUM:  // NOLINT(clang-diagnostic-deprecated-declarations)
+        root.add("speed", "medium");
+        break;
+      case fan::FAN_SPEED_HIGH:  // NOLINT(clang-diagnostic-deprecated-declarations)
+        root.add("speed", "high");
+        break;
     }
-    if (obj->get_traits().supports_oscillation())
-      root["oscillation"] = obj->oscillating;
-  });
+  }
+  if (traits.supports_oscillation())
+    root.add("oscillation", obj->oscillating);
 }
 void WebServer::handle_fan_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (fan::FanState *obj : App.get_fans()) {
@@ -421,8 +441,7 @@ void WebServer::handle_fan_request(AsyncWebServerRequest *request, const UrlMatc
       continue;
 
     if (request->method() == HTTP_GET) {
-      std::string data = this->fan_json(obj);
-      request->send(200, "text/json", data.c_str());
+      this->send_json_response_(request, [this, obj](json::JsonWriter &root) { this->fan_json(root, obj); });
     } else if (match.method == "toggle") {
       this->defer([obj]() { obj->toggle().perform(); });
       request->send(200);
@@ -477,7 +496,7 @@ void WebServer::handle_fan_request(AsyncWebServerRequest *request, const UrlMatc
 void WebServer::on_light_update(light::LightState *obj) {
   if (obj->is_internal())
     return;
-  this->events_.send(this->light_json(obj).c_str(), "state");
+  this->send_state_event_([this, obj](json::JsonWriter &root) { this->light_json(root, obj); });
 }
 void WebServer::handle_light_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (light::LightState *obj : App.get_lights()) {
@@ -487,8 +506,7 @@ void WebServer::handle_light_request(AsyncWebServerRequest *request, const UrlMa
       continue;
 
     if (request->method() == HTTP_GET) {
-      std::string data = this->light_json(obj);
-      request->send(200, "text/json", data.c_str());
+      this->send_json_response_(request, [this, obj](json::JsonWriter &root) { this->light_json(root, obj); });
     } else if (match.method == "toggle") {
       this->defer([obj]() { obj->toggle().perform(); });
       request->send(200);
@@ -539,12 +557,12 @@ void WebServer::handle_light_request(AsyncWebServerRequest *request, const UrlMa
   }
   request->send(404);
 }
-std::string WebServer::light_json(light::LightState *obj) {
-  return json::build_json([obj](JsonObject &root) {
-    root["id"] = "light-" + obj->get_object_id();
-    root["state"] = obj->remote_values.is_on() ? "ON" : "OFF";
-    light::LightJSONSchema::dump_json(*obj, root);
-  });
+void WebServer::light_json(json::JsonWriter &root, light::LightState *obj) {
+  root.add("id", "light-" + obj->get_object_id());
+  // dump_json() already writes the state for lights with on/off capability
+  if (!(obj->remote_values.get_color_mode() & light::ColorCapability::ON_OFF))
+    root.add("state", obj->remote_values.is_on() ? "ON" : "OFF");
+  light::LightJSONSchema::dump_json(*obj, root);
 }
 #endif
 
@@ -552,7 +570,7 @@ std::string WebServer::light_json(light::LightState *obj) {
 void WebServer::on_cover_update(cover::Cover *obj) {
   if (obj->is_internal())
     return;
-  this->events_.send(this->cover_json(obj).c_str(), "state");
+  this->send_state_event_([this, obj](json::JsonWriter &root) { this->cover_json(root, obj); });
 }
 void WebServer::handle_cover_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (cover::Cover *obj : App.get_covers()) {
@@ -562,8 +580,7 @@ void WebServer::handle_cover_request(AsyncWebServerRequest *request, const UrlMa
       continue;
 
     if (request->method() == HTTP_GET) {
-      std::string data = this->cover_json(obj);
-      request->send(200, "text/json", data.c_str());
+      this->send_json_response_(request, [this, obj](json::JsonWriter &root) { this->cover_json(root, obj); });
       continue;
     }
 
@@ -597,22 +614,20 @@ void WebServer::handle_cover_request(AsyncWebServerRequest *request, const UrlMa
   }
   request->send(404);
 }
-std::string WebServer::cover_json(cover::Cover *obj) {
-  return json::build_json([obj](JsonObject &root) {
-    root["id"] = "cover-" + obj->get_object_id();
-    root["state"] = obj->is_fully_closed() ? "CLOSED" : "OPEN";
-    root["value"] = obj->position;
-    root["current_operation"] = cover::cover_operation_to_str(obj->current_operation);
+void WebServer::cover_json(json::JsonWriter &root, cover::Cover *obj) {
+  root.add("id", "cover-" + obj->get_object_id());
+  root.add("state", obj->is_fully_closed() ? "CLOSED" : "OPEN");
+  root.add("value", obj->position);
+  root.add("current_operation", cover::cover_operation_to_str(obj->current_operation));
 
-    if (obj->get_traits().get_supports_tilt())
-      root["tilt"] = obj->tilt;
-  });
+  if (obj->get_traits().get_supports_tilt())
+    root.add("tilt", obj->tilt);
 }
 #endif
 
 #ifdef USE_NUMBER
 void WebServer::on_number_update(number::Number *obj, float state) {
-  this->events_.send(this->number_json(obj, state).c_str(), "state");
+  this->send_state_event_([this, obj, state](json::JsonWriter &root) { this->number_json(root, obj, state); });
 }
 void WebServer::handle_number_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_numbers()) {
@@ -620,26 +635,24 @@ void WebServer::handle_number_request(AsyncWebServerRequest *request, const UrlM
       continue;
     if (obj->get_object_id() != match.id)
       continue;
-    std::string data = this->number_json(obj, obj->state);
-    request->send(200, "text/json", data.c_str());
+    this->send_json_response_(request,
+                              [this, obj](json::JsonWriter &root) { this->number_json(root, obj, obj->state); });
     return;
   }
   request->send(404);
 }
-std::string WebServer::number_json(number::Number *obj, float value) {
-  return json::build_json([obj, value](JsonObject &root) {
-    root["id"] = "number-" + obj->get_object_id();
-    char buffer[64];
-    snprintf(buffer, sizeof(buffer), "%f", value);
-    root["state"] = buffer;
-    root["value"] = value;
-  });
+void WebServer::number_json(json::JsonWriter &root, number::Number *obj, float value) {
+  root.add("id", "number-" + obj->get_object_id());
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%f", value);
+  root.add("state", buffer);
+  root.add("value", value);
 }
 #endif
 
 #ifdef USE_SELECT
 void WebServer::on_select_update(select::Select *obj, const std::string &state) {
-  this->events_.send(this->select_json(obj, state).c_str(), "state");
+  this->send_state_event_([this, obj, &state](json::JsonWriter &root) { this->select_json(root, obj, state); });
 }
 void WebServer::handle_select_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_selects()) {
@@ -647,18 +660,16 @@ void WebServer::handle_select_request(AsyncWebServerRequest *request, const UrlM
       continue;
     if (obj->get_object_id() != match.id)
       continue;
-    std::string data = this->select_json(obj, obj->state);
-    request->send(200, "text/json", data.c_str());
+    this->send_json_response_(request,
+                              [this, obj](json::JsonWriter &root) { this->select_json(root, obj, obj->state); });
     return;
   }
   request->send(404);
 }
-std::string WebServer::select_json(select::Select *obj, const std::string &value) {
-  return json::build_json([obj, value](JsonObject &root) {
-    root["id"] = "select-" + obj->get_object_id();
-    root["state"] = value;
-    root["value"] = value;
-  });
+void WebServer::select_json(json::JsonWriter &root, select::Select *obj, const std::string &value) {
+  root.add("id", "select-" + obj->get_object_id());
+  root.add("state", value);
+  root.add("value", value);
 }
 #endif
 
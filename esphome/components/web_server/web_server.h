@@ -2,7 +2,10 @@
 
 #include "esphome/core/component.h"
 #include "esphome/core/controller.h"
+#include "esphome/core/helpers.h"
 #include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/components/json/json_util.h"
+#include "initial_state_iterator.h"
 
 #include <vector>
 
@@ -64,6 +67,12 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   // (In most use cases you won't need these)
   /// Setup the internal web server and register handlers.
   void setup() override;
+  /// Send the initial states to newly connected event source clients.
+  void loop() override;
+  /// Stream the JSON state written by f to the client that is receiving the initial states.
+  void send_initial_state(const json::json_write_t &f);
+  /// Called once all initial states were sent to the current client.
+  void initial_states_sent();
 
   void dump_config() override;
 
@@ -90,8 +99,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a sensor request under '/sensor/<id>'.
   void handle_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the sensor state with its value as a JSON string.
-  std::string sensor_json(sensor::Sensor *obj, float value);
+  /// Dump the sensor state with its value as JSON.
+  void sensor_json(json::JsonWriter &root, sensor::Sensor *obj, float value);
 #endif
 
 #ifdef USE_SWITCH
@@ -100,8 +109,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a switch request under '/switch/<id>/</turn_on/turn_off/toggle>'.
   void handle_switch_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the switch state with its value as a JSON string.
-  std::string switch_json(switch_::Switch *obj, bool value);
+  /// Dump the switch state with its value as JSON.
+  void switch_json(json::JsonWriter &root, switch_::Switch *obj, bool value);
 #endif
 
 #ifdef USE_BINARY_SENSOR
@@ -110,8 +119,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a binary sensor request under '/binary_sensor/<id>'.
   void handle_binary_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the binary sensor state with its value as a JSON string.
-  std::string binary_sensor_json(binary_sensor::BinarySensor *obj, bool value);
+  /// Dump the binary sensor state with its value as JSON.
+  void binary_sensor_json(json::JsonWriter &root, binary_sensor::BinarySensor *obj, bool value);
 #endif
 
 #ifdef USE_FAN
@@ -120,8 +129,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a fan request under '/fan/<id>/</turn_on/turn_off/toggle>'.
   void handle_fan_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the fan state as a JSON string.
-  std::string fan_json(fan::FanState *obj);
+  /// Dump the fan state as JSON.
+  void fan_json(json::JsonWriter &root, fan::FanState *obj);
 #endif
 
 #ifdef USE_LIGHT
@@ -130,8 +139,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a light request under '/light/<id>/</turn_on/turn_off/toggle>'.
   void handle_light_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the light state as a JSON string.
-  std::string light_json(light::LightState *obj);
+  /// Dump the light state as JSON.
+  void light_json(json::JsonWriter &root, light::LightState *obj);
 #endif
 
 #ifdef USE_TEXT_SENSOR
@@ -140,8 +149,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a text sensor request under '/text_sensor/<id>'.
   void handle_text_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the text sensor state with its value as a JSON string.
-  std::string text_sensor_json(text_sensor::TextSensor *obj, const std::string &value);
+  /// Dump the text sensor state with its value as JSON.
+  void text_sensor_json(json::JsonWriter &root, text_sensor::TextSensor *obj, const std::string &value);
 #endif
 
 #ifdef USE_COVER
@@ -150,8 +159,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a cover request under '/cover/<id>/<open/close/stop/set>'.
   void handle_cover_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the cover state as a JSON string.
-  std::string cover_json(cover::Cover *obj);
+  /// Dump the cover state as JSON.
+  void cover_json(json::JsonWriter &root, cover::Cover *obj);
 #endif
 
 #ifdef USE_NUMBER
@@ -159,8 +168,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a number request under '/number/<id>'.
   void handle_number_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the number state with its value as a JSON string.
-  std::string number_json(number::Number *obj, float value);
+  /// Dump the number state with its value as JSON.
+  void number_json(json::JsonWriter &root, number::Number *obj, float value);
 #endif
 
 #ifdef USE_SELECT
@@ -168,8 +177,8 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a select request under '/select/<id>'.
   void handle_select_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  /// Dump the number state with its value as a JSON string.
-  std::string select_json(select::Select *obj, const std::string &value);
+  /// Dump the number state with its value as JSON.
+  void select_json(json::JsonWriter &root, select::Select *obj, const std::string &value);
 #endif
 
   /// Override the web handler's canHandle method.
@@ -180,8 +189,25 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   bool isRequestHandlerTrivial() override;
 
  protected:
+  /// Stream the JSON state written by f to all connected event source clients.
+  void send_state_event_(const json::json_write_t &f);
+  /// Stream the JSON state written by f as the response to request.
+  void send_json_response_(AsyncWebServerRequest *request, const json::json_write_t &f);
+  /// Stop sending the initial states to client, if it is waiting for them or receiving them.
+  void remove_initial_state_client_(AsyncEventSourceClient *client);
+  /// Whether client is still connected to the event source, and not deleted yet.
+  bool is_event_source_client_(AsyncEventSourceClient *client);
+
   web_server_base::WebServerBase *base_;
   AsyncEventSource events_{"/events"};
+  InitialStateIterator initial_state_iterator_{this};
+  /// Clients that connected on the AsyncTCP task and are picked up by loop().
+  LockFreeQueue<AsyncEventSourceClient *, 8> connected_clients_;
+  uint32_t connected_clients_dropped_{0};
+  /// Event source clients that are waiting for the initial states, in the order they connected.
+  std::vector<AsyncEventSourceClient *> initial_state_clients_;
+  /// The client the initial state iterator is sending to.
+  AsyncEventSourceClient *initial_state_client_{nullptr};
   const char *username_{nullptr};
   const char *password_{nullptr};
   const char *css_url_{nullptr};
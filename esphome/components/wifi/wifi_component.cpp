@@ -159,6 +159,12 @@ void WiFiComponent::loop() {
     }
   }
 
+  const bool connected = this->is_connected();
+  if (connected != this->was_connected_) {
+    this->was_connected_ = connected;
+    this->connected_state_callback_.call();
+  }
+
   network_tick_mdns();
 }
 
@@ -187,6 +187,10 @@ class WiFiComponent : public Component {
   void set_reboot_timeout(uint32_t reboot_timeout);
 
   bool is_connected();
+  /// Add a callback that is called after is_connected() has changed, at the latest in the next loop iteration.
+  template<typename F> void add_on_connected_state_callback(F &&callback) {
+    this->connected_state_callback_.add(std::forward<F>(callback));
+  }
 
   void set_power_save_mode(WiFiPowerSaveMode power_save);
   void set_output_power(float output_power) { output_power_ = output_power; }
@@ -299,6 +303,8 @@ class WiFiComponent : public Component {
   optional<float> output_power_;
   ESPPreferenceObject pref_;
   bool has_saved_wifi_settings_{false};
+  bool was_connected_{false};
+  CallbackManager<void()> connected_state_callback_;
 };
 
 extern WiFiComponent *global_wifi_component;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
@@ -306,6 +312,10 @@ extern WiFiComponent *global_wifi_component;  // NOLINT(cppcoreguidelines-avoid-
 template<typename... Ts> class WiFiConnectedCondition : public Condition<Ts...> {
  public:
   bool check(Ts... x) override;
+  bool add_listener(ConditionListener *listener) override {
+    global_wifi_component->add_on_connected_state_callback([listener]() { listener->on_condition_change(); });
+    return true;
+  }
 };
 
 template<typename... Ts> bool WiFiConnectedCondition<Ts...>::check(Ts... x) {
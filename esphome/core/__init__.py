@@ -2,7 +2,7 @@ import logging
 import math
 import os
 import re
-from typing import TYPE_CHECKING, Dict, List, Optional, Set, Tuple
+from typing import TYPE_CHECKING, Any, Dict, List, Optional, Set, Tuple
 
 from esphome.const import (
     CONF_ARDUINO_VERSION,
@@ -498,6 +498,8 @@ class EsphomeCore:
         self.loaded_integrations = set()
         # A set of component IDs to track what Component subclasses are declared
         self.component_ids = set()
+        # Data shared between the code generation of integrations, keyed by integration or module name
+        self.data: Dict[str, Any] = {}
         # Whether ESPHome was started in verbose mode
         self.verbose = False
 
@@ -520,6 +522,7 @@ class EsphomeCore:
         self.defines = set()
         self.loaded_integrations = set()
         self.component_ids = set()
+        self.data = {}
 
     @property
     def address(self) -> Optional[str]:
@@ -67,7 +67,11 @@ void Application::setup() {
 void Application::loop() {
   uint32_t new_app_state = 0;
 
+  if (this->looping_components_changed_)
+    this->calculate_looping_components_();
+
   this->scheduler.call();
+  global_preferences.loop();
   for (Component *component : this->looping_components_) {
     {
       WarnIfComponentBlockingGuard guard{component};
@@ -127,6 +131,7 @@ void Application::reboot() {
   ESP_LOGI(TAG, "Forcing a reboot...");
   for (auto *comp : this->components_)
     comp->on_shutdown();
+  global_preferences.sync();
   ESP.restart();
   // restart() doesn't always end execution
   while (true) {
@@ -139,6 +144,7 @@ void Application::safe_reboot() {
     comp->on_safe_shutdown();
   for (auto *comp : this->components_)
     comp->on_shutdown();
+  global_preferences.sync();
   ESP.restart();
   // restart() doesn't always end execution
   while (true) {
@@ -147,10 +153,12 @@ void Application::safe_reboot() {
 }
 
 void Application::calculate_looping_components_() {
+  this->looping_components_.clear();
   for (auto *obj : this->components_) {
-    if (obj->has_overridden_loop())
+    if (obj->has_overridden_loop() && obj->is_loop_enabled())
       this->looping_components_.push_back(obj);
   }
+  this->looping_components_changed_ = false;
 }
 
 Application App;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
@@ -146,6 +146,7 @@ class Application {
     for (auto *comp : this->components_) {
       comp->on_shutdown();
     }
+    global_preferences.sync();
   }
 
   uint32_t get_app_state() const { return this->app_state_; }
@@ -253,7 +254,9 @@ class Application {
   void feed_wdt_arch_();
 
   std::vector<Component *> components_{};
+  /// The components with a loop() that is enabled, rebuilt when looping_components_changed_ is set.
   std::vector<Component *> looping_components_{};
+  bool looping_components_changed_{false};
 
 #ifdef USE_BINARY_SENSOR
   std::vector<binary_sensor::BinarySensor *> binary_sensors_{};
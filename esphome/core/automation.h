@@ -26,6 +26,12 @@ namespace esphome {
 
 #define TEMPLATABLE_STRING_VALUE(name) TEMPLATABLE_STRING_VALUE_(name)
 
+/// Something that waits for a condition and re-checks it when the condition tells it that its result may have changed.
+class ConditionListener {
+ public:
+  virtual void on_condition_change() = 0;
+};
+
 /** Base class for all automation conditions.
  *
  * @tparam Ts The template parameters to pass when executing.
@@ -35,6 +41,14 @@ template<typename... Ts> class Condition {
   /// Check whether this condition passes. This condition check must be instant, and not cause any delays.
   virtual bool check(Ts... x) = 0;
 
+  /** Call listener->on_condition_change() from now on whenever the result of check() may have changed.
+   *
+   * Conditions on the state of an entity hook into its state callback, so that waiting for them doesn't require
+   * calling check() in every loop iteration. Returns false if the condition can't tell when it changes (lambdas), it
+   * then has to be polled.
+   */
+  virtual bool add_listener(ConditionListener *listener) { return false; }
+
   /// Call check with a tuple of values as parameter.
   bool check_tuple(const std::tuple<Ts...> &tuple) {
     return this->check_tuple_(tuple, typename gens<sizeof...(Ts)>::type());
@@ -192,7 +206,7 @@ template<typename... Ts> class Automation {
  public:
   explicit Automation(Trigger<Ts...> *trigger) : trigger_(trigger) { this->trigger_->set_automation_parent(this); }
 
-  Action<Ts...> *add_action(Action<Ts...> *action) { this->actions_.add_action(action); }
+  void add_action(Action<Ts...> *action) { this->actions_.add_action(action); }
   void add_actions(const std::vector<Action<Ts...> *> &actions) { this->actions_.add_actions(actions); }
 
   void stop() { this->actions_.stop(); }
@@ -16,6 +16,12 @@ template<typename... Ts> class AndCondition : public Condition<Ts...> {
 
     return true;
   }
+  bool add_listener(ConditionListener *listener) override {
+    bool all = true;
+    for (auto *condition : this->conditions_)
+      all = condition->add_listener(listener) && all;
+    return all;
+  }
 
  protected:
   std::vector<Condition<Ts...> *> conditions_;
@@ -32,6 +38,12 @@ template<typename... Ts> class OrCondition : public Condition<Ts...> {
 
     return false;
   }
+  bool add_listener(ConditionListener *listener) override {
+    bool all = true;
+    for (auto *condition : this->conditions_)
+      all = condition->add_listener(listener) && all;
+    return all;
+  }
 
  protected:
   std::vector<Condition<Ts...> *> conditions_;
@@ -41,6 +53,7 @@ template<typename... Ts> class NotCondition : public Condition<Ts...> {
  public:
   explicit NotCondition(Condition<Ts...> *condition) : condition_(condition) {}
   bool check(Ts... x) override { return !this->condition_->check(x...); }
+  bool add_listener(ConditionListener *listener) override { return this->condition_->add_listener(listener); }
 
  protected:
   Condition<Ts...> *condition_;
@@ -55,18 +68,30 @@ template<typename... Ts> class LambdaCondition : public Condition<Ts...> {
   std::function<bool(Ts...)> f_;
 };
 
-template<typename... Ts> class ForCondition : public Condition<Ts...>, public Component {
+/** A condition that passes once the inner condition has been passing for some time.
+ *
+ * Keeping track of when the inner condition started passing only requires polling it if it can't tell when it changes.
+ */
+template<typename... Ts> class ForCondition : public Condition<Ts...>, public Component, public ConditionListener {
  public:
   explicit ForCondition(Condition<> *condition) : condition_(condition) {}
 
   TEMPLATABLE_VALUE(uint32_t, time);
 
+  void setup() override {
+    this->check_internal();
+    if (this->condition_->add_listener(this))
+      this->disable_loop();
+  }
   void loop() override { this->check_internal(); }
+  void on_condition_change() override { this->check_internal(); }
   float get_setup_priority() const override { return setup_priority::DATA; }
   bool check_internal() {
     bool cond = this->condition_->check();
-    if (!cond)
+    // last_inactive_ is the time the inner condition started passing
+    if (!cond || !this->active_)
       this->last_inactive_ = millis();
+    this->active_ = cond;
     return cond;
   }
 
@@ -79,6 +104,7 @@ template<typename... Ts> class ForCondition : public Condition<Ts...>, public Co
  protected:
   Condition<> *condition_;
   uint32_t last_inactive_{0};
+  bool active_{false};
 };
 
 class StartupTrigger : public Trigger<>, public Component {
@@ -224,10 +250,21 @@ template<typename... Ts> class WhileAction : public Action<Ts...> {
   std::tuple<Ts...> var_{};
 };
 
-template<typename... Ts> class WaitUntilAction : public Action<Ts...>, public Component {
+/** An action that waits until a condition passes.
+ *
+ * The condition is only re-checked in every loop iteration while waiting and only if it can't tell when it changes,
+ * otherwise it is re-checked whenever it notifies this action.
+ */
+template<typename... Ts> class WaitUntilAction : public Action<Ts...>, public Component, public ConditionListener {
  public:
   WaitUntilAction(Condition<Ts...> *condition) : condition_(condition) {}
 
+  void setup() override {
+    this->polling_ = !this->condition_->add_listener(this);
+    if (!this->polling_ || this->num_running_ == 0)
+      this->disable_loop();
+  }
+
   void play_complex(Ts... x) override {
     this->num_running_++;
     // Check if we can continue immediately.
@@ -238,18 +275,34 @@ template<typename... Ts> class WaitUntilAction : public Action<Ts...>, public Co
       return;
     }
     this->var_ = std::make_tuple(x...);
-    this->loop();
+    if (this->polling_)
+      this->enable_loop();
   }
 
   void loop() override {
-    if (this->num_running_ == 0)
+    if (this->num_running_ == 0) {
+      this->disable_loop();
       return;
+    }
 
     if (!this->condition_->check_tuple(this->var_)) {
+      if (!this->polling_)
+        this->disable_loop();
       return;
     }
 
     this->play_next_tuple_(this->var_);
+    // Further waiting instances continue one per loop iteration
+    if (this->num_running_ == 0) {
+      this->disable_loop();
+    } else {
+      this->enable_loop();
+    }
+  }
+
+  void on_condition_change() override {
+    if (this->num_running_ > 0)
+      this->loop();
   }
 
   float get_setup_priority() const override { return setup_priority::DATA; }
@@ -258,8 +311,11 @@ template<typename... Ts> class WaitUntilAction : public Action<Ts...>, public Co
   }
 
  protected:
+  void stop() override { this->disable_loop(); }
+
   Condition<Ts...> *condition_;
   std::tuple<Ts...> var_{};
+  bool polling_{true};
 };
 
 template<typename... Ts> class UpdateComponentAction : public Action<Ts...> {
@@ -35,6 +35,7 @@ const uint32_t STATUS_LED_MASK = 0xFF00;
 const uint32_t STATUS_LED_OK = 0x0000;
 const uint32_t STATUS_LED_WARNING = 0x0100;
 const uint32_t STATUS_LED_ERROR = 0x0200;
+const uint32_t COMPONENT_LOOP_DISABLED = 0x10000;
 
 uint32_t global_state = 0;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
@@ -65,6 +66,19 @@ bool Component::cancel_timeout(const std::string &name) {  // NOLINT
 void Component::call_loop() { this->loop(); }
 
 void Component::call_setup() { this->setup(); }
+bool Component::is_loop_enabled() const { return (this->component_state_ & COMPONENT_LOOP_DISABLED) == 0; }
+void Component::disable_loop() {
+  if (!this->is_loop_enabled())
+    return;
+  this->component_state_ |= COMPONENT_LOOP_DISABLED;
+  App.looping_components_changed_ = true;
+}
+void Component::enable_loop() {
+  if (this->is_loop_enabled())
+    return;
+  this->component_state_ &= ~COMPONENT_LOOP_DISABLED;
+  App.looping_components_changed_ = true;
+}
 uint32_t Component::get_component_state() const { return this->component_state_; }
 void Component::call() {
   uint32_t state = this->component_state_ & COMPONENT_STATE_MASK;
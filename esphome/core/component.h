@@ -54,6 +54,7 @@ extern const uint32_t STATUS_LED_MASK;
 extern const uint32_t STATUS_LED_OK;
 extern const uint32_t STATUS_LED_WARNING;
 extern const uint32_t STATUS_LED_ERROR;
+extern const uint32_t COMPONENT_LOOP_DISABLED;
 
 class Component {
  public:
@@ -130,6 +131,9 @@ class Component {
 
   bool has_overridden_loop() const;
 
+  /// Whether loop() is called by the application, see disable_loop().
+  bool is_loop_enabled() const;
+
   /** Set where this component was loaded from for some debug messages.
    *
    * This is set by the ESPHome core, and should not be called manually.
@@ -144,6 +148,15 @@ class Component {
  protected:
   virtual void call_loop();
   virtual void call_setup();
+
+  /** Stop calling loop() of this component until enable_loop() is called.
+   *
+   * For components that only have something to do at times, like actions that wait for a condition, so that they
+   * don't cost loop time while they are idle. The change takes effect from the next loop iteration on.
+   */
+  void disable_loop();
+  void enable_loop();
+
   /** Set an interval function with a unique name. Empty name means no cancelling possible.
    *
    * This will call f every interval ms. Can be cancelled via CancelInterval().
@@ -3,20 +3,27 @@
 #include "esphome/core/helpers.h"
 #include "esphome/core/component.h"
 #include "esphome/core/controller.h"
+#include "esphome/core/defines.h"
 #ifdef USE_ESP32_CAMERA
 #include "esphome/components/esp32_camera/esp32_camera.h"
 #endif
 
 namespace esphome {
-namespace api {
 
-class APIServer;
+#ifdef USE_API
+namespace api {
 class UserServiceDescriptor;
+}  // namespace api
+#endif
 
+/** Iterates over all non-internal entities of the application, one entity per call to advance().
+ *
+ * This allows sending the state or info of every entity over a connection without blocking the main loop:
+ * the callbacks return false if the entity could not be sent yet (for example because a buffer is full), in
+ * which case the same entity is retried on the next call to advance().
+ */
 class ComponentIterator {
  public:
-  ComponentIterator(APIServer *server);
-
   void begin();
   void advance();
   virtual bool on_begin();
@@ -41,7 +48,9 @@ class ComponentIterator {
 #ifdef USE_TEXT_SENSOR
   virtual bool on_text_sensor(text_sensor::TextSensor *text_sensor) = 0;
 #endif
-  virtual bool on_service(UserServiceDescriptor *service);
+#ifdef USE_API
+  virtual bool on_service(api::UserServiceDescriptor *service);
+#endif
 #ifdef USE_ESP32_CAMERA
   virtual bool on_camera(esp32_camera::ESP32Camera *camera);
 #endif
@@ -81,7 +90,9 @@ class ComponentIterator {
 #ifdef USE_TEXT_SENSOR
     TEXT_SENSOR,
 #endif
+#ifdef USE_API
     SERVICE,
+#endif
 #ifdef USE_ESP32_CAMERA
     CAMERA,
 #endif
@@ -97,9 +108,6 @@ class ComponentIterator {
     MAX,
   } state_{IteratorState::NONE};
   size_t at_{0};
-
-  APIServer *server_;
 };
 
-}  // namespace api
 }  // namespace esphome
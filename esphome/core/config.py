@@ -48,6 +48,7 @@ LoopTrigger = cg.esphome_ns.class_(
 VERSION_REGEX = re.compile(r"^[0-9]+\.[0-9]+\.[0-9]+(?:[ab]\d+)?$")
 
 CONF_NAME_ADD_MAC_SUFFIX = "name_add_mac_suffix"
+CONF_FLASH_WRITE_DELAY = "flash_write_delay"
 
 
 def validate_board(value: str):
@@ -177,6 +178,9 @@ CONFIG_SCHEMA = cv.Schema(
         cv.SplitDefault(CONF_BOARD_FLASH_MODE, esp8266="dout"): cv.one_of(
             *BUILD_FLASH_MODES, lower=True
         ),
+        cv.Optional(
+            CONF_FLASH_WRITE_DELAY, default="5s"
+        ): cv.positive_time_period_milliseconds,
         cv.Optional(CONF_ON_BOOT): automation.validate_automation(
             {
                 cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(StartupTrigger),
@@ -320,6 +324,12 @@ async def to_code(config):
         )
     )
 
+    cg.add(
+        cg.esphome_ns.global_preferences.set_flash_write_delay(
+            config[CONF_FLASH_WRITE_DELAY]
+        )
+    )
+
     CORE.add_job(_add_automations, config)
 
     # Set LWIP build constants for ESP8266
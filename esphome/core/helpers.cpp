@@ -114,11 +114,19 @@ std::string truncate_string(const std::string &s, size_t length) {
 }
 
 std::string value_accuracy_to_string(float value, int8_t accuracy_decimals) {
+  char tmp[VALUE_ACCURACY_MAX_LEN];
+  size_t len = value_accuracy_to_buf(tmp, sizeof(tmp), value, accuracy_decimals);
+  return std::string(tmp, len);
+}
+size_t value_accuracy_to_buf(char *buf, size_t buf_len, float value, int8_t accuracy_decimals) {
   auto multiplier = float(powf(10.0f, accuracy_decimals));
   float value_rounded = roundf(value * multiplier) / multiplier;
-  char tmp[32];  // should be enough, but we should maybe improve this at some point.
-  dtostrf(value_rounded, 0, uint8_t(std::max(0, int(accuracy_decimals))), tmp);
-  return std::string(tmp);
+  int ret = snprintf(buf, buf_len, "%.*f", std::max(0, int(accuracy_decimals)), value_rounded);
+  if (ret < 0) {
+    buf[0] = '\0';
+    return 0;
+  }
+  return std::min(size_t(ret), buf_len - 1);
 }
 std::string uint64_to_string(uint64_t num) {
   char buffer[17];
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <functional>
 #include <vector>
 #include <memory>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 #include "esphome/core/optional.h"
 #include "esphome/core/esphal.h"
@@ -122,6 +125,15 @@ float gamma_uncorrect(float value, float gamma);
 /// Create a string from a value and an accuracy in decimals.
 std::string value_accuracy_to_string(float value, int8_t accuracy_decimals);
 
+/// Size of a buffer that can always hold the output of value_accuracy_to_buf(), including the null terminator.
+static const size_t VALUE_ACCURACY_MAX_LEN = 64;
+/** Format a value with an accuracy in decimals into a caller-provided buffer, without allocating.
+ *
+ * @param buf The output buffer, should be VALUE_ACCURACY_MAX_LEN bytes long.
+ * @return The length of the formatted string (excluding the null terminator).
+ */
+size_t value_accuracy_to_buf(char *buf, size_t buf_len, float value, int8_t accuracy_decimals);
+
 /// Convert a uint64_t to a hex string
 std::string uint64_to_string(uint64_t num);
 
@@ -201,6 +213,103 @@ template<bool B, class T = void> using enable_if_t = typename std::enable_if<B,
 template<typename T, enable_if_t<!std::is_pointer<T>::value, int> = 0> T id(T value) { return value; }
 template<typename T, enable_if_t<std::is_pointer<T *>::value, int> = 0> T &id(T *value) { return *value; }
 
+template<typename... X> class Callback;
+
+/** A callable like std::function<void(Ts...)>, but 4 bytes smaller.
+ *
+ * Functors of up to two pointers, like lambdas that capture `this` and one other pointer, are stored inline and
+ * larger ones on the heap. Instead of two function pointers each object only stores a pointer to the static
+ * operations of its functor type.
+ */
+template<typename... Ts> class Callback<void(Ts...)> {
+ public:
+  template<typename F, typename D = typename std::decay<F>::type,
+           enable_if_t<!std::is_same<D, Callback>::value, int> = 0>
+  Callback(F &&f) : ops_(Callback::ops<D>()) {
+    Callback::construct<D>(&this->storage_, std::forward<F>(f));
+  }
+  Callback(const Callback &other) : ops_(other.ops_) {
+    this->ops_->manage(&this->storage_, const_cast<Storage *>(&other.storage_), COPY);
+  }
+  Callback(Callback &&other) noexcept : ops_(other.ops_) {
+    this->ops_->manage(&this->storage_, &other.storage_, MOVE);
+  }
+  Callback &operator=(const Callback &other) {
+    if (this != &other) {
+      this->ops_->manage(nullptr, &this->storage_, DESTROY);
+      this->ops_ = other.ops_;
+      this->ops_->manage(&this->storage_, const_cast<Storage *>(&other.storage_), COPY);
+    }
+    return *this;
+  }
+  Callback &operator=(Callback &&other) noexcept {
+    if (this != &other) {
+      this->ops_->manage(nullptr, &this->storage_, DESTROY);
+      this->ops_ = other.ops_;
+      this->ops_->manage(&this->storage_, &other.storage_, MOVE);
+    }
+    return *this;
+  }
+  ~Callback() { this->ops_->manage(nullptr, &this->storage_, DESTROY); }
+
+  void operator()(Ts... args) { this->ops_->invoke(&this->storage_, args...); }
+
+ protected:
+  using Storage = typename std::aligned_storage<2 * sizeof(void *), alignof(void *)>::type;
+  enum Operation : uint8_t { COPY, MOVE, DESTROY };
+  struct Ops {
+    void (*invoke)(Storage *storage, Ts... args);
+    void (*manage)(Storage *dst, Storage *src, Operation op);
+  };
+
+  template<typename D> static constexpr bool is_inline() {
+    return sizeof(D) <= sizeof(Storage) && alignof(D) <= alignof(Storage);
+  }
+  template<typename D> static D *get(Storage *storage) {
+    if (is_inline<D>())
+      return reinterpret_cast<D *>(storage);
+    return *reinterpret_cast<D **>(storage);
+  }
+  template<typename D, typename F> static void construct(Storage *storage, F &&f) {
+    if (is_inline<D>()) {
+      new (storage) D(std::forward<F>(f));
+    } else {
+      *reinterpret_cast<D **>(storage) = new D(std::forward<F>(f));
+    }
+  }
+  template<typename D> static void invoke(Storage *storage, Ts... args) { (*Callback::get<D>(storage))(args...); }
+  template<typename D> static void manage(Storage *dst, Storage *src, Operation op) {
+    switch (op) {
+      case COPY:
+        Callback::construct<D>(dst, *Callback::get<D>(src));
+        break;
+      case MOVE:
+        if (is_inline<D>()) {
+          Callback::construct<D>(dst, std::move(*Callback::get<D>(src)));
+        } else {
+          // Take over the heap allocation
+          *reinterpret_cast<D **>(dst) = Callback::get<D>(src);
+          *reinterpret_cast<D **>(src) = nullptr;
+        }
+        break;
+      case DESTROY:
+        if (is_inline<D>()) {
+          Callback::get<D>(src)->~D();
+        } else {
+          delete Callback::get<D>(src);
+        }
+        break;
+    }
+  }
+  template<typename D> static const Ops *ops() {
+    static const Ops OPS = {&Callback::invoke<D>, &Callback::manage<D>};
+    return &OPS;
+  }
+
+  const Ops *ops_;
+  Storage storage_;
+};
+
 template<typename... X> class CallbackManager;
 
 /** Simple helper class to allow having multiple subscribers to a signal.
@@ -210,7 +319,7 @@ template<typename... X> class CallbackManager;
 template<typename... Ts> class CallbackManager<void(Ts...)> {
  public:
   /// Add a callback to the internal callback list.
-  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  template<typename F> void add(F &&callback) { this->callbacks_.emplace_back(std::forward<F>(callback)); }
 
   /// Call all callbacks in this manager.
   void call(Ts... args) {
@@ -219,7 +328,7 @@ template<typename... Ts> class CallbackManager<void(Ts...)> {
   }
 
  protected:
-  std::vector<std::function<void(Ts...)>> callbacks_;
+  std::vector<Callback<void(Ts...)>> callbacks_;
 };
 
 // https://stackoverflow.com/a/37161919/8924614
@@ -233,6 +342,11 @@ struct is_callable  // NOLINT
   static constexpr auto value = decltype(test<T>(nullptr))::value;  // NOLINT
 };
 
+/** A value that is either a constant or computed by a lambda from the arguments of an action.
+ *
+ * Lambdas without captures (which is what codegen generates when it can) are stored as a plain function pointer, only
+ * other lambdas are wrapped in a heap-allocated std::function.
+ */
 template<typename T, typename... X> class TemplatableValue {
  public:
   TemplatableValue() : type_(EMPTY) {}
@@ -240,14 +354,54 @@ template<typename T, typename... X> class TemplatableValue {
   template<typename F, enable_if_t<!is_callable<F, X...>::value, int> = 0>
   TemplatableValue(F value) : type_(VALUE), value_(value) {}
 
-  template<typename F, enable_if_t<is_callable<F, X...>::value, int> = 0>
-  TemplatableValue(F f) : type_(LAMBDA), f_(f) {}
+  template<typename F, enable_if_t<is_callable<F, X...>::value && std::is_convertible<F, T (*)(X...)>::value, int> = 0>
+  TemplatableValue(F f) : type_(STATELESS_LAMBDA) {
+    this->stateless_f_ = f;
+  }
+
+  template<typename F, enable_if_t<is_callable<F, X...>::value && !std::is_convertible<F, T (*)(X...)>::value, int> = 0>
+  TemplatableValue(F f) : type_(LAMBDA) {
+    this->f_ = new std::function<T(X...)>(std::move(f));
+  }
+
+  TemplatableValue(const TemplatableValue &other) : type_(other.type_), value_(other.value_) {
+    if (this->type_ == LAMBDA) {
+      this->f_ = new std::function<T(X...)>(*other.f_);
+    } else if (this->type_ == STATELESS_LAMBDA) {
+      this->stateless_f_ = other.stateless_f_;
+    }
+  }
+
+  TemplatableValue(TemplatableValue &&other) noexcept : type_(other.type_), value_(std::move(other.value_)) {
+    if (this->type_ == LAMBDA) {
+      this->f_ = other.f_;
+      other.type_ = EMPTY;
+    } else if (this->type_ == STATELESS_LAMBDA) {
+      this->stateless_f_ = other.stateless_f_;
+    }
+  }
+
+  TemplatableValue &operator=(TemplatableValue other) {
+    std::swap(this->type_, other.type_);
+    std::swap(this->value_, other.value_);
+    // Both union members are pointers, so swapping one of them swaps the whole union
+    std::swap(this->f_, other.f_);
+    return *this;
+  }
+
+  ~TemplatableValue() {
+    if (this->type_ == LAMBDA)
+      delete this->f_;
+  }
 
   bool has_value() { return this->type_ != EMPTY; }
 
   T value(X... x) {
+    if (this->type_ == STATELESS_LAMBDA) {
+      return this->stateless_f_(x...);
+    }
     if (this->type_ == LAMBDA) {
-      return this->f_(x...);
+      return (*this->f_)(x...);
     }
     // return value also when empty
     return this->value_;
@@ -268,14 +422,18 @@ template<typename T, typename... X> class TemplatableValue {
   }
 
  protected:
-  enum {
+  enum : uint8_t {
     EMPTY,
     VALUE,
+    STATELESS_LAMBDA,
     LAMBDA,
   } type_;
 
-  T value_;
-  std::function<T(X...)> f_;
+  T value_{};
+  union {
+    T (*stateless_f_)(X...);
+    std::function<T(X...)> *f_{nullptr};
+  };
 };
 
 template<typename... X> class TemplatableStringValue : public TemplatableValue<std::string, X...> {
@@ -285,7 +443,12 @@ template<typename... X> class TemplatableStringValue : public TemplatableValue<s
   template<typename F, enable_if_t<!is_callable<F, X...>::value, int> = 0>
   TemplatableStringValue(F value) : TemplatableValue<std::string, X...>(value) {}
 
-  template<typename F, enable_if_t<is_callable<F, X...>::value, int> = 0>
+  // Lambdas that already return a string are passed on as is, so they can still be stored as a function pointer
+  template<typename F, enable_if_t<std::is_convertible<F, std::string (*)(X...)>::value, int> = 0>
+  TemplatableStringValue(F f) : TemplatableValue<std::string, X...>(f) {}
+
+  template<typename F, enable_if_t<is_callable<F, X...>::value && !std::is_convertible<F, std::string (*)(X...)>::value,
+                                   int> = 0>
   TemplatableStringValue(F f)
       : TemplatableValue<std::string, X...>([f](X... x) -> std::string { return to_string(f(x...)); }) {}
 };
@@ -322,6 +485,67 @@ template<typename T> class Parented {
   T *parent_{nullptr};
 };
 
+/// A non-owning view of a contiguous sequence of objects, the data is only valid as long as its owner keeps it alive.
+template<typename T> class Span {
+ public:
+  Span() = default;
+  Span(T *data, size_t size) : data_(data), size_(size) {}
+
+  T *data() const { return this->data_; }
+  size_t size() const { return this->size_; }
+  bool empty() const { return this->size_ == 0; }
+  T &operator[](size_t index) const { return this->data_[index]; }
+  T *begin() const { return this->data_; }
+  T *end() const { return this->data_ + this->size_; }
+  Span subspan(size_t offset, size_t count) const { return Span(this->data_ + offset, count); }
+
+ protected:
+  T *data_{nullptr};
+  size_t size_{0};
+};
+
+/** A fixed-capacity queue with one producer and one consumer, which may run on different tasks.
+ *
+ * It needs no lock: only the producer moves the tail and only the consumer moves the head. The elements are stored in
+ * place, so queueing never allocates. When the queue is full, new elements are dropped and counted.
+ */
+template<typename T, size_t SIZE> class LockFreeQueue {
+ public:
+  /// Add a copy of element to the end of the queue, only call this from the producer. Returns false if it was dropped.
+  bool push(const T &element) {
+    uint32_t tail = this->tail_.load(std::memory_order_relaxed);
+    uint32_t next = (tail + 1) % (SIZE + 1);
+    if (next == this->head_.load(std::memory_order_acquire)) {
+      this->dropped_.store(this->dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    this->elements_[tail] = element;
+    this->tail_.store(next, std::memory_order_release);
+    return true;
+  }
+  /// The element at the front of the queue or nullptr if it is empty, only call this from the consumer.
+  T *front() {
+    uint32_t head = this->head_.load(std::memory_order_relaxed);
+    if (head == this->tail_.load(std::memory_order_acquire))
+      return nullptr;
+    return &this->elements_[head];
+  }
+  /// Remove the element at the front of the queue, only call this from the consumer once front() returned it.
+  void pop() {
+    uint32_t head = this->head_.load(std::memory_order_relaxed);
+    this->head_.store((head + 1) % (SIZE + 1), std::memory_order_release);
+  }
+  /// The number of elements dropped since construction because the queue was full.
+  uint32_t get_dropped() const { return this->dropped_.load(std::memory_order_relaxed); }
+
+ protected:
+  // one slot stays free to tell a full queue from an empty one
+  T elements_[SIZE + 1];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
+
 uint32_t fnv1_hash(const std::string &str);
 
 template<typename T> T *new_buffer(size_t length) {
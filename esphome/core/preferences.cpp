@@ -3,6 +3,8 @@
 #include "esphome/core/helpers.h"
 #include "esphome/core/application.h"
 
+#include <algorithm>
+
 #ifdef ARDUINO_ARCH_ESP8266
 extern "C" {
 #include "spi_flash.h"
@@ -16,6 +18,8 @@ extern "C" {
 namespace esphome {
 
 static const char *const TAG = "preferences";
+/// Pending changes are written after at most this many write delays, even if preferences keep changing.
+static const uint32_t MAX_WRITE_DELAY_FACTOR = 10;
 
 ESPPreferenceObject::ESPPreferenceObject() : offset_(0), length_words_(0), type_(0), data_(nullptr) {}
 ESPPreferenceObject::ESPPreferenceObject(size_t offset, size_t length, uint32_t type)
@@ -38,6 +42,39 @@ bool ESPPreferenceObject::load_() {
             YESNO(valid), this->data_[0], this->data_[1], this->type_, this->calculate_crc_());
   return valid;
 }
+void ESPPreferences::schedule_sync_() {
+  uint32_t now = millis();
+  if (this->pending_saves_ == 0)
+    this->first_pending_save_ = now;
+  this->last_pending_save_ = now;
+  this->pending_saves_++;
+  if (this->flash_write_delay_ == 0)
+    this->sync();
+}
+void ESPPreferences::loop() {
+  if (this->pending_saves_ == 0)
+    return;
+  uint32_t now = millis();
+  if (now - this->last_pending_save_ < this->flash_write_delay_ &&
+      now - this->first_pending_save_ < this->flash_write_delay_ * MAX_WRITE_DELAY_FACTOR)
+    return;
+  if (!this->sync()) {
+    // try again after another write delay
+    this->first_pending_save_ = this->last_pending_save_ = now;
+  }
+}
+bool ESPPreferences::sync() {
+  if (this->pending_saves_ == 0)
+    return true;
+  if (!this->sync_internal_())
+    return false;
+  this->commits_avoided_ += this->pending_saves_ - 1;
+  ESP_LOGD(TAG, "Wrote %u preference change(s) to flash, %u flash commits avoided since boot", this->pending_saves_,
+           this->commits_avoided_);
+  this->pending_saves_ = 0;
+  return true;
+}
+
 bool ESPPreferenceObject::save_() {
   if (!this->is_initialized()) {
     ESP_LOGV(TAG, "Save Pref Not initialized!");
@@ -59,11 +96,20 @@ static const uint32_t ESP_RTC_USER_MEM_START = 0x60001200;
 static const uint32_t ESP_RTC_USER_MEM_SIZE_WORDS = 128;
 static const uint32_t ESP_RTC_USER_MEM_SIZE_BYTES = ESP_RTC_USER_MEM_SIZE_WORDS * 4;
 
-#ifdef USE_ESP8266_PREFERENCES_FLASH
-static const uint32_t ESP8266_FLASH_STORAGE_SIZE = 128;
-#else
-static const uint32_t ESP8266_FLASH_STORAGE_SIZE = 64;
-#endif
+// The flash preferences are stored as a log of records in the sector at _SPIFFS_end, the one that used to hold the
+// whole preference image, or in the spare sector right below it. The log is compacted into the other sector, which
+// only becomes valid once it is complete, so a power loss while compacting keeps the previous log. The spare sector
+// is reserved by moving _SPIFFS_start/_FS_start down one sector (see writer.py). With linker scripts that don't allow
+// that, it belongs to the area OTA updates are staged in and the log is compacted within its sector.
+/// Maximum size of all flash preferences in words, leaves room for appending records after compacting them.
+static const uint32_t ESP8266_FLASH_STORAGE_SIZE = 480;
+/// Size of the preference image written by versions without the record log.
+static const uint32_t ESP8266_LEGACY_FLASH_STORAGE_SIZE = 128;
+static const uint32_t ESP8266_FLASH_SECTOR_MAGIC = 0x50505345;  // "ESPP"
+/// Sector header: magic and sequence number, the sector with the highest sequence number holds the current log.
+static const uint32_t ESP8266_FLASH_SECTOR_HEADER_SIZE = 8;
+/// Record header: offset and length in words, CRC.
+static const uint32_t ESP8266_FLASH_RECORD_HEADER_SIZE = 8;
 
 static inline bool esp_rtc_user_mem_read(uint32_t index, uint32_t *dest) {
   if (index >= ESP_RTC_USER_MEM_SIZE_WORDS) {
@@ -73,8 +119,6 @@ static inline bool esp_rtc_user_mem_read(uint32_t index, uint32_t *dest) {
   return true;
 }
 
-static bool esp8266_flash_dirty = false;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
-
 static inline bool esp_rtc_user_mem_write(uint32_t index, uint32_t value) {
   if (index >= ESP_RTC_USER_MEM_SIZE_WORDS) {
     return false;
@@ -88,56 +132,221 @@ static inline bool esp_rtc_user_mem_write(uint32_t index, uint32_t value) {
   return true;
 }
 
-extern "C" uint32_t _SPIFFS_end;  // NOLINT
+extern "C" uint32_t _SPIFFS_start;  // NOLINT
+extern "C" uint32_t _SPIFFS_end;    // NOLINT
 
-static const uint32_t get_esp8266_flash_sector() {
+static uint32_t get_esp8266_flash_offset(uint32_t *symbol) {
   union {
     uint32_t *ptr;
     uint32_t uint;
   } data{};
-  data.ptr = &_SPIFFS_end;
-  return (data.uint - 0x40200000) / SPI_FLASH_SEC_SIZE;
+  data.ptr = symbol;
+  return data.uint - 0x40200000;
+}
+/// The flash sector of the log, 0 for the sector at _SPIFFS_end and 1 for the spare sector below it.
+static uint32_t get_esp8266_flash_sector(uint8_t sector) {
+  return get_esp8266_flash_offset(&_SPIFFS_end) / SPI_FLASH_SEC_SIZE - sector;
+}
+static uint32_t get_esp8266_flash_address(uint8_t sector) {
+  return get_esp8266_flash_sector(sector) * SPI_FLASH_SEC_SIZE;
+}
+/// Whether the spare sector is outside of the area OTA updates are staged in, which ends at _SPIFFS_start.
+static bool has_esp8266_spare_flash_sector() {
+  return get_esp8266_flash_offset(&_SPIFFS_start) <= get_esp8266_flash_address(1);
+}
+static bool esp8266_flash_read(uint32_t address, uint32_t *data, size_t len) {
+  InterruptLock lock;
+  return spi_flash_read(address, data, len) == SPI_FLASH_RESULT_OK;
+}
+static bool esp8266_flash_write(uint32_t address, uint32_t *data, size_t len) {
+  InterruptLock lock;
+  return spi_flash_write(address, data, len) == SPI_FLASH_RESULT_OK;
+}
+static uint32_t esp8266_flash_record_crc(uint32_t header, const uint32_t *data, size_t length) {
+  // FNV-1a over the record header and data words
+  uint32_t crc = (2166136261UL ^ header) * 16777619UL;
+  for (size_t i = 0; i < length; i++)
+    crc = (crc ^ data[i]) * 16777619UL;
+  return crc;
 }
-static const uint32_t get_esp8266_flash_address() { return get_esp8266_flash_sector() * SPI_FLASH_SEC_SIZE; }
-
-void ESPPreferences::save_esp8266_flash_() {
-  if (!esp8266_flash_dirty)
-    return;
 
-  ESP_LOGVV(TAG, "Saving preferences to flash...");
-  SpiFlashOpResult erase_res, write_res = SPI_FLASH_RESULT_OK;
+void ESPPreferences::add_esp8266_flash_record_(uint16_t offset, uint16_t length) {
+  // drop records of an older layout that overlap the new one, they would overwrite its data when compacting
+  auto end = offset + length;
+  this->flash_records_.erase(std::remove_if(this->flash_records_.begin(), this->flash_records_.end(),
+                                            [offset, end](const FlashRecord &record) {
+                                              return record.offset < end && offset < record.offset + record.length;
+                                            }),
+                             this->flash_records_.end());
+  this->flash_records_.push_back(FlashRecord{offset, length});
+  if (this->flash_storage_.size() < end)
+    this->flash_storage_.resize(end, 0);
+}
+bool ESPPreferences::write_esp8266_flash_record_(uint8_t sector, const FlashRecord &record) {
+  uint32_t address = get_esp8266_flash_address(sector) + this->flash_write_offset_;
+  uint32_t *data = &this->flash_storage_[record.offset];
+  uint32_t header[2];
+  header[0] = record.offset | (uint32_t(record.length) << 16);
+  header[1] = esp8266_flash_record_crc(header[0], data, record.length);
+  // an interrupted write leaves a record with a wrong CRC, which is skipped when loading
+  bool ok = esp8266_flash_write(address, header, sizeof(header)) &&
+            esp8266_flash_write(address + sizeof(header), data, record.length * 4);
+  this->flash_write_offset_ += ESP8266_FLASH_RECORD_HEADER_SIZE + record.length * 4;
+  return ok;
+}
+bool ESPPreferences::compact_esp8266_flash_() {
+  size_t size = ESP8266_FLASH_SECTOR_HEADER_SIZE;
+  for (const auto &record : this->flash_records_)
+    size += ESP8266_FLASH_RECORD_HEADER_SIZE + record.length * 4;
+  if (size > SPI_FLASH_SEC_SIZE) {
+    ESP_LOGE(TAG, "Preferences don't fit into a flash sector (%u bytes)!", size);
+    return false;
+  }
+  const uint8_t sector = this->flash_has_spare_ ? 1 - this->flash_sector_ : 0;
+  // Without a spare sector the current log is erased, then the sector header is written first so the records written
+  // before an interruption are still found when loading. Otherwise it's written last and the previous log stays valid
+  // until the new one is complete.
+  const bool header_first = sector == this->flash_sector_;
+  ESP_LOGD(TAG, "Compacting preferences in flash...");
+  SpiFlashOpResult erase_res;
   {
     InterruptLock lock;
-    erase_res = spi_flash_erase_sector(get_esp8266_flash_sector());
-    if (erase_res == SPI_FLASH_RESULT_OK) {
-      write_res = spi_flash_write(get_esp8266_flash_address(), this->flash_storage_, ESP8266_FLASH_STORAGE_SIZE * 4);
-    }
+    erase_res = spi_flash_erase_sector(get_esp8266_flash_sector(sector));
   }
+  // nothing can be appended until the log was rewritten successfully, the next save tries again
+  this->flash_write_offset_ = SPI_FLASH_SEC_SIZE;
   if (erase_res != SPI_FLASH_RESULT_OK) {
     ESP_LOGV(TAG, "Erase ESP8266 flash failed!");
-    return;
+    return false;
   }
-  if (write_res != SPI_FLASH_RESULT_OK) {
+
+  uint32_t header[2] = {ESP8266_FLASH_SECTOR_MAGIC, this->flash_sequence_ + 1};
+  bool ok = !header_first || esp8266_flash_write(get_esp8266_flash_address(sector), header, sizeof(header));
+  this->flash_write_offset_ = ESP8266_FLASH_SECTOR_HEADER_SIZE;
+  for (const auto &record : this->flash_records_)
+    ok = ok && this->write_esp8266_flash_record_(sector, record);
+  if (ok && !header_first)
+    ok = esp8266_flash_write(get_esp8266_flash_address(sector), header, sizeof(header));
+  if (!ok) {
     ESP_LOGV(TAG, "Write ESP8266 flash failed!");
+    this->flash_write_offset_ = SPI_FLASH_SEC_SIZE;
+    return false;
+  }
+  this->flash_sector_ = sector;
+  this->flash_sequence_++;
+  return true;
+}
+bool ESPPreferences::save_esp8266_flash_() {
+  if (this->flash_dirty_.empty())
+    return true;
+
+  ESP_LOGVV(TAG, "Saving preferences to flash...");
+  size_t required = 0;
+  for (uint16_t offset : this->flash_dirty_) {
+    for (const auto &record : this->flash_records_) {
+      if (record.offset == offset)
+        required += ESP8266_FLASH_RECORD_HEADER_SIZE + record.length * 4;
+    }
+  }
+
+  bool ok;
+  if (this->flash_write_offset_ + required > SPI_FLASH_SEC_SIZE) {
+    // the sector is full, erase it and write the current state of all preferences
+    ok = this->compact_esp8266_flash_();
+  } else {
+    // common case: append the changed preferences, no erase needed
+    ok = true;
+    for (uint16_t offset : this->flash_dirty_) {
+      for (const auto &record : this->flash_records_) {
+        if (record.offset == offset)
+          ok = this->write_esp8266_flash_record_(this->flash_sector_, record) && ok;
+      }
+    }
+    if (!ok) {
+      ESP_LOGV(TAG, "Write ESP8266 flash failed!");
+      // don't write after a failed record, compact on the next save
+      this->flash_write_offset_ = SPI_FLASH_SEC_SIZE;
+    }
+  }
+  if (ok)
+    this->flash_dirty_.clear();
+  return ok;
+}
+bool ESPPreferences::sync_internal_() { return this->save_esp8266_flash_(); }
+void ESPPreferences::load_esp8266_flash_() {
+  this->flash_has_spare_ = has_esp8266_spare_flash_sector();
+  if (!this->flash_has_spare_)
+    ESP_LOGW(TAG, "No spare flash sector reserved, preferences can be lost if power fails while they're compacted");
+
+  // The spare sector is checked even if it isn't reserved, it holds the log if it was reserved before an update
+  bool found = false;
+  for (uint8_t sector = 0; sector < 2; sector++) {
+    uint32_t sector_header[2];
+    if (!esp8266_flash_read(get_esp8266_flash_address(sector), sector_header, sizeof(sector_header)) ||
+        sector_header[0] != ESP8266_FLASH_SECTOR_MAGIC || (found && sector_header[1] <= this->flash_sequence_))
+      continue;
+    found = true;
+    this->flash_sector_ = sector;
+    this->flash_sequence_ = sector_header[1];
+  }
+  if (!found) {
+    // Nothing written by this version yet, load the preference image of older versions as one big record. It's
+    // replaced by the records of the preferences overlapping it as they're created.
+    ESP_LOGD(TAG, "No preference log found in flash, loading legacy preferences");
+    this->flash_storage_.resize(ESP8266_LEGACY_FLASH_STORAGE_SIZE);
+    esp8266_flash_read(get_esp8266_flash_address(0), this->flash_storage_.data(),
+                       ESP8266_LEGACY_FLASH_STORAGE_SIZE * 4);
+    this->flash_records_.push_back(FlashRecord{0, ESP8266_LEGACY_FLASH_STORAGE_SIZE});
+    // start the log with the next save
+    this->flash_sector_ = 0;
+    this->flash_write_offset_ = SPI_FLASH_SEC_SIZE;
     return;
   }
 
-  esp8266_flash_dirty = false;
+  // replay the records of the sector, later records replace earlier ones
+  uint32_t base = get_esp8266_flash_address(this->flash_sector_);
+  uint32_t pos = ESP8266_FLASH_SECTOR_HEADER_SIZE;
+  std::vector<uint32_t> data;
+  while (pos + ESP8266_FLASH_RECORD_HEADER_SIZE <= SPI_FLASH_SEC_SIZE) {
+    uint32_t header[2];
+    if (!esp8266_flash_read(base + pos, header, sizeof(header)) || header[0] == 0xFFFFFFFF)
+      break;  // erased flash, end of the log
+    uint16_t offset = header[0] & 0xFFFF;
+    uint16_t length = header[0] >> 16;
+    uint32_t size = ESP8266_FLASH_RECORD_HEADER_SIZE + length * 4;
+    if (length == 0 || pos + size > SPI_FLASH_SEC_SIZE) {
+      // corrupted header, don't append after it
+      pos = SPI_FLASH_SEC_SIZE;
+      break;
+    }
+    data.resize(length);
+    if (esp8266_flash_read(base + pos + ESP8266_FLASH_RECORD_HEADER_SIZE, data.data(), length * 4) &&
+        header[1] == esp8266_flash_record_crc(header[0], data.data(), length) &&
+        offset + length <= ESP8266_FLASH_STORAGE_SIZE) {
+      this->add_esp8266_flash_record_(offset, length);
+      std::copy(data.begin(), data.end(), this->flash_storage_.begin() + offset);
+    }
+    pos += size;
+  }
+  // a log in the spare sector that isn't reserved is moved into the reserved one with the next save
+  this->flash_write_offset_ = this->flash_has_spare_ || this->flash_sector_ == 0 ? pos : SPI_FLASH_SEC_SIZE;
+  ESP_LOGV(TAG, "Loaded %u preference records from flash sector %u, the log was compacted %u times",
+           this->flash_records_.size(), this->flash_sector_, this->flash_sequence_);
 }
 
 bool ESPPreferenceObject::save_internal_() {
   if (this->in_flash_) {
-    for (uint32_t i = 0; i <= this->length_words_; i++) {
-      uint32_t j = this->offset_ + i;
-      if (j >= ESP8266_FLASH_STORAGE_SIZE)
-        return false;
-      uint32_t v = this->data_[i];
-      uint32_t *ptr = &global_preferences.flash_storage_[j];
-      if (*ptr != v)
-        esp8266_flash_dirty = true;
-      *ptr = v;
+    auto &storage = global_preferences.flash_storage_;
+    if (this->offset_ + this->length_words_ >= storage.size())
+      return false;
+    if (!std::equal(this->data_, this->data_ + this->length_words_ + 1, storage.begin() + this->offset_)) {
+      // only the RAM copy is updated here, the record is appended once the write delay has passed
+      std::copy(this->data_, this->data_ + this->length_words_ + 1, storage.begin() + this->offset_);
+      auto &dirty = global_preferences.flash_dirty_;
+      if (std::find(dirty.begin(), dirty.end(), this->offset_) == dirty.end())
+        dirty.push_back(this->offset_);
+      global_preferences.schedule_sync_();
     }
-    global_preferences.save_esp8266_flash_();
     return true;
   }
 
@@ -150,13 +359,10 @@ bool ESPPreferenceObject::save_internal_() {
 }
 bool ESPPreferenceObject::load_internal_() {
   if (this->in_flash_) {
-    for (uint32_t i = 0; i <= this->length_words_; i++) {
-      uint32_t j = this->offset_ + i;
-      if (j >= ESP8266_FLASH_STORAGE_SIZE)
-        return false;
-      this->data_[i] = global_preferences.flash_storage_[j];
-    }
-
+    const auto &storage = global_preferences.flash_storage_;
+    if (this->offset_ + this->length_words_ >= storage.size())
+      return false;
+    std::copy(storage.begin() + this->offset_, storage.begin() + this->offset_ + this->length_words_ + 1, this->data_);
     return true;
   }
 
@@ -173,13 +379,8 @@ ESPPreferences::ESPPreferences()
     : current_offset_(0) {}
 
 void ESPPreferences::begin() {
-  this->flash_storage_ = new uint32_t[ESP8266_FLASH_STORAGE_SIZE];
   ESP_LOGVV(TAG, "Loading preferences from flash...");
-
-  {
-    InterruptLock lock;
-    spi_flash_read(get_esp8266_flash_address(), this->flash_storage_, ESP8266_FLASH_STORAGE_SIZE * 4);
-  }
+  this->load_esp8266_flash_();
 }
 
 ESPPreferenceObject ESPPreferences::make_preference(size_t length, uint32_t type, bool in_flash) {
@@ -190,6 +391,7 @@ ESPPreferenceObject ESPPreferences::make_preference(size_t length, uint32_t type
       return {};
     auto pref = ESPPreferenceObject(start, length, type);
     pref.in_flash_ = true;
+    this->add_esp8266_flash_record_(start, length + 1);
     this->current_flash_offset_ = end;
     return pref;
   }
@@ -231,25 +433,32 @@ bool ESPPreferenceObject::save_internal_() {
   if (global_preferences.nvs_handle_ == 0)
     return false;
 
-  char key[32];
-  sprintf(key, "%u", this->offset_);
-  uint32_t len = (this->length_words_ + 1) * 4;
-  esp_err_t err = nvs_set_blob(global_preferences.nvs_handle_, key, this->data_, len);
-  if (err) {
-    ESP_LOGV(TAG, "nvs_set_blob('%s', len=%u) failed: %s", key, len, esp_err_to_name(err));
-    return false;
-  }
-  err = nvs_commit(global_preferences.nvs_handle_);
-  if (err) {
-    ESP_LOGV(TAG, "nvs_commit('%s', len=%u) failed: %s", key, len, esp_err_to_name(err));
-    return false;
+  // keep the data in RAM, it's written to NVS together with other changes once the write delay has passed
+  auto &pending = global_preferences.pending_;
+  auto it = std::find_if(pending.begin(), pending.end(),
+                         [this](const ESPPreferences::PendingSave &save) { return save.key == this->offset_; });
+  if (it == pending.end()) {
+    pending.emplace_back();
+    it = pending.end() - 1;
+    it->key = this->offset_;
   }
+  it->data.assign(this->data_, this->data_ + this->length_words_ + 1);
+  global_preferences.schedule_sync_();
   return true;
 }
 bool ESPPreferenceObject::load_internal_() {
   if (global_preferences.nvs_handle_ == 0)
     return false;
 
+  for (const auto &save : global_preferences.pending_) {
+    if (save.key != this->offset_)
+      continue;
+    if (save.data.size() != this->length_words_ + 1)
+      return false;
+    std::copy(save.data.begin(), save.data.end(), this->data_);
+    return true;
+  }
+
   char key[32];
   sprintf(key, "%u", this->offset_);
   size_t len = (this->length_words_ + 1) * 4;
@@ -271,6 +480,44 @@ bool ESPPreferenceObject::load_internal_() {
   }
   return true;
 }
+bool ESPPreferences::sync_internal_() {
+  if (this->nvs_handle_ == 0)
+    return false;
+
+  bool written = false;
+  std::vector<PendingSave> failed;
+  for (auto &save : this->pending_) {
+    char key[32];
+    sprintf(key, "%u", save.key);
+    size_t len = save.data.size() * 4;
+
+    // don't rewrite data that is already stored, every NVS write uses up flash
+    size_t actual_len;
+    if (nvs_get_blob(this->nvs_handle_, key, nullptr, &actual_len) == ESP_OK && actual_len == len) {
+      std::vector<uint32_t> stored(save.data.size());
+      if (nvs_get_blob(this->nvs_handle_, key, stored.data(), &actual_len) == ESP_OK && stored == save.data)
+        continue;
+    }
+
+    esp_err_t err = nvs_set_blob(this->nvs_handle_, key, save.data.data(), len);
+    if (err) {
+      ESP_LOGV(TAG, "nvs_set_blob('%s', len=%u) failed: %s", key, len, esp_err_to_name(err));
+      failed.push_back(std::move(save));
+      continue;
+    }
+    written = true;
+  }
+  this->pending_.swap(failed);
+
+  if (written) {
+    esp_err_t err = nvs_commit(this->nvs_handle_);
+    if (err) {
+      ESP_LOGV(TAG, "nvs_commit() failed: %s", esp_err_to_name(err));
+      return false;
+    }
+  }
+  return this->pending_.empty();
+}
 ESPPreferences::ESPPreferences() : current_offset_(0) {}
 void ESPPreferences::begin() {
   auto ns = truncate_string(App.get_name(), 15);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "esphome/core/esphal.h"
 #include "esphome/core/defines.h"
@@ -56,6 +57,22 @@ class ESPPreferences {
   ESPPreferenceObject make_preference(size_t length, uint32_t type, bool in_flash = DEFAULT_IN_FLASH);
   template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash = DEFAULT_IN_FLASH);
 
+  /** Set how long no preference may change before the pending changes are written to flash.
+   *
+   * Saves to flash preferences only update a RAM copy, the changes of all preferences are then committed together
+   * once no preference has changed for this long (or at most ten times this long after the first change). This
+   * turns a burst of saves, for example while dimming a light, into a single flash write.
+   *
+   * @param flash_write_delay The delay in milliseconds, 0 writes every save to flash immediately.
+   */
+  void set_flash_write_delay(uint32_t flash_write_delay) { this->flash_write_delay_ = flash_write_delay; }
+  /// Write all pending preference changes to flash now, returns false if that failed.
+  bool sync();
+  /// Write the pending preference changes to flash once the write delay has passed. Called by the application loop.
+  void loop();
+  /// The number of flash commits saved by coalescing preference saves.
+  uint32_t get_commits_avoided() const { return this->commits_avoided_; }
+
 #ifdef ARDUINO_ARCH_ESP8266
   /** On the ESP8266, we can't override the first 128 bytes during OTA uploads
    * as the eboot parameters are stored there. Writing there during an OTA upload
@@ -71,15 +88,55 @@ class ESPPreferences {
  protected:
   friend ESPPreferenceObject;
 
+  /// Called after a flash preference was saved to its RAM copy.
+  void schedule_sync_();
+  /// Write the RAM copies of all changed flash preferences to flash.
+  bool sync_internal_();
+
   uint32_t current_offset_;
+  uint32_t flash_write_delay_{0};
+  /// The number of saves since the last flash commit.
+  uint32_t pending_saves_{0};
+  uint32_t first_pending_save_{0};
+  uint32_t last_pending_save_{0};
+  uint32_t commits_avoided_{0};
 #ifdef ARDUINO_ARCH_ESP32
+  struct PendingSave {
+    uint32_t key;
+    std::vector<uint32_t> data;
+  };
+
   uint32_t nvs_handle_;
+  /// Saved data that has not been written to NVS yet, one entry per key.
+  std::vector<PendingSave> pending_;
 #endif
 #ifdef ARDUINO_ARCH_ESP8266
-  void save_esp8266_flash_();
+  /// A preference stored in the flash record log, offset and length (including the CRC word) in words.
+  struct FlashRecord {
+    uint16_t offset;
+    uint16_t length;
+  };
+
+  void load_esp8266_flash_();
+  bool save_esp8266_flash_();
+  bool compact_esp8266_flash_();
+  void add_esp8266_flash_record_(uint16_t offset, uint16_t length);
+  bool write_esp8266_flash_record_(uint8_t sector, const FlashRecord &record);
   bool prevent_write_{false};
-  uint32_t *flash_storage_;
-  uint32_t current_flash_offset_;
+  /// RAM copy of all flash preferences, indexed by word offset.
+  std::vector<uint32_t> flash_storage_;
+  uint32_t current_flash_offset_{0};
+  /// All preferences stored in the record log.
+  std::vector<FlashRecord> flash_records_;
+  /// Offsets of the preferences that have changed since they were last written.
+  std::vector<uint16_t> flash_dirty_;
+  /// The number of times the log was compacted and the position the next record is appended at.
+  uint32_t flash_sequence_{0};
+  uint32_t flash_write_offset_{0};
+  /// The sector holding the log, 0 for the one at _SPIFFS_end and 1 for the spare sector below it.
+  uint8_t flash_sector_{0};
+  /// Whether the spare sector is reserved, compacting then never erases the sector holding the current log.
+  bool flash_has_spare_{false};
 #endif
 };
 
@@ -25,6 +25,9 @@ from esphome.core import (  # noqa
 from esphome.helpers import cpp_string_escape, indent_all_but_first_and_last
 from esphome.util import OrderedDict
 
+# Key in CORE.data of the IDs of variables that are local to setup()
+KEY_LOCAL_VARIABLES = "cpp_generator_local_variables"
+
 
 class Expression(abc.ABC):
     __slots__ = ()
@@ -464,6 +467,8 @@ def variable(id_: ID, rhs: SafeExpType, type_: "MockObj" = None) -> "MockObj":
     assignment = AssignmentExpression(id_.type, "", id_, rhs, obj)
     CORE.add(assignment)
     CORE.register_variable(id_, obj)
+    # Lambdas referring to this variable have to capture it, as it only exists in setup()
+    CORE.data.setdefault(KEY_LOCAL_VARIABLES, set()).add(id_.id)
     return obj
 
 
@@ -607,7 +612,8 @@ async def process_lambda(
 
     :param value: The lambda to process.
     :param parameters: The parameters to pass to the Lambda, list of tuples
-    :param capture: The capture expression for the lambda, usually ''.
+    :param capture: The capture expression for the lambda, usually ''. Lambdas that use a variable
+      declared with variable() always capture by value.
     :param return_type: The return type of the lambda.
     :return: The generated lambda expression.
     """
@@ -616,8 +622,11 @@ async def process_lambda(
     if value is None:
         return
     parts = value.parts[:]
+    local_variables = CORE.data.get(KEY_LOCAL_VARIABLES, set())
     for i, id in enumerate(value.requires_ids):
         full_id, var = await get_variable_with_full_id(id)
+        if full_id is not None and full_id.id in local_variables:
+            capture = "="
         if (
             full_id is not None
             and isinstance(full_id.type, MockObjClass)
@@ -663,7 +672,9 @@ async def templatable(
     :return: The potentially templated value.
     """
     if is_template(value):
-        return await process_lambda(value, args, return_type=output_type)
+        # Without captures the lambda converts to a function pointer, which TemplatableValue stores without
+        # allocating a std::function
+        return await process_lambda(value, args, capture="", return_type=output_type)
     if to_exp is None:
         return value
     if isinstance(to_exp, dict):
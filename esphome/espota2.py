@@ -1,9 +1,12 @@
 import hashlib
 import logging
+import os
 import random
 import socket
+import struct
 import sys
 import time
+import zlib
 
 from esphome.core import EsphomeError
 from esphome.helpers import is_ip_address, resolve_ip_address
@@ -17,6 +20,8 @@ RESPONSE_UPDATE_PREPARE_OK = 66
 RESPONSE_BIN_MD5_OK = 67
 RESPONSE_RECEIVE_OK = 68
 RESPONSE_UPDATE_END_OK = 69
+RESPONSE_FEATURES_OK = 70
+RESPONSE_BIN_MD5_RESUME = 71
 
 RESPONSE_ERROR_MAGIC = 128
 RESPONSE_ERROR_UPDATE_PREPARE = 129
@@ -28,10 +33,28 @@ RESPONSE_ERROR_WRONG_CURRENT_FLASH_CONFIG = 134
 RESPONSE_ERROR_WRONG_NEW_FLASH_CONFIG = 135
 RESPONSE_ERROR_ESP8266_NOT_ENOUGH_SPACE = 136
 RESPONSE_ERROR_ESP32_NOT_ENOUGH_SPACE = 137
+RESPONSE_ERROR_DECOMPRESSING = 138
+RESPONSE_ERROR_PATCH = 139
 RESPONSE_ERROR_UNKNOWN = 255
 
 OTA_VERSION_1_0 = 1
 
+FEATURE_COMPRESSION = 0x01
+FEATURE_RESUME = 0x02
+FEATURE_DELTA = 0x04
+FEATURES = FEATURE_COMPRESSION | FEATURE_RESUME | FEATURE_DELTA
+
+# gzip with a 4 KiB window, the device keeps only that much history while decompressing
+COMPRESSION_WBITS = 16 + 12
+
+# How often an upload that lost its connection is resumed before giving up
+RESUME_ATTEMPTS = 5
+
+# Number of uploaded binaries kept to compute patches against
+BASE_IMAGES = 3
+# Blocks of this size anchor the matches between the old and the new binary
+PATCH_BLOCK = 16
+
 MAGIC_BYTES = [0x6C, 0x26, 0xF7, 0x5C, 0x45]
 
 _LOGGER = logging.getLogger(__name__)
@@ -68,6 +91,10 @@ class OTAError(EsphomeError):
     pass
 
 
+class OTAConnectionLost(OTAError):
+    """The connection was lost during an upload that the device can resume."""
+
+
 def recv_decode(sock, amount, decode=True):
     data = sock.recv(amount)
     if not decode:
@@ -149,6 +176,16 @@ def check_error(data, expect):
             "Error: The OTA partition on the ESP is too small. ESPHome needs to resize "
             "this partition, please flash over USB."
         )
+    if dat == RESPONSE_ERROR_DECOMPRESSING:
+        raise OTAError(
+            "Error: Decompressing the binary failed. See the MQTT/USB logs for more "
+            "information."
+        )
+    if dat == RESPONSE_ERROR_PATCH:
+        raise OTAError(
+            "Error: Applying the patch to the running firmware failed. See the "
+            "MQTT/USB logs for more information."
+        )
     if dat == RESPONSE_ERROR_UNKNOWN:
         raise OTAError("Unknown error from ESP")
     if not isinstance(expect, (list, tuple)):
@@ -171,12 +208,152 @@ def send_check(sock, data, msg):
         raise OTAError(f"Error sending {msg}: {err}") from err
 
 
-def perform_ota(sock, password, file_handle, filename):
-    file_md5 = hashlib.md5(file_handle.read()).hexdigest()
-    file_size = file_handle.tell()
+def compress_binary(data):
+    compressor = zlib.compressobj(9, zlib.DEFLATED, COMPRESSION_WBITS)
+    return compressor.compress(data) + compressor.flush()
+
+
+def _is_anchor(block):
+    # content defined, so matching blocks are anchors in both binaries
+    return hash(block) & 7 == 0
+
+
+def _extend_match(old, old_pos, new, new_pos):
+    """Length of the approximate match at the given positions.
+
+    Like bsdiff, differing bytes are accepted as long as more bytes match,
+    code that moved only differs in the addresses it refers to.
+    """
+    limit = min(len(old) - old_pos, len(new) - new_pos)
+    length = score = best_length = best_score = 0
+    while length < limit and score > best_score - 32:
+        end = min(length + 64, limit)
+        old_block = old[old_pos + length : old_pos + end]
+        if old_block == new[new_pos + length : new_pos + end]:
+            score += end - length
+            length = end
+        else:
+            score += 1 if old[old_pos + length] == new[new_pos + length] else -1
+            length += 1
+        if score > best_score:
+            best_score, best_length = score, length
+    return best_length
+
+
+def make_patch(old, new):
+    """Compute a patch that turns the binary old into new.
+
+    The patch is a sequence of records, each made of the lengths of a diff
+    and an extra block and the offset in old the diff block applies to
+    (4 bytes LSB first each), followed by the blocks. The bytes of the diff
+    block are added to those of old, the extra block is copied as is. The
+    diff blocks are mostly zero, which the compression of the upload removes.
+    """
+    index = {}
+    for i in range(len(old) - PATCH_BLOCK + 1):
+        block = old[i : i + PATCH_BLOCK]
+        if _is_anchor(block):
+            index.setdefault(block, i)
+
+    patch = bytearray()
+    # the pending diff block, written together with the extra block after it
+    diff_old = diff_new = diff_len = 0
+    scan = 0
+    while scan <= len(new) - PATCH_BLOCK:
+        block = new[scan : scan + PATCH_BLOCK]
+        old_pos = index.get(block) if _is_anchor(block) else None
+        if old_pos is None:
+            scan += 1
+            continue
+
+        # take the bytes before the anchor that match exactly as well
+        start = scan
+        diff_end = diff_new + diff_len
+        while start > diff_end and old_pos > 0 and new[start - 1] == old[old_pos - 1]:
+            start -= 1
+            old_pos -= 1
+        length = _extend_match(old, old_pos, new, start)
+
+        _add_patch_record(patch, old, new, diff_old, diff_new, diff_len, start)
+        diff_old, diff_new, diff_len = old_pos, start, length
+        scan = start + max(length, 1)
+
+    _add_patch_record(patch, old, new, diff_old, diff_new, diff_len, len(new))
+    return bytes(patch)
+
+
+def _add_patch_record(patch, old, new, diff_old, diff_new, diff_len, extra_end):
+    extra_start = diff_new + diff_len
+    patch += struct.pack("<III", diff_len, extra_end - extra_start, diff_old)
+    patch += bytes(
+        (n - o) & 0xFF
+        for n, o in zip(new[diff_new:extra_start], old[diff_old : diff_old + diff_len])
+    )
+    patch += new[extra_start:extra_end]
+
+
+def apply_patch(old, patch):
+    """Apply a patch of make_patch() to old, like the device does."""
+    new = bytearray()
+    pos = 0
+    while pos < len(patch):
+        diff_len, extra_len, old_pos = struct.unpack_from("<III", patch, pos)
+        pos += 12
+        if old_pos + diff_len > len(old):
+            raise ValueError("Patch refers to data beyond the old binary")
+        old_block = old[old_pos : old_pos + diff_len]
+        new += bytes(
+            (o + d) & 0xFF for o, d in zip(old_block, patch[pos : pos + diff_len])
+        )
+        pos += diff_len
+        new += patch[pos : pos + extra_len]
+        pos += extra_len
+    return bytes(new)
+
+
+def base_image_dir(filename):
+    return os.path.join(os.path.dirname(os.path.abspath(filename)), "ota_base")
+
+
+def load_base_image(base_dir, md5):
+    try:
+        with open(os.path.join(base_dir, f"{md5}.bin"), "rb") as base_file:
+            return base_file.read()
+    except OSError:
+        return None
+
+
+def store_base_image(base_dir, contents):
+    """Keep an uploaded binary, the next upload can be sent as a patch against it."""
+    os.makedirs(base_dir, exist_ok=True)
+    md5 = hashlib.md5(contents).hexdigest()
+    with open(os.path.join(base_dir, f"{md5}.bin"), "wb") as base_file:
+        base_file.write(contents)
+    images = sorted(
+        (os.path.join(base_dir, name) for name in os.listdir(base_dir)),
+        key=os.path.getmtime,
+    )
+    for path in images[:-BASE_IMAGES]:
+        os.remove(path)
+
+
+def perform_ota(
+    sock, password, file_handle, filename, features=FEATURES, base_dir=None
+):
+    """Upload the binary over a connected socket.
+
+    If base_dir holds the binary the device runs, only a patch against it is
+    sent.
+
+    Raises OTAConnectionLost if the connection is lost while sending the binary
+    and the device can resume the upload; calling this again with a new
+    connection then continues where the upload stopped.
+    """
+    file_contents = file_handle.read()
+    file_size = len(file_contents)
     _LOGGER.info("Uploading %s (%s bytes)", filename, file_size)
-    file_handle.seek(0)
-    _LOGGER.debug("MD5 of binary is %s", file_md5)
+    if base_dir is None:
+        features &= ~FEATURE_DELTA
 
     # Enable nodelay, we need it for phase 1
     sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
@@ -187,8 +364,27 @@ def perform_ota(sock, password, file_handle, filename):
         raise OTAError(f"Unsupported OTA version {version}")
 
     # Features
-    send_check(sock, 0x00, "features")
-    receive_exactly(sock, 1, "features", RESPONSE_HEADER_OK)
+    send_check(sock, features, "features")
+    (features_ok,) = receive_exactly(
+        sock, 1, "features", [RESPONSE_HEADER_OK, RESPONSE_FEATURES_OK]
+    )
+    if features_ok == RESPONSE_FEATURES_OK:
+        (features,) = receive_exactly(sock, 1, "features", [])
+    else:
+        # device predates the protocol extensions
+        features = 0
+    _LOGGER.debug("Features are 0x%02X", features)
+
+    if features & FEATURE_DELTA:
+        running_md5 = receive_exactly(
+            sock, 32, "firmware MD5", [], decode=False
+        ).decode()
+        _LOGGER.debug("MD5 of running firmware is %s", running_md5)
+        base_contents = load_base_image(base_dir, running_md5)
+        if base_contents is None:
+            _LOGGER.debug("Running firmware is unknown, sending full binary")
+            features &= ~FEATURE_DELTA
+        send_check(sock, 1 if features & FEATURE_DELTA else 0, "delta")
 
     (auth,) = receive_exactly(
         sock, 1, "auth", [RESPONSE_REQUEST_AUTH, RESPONSE_AUTH_OK]
@@ -215,41 +411,71 @@ def perform_ota(sock, password, file_handle, filename):
         send_check(sock, result, "auth result")
         receive_exactly(sock, 1, "auth result", RESPONSE_AUTH_OK)
 
-    file_size_encoded = [
-        (file_size >> 24) & 0xFF,
-        (file_size >> 16) & 0xFF,
-        (file_size >> 8) & 0xFF,
-        (file_size >> 0) & 0xFF,
+    upload_contents = file_contents
+    if features & FEATURE_DELTA:
+        upload_contents = make_patch(base_contents, file_contents)
+        if apply_patch(base_contents, upload_contents) != file_contents:
+            raise OTAError("Computing the patch against the running firmware failed")
+        _LOGGER.info("Patch against running firmware is %s bytes", len(upload_contents))
+    if features & FEATURE_COMPRESSION:
+        upload_contents = compress_binary(upload_contents)
+        _LOGGER.info(
+            "Compressed to %s bytes (%.0f%%)",
+            len(upload_contents),
+            len(upload_contents) * 100.0 / file_size,
+        )
+    upload_size = len(upload_contents)
+    if features & FEATURE_DELTA:
+        # the device checks the binary it builds from the patch
+        upload_md5 = hashlib.md5(file_contents).hexdigest()
+    else:
+        upload_md5 = hashlib.md5(upload_contents).hexdigest()
+    _LOGGER.debug("MD5 of upload is %s", upload_md5)
+
+    upload_size_encoded = [
+        (upload_size >> 24) & 0xFF,
+        (upload_size >> 16) & 0xFF,
+        (upload_size >> 8) & 0xFF,
+        (upload_size >> 0) & 0xFF,
     ]
-    send_check(sock, file_size_encoded, "binary size")
+    send_check(sock, upload_size_encoded, "binary size")
     receive_exactly(sock, 1, "binary size", RESPONSE_UPDATE_PREPARE_OK)
 
-    send_check(sock, file_md5, "file checksum")
-    receive_exactly(sock, 1, "file checksum", RESPONSE_BIN_MD5_OK)
+    send_check(sock, upload_md5, "file checksum")
+    (md5_ok,) = receive_exactly(
+        sock, 1, "file checksum", [RESPONSE_BIN_MD5_OK, RESPONSE_BIN_MD5_RESUME]
+    )
+    offset = 0
+    if md5_ok == RESPONSE_BIN_MD5_RESUME:
+        offset_encoded = receive_exactly(sock, 4, "resume offset", [], decode=False)
+        offset = int.from_bytes(offset_encoded, "big")
+        if offset > upload_size:
+            raise OTAError(f"Invalid resume offset {offset}")
+        _LOGGER.info("Resuming upload at %s of %s bytes", offset, upload_size)
 
     # Disable nodelay for transfer
     sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 0)
     # Limit send buffer (usually around 100kB) in order to have progress bar
-    # show the actual progress
-    sock.setsockopt(socket.SOL_SOCKET, socket.SO_SNDBUF, 8192)
+    # show the actual progress, while still keeping the receive window of the
+    # device full
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_SNDBUF, 16384)
     # Set higher timeout during upload
     sock.settimeout(20.0)
 
-    offset = 0
     progress = ProgressBar()
-    while True:
-        chunk = file_handle.read(1024)
-        if not chunk:
-            break
-        offset += len(chunk)
-
+    upload_view = memoryview(upload_contents)
+    while offset < upload_size:
+        chunk = upload_view[offset : offset + 4096]
         try:
             sock.sendall(chunk)
         except OSError as err:
             sys.stderr.write("\n")
+            if features & FEATURE_RESUME:
+                raise OTAConnectionLost(f"Error sending data: {err}") from err
             raise OTAError(f"Error sending data: {err}") from err
+        offset += len(chunk)
 
-        progress.update(offset / float(file_size))
+        progress.update(offset / float(upload_size))
     progress.done()
 
     # Enable nodelay for last checks
@@ -287,25 +513,50 @@ def run_ota_impl_(remote_host, remote_port, password, filename):
             raise OTAError(err) from err
         _LOGGER.info(" -> %s", ip)
 
-    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-    sock.settimeout(10.0)
-    try:
-        sock.connect((ip, remote_port))
-    except OSError as err:
-        sock.close()
-        _LOGGER.error("Connecting to %s:%s failed: %s", remote_host, remote_port, err)
-        return 1
+    base_dir = base_image_dir(filename)
+    for attempt in range(RESUME_ATTEMPTS + 1):
+        if attempt:
+            # give the device time to notice the lost connection
+            time.sleep(2)
+            _LOGGER.info("Reconnecting to %s to resume the upload", remote_host)
 
-    with open(filename, "rb") as file_handle:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(10.0)
         try:
-            perform_ota(sock, password, file_handle, filename)
-        except OTAError as err:
-            _LOGGER.error(str(err))
-            return 1
-        finally:
+            sock.connect((ip, remote_port))
+        except OSError as err:
             sock.close()
+            _LOGGER.error(
+                "Connecting to %s:%s failed: %s", remote_host, remote_port, err
+            )
+            if attempt:
+                continue
+            return 1
 
-    return 0
+        with open(filename, "rb") as file_handle:
+            try:
+                perform_ota(
+                    sock, password, file_handle, filename, base_dir=base_dir
+                )
+            except OTAConnectionLost as err:
+                _LOGGER.warning(str(err))
+                continue
+            except OTAError as err:
+                _LOGGER.error(str(err))
+                return 1
+            finally:
+                sock.close()
+
+            # the device runs this binary now, the next upload can be a patch
+            file_handle.seek(0)
+            try:
+                store_base_image(base_dir, file_handle.read())
+            except OSError as err:
+                _LOGGER.debug("Storing base image failed: %s", err)
+            return 0
+
+    _LOGGER.error("Giving up after %s attempts to resume the upload", RESUME_ATTEMPTS)
+    return 1
 
 
 def run_ota(remote_host, remote_port, password, filename):
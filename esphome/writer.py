@@ -25,7 +25,7 @@ from esphome.helpers import (
     get_bool_env,
 )
 from esphome.storage_json import StorageJSON, storage_path
-from esphome.boards import ESP8266_FLASH_SIZES, ESP8266_LD_SCRIPTS
+from esphome.boards import ESP8266_FLASH_SIZES, ESP8266_LD_SCRIPTS, FLASH_SIZE_16_MB
 from esphome import loader
 
 _LOGGER = logging.getLogger(__name__)
@@ -273,6 +273,20 @@ def get_ini_content():
         if ld_script is not None:
             data["board_build.ldscript"] = ld_script
 
+        if (
+            ld_script is not None
+            and CORE.arduino_version not in versions_with_old_ldscripts
+            and flash_size != FLASH_SIZE_16_MB
+        ):
+            # These layouts have no filesystem and OTA updates are staged right below
+            # the preferences sector. End the staging area one sector lower, the
+            # preferences need a spare sector to be compacted safely.
+            fs_start = 0x40200000 + flash_size - 0x6000
+            data["build_flags"] = [
+                f"-Wl,--defsym,_FS_start={fs_start:#x}",
+                f"-Wl,--defsym,_SPIFFS_start={fs_start:#x}",
+            ] + data["build_flags"]
+
     # Ignore libraries that are not explicitly used, but may
     # be added by LDF
     # data['lib_ldf_mode'] = 'chain'
@@ -0,0 +1,182 @@
+// Sources: esphome/core/preferences.cpp
+
+#include "host.h"
+#include "esphome/core/preferences.h"
+
+extern "C" {
+#include "spi_flash.h"
+}
+
+#include <cstring>
+#include <new>
+#include <vector>
+
+using namespace esphome;
+
+// The linker symbols of a 4 MB layout, with the spare sector below the preferences reserved by writer.py
+asm(".globl _SPIFFS_start\n.set _SPIFFS_start, 0x405FA000\n.globl _SPIFFS_end\n.set _SPIFFS_end, 0x405FB000");
+
+static const uint32_t PREFERENCES_SECTOR = 0x3FB;
+static const uint32_t SPARE_SECTOR = 0x3FA;
+
+/// The last 16 sectors of the flash.
+static const uint32_t FLASH_START = 0x3F0000;
+static std::vector<uint8_t> flash(16 * SPI_FLASH_SEC_SIZE, 0xFF);  // NOLINT
+/// Erases and writes fail once this many have succeeded, like after a power loss, -1 to never fail.
+static int fail_after = -1;  // NOLINT
+static int operations = 0;   // NOLINT
+static int erases[16];       // NOLINT
+
+static bool power_lost() { return fail_after >= 0 && operations++ >= fail_after; }
+SpiFlashOpResult spi_flash_erase_sector(uint16_t sector) {
+  if (power_lost())
+    return SPI_FLASH_RESULT_ERR;
+  erases[sector - FLASH_START / SPI_FLASH_SEC_SIZE]++;
+  memset(&flash[sector * SPI_FLASH_SEC_SIZE - FLASH_START], 0xFF, SPI_FLASH_SEC_SIZE);
+  return SPI_FLASH_RESULT_OK;
+}
+SpiFlashOpResult spi_flash_write(uint32_t address, uint32_t *src, uint32_t size) {
+  if (power_lost())
+    return SPI_FLASH_RESULT_ERR;
+  // writing can only clear bits
+  auto *data = reinterpret_cast<uint8_t *>(src);
+  for (uint32_t i = 0; i < size; i++)
+    flash[address - FLASH_START + i] &= data[i];
+  return SPI_FLASH_RESULT_OK;
+}
+SpiFlashOpResult spi_flash_read(uint32_t address, uint32_t *dst, uint32_t size) {
+  memcpy(dst, &flash[address - FLASH_START], size);
+  return SPI_FLASH_RESULT_OK;
+}
+
+struct Values {
+  uint32_t a;
+  uint32_t b;
+};
+static const uint32_t COUNT = 6;
+static std::vector<ESPPreferenceObject> prefs;  // NOLINT
+
+static void reboot() {
+  global_preferences.~ESPPreferences();
+  new (&global_preferences) ESPPreferences();
+  global_preferences.set_flash_write_delay(1000);
+  global_preferences.begin();
+  prefs.clear();
+  for (uint32_t i = 0; i < COUNT; i++)
+    prefs.push_back(global_preferences.make_preference<Values>(i + 1));
+}
+
+/// Save the values of all preferences and write them to flash, returns false if that failed.
+static bool save(uint32_t value) {
+  for (uint32_t i = 0; i < COUNT; i++) {
+    Values values{value, value * 2 + i};
+    prefs[i].save(&values);
+  }
+  return global_preferences.sync();
+}
+
+/// Load the value all preferences have, 0 if one can't be loaded or they differ.
+static uint32_t load() {
+  uint32_t value = 0;
+  for (uint32_t i = 0; i < COUNT; i++) {
+    Values values{};
+    if (!prefs[i].load(&values) || values.b != values.a * 2 + i || (i > 0 && values.a != value))
+      return 0;
+    value = values.a;
+  }
+  return value;
+}
+
+static uint8_t *sector_data(uint32_t sector) { return &flash[sector * SPI_FLASH_SEC_SIZE - FLASH_START]; }
+static int sector_erases(uint32_t sector) { return erases[sector - FLASH_START / SPI_FLASH_SEC_SIZE]; }
+
+static void test_legacy_image() {
+  // versions without the log stored the preferences one after another at the start of the preference sector, each
+  // followed by a CRC
+  const uint32_t crc = 1 ^ uint32_t((7 * 2654435769UL) >> 1) ^ uint32_t((14 * 2654435769UL) >> 1);
+  const uint32_t legacy[3] = {7, 14, crc};
+  std::fill(flash.begin(), flash.end(), 0xFF);
+  memcpy(sector_data(PREFERENCES_SECTOR), legacy, sizeof(legacy));
+
+  reboot();
+  Values values{};
+  HOST_CHECK(prefs[0].load(&values) && values.a == 7 && values.b == 14, "legacy values %u %u", values.a, values.b);
+  // the first log is written to the spare sector, the legacy image stays
+  HOST_CHECK(save(8), "save failed");
+  HOST_CHECK(memcmp(sector_data(PREFERENCES_SECTOR), legacy, sizeof(legacy)) == 0, "legacy image was changed");
+  reboot();
+  HOST_CHECK(load() == 8, "loaded %u after the first save", load());
+}
+
+static void test_wear_levelling() {
+  std::fill(flash.begin(), flash.end(), 0xFF);
+  memset(erases, 0, sizeof(erases));
+  uint32_t value = 1;
+  for (int boot = 0; boot < 5; boot++) {
+    reboot();
+    HOST_CHECK(boot == 0 || load() == value, "boot %d: loaded %u instead of %u", boot, load(), value);
+    for (int i = 0; i < 200; i++)
+      save(++value);
+  }
+  reboot();
+  HOST_CHECK(load() == value, "loaded %u instead of %u", load(), value);
+  const int preferences = sector_erases(PREFERENCES_SECTOR);
+  const int spare = sector_erases(SPARE_SECTOR);
+  // 6 records of 20 bytes, a sector holds 34 saves and the compacted log takes one
+  HOST_CHECK(preferences + spare <= 1000 / 33 + 1, "%d erases for 1000 saves", preferences + spare);
+  HOST_CHECK(preferences > 0 && spare > 0 && preferences - spare <= 1 && spare - preferences <= 1,
+             "compacting alternates the sectors, erased %d and %d times", preferences, spare);
+  for (uint32_t sector = FLASH_START / SPI_FLASH_SEC_SIZE; sector < (FLASH_START + flash.size()) / SPI_FLASH_SEC_SIZE;
+       sector++) {
+    if (sector != PREFERENCES_SECTOR && sector != SPARE_SECTOR)
+      HOST_CHECK(sector_erases(sector) == 0, "sector 0x%X was erased", sector);
+  }
+}
+
+static void test_power_loss() {
+  std::fill(flash.begin(), flash.end(), 0xFF);
+  reboot();
+  uint32_t value = 1;
+  save(value);
+  int compactions = 0;
+  while (compactions < 4) {
+    // find out how many flash operations the next save takes and whether it compacts
+    const std::vector<uint8_t> before = flash;
+    const int erased = sector_erases(PREFERENCES_SECTOR) + sector_erases(SPARE_SECTOR);
+    operations = 0;
+    fail_after = 1000000;
+    save(value + 1);
+    fail_after = -1;
+    const int needed = operations;
+    const bool compacted = sector_erases(PREFERENCES_SECTOR) + sector_erases(SPARE_SECTOR) != erased;
+
+    // lose power after each of the operations, the old or the new values must be there after a reboot
+    for (int i = 0; compacted && i < needed; i++) {
+      flash = before;
+      reboot();
+      operations = 0;
+      fail_after = i;
+      HOST_CHECK(!save(value + 1), "save with power loss after %d of %d operations succeeded", i, needed);
+      fail_after = -1;
+      reboot();
+      const uint32_t loaded = load();
+      HOST_CHECK(loaded == value, "power loss after %d of %d operations while compacting: loaded %u instead of %u", i,
+                 needed, loaded, value);
+    }
+    flash = before;
+    reboot();
+    HOST_CHECK(save(++value), "save failed");
+    reboot();
+    HOST_CHECK(load() == value, "loaded %u instead of %u", load(), value);
+    if (compacted)
+      compactions++;
+  }
+}
+
+int main() {
+  test_legacy_image();
+  test_wear_levelling();
+  test_power_loss();
+  printf("%d failures\n", host::failures);
+  return host::failures == 0 ? 0 : 1;
+}
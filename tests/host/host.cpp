@@ -0,0 +1,126 @@
+#include "host.h"
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#include <cstdarg>
+#include <sys/time.h>
+#include <vector>
+
+namespace esphome {
+namespace host {
+
+int failures = 0;  // NOLINT
+
+/// The fake UTC time and the time since boot, in microseconds.
+static int64_t fake_time = 0;     // NOLINT
+static uint64_t fake_micros = 0;  // NOLINT
+
+struct Timeout {
+  Component *component;
+  std::string name;
+  uint32_t at;
+  std::function<void()> f;
+};
+static std::vector<Timeout> timeouts;  // NOLINT
+
+void set_time(time_t timestamp) { fake_time = int64_t(timestamp) * 1000000; }
+time_t get_time() { return fake_time / 1000000; }
+/// Run the timeouts that are due, in the order they were set.
+static void run_timeouts() {
+  bool ran = true;
+  while (ran) {
+    ran = false;
+    for (size_t i = 0; i < timeouts.size(); i++) {
+      if (int32_t(millis() - timeouts[i].at) < 0)
+        continue;
+      std::function<void()> f = std::move(timeouts[i].f);
+      timeouts.erase(timeouts.begin() + i);
+      f();
+      ran = true;
+      break;
+    }
+  }
+}
+
+void advance_micros(uint32_t micros) {
+  fake_time += micros;
+  fake_micros += micros;
+  run_timeouts();
+}
+void advance(uint32_t seconds) {
+  for (uint32_t i = 0; i < seconds; i++)
+    advance_micros(1000000);
+}
+
+}  // namespace host
+
+namespace setup_priority {
+const float BUS = 1000.0f;
+const float IO = 900.0f;
+const float HARDWARE = 800.0f;
+const float DATA = 600.0f;
+const float PROCESSOR = 400.0;
+const float BLUETOOTH = 350.0f;
+const float AFTER_BLUETOOTH = 300.0f;
+const float WIFI = 250.0f;
+const float AFTER_WIFI = 200.0f;
+const float AFTER_CONNECTION = 100.0f;
+const float LATE = -100.0f;
+}  // namespace setup_priority
+
+void Component::setup() {}
+void Component::loop() {}
+void Component::dump_config() {}
+float Component::get_setup_priority() const { return setup_priority::DATA; }
+float Component::get_loop_priority() const { return 0.0f; }
+void Component::mark_failed() {}
+bool Component::can_proceed() { return true; }
+void Component::call_loop() { this->loop(); }
+void Component::call_setup() { this->setup(); }
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {  // NOLINT
+  auto &timeouts = host::timeouts;
+  for (size_t i = 0; i < timeouts.size(); i++) {
+    if (timeouts[i].component == this && timeouts[i].name == name) {
+      timeouts.erase(timeouts.begin() + i);
+      break;
+    }
+  }
+  timeouts.push_back(host::Timeout{this, name, uint32_t(millis() + timeout), std::move(f)});
+}
+
+PollingComponent::PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+void PollingComponent::call_setup() { this->setup(); }
+uint32_t PollingComponent::get_update_interval() const { return this->update_interval_; }
+void PollingComponent::set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+
+void HighFrequencyLoopRequester::start() {}
+void HighFrequencyLoopRequester::stop() {}
+InterruptLock::InterruptLock() {}
+InterruptLock::~InterruptLock() {}
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...) {  // NOLINT
+  va_list arg;
+  va_start(arg, format);
+  printf("[%s:%03d] ", tag, line);
+  vprintf(format, arg);
+  printf("\n");
+  va_end(arg);
+}
+
+}  // namespace esphome
+
+unsigned long millis() { return esphome::host::fake_micros / 1000; }  // NOLINT
+unsigned long micros() { return esphome::host::fake_micros; }          // NOLINT
+void delay(unsigned long ms) { esphome::host::advance_micros(ms * 1000); }  // NOLINT
+
+extern "C" time_t time(time_t *t) {  // NOLINT
+  if (t != nullptr)
+    *t = esphome::host::get_time();
+  return esphome::host::get_time();
+}
+extern "C" int gettimeofday(struct timeval *tv, void *tz) {  // NOLINT
+  tv->tv_sec = esphome::host::fake_time / 1000000;
+  tv->tv_usec = esphome::host::fake_time % 1000000;
+  return 0;
+}
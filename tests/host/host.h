@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+
+// Support for the host tests: a fake clock, the timeouts components set, and checks.
+
+namespace esphome {
+namespace host {
+
+/// Set the fake UTC time returned by time() and gettimeofday(), like a time sync. millis() doesn't change.
+void set_time(time_t timestamp);
+time_t get_time();
+/// Let the given number of microseconds pass, then run the timeouts that have become due.
+void advance_micros(uint32_t micros);
+/// Let the given number of seconds pass second by second, running the timeouts that become due.
+void advance(uint32_t seconds);
+
+extern int failures;
+
+}  // namespace host
+}  // namespace esphome
+
+#define HOST_CHECK(condition, ...) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #condition); \
+      printf(__VA_ARGS__); \
+      printf("\n"); \
+      esphome::host::failures++; \
+    } \
+  } while (0)
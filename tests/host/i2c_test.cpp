@@ -0,0 +1,200 @@
+// Sources: esphome/components/i2c/i2c.cpp esphome/components/tca9548a/tca9548a.cpp
+
+#include "host.h"
+#include "esphome/core/application.h"
+#include "esphome/components/i2c/i2c.h"
+#include "esphome/components/tca9548a/tca9548a.h"
+
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::i2c;
+
+// A simulated bus at 100kHz with a TCA9548A multiplexer. Each channel has a device at the same address, and reads
+// return the channel that is selected.
+
+static const uint8_t MULTIPLEXER_ADDRESS = 0x70;
+static const uint32_t BYTE_MICROS = 90;
+
+static uint8_t selected_channel = 0xFF;  // NOLINT
+static uint32_t channel_switches = 0;    // NOLINT
+static uint8_t transmission_address = 0;  // NOLINT
+static uint8_t transmission_length = 0;   // NOLINT
+static uint8_t last_written = 0;          // NOLINT
+static uint32_t transfers = 0;            // NOLINT
+
+TwoWire Wire;  // NOLINT
+void TwoWire::begin(int sda, int scl) {}
+void TwoWire::setClock(uint32_t frequency) {}
+void TwoWire::beginTransmission(uint8_t address) {
+  transmission_address = address;
+  transmission_length = 0;
+}
+size_t TwoWire::write(uint8_t data) {
+  last_written = data;
+  transmission_length++;
+  return 1;
+}
+uint8_t TwoWire::endTransmission(bool send_stop) {
+  transfers++;
+  host::advance_micros((1 + transmission_length) * BYTE_MICROS);
+  if (transmission_address == MULTIPLEXER_ADDRESS && transmission_length == 2) {
+    // the register byte of write_byte(), then the channel mask
+    for (uint8_t channel = 0; channel < 8; channel++) {
+      if (last_written == 1 << channel) {
+        selected_channel = channel;
+        channel_switches++;
+      }
+    }
+  }
+  return 0;
+}
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t len) {
+  transfers++;
+  host::advance_micros((1 + len) * BYTE_MICROS);
+  return len;
+}
+int TwoWire::read() { return selected_channel; }
+
+namespace esphome {
+Application App;  // NOLINT
+void Application::feed_wdt() {}
+namespace i2c {
+// only declared, the firmware is optimized enough to not need the vtable of the base class
+void I2CMultiplexer::set_channel(uint8_t channelno) {}
+}  // namespace i2c
+}  // namespace esphome
+
+class PolledDevice : public I2CDevice {
+ public:
+  /// Start an asynchronous read with the given conversion time.
+  void poll(uint32_t conversion) {
+    const uint32_t start = millis();
+    this->polls++;
+    this->pending++;
+    this->read_bytes_async(0x00, 2, conversion, [this, start, conversion](bool success, const uint8_t *data) {
+      this->pending--;
+      if (!success || data[0] != this->channel || data[1] != this->channel) {
+        this->wrong++;
+        return;
+      }
+      const uint32_t latency = millis() - start;
+      this->reads++;
+      this->total_latency += latency;
+      if (latency < conversion)
+        this->early++;
+      if (latency > this->max_latency)
+        this->max_latency = latency;
+    });
+  }
+
+  /// The channel the device is on, the value reads return.
+  uint8_t channel{0};
+  int polls{0};
+  int pending{0};
+  int reads{0};
+  int wrong{0};
+  int early{0};
+  uint32_t total_latency{0};
+  uint32_t max_latency{0};
+};
+
+struct Result {
+  int polls;
+  int reads;
+  int wrong;
+  int early;
+  uint32_t switches;
+  uint32_t max_latency;
+};
+
+/** Poll 32 devices on the 8 channels once a second each with a 20ms conversion, running the bus loop every 16ms.
+ *
+ * The polls of the devices are spread over the second.
+ */
+static Result run(uint32_t latency_budget, int seconds) {
+  I2CComponent bus;
+  tca9548a::TCA9548AComponent multiplexer;
+  multiplexer.set_i2c_parent(&bus);
+  multiplexer.set_i2c_address(MULTIPLEXER_ADDRESS);
+  std::vector<PolledDevice> devices(32);
+  std::vector<uint32_t> next(devices.size());
+  for (size_t i = 0; i < devices.size(); i++) {
+    devices[i].set_i2c_parent(&bus);
+    devices[i].set_i2c_address(0x40);
+    devices[i].channel = i % 8;
+    devices[i].set_i2c_multiplexer(&multiplexer, devices[i].channel);
+    devices[i].set_i2c_latency_budget(latency_budget);
+    next[i] = millis() + (i * 997) % 1000;
+  }
+  selected_channel = 0xFF;
+  channel_switches = 0;
+
+  const uint32_t end = millis() + seconds * 1000;
+  while (int32_t(millis() - end) < 0) {
+    for (size_t i = 0; i < devices.size(); i++) {
+      if (int32_t(millis() - next[i]) >= 0) {
+        next[i] += 1000;
+        devices[i].poll(20);
+      }
+    }
+    bus.loop();
+    host::advance_micros(16000);
+  }
+  // let the last reads finish
+  for (int i = 0; i < 10; i++) {
+    bus.loop();
+    host::advance_micros(16000);
+  }
+
+  Result result{0, 0, 0, 0, channel_switches, 0};
+  for (auto &device : devices) {
+    HOST_CHECK(device.pending == 0, "%d reads pending", device.pending);
+    result.polls += device.polls;
+    result.reads += device.reads;
+    result.wrong += device.wrong;
+    result.early += device.early;
+    if (device.max_latency > result.max_latency)
+      result.max_latency = device.max_latency;
+  }
+  return result;
+}
+
+static void test_batching() {
+  const Result unbatched = run(0, 60);
+  const Result batched = run(50, 60);
+  for (const Result &result : {unbatched, batched}) {
+    HOST_CHECK(result.polls >= 32 * 59 && result.reads == result.polls, "%d of %d reads", result.reads, result.polls);
+    HOST_CHECK(result.wrong == 0, "%d reads on the wrong channel", result.wrong);
+    HOST_CHECK(result.early == 0, "%d reads before the conversion time", result.early);
+  }
+  // the write and the read may each wait for the budget, plus a loop iteration
+  HOST_CHECK(batched.max_latency <= 20 + 2 * 50 + 2 * 16, "latency up to %ums", batched.max_latency);
+  HOST_CHECK(batched.switches * 3 < unbatched.switches * 2, "%u channel switches batched, %u without",
+             batched.switches, unbatched.switches);
+}
+
+static void test_without_multiplexer() {
+  // without a needed channel switch or a conversion time a transaction runs right away
+  I2CComponent bus;
+  PolledDevice device;
+  device.set_i2c_parent(&bus);
+  device.set_i2c_address(0x40);
+  selected_channel = 0;
+  const uint32_t before = transfers;
+  device.poll(0);
+  HOST_CHECK(transfers == before + 2 && device.reads == 1, "%u transfers, %d reads", transfers - before, device.reads);
+  device.poll(20);
+  HOST_CHECK(transfers == before + 3 && device.pending == 1, "%u transfers before the conversion",
+             transfers - before);
+  host::advance_micros(20000);
+  bus.loop();
+  HOST_CHECK(transfers == before + 4 && device.pending == 0, "%u transfers after the conversion", transfers - before);
+}
+
+int main() {
+  test_batching();
+  test_without_multiplexer();
+  printf("%d failures\n", host::failures);
+  return host::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+// Sources: esphome/components/json/json_writer.cpp
+
+#include "host.h"
+#include "esphome/components/json/json_writer.h"
+
+#include <cmath>
+#include <string>
+
+using namespace esphome;
+using namespace esphome::json;
+
+class StringPrint : public Print {
+ public:
+  size_t write(uint8_t c) override {
+    this->str.push_back(char(c));
+    return 1;
+  }
+
+  std::string str;
+};
+
+static void test_values() {
+  StringPrint out;
+  JsonWriter writer(&out);
+  writer.begin_object();
+  writer.add("name", "a \"quoted\"\\\n\x01 name");
+  writer.add("on", true);
+  writer.add("value", 1.5f);
+  writer.add("nan", NAN);
+  writer.add("count", -42);
+  writer.add("big", uint64_t(18446744073709551615ULL));
+  writer.add_null("none");
+  writer.begin_array("list");
+  writer.add(1);
+  writer.add("two");
+  writer.begin_object();
+  writer.end_object();
+  writer.begin_array();
+  writer.end_array();
+  writer.end_array();
+  writer.end_object();
+  const char *expected = R"({"name":"a \"quoted\"\\\n\u0001 name","on":true,"value":1.5,"nan":null,"count":-42,)"
+                         R"("big":18446744073709551615,"none":null,"list":[1,"two",{},[]]})";
+  HOST_CHECK(out.str == expected, "wrote %s", out.str.c_str());
+}
+
+static std::string nested(int depth, const std::string &inner) {
+  return std::string(depth, '[') + inner + std::string(depth, ']');
+}
+
+static void test_max_depth() {
+  StringPrint out;
+  JsonWriter writer(&out);
+  for (int i = 0; i < JsonWriter::MAX_DEPTH; i++)
+    writer.begin_array();
+  writer.add(1);
+  // too deep: dropped together with its elements
+  writer.begin_array();
+  writer.add(2);
+  writer.begin_object();
+  writer.add("key", 3);
+  writer.end_object();
+  writer.end_array();
+  writer.add(4);
+  for (int i = 0; i < JsonWriter::MAX_DEPTH; i++)
+    writer.end_array();
+  // closing more than was opened is ignored
+  writer.end_array();
+  HOST_CHECK(out.str == nested(JsonWriter::MAX_DEPTH, "1,4"), "wrote %s", out.str.c_str());
+
+  // a dropped first element doesn't make the next one start with a comma
+  out.str.clear();
+  writer.begin_object();
+  for (int i = 1; i < JsonWriter::MAX_DEPTH; i++)
+    writer.begin_array("a");
+  writer.begin_object("dropped");
+  writer.end_object();
+  writer.add(5);
+  for (int i = 1; i < JsonWriter::MAX_DEPTH; i++)
+    writer.end_array();
+  writer.add("after", true);
+  writer.end_object();
+  std::string expected = "{";
+  for (int i = 1; i < JsonWriter::MAX_DEPTH; i++)
+    expected += R"("a":[)";
+  expected += "5" + std::string(JsonWriter::MAX_DEPTH - 1, ']') + R"(,"after":true})";
+  HOST_CHECK(out.str == expected, "wrote %s", out.str.c_str());
+}
+
+int main() {
+  test_values();
+  test_max_depth();
+  printf("%d failures\n", host::failures);
+  return host::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+// Sources: esphome/components/modbus/modbus.cpp
+
+#include "host.h"
+#include "esphome/components/modbus/modbus.h"
+
+#include <deque>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::modbus;
+
+// A simulated RS-485 bus at 9600 baud with slaves that answer read requests with their address in every data byte.
+
+static const uint32_t BAUD_RATE = 9600;
+static const uint32_t BYTE_MICROS = 11 * 1000000 / BAUD_RATE;
+/// The time a slave takes to start its response.
+static const uint32_t TURNAROUND_MICROS = 5000;
+
+struct Byte {
+  uint64_t at;
+  uint8_t value;
+};
+/// The bytes the slaves send, with the time they arrive at the master.
+static std::deque<Byte> wire;  // NOLINT
+/// Slaves up to this address answer.
+static uint8_t present_slaves = 0;  // NOLINT
+/// Every n-th request isn't answered, 0 to answer all.
+static uint32_t lose_every = 0;  // NOLINT
+static uint32_t requests = 0;    // NOLINT
+/// The addresses in the order their requests were sent.
+static std::vector<uint8_t> sent;  // NOLINT
+
+namespace esphome {
+
+// dump_config() logs the flow control pin, which the bus doesn't have
+uint8_t GPIOPin::get_pin() const { return this->pin_; }
+const char *GPIOPin::get_pin_mode_name() const { return ""; }
+bool GPIOPin::is_inverted() const { return this->inverted_; }
+
+namespace uart {
+
+void UARTComponent::write_array(const uint8_t *data, size_t len) {
+  const uint8_t address = data[0];
+  const uint16_t count = (data[4] << 8) | data[5];
+  sent.push_back(address);
+  // flush() waits until the frame is sent
+  host::advance_micros(len * BYTE_MICROS);
+  requests++;
+  if (address > present_slaves || (lose_every != 0 && requests % lose_every == 0))
+    return;
+
+  std::vector<uint8_t> response{address, data[1], uint8_t(count * 2)};
+  response.resize(3 + count * 2, address);
+  const uint16_t crc = crc16(response.data(), response.size());
+  response.push_back(crc);
+  response.push_back(crc >> 8);
+  uint64_t at = micros() + TURNAROUND_MICROS;
+  for (uint8_t value : response) {
+    at += BYTE_MICROS;
+    wire.push_back(Byte{at, value});
+  }
+}
+Span<const uint8_t> UARTComponent::read_span(size_t max_len) {
+  this->read_chunk_.clear();
+  while (!wire.empty() && wire.front().at <= micros() && this->read_chunk_.size() < max_len) {
+    this->read_chunk_.push_back(wire.front().value);
+    wire.pop_front();
+  }
+  return Span<const uint8_t>(this->read_chunk_.data(), this->read_chunk_.size());
+}
+void UARTComponent::flush() {}
+void UARTComponent::setup() {}
+void UARTComponent::dump_config() {}
+int UARTComponent::available() { return !wire.empty() && wire.front().at <= micros(); }
+size_t UARTComponent::write(uint8_t data) { return 0; }
+int UARTComponent::read() { return -1; }
+int UARTComponent::peek() { return -1; }
+
+}  // namespace uart
+}  // namespace esphome
+
+class CountingDevice : public ModbusDevice {
+ public:
+  void on_modbus_data(Span<const uint8_t> data) override {
+    for (uint8_t value : data) {
+      if (value != this->address_) {
+        this->mismatched++;
+        return;
+      }
+    }
+    this->responses++;
+  }
+
+  int responses{0};
+  int mismatched{0};
+};
+
+/// Poll all devices once a second for the given number of seconds, running the bus loop every millisecond.
+static void run(Modbus &bus, std::vector<CountingDevice> &devices, int seconds) {
+  for (int second = 0; second < seconds; second++) {
+    for (auto &device : devices)
+      device.send(0x04, 0, 10);
+    for (int i = 0; i < 1000; i++) {
+      bus.loop();
+      host::advance_micros(1000);
+    }
+  }
+}
+
+static void setup(Modbus &bus, uart::UARTComponent &uart, std::vector<CountingDevice> &devices) {
+  wire.clear();
+  sent.clear();
+  requests = 0;
+  uart.set_baud_rate(BAUD_RATE);
+  bus.set_uart_parent(&uart);
+  bus.setup();
+  for (size_t i = 0; i < devices.size(); i++) {
+    devices[i].set_parent(&bus);
+    devices[i].set_address(i + 1);
+    bus.register_device(&devices[i]);
+  }
+}
+
+static void test_shared_bus() {
+  // 20 slaves polled for 10 registers once a second take about 800ms of the bus
+  uart::UARTComponent uart;
+  Modbus bus;
+  std::vector<CountingDevice> devices(20);
+  present_slaves = 20;
+  lose_every = 0;
+  setup(bus, uart, devices);
+  run(bus, devices, 60);
+
+  HOST_CHECK(bus.get_responses() == 20 * 60, "%u responses", bus.get_responses());
+  HOST_CHECK(bus.get_timeouts() == 0 && bus.get_retries() == 0, "%u timeouts, %u retries", bus.get_timeouts(),
+             bus.get_retries());
+  for (size_t i = 0; i < devices.size(); i++) {
+    HOST_CHECK(devices[i].responses == 60 && devices[i].mismatched == 0, "device %u got %d responses and %d of others",
+               unsigned(i + 1), devices[i].responses, devices[i].mismatched);
+  }
+}
+
+static void test_priority() {
+  uart::UARTComponent uart;
+  Modbus bus;
+  std::vector<CountingDevice> devices(5);
+  present_slaves = 5;
+  lose_every = 0;
+  setup(bus, uart, devices);
+  devices[4].set_priority(1);
+  run(bus, devices, 1);
+  // the first request is sent right away, the one with the priority next
+  HOST_CHECK(sent.size() == 5 && sent[0] == 1 && sent[1] == 5 && sent[2] == 2, "sent to %u, %u, %u of %u", sent[0],
+             sent[1], sent[2], unsigned(sent.size()));
+  // a request that is already queued isn't queued again
+  devices[0].send(0x04, 0, 10);
+  devices[0].send(0x04, 0, 10);
+  devices[1].send(0x04, 0, 10);
+  devices[1].send(0x04, 0, 10);
+  for (int i = 0; i < 1000; i++) {
+    bus.loop();
+    host::advance_micros(1000);
+  }
+  HOST_CHECK(sent.size() == 7, "sent %u requests", unsigned(sent.size()));
+}
+
+static void test_timeouts() {
+  // slaves 4 and 5 don't answer, and every 5th request is lost
+  uart::UARTComponent uart;
+  Modbus bus;
+  std::vector<CountingDevice> devices(5);
+  present_slaves = 3;
+  lose_every = 5;
+  setup(bus, uart, devices);
+  bus.set_response_timeout(100);
+  run(bus, devices, 10);
+
+  HOST_CHECK(bus.get_timeouts() == 2 * 10, "%u timeouts", bus.get_timeouts());
+  for (int i = 0; i < 3; i++) {
+    HOST_CHECK(devices[i].responses == 10 && devices[i].mismatched == 0, "device %d got %d responses and %d of others",
+               i + 1, devices[i].responses, devices[i].mismatched);
+  }
+  HOST_CHECK(bus.get_retries() > 2 * 10, "%u retries", bus.get_retries());
+}
+
+int main() {
+  test_shared_bus();
+  test_priority();
+  test_timeouts();
+  printf("%d failures\n", host::failures);
+  return host::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// The parts of the Arduino API the host tests need. The tests are built as ESP8266 code without the framework.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+typedef uint8_t byte;  // NOLINT
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x02
+#define INPUT_PULLUP 0x04
+
+unsigned long millis();  // NOLINT
+unsigned long micros();  // NOLINT
+void delay(unsigned long ms);  // NOLINT
+void delayMicroseconds(unsigned int us);
+void yield();
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
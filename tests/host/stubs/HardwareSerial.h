@@ -0,0 +1,5 @@
+#pragma once
+
+#include "Stream.h"
+
+class HardwareSerial;
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class Print {
+ public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--)
+      n += this->write(*buffer++);
+    return n;
+  }
+  size_t write(const char *str) { return this->write(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+  size_t print(const char *str) { return this->write(str); }
+};
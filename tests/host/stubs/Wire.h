@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The host tests define the transfers to simulate devices on the bus.
+class TwoWire {
+ public:
+  TwoWire(uint8_t bus_num = 0) {}
+  void begin(int sda, int scl);
+  void setClock(uint32_t frequency);
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool send_stop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t len);
+  size_t write(uint8_t data);
+  int read();
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,5 @@
+#pragma once
+
+#define ARDUINO_ESP8266_MAJOR 3
+#define ARDUINO_ESP8266_MINOR 0
+#define ARDUINO_ESP8266_REVISION 2
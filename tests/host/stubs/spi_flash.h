@@ -0,0 +1,7 @@
+#pragma once
+#include <cstdint>
+#define SPI_FLASH_SEC_SIZE 4096
+typedef enum { SPI_FLASH_RESULT_OK, SPI_FLASH_RESULT_ERR } SpiFlashOpResult;
+SpiFlashOpResult spi_flash_erase_sector(uint16_t sec);
+SpiFlashOpResult spi_flash_write(uint32_t addr, uint32_t *src, uint32_t size);
+SpiFlashOpResult spi_flash_read(uint32_t addr, uint32_t *dst, uint32_t size);
@@ -0,0 +1,7 @@
+#pragma once
+
+// glibc declares a variable named timezone in time.h, which hides struct timezone from sys/time.h in C++. The
+// ESP8266 toolchain has no such variable, so the struct gets another name on the host.
+#include <time.h>
+#define timezone host_timezone
+#include_next <sys/time.h>
@@ -0,0 +1,157 @@
+// Sources: esphome/components/time/automation.cpp esphome/components/time/real_time_clock.cpp
+
+#include "host.h"
+#include "esphome/components/time/automation.h"
+#include "esphome/core/base_automation.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::time;
+
+class FakeClock : public RealTimeClock {
+ public:
+  void update() override {}
+  /// Set the time like a time source does.
+  void sync(time_t timestamp) {
+    host::set_time(timestamp);
+    this->time_sync_callback_.call();
+  }
+};
+
+/// A cron trigger with all days, counting how often it fired.
+class CountingTrigger : public CronTrigger {
+ public:
+  CountingTrigger(RealTimeClock *rtc, const std::vector<uint8_t> &seconds, const std::vector<uint8_t> &minutes,
+                  const std::vector<uint8_t> &hours)
+      : CronTrigger(rtc), automation_(this) {
+    this->add_seconds(seconds);
+    this->add_minutes(minutes);
+    this->add_hours(hours);
+    for (uint8_t i = 1; i <= 31; i++)
+      this->add_day_of_month(i);
+    for (uint8_t i = 1; i <= 12; i++)
+      this->add_month(i);
+    for (uint8_t i = 1; i <= 7; i++)
+      this->add_day_of_week(i);
+    this->automation_.add_action(new LambdaAction<>([this]() { this->fired++; }));
+  }
+
+  int fired{0};
+
+ protected:
+  Automation<> automation_;
+};
+
+static std::vector<uint8_t> range(uint8_t from, uint8_t to) {
+  std::vector<uint8_t> values;
+  for (uint8_t i = from; i < to; i++)
+    values.push_back(i);
+  return values;
+}
+
+/// Compare next_match_after() with checking every second of local time from start to end.
+static void check_next_match(const char *name, CountingTrigger &trigger, time_t start, time_t end) {
+  time_t last = start;
+  time_t next = trigger.next_match_after(start);
+  int matches = 0;
+  for (time_t timestamp = start + 1; timestamp <= end; timestamp++) {
+    if (!trigger.matches(ESPTime::from_epoch_local(timestamp)))
+      continue;
+    HOST_CHECK(next == timestamp, "%s: matches at %ld, next_match_after(%ld) is %ld", name, (long) timestamp,
+               (long) last, (long) next);
+    matches++;
+    last = timestamp;
+    next = trigger.next_match_after(timestamp);
+  }
+  HOST_CHECK(next == 0 || next > end, "%s: no match until %ld, next_match_after(%ld) is %ld", name, (long) end,
+             (long) last, (long) next);
+  HOST_CHECK(matches > 0, "%s: no matches", name);
+}
+
+/// Check the days around the start and the end of DST in a timezone.
+static void test_dst(const char *tz, time_t begin, time_t end) {
+  setenv("TZ", tz, 1);
+  tzset();
+  FakeClock rtc;
+  CountingTrigger daily(&rtc, {0}, {30}, {2});
+  CountingTrigger quarter(&rtc, {0, 30}, {0, 15, 30, 45}, range(0, 24));
+  CountingTrigger half_past(&rtc, {0}, {30}, range(0, 24));
+  CountingTrigger every_second(&rtc, range(0, 60), range(0, 60), {1, 2, 3});
+
+  for (time_t start : {begin, end}) {
+    check_next_match("daily", daily, start, start + 3 * 86400);
+    check_next_match("quarter", quarter, start, start + 3 * 86400);
+    check_next_match("half past", half_past, start, start + 3 * 86400);
+    check_next_match("every second", every_second, start, start + 3 * 86400);
+  }
+}
+
+static void test_leap_day() {
+  setenv("TZ", "UTC0", 1);
+  tzset();
+  FakeClock rtc;
+  // 12:00 on the 29th of February if it is a Monday
+  CronTrigger monday(&rtc);
+  monday.add_second(0);
+  monday.add_minute(0);
+  monday.add_hour(12);
+  monday.add_day_of_month(29);
+  monday.add_month(2);
+  monday.add_day_of_week(2);
+  const ESPTime next = ESPTime::from_epoch_local(monday.next_match_after(1635552000));  // 2021-10-30
+  HOST_CHECK(next.year == 2044 && next.month == 2 && next.day_of_month == 29 && next.hour == 12,
+             "next is %04d-%02d-%02d %02d:00", next.year, next.month, next.day_of_month, next.hour);
+}
+
+static void test_time_changes() {
+  setenv("TZ", "UTC0", 1);
+  tzset();
+  FakeClock rtc;
+  CronScheduler scheduler(&rtc);
+  CountingTrigger hourly(&rtc, {0}, {0}, range(0, 24));
+  scheduler.add_trigger(&hourly);
+
+  const time_t midnight = 1635552000;  // 2021-10-30 00:00 UTC
+  host::set_time(midnight + 600);
+  scheduler.setup();
+  HOST_CHECK(hourly.fired == 0, "fired %d times at setup", hourly.fired);
+
+  host::advance(3000);
+  HOST_CHECK(hourly.fired == 1, "fired %d times until 01:00", hourly.fired);
+
+  // A small correction over the next full hour fires the trigger once
+  host::advance(3600 - 30);
+  rtc.sync(midnight + 2 * 3600 + 300);
+  HOST_CHECK(hourly.fired == 2, "fired %d times after a small correction", hourly.fired);
+
+  // After a jump by days the trigger doesn't fire for what was skipped, only at the next full hour
+  rtc.sync(midnight + 5 * 86400 + 1800);
+  HOST_CHECK(hourly.fired == 2, "fired %d times after a jump forward", hourly.fired);
+  host::advance(1800);
+  HOST_CHECK(hourly.fired == 3, "fired %d times after the next full hour", hourly.fired);
+
+  // After a jump back the full hours fire again
+  rtc.sync(midnight + 1800);
+  HOST_CHECK(hourly.fired == 3, "fired %d times after a jump back", hourly.fired);
+  host::advance(1800);
+  HOST_CHECK(hourly.fired == 4, "fired %d times after the next full hour", hourly.fired);
+
+  // A jump without a time sync is noticed by the scheduler itself
+  host::set_time(midnight + 10 * 86400 + 1800);
+  host::advance(60);
+  HOST_CHECK(hourly.fired == 4, "fired %d times after an unreported jump", hourly.fired);
+  host::advance(1800);
+  HOST_CHECK(hourly.fired == 5, "fired %d times after the next full hour", hourly.fired);
+}
+
+int main() {
+  // 2021: DST in Europe from March 28 to October 31, in southeast Australia until April 4 and from October 3
+  test_dst("CET-1CEST,M3.5.0,M10.5.0/3", 1616803200, 1635552000);
+  test_dst("AEST-10AEDT,M10.1.0,M4.1.0/3", 1633132800, 1617408000);
+  test_leap_day();
+  test_time_changes();
+  printf("%d failures\n", host::failures);
+  return host::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+import hashlib
+import random
+import socket
+import threading
+import zlib
+
+import pytest
+
+from esphome import espota2
+
+
+class SimulatedDevice:
+    """The device side of the OTA protocol, writing to a simulated flash.
+
+    Mirrors OTAComponent: negotiates the features it supports, decompresses
+    compressed uploads as they arrive, applies patches to the running firmware
+    and keeps an upload that lost its connection for the uploader to resume.
+    """
+
+    def __init__(
+        self, features=espota2.FEATURES, password="", drop_after=None, running=b""
+    ):
+        self.features = features
+        self.password = password
+        self.running = running
+        # close the first connection after this many bytes of the binary
+        self.drop_after = drop_after
+        self.flash = bytearray()
+        self.finished = False
+        self.resumed_at = []
+        self.received = 0
+        self._update = None
+        self._server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        # a small receive buffer makes a dropped connection show on the sender
+        self._server.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+        self._server.bind(("127.0.0.1", 0))
+        self._server.listen(1)
+        self.port = self._server.getsockname()[1]
+        self._thread = threading.Thread(target=self._run, daemon=True)
+        self._thread.start()
+
+    def close(self):
+        self._server.close()
+        self._thread.join(5)
+
+    def _run(self):
+        while not self.finished:
+            try:
+                conn, _ = self._server.accept()
+            except OSError:
+                return
+            with conn:
+                try:
+                    self._handle(conn)
+                except (OSError, ValueError):
+                    pass
+
+    @staticmethod
+    def _recv(conn, amount):
+        data = b""
+        while len(data) < amount:
+            chunk = conn.recv(amount - len(data))
+            if not chunk:
+                raise ValueError("connection closed")
+            data += chunk
+        return data
+
+    def _handle(self, conn):
+        assert self._recv(conn, 5) == bytes(espota2.MAGIC_BYTES)
+        conn.sendall(bytes([espota2.RESPONSE_OK, espota2.OTA_VERSION_1_0]))
+
+        (features,) = self._recv(conn, 1)
+        if features == 0 or self.features is None:
+            features = 0
+            conn.sendall(bytes([espota2.RESPONSE_HEADER_OK]))
+        else:
+            features &= self.features
+            conn.sendall(bytes([espota2.RESPONSE_FEATURES_OK, features]))
+        if features & espota2.FEATURE_DELTA:
+            conn.sendall(hashlib.md5(self.running).hexdigest().encode())
+            if self._recv(conn, 1) == b"\x00":
+                features &= ~espota2.FEATURE_DELTA
+
+        if self.password:
+            conn.sendall(bytes([espota2.RESPONSE_REQUEST_AUTH]))
+            nonce = hashlib.md5(b"nonce").hexdigest().encode()
+            conn.sendall(nonce)
+            cnonce = self._recv(conn, 32)
+            expected = hashlib.md5(self.password.encode() + nonce + cnonce)
+            if self._recv(conn, 32).decode() != expected.hexdigest():
+                conn.sendall(bytes([espota2.RESPONSE_ERROR_AUTH_INVALID]))
+                return
+        conn.sendall(bytes([espota2.RESPONSE_AUTH_OK]))
+
+        size = int.from_bytes(self._recv(conn, 4), "big")
+        conn.sendall(bytes([espota2.RESPONSE_UPDATE_PREPARE_OK]))
+        md5 = self._recv(conn, 32).decode()
+
+        update = self._update
+        if (
+            update is not None
+            and features & espota2.FEATURE_RESUME
+            and update == (size, md5, features)
+        ):
+            self.resumed_at.append(self.received)
+            conn.sendall(bytes([espota2.RESPONSE_BIN_MD5_RESUME]))
+            conn.sendall(self.received.to_bytes(4, "big"))
+        else:
+            self._update = (size, md5, features)
+            self.flash = bytearray()
+            self.patch = bytearray()
+            self.received = 0
+            self._stream_md5 = hashlib.md5()
+            # the device keeps a history of 4 KiB, larger windows fail here
+            self._inflator = zlib.decompressobj(espota2.COMPRESSION_WBITS)
+            conn.sendall(bytes([espota2.RESPONSE_BIN_MD5_OK]))
+
+        while self.received < size:
+            if self.drop_after is not None and self.received >= self.drop_after:
+                self.drop_after = None
+                return
+            data = conn.recv(min(4096, size - self.received))
+            if not data:
+                return
+            self.received += len(data)
+            self._stream_md5.update(data)
+            if features & espota2.FEATURE_COMPRESSION:
+                data = self._inflator.decompress(data)
+            if features & espota2.FEATURE_DELTA:
+                self.patch += data
+            else:
+                self.flash += data
+
+        if features & espota2.FEATURE_DELTA:
+            self.flash = bytearray(espota2.apply_patch(self.running, self.patch))
+            upload_md5 = hashlib.md5(self.flash).hexdigest()
+        else:
+            upload_md5 = self._stream_md5.hexdigest()
+        if upload_md5 != md5:
+            conn.sendall(bytes([espota2.RESPONSE_ERROR_UPDATE_END]))
+            return
+        conn.sendall(bytes([espota2.RESPONSE_RECEIVE_OK]))
+        conn.sendall(bytes([espota2.RESPONSE_UPDATE_END_OK]))
+        assert self._recv(conn, 1) == bytes([espota2.RESPONSE_OK])
+        self.finished = True
+
+
+@pytest.fixture
+def binary(tmp_path):
+    rand = random.Random(0)
+    # partly compressible, like a firmware image
+    data = bytes(rand.getrandbits(8) for _ in range(256 * 1024))
+    data += b"".join(b"string %d\0" % rand.randrange(100) for _ in range(100000))
+    path = tmp_path / "firmware.bin"
+    path.write_bytes(data)
+    return path
+
+
+@pytest.fixture(autouse=True)
+def no_sleep(monkeypatch):
+    monkeypatch.setattr(espota2.time, "sleep", lambda _: None)
+
+
+def run_ota(device, binary, password=""):
+    return espota2.run_ota_impl_("127.0.0.1", device.port, password, str(binary))
+
+
+def test_run_ota__legacy_device(binary):
+    device = SimulatedDevice(features=None)
+    try:
+        assert run_ota(device, binary) == 0
+    finally:
+        device.close()
+
+    assert device.finished
+    assert device.received == binary.stat().st_size
+    assert device.flash == binary.read_bytes()
+
+
+def test_run_ota__compressed(binary):
+    device = SimulatedDevice(password="secret")
+    try:
+        assert run_ota(device, binary, "secret") == 0
+    finally:
+        device.close()
+
+    assert device.finished
+    assert device.received < binary.stat().st_size
+    assert device.flash == binary.read_bytes()
+
+
+def test_run_ota__resumes_after_connection_lost(binary):
+    device = SimulatedDevice(drop_after=64 * 1024)
+    try:
+        assert run_ota(device, binary) == 0
+    finally:
+        device.close()
+
+    assert device.finished
+    assert len(device.resumed_at) == 1
+    assert device.resumed_at[0] >= 64 * 1024
+    assert device.flash == binary.read_bytes()
+
+
+def test_run_ota__connection_lost_without_resume(binary):
+    device = SimulatedDevice(
+        features=espota2.FEATURE_COMPRESSION, drop_after=64 * 1024
+    )
+    try:
+        assert run_ota(device, binary) == 1
+    finally:
+        device.close()
+
+    assert not device.finished
+    assert not device.resumed_at
+
+
+def test_run_ota__wrong_password(binary):
+    device = SimulatedDevice(password="secret")
+    try:
+        assert run_ota(device, binary, "wrong") == 1
+    finally:
+        device.close()
+
+    assert not device.finished
+
+
+def test_run_ota__delta(binary):
+    contents = binary.read_bytes()
+    # the running firmware differs by a few changed and inserted bytes
+    running = contents[:1000] + b"old" + contents[1000:200000] + contents[200100:]
+    espota2.store_base_image(espota2.base_image_dir(str(binary)), running)
+    device = SimulatedDevice(running=running)
+    try:
+        assert run_ota(device, binary) == 0
+    finally:
+        device.close()
+
+    assert device.finished
+    assert len(device.patch) > len(contents)
+    assert device.received < len(contents) // 10
+    assert device.flash == contents
+
+
+def test_run_ota__delta_unknown_firmware(binary):
+    device = SimulatedDevice(running=b"unknown")
+    try:
+        assert run_ota(device, binary) == 0
+    finally:
+        device.close()
+
+    assert device.finished
+    assert not device.patch
+    assert device.flash == binary.read_bytes()
+    # the next upload can be a patch against it
+    base = espota2.base_image_dir(str(binary))
+    md5 = hashlib.md5(binary.read_bytes()).hexdigest()
+    assert espota2.load_base_image(base, md5) == binary.read_bytes()
+
+
+@pytest.mark.parametrize(
+    "old, new",
+    (
+        (b"", b""),
+        (b"", b"new binary"),
+        (b"old binary", b""),
+        (bytes(range(256)) * 64, bytes(range(256)) * 64),
+        (bytes(range(256)) * 64, b"head" + bytes(range(256)) * 64 + b"tail"),
+        (bytes(range(256)) * 64, bytes((i * 7) & 0xFF for i in range(16384))),
+    ),
+)
+def test_make_patch(old, new):
+    patch = espota2.make_patch(old, new)
+
+    assert espota2.apply_patch(old, patch) == new
+
+
+def test_store_base_image__keeps_latest(tmp_path):
+    for i in range(espota2.BASE_IMAGES + 2):
+        espota2.store_base_image(str(tmp_path), b"binary %d" % i)
+
+    assert len(list(tmp_path.iterdir())) == espota2.BASE_IMAGES
+
+
+def test_compress_binary__window():
+    data = bytes(range(256)) * 64
+    compressed = espota2.compress_binary(data)
+
+    assert compressed[:4] == b"\x1f\x8b\x08\x00"
+    assert zlib.decompress(compressed, espota2.COMPRESSION_WBITS) == data
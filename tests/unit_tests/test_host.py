@@ -0,0 +1,54 @@
+"""Build and run the C++ tests in tests/host with the host compiler."""
+import shutil
+import subprocess
+from pathlib import Path
+
+import pytest
+
+ROOT = Path(__file__).resolve().parents[2]
+HOST_DIR = ROOT / "tests" / "host"
+CXX = shutil.which("g++")
+
+
+def sources(test):
+    """The component sources a test needs, from its `// Sources:` line."""
+    for line in test.read_text().splitlines():
+        if line.startswith("// Sources:"):
+            return [ROOT / src for src in line[len("// Sources:") :].split()]
+    return []
+
+
+@pytest.mark.skipif(CXX is None, reason="g++ is not installed")
+@pytest.mark.parametrize(
+    "test", sorted(HOST_DIR.glob("*_test.cpp")), ids=lambda test: test.stem
+)
+def test_host(test, tmp_path):
+    objects = []
+    # Compile one by one, the components' TAG constants clash in one unit
+    for src in [test, HOST_DIR / "host.cpp"] + sources(test):
+        obj = tmp_path / f"{len(objects)}_{src.stem}.o"
+        subprocess.run(
+            [
+                CXX,
+                "-std=c++11",
+                # tests place linker symbols at the absolute addresses of the ESP8266
+                "-fno-pie",
+                "-DARDUINO_ARCH_ESP8266",
+                f"-I{ROOT}",
+                f"-I{HOST_DIR / 'stubs'}",
+                f"-I{HOST_DIR}",
+                "-c",
+                str(src),
+                "-o",
+                str(obj),
+            ],
+            check=True,
+        )
+        objects.append(str(obj))
+    binary = tmp_path / test.stem
+    subprocess.run([CXX, "-no-pie"] + objects + ["-o", str(binary)], check=True)
+
+    result = subprocess.run(
+        [str(binary)], stdout=subprocess.PIPE, universal_newlines=True
+    )
+    assert result.returncode == 0, result.stdout
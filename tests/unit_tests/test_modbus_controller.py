@@ -0,0 +1,73 @@
+import pytest
+
+from esphome.components.modbus_controller import (
+    MAX_REGISTERS_PER_READ,
+    coalesce_registers,
+)
+
+
+@pytest.mark.parametrize(
+    "registers, max_gap, expected",
+    (
+        # Adjacent and overlapping registers are read together
+        ([("holding", 0, 1), ("holding", 1, 2)], 0, [("holding", 0, 3)]),
+        ([("holding", 0, 2), ("holding", 1, 1)], 0, [("holding", 0, 2)]),
+        # The order of the items doesn't matter
+        ([("holding", 10, 2), ("holding", 0, 1)], 9, [("holding", 0, 12)]),
+        # Gaps up to max_gap are read along
+        ([("holding", 0, 1), ("holding", 9, 1)], 8, [("holding", 0, 10)]),
+        (
+            [("holding", 0, 1), ("holding", 10, 1)],
+            8,
+            [("holding", 0, 1), ("holding", 10, 1)],
+        ),
+        ([("holding", 0, 1), ("holding", 1, 1)], 0, [("holding", 0, 2)]),
+        (
+            [("holding", 0, 1), ("holding", 2, 1)],
+            0,
+            [("holding", 0, 1), ("holding", 2, 1)],
+        ),
+        # Registers of different types are never read together
+        (
+            [("input", 1, 2), ("holding", 0, 1), ("holding", 3, 2), ("input", 4, 1)],
+            8,
+            [("holding", 0, 5), ("input", 1, 4)],
+        ),
+        (
+            [("holding", 0, 2), ("input", 2, 2)],
+            8,
+            [("holding", 0, 2), ("input", 2, 2)],
+        ),
+        ([], 8, []),
+    ),
+)
+def test_coalesce_registers(registers, max_gap, expected):
+    assert coalesce_registers(registers, max_gap) == expected
+
+
+def test_coalesce_registers__max_span():
+    # One read may span exactly MAX_REGISTERS_PER_READ registers
+    last = MAX_REGISTERS_PER_READ - 2
+    assert coalesce_registers([("holding", 0, 1), ("holding", last, 2)], 200) == [
+        ("holding", 0, MAX_REGISTERS_PER_READ)
+    ]
+    # One more starts a new read, even within max_gap
+    assert coalesce_registers([("holding", 0, 1), ("holding", last + 1, 2)], 200) == [
+        ("holding", 0, 1),
+        ("holding", last + 1, 2),
+    ]
+
+
+def test_coalesce_registers__max_span_splits_run():
+    registers = [("input", address, 2) for address in range(0, 300, 2)]
+
+    reads = coalesce_registers(registers, 0)
+
+    assert all(count <= MAX_REGISTERS_PER_READ for _, _, count in reads)
+    # No value is split between reads and all registers are covered exactly once
+    assert [(start, count % 2) for _, start, count in reads] == [
+        (0, 0),
+        (124, 0),
+        (248, 0),
+    ]
+    assert sum(count for _, _, count in reads) == 300